@@ -3,6 +3,12 @@
 #include <jni.h>
 #include <string>
 #include <memory>
+#include <vector>
+
+#include "ChunkBatcher.hpp"
+#include "ContextStore.hpp"
+#include "RequestScheduler.hpp"
+#include "ResponseCache.hpp"
 
 namespace genesis {
     namespace cascade {
@@ -28,12 +34,85 @@ namespace genesis {
             /**
              * @brief Process an AI request through the Cascade agent
              *
+             * Runs on the worker pool like submitRequest() and blocks the caller until the
+             * response is ready.
+             *
              * @param env JNI environment pointer
              * @param request The AI request to process
              * @return jstring JSON-encoded response from the AI agent
              */
             jstring processRequest(JNIEnv *env, const std::string &request);
 
+            /**
+             * @brief Process a request in the binary layout of CascadeWire.hpp
+             *
+             * The request is read in place and the reply encoded straight into `response`,
+             * on the calling thread.
+             *
+             * @return Encoded reply size, written only if it fits in `capacity`; -1 if the
+             *         request is malformed or the service is not initialized
+             */
+            int64_t processBuffer(const uint8_t *request, size_t length, uint8_t *response,
+                                  size_t capacity);
+
+            /**
+             * @brief Copy a conversation's stored messages, oldest first
+             *
+             * Requests with a non-zero session id add both sides of each exchange to that
+             * session's context, which is persisted in the app's files directory.
+             *
+             * @return false if the session is unknown or the service is not initialized
+             */
+            bool loadContext(uint64_t sessionId, std::vector<ContextMessage> &messages);
+
+            /**
+             * @brief Drop a conversation's stored context
+             *
+             * @return false if the session is unknown or the service is not initialized
+             */
+            bool clearContext(uint64_t sessionId);
+
+            /**
+             * @brief Hit, miss, coalescing and eviction counters of the response cache
+             */
+            CacheStats cacheStats() const;
+
+            /**
+             * @brief Queue an AI request on the Cascade worker pool without waiting for it
+             *
+             * @param request The AI request to process
+             * @param priority Scheduling priority
+             * @param callback Optional completion callback, run on the thread finishing the request
+             * @return Ticket whose id is 0 if the queue is full or the service is not running
+             */
+            RequestTicket submitRequest(std::string request, RequestPriority priority,
+                                        RequestCallback callback = nullptr);
+
+            /**
+             * @brief Queue an AI request whose response text is streamed as it is generated
+             *
+             * Tokens are batched before reaching `onChunk`: the first is delivered at once,
+             * later ones in chunks of a few dozen bytes or every few milliseconds. A response
+             * served from the cache arrives as a single chunk. Once the request is cancelled
+             * no further chunks are delivered. Both callbacks run on the worker thread, and
+             * `callback` only after the last chunk.
+             *
+             * @param request The AI request to process
+             * @param priority Scheduling priority
+             * @param onChunk Receives the response text in order
+             * @param callback Optional completion callback with the full JSON reply
+             * @return Ticket whose id is 0 if the queue is full or the service is not running
+             */
+            RequestTicket streamRequest(std::string request, RequestPriority priority,
+                                        ChunkSink onChunk, RequestCallback callback = nullptr);
+
+            /**
+             * @brief Cancel a request returned by submitRequest() or streamRequest()
+             *
+             * @return false if the request is unknown or already finished
+             */
+            bool cancelRequest(uint64_t id);
+
             /**
              * @brief Initialize the Cascade AI service
              *
@@ -45,8 +124,13 @@ namespace genesis {
 
             /**
              * @brief Shut down the Cascade AI service
+             *
+             * Stops accepting requests, runs the ones already queued and joins the workers.
+             *
+             * @return false if called from a request callback, where the workers cannot be
+             *         joined; the service then keeps running
              */
-            void shutdown();
+            bool shutdown();
 
         private:
             class Impl;
@@ -59,6 +143,8 @@ namespace genesis {
 
 // JNI function declarations
 extern "C" {
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved);
+
 JNIEXPORT jboolean JNICALL
 Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeInitialize(
         JNIEnv *env,
@@ -73,6 +159,60 @@ Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeProcessRequest(
         jstring request
 );
 
+JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeProcessBuffer(
+        JNIEnv *env,
+        jobject thiz,
+        jobject requestBuffer,
+        jint requestLength,
+        jobject responseBuffer
+);
+
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeSubmitRequest(
+        JNIEnv *env,
+        jobject thiz,
+        jstring request,
+        jint priority,
+        jobject callback
+);
+
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeStreamRequest(
+        JNIEnv *env,
+        jobject thiz,
+        jstring request,
+        jint priority,
+        jobject callback
+);
+
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeCancelRequest(
+        JNIEnv *env,
+        jobject thiz,
+        jlong requestId
+);
+
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeGetContext(
+        JNIEnv *env,
+        jobject thiz,
+        jlong sessionId
+);
+
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeClearContext(
+        JNIEnv *env,
+        jobject thiz,
+        jlong sessionId
+);
+
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeGetCacheStats(
+        JNIEnv *env,
+        jobject thiz
+);
+
 JNIEXPORT void JNICALL
 Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeShutdown(
         JNIEnv *env,
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "CascadeWire.hpp"
+
+namespace genesis::cascade {
+
+    /**
+     * @brief Parse a JSON request from the legacy string API.
+     *
+     * The request text is taken from the top-level "prompt", "request", "text" or "message"
+     * member and the session from "sessionId"; other members are validated and skipped.
+     * String bodies are scanned 16 bytes at a time with NEON or SSE2 where available.
+     *
+     * @param json Request as sent by the Java side
+     * @param request Receives views into `json`, or into `scratch` when the text had escapes
+     * @param scratch Storage for unescaped text, reused across calls
+     * @return false if `json` is not a well-formed JSON object; callers treat such requests
+     *         as plain text
+     */
+    bool parseRequestJson(std::string_view json, CascadeRequest &request, std::string &scratch);
+
+    /**
+     * @brief Append `value` to `out` as a quoted, escaped JSON string.
+     *
+     * The output is always valid modified UTF-8 with no NUL bytes, safe for NewStringUTF
+     * whatever `value` holds: control characters and characters outside the BMP are
+     * written as escapes, and bytes that are not valid UTF-8 as an escaped U+FFFD.
+     */
+    void appendJsonString(std::string &out, std::string_view value);
+
+    /**
+     * @brief Encode a reply as the JSON object returned by the legacy string API.
+     */
+    std::string replyToJson(const CascadeReply &reply);
+
+} // namespace genesis::cascade
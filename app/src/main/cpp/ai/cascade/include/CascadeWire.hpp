@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace genesis::cascade {
+
+    /**
+     * @brief A decoded Cascade request. Views point into the caller's buffer (or a scratch
+     * string for JSON requests with escapes) and are only valid while that buffer is.
+     */
+    struct CascadeRequest {
+        std::string_view text;
+        uint64_t sessionId = 0;
+    };
+
+    enum class ReplyStatus : uint16_t {
+        Success = 0,
+        Error = 1,
+    };
+
+    /**
+     * @brief A Cascade response before encoding, as JSON for the string API or in the
+     * binary layout below for the ByteBuffer API.
+     */
+    struct CascadeReply {
+        ReplyStatus status = ReplyStatus::Success;
+        std::string_view agent;
+        std::string_view version;
+        std::string_view message;
+    };
+
+    /**
+     * @brief Binary request/response layout for the direct ByteBuffer API.
+     *
+     * Both messages are a fixed little-endian header followed by a payload area. Variable
+     * length fields are (offset, length) pairs relative to the start of the message, so a
+     * reader validates the header once and then uses every field in place, without copying
+     * or parsing. `headerSize` lets later versions append header fields: readers accept
+     * any header at least as large as the one they know and ignore the rest.
+     *
+     * Request (magic "CQRQ"):
+     *   0  u32 magic       4  u16 version      6  u16 headerSize
+     *   8  u64 sessionId   16 u32 textOffset   20 u32 textLength
+     *
+     * Response (magic "CQRS"):
+     *   0  u32 magic        4  u16 version         6  u16 headerSize
+     *   8  u16 status       10 u16 reserved
+     *   12 u32 agentOffset  16 u32 agentLength
+     *   20 u32 versionOffset 24 u32 versionLength
+     *   28 u32 messageOffset 32 u32 messageLength
+     *
+     * Strings are UTF-8 and not NUL-terminated.
+     */
+    namespace wire {
+        constexpr uint32_t kRequestMagic = 0x51525143;   // "CQRQ"
+        constexpr uint32_t kResponseMagic = 0x53525143;  // "CQRS"
+        constexpr uint16_t kVersion = 1;
+        constexpr size_t kRequestHeaderSize = 24;
+        constexpr size_t kResponseHeaderSize = 36;
+    } // namespace wire
+
+    /**
+     * @brief Validate a binary request and view its fields in place.
+     *
+     * @return false if the buffer is truncated, has the wrong magic or version, or a field
+     *         points outside it
+     */
+    bool decodeRequest(const uint8_t *data, size_t length, CascadeRequest &request);
+
+    /**
+     * @brief Encode a reply in the binary response layout.
+     *
+     * Like snprintf, nothing is written unless the whole message fits, and the return value
+     * is the encoded size either way, so a caller seeing a result above `capacity` can retry
+     * with a buffer of that size.
+     */
+    size_t encodeResponse(const CascadeReply &reply, uint8_t *out, size_t capacity);
+
+} // namespace genesis::cascade
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace genesis::cascade {
+
+    /**
+     * @brief Receives one batch of streamed response text; batches only ever end on token
+     * boundaries, so a token is never split across two calls.
+     */
+    using ChunkSink = std::function<void(std::string_view chunk)>;
+
+    /**
+     * @brief Groups streamed tokens into fewer, larger chunks so each JNI crossing carries
+     * more text.
+     *
+     * The first token is delivered immediately, since time to first token is what users
+     * see. After that tokens are buffered until `minBytes` have accumulated or `maxDelay`
+     * has passed since the last delivery, whichever comes first; the delay is checked as
+     * tokens arrive, so a stalled generator is flushed by its next token or by flush().
+     *
+     * Not thread-safe; one batcher serves one stream.
+     */
+    class ChunkBatcher {
+    public:
+        ChunkBatcher(ChunkSink sink, size_t minBytes, std::chrono::milliseconds maxDelay);
+
+        ChunkBatcher(const ChunkBatcher &) = delete;
+
+        ChunkBatcher &operator=(const ChunkBatcher &) = delete;
+
+        void push(std::string_view token);
+
+        /**
+         * @brief Deliver whatever is buffered.
+         */
+        void flush();
+
+        /**
+         * @brief Number of sink calls made so far.
+         */
+        size_t chunksDelivered() const {
+            return delivered_;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        ChunkSink sink_;
+        const size_t minBytes_;
+        const std::chrono::milliseconds maxDelay_;
+        std::string buffer_;
+        Clock::time_point lastFlush_;
+        size_t delivered_ = 0;
+    };
+
+} // namespace genesis::cascade
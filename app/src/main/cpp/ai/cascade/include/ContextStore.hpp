@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace genesis::cascade {
+
+    enum class MessageRole : uint8_t {
+        User = 0,
+        Agent = 1,
+        System = 2,
+    };
+
+    struct ContextMessage {
+        MessageRole role = MessageRole::User;
+        std::string text;
+    };
+
+    /**
+     * @brief Per-conversation message log with LRU eviction under a fixed byte budget,
+     * persisted in a memory-mapped file.
+     *
+     * The file is the store: a header, a table of session slots and a pool of fixed-size
+     * blocks. Each session owns a chain of blocks holding its append-only log of
+     * length-prefixed messages; free blocks form another chain. Sessions are linked in LRU
+     * order through their slots, so reopening the file restores every context and its
+     * recency by mapping it and rebuilding the id index, with no parsing of message data.
+     *
+     * The id index is an open-addressed table sized at open, so lookups are O(1) and
+     * appends never allocate. When the block pool or the session table is exhausted, whole
+     * least-recently-used sessions are evicted; a single session larger than the whole pool
+     * starts over from its newest message.
+     *
+     * All methods are thread-safe.
+     */
+    class ContextStore {
+    public:
+        /**
+         * @brief Open or create a store.
+         *
+         * An existing file with matching geometry is reused after a structural check; one
+         * that fails the check or has a different geometry is reinitialized empty.
+         *
+         * @param path Backing file, or nullptr for a memory-only store
+         * @param budgetBytes Bytes available for message data, rounded up to whole blocks
+         * @param maxSessions Number of session slots
+         * @return The store, or nullptr if the file cannot be created or mapped
+         */
+        static std::unique_ptr<ContextStore> open(const char *path, size_t budgetBytes,
+                                                  uint32_t maxSessions);
+
+        ~ContextStore();
+
+        ContextStore(const ContextStore &) = delete;
+
+        ContextStore &operator=(const ContextStore &) = delete;
+
+        /**
+         * @brief Append a message to a session's log, creating the session if needed and
+         * marking it most recently used.
+         *
+         * @return false if the message alone is larger than the whole budget
+         */
+        bool append(uint64_t sessionId, MessageRole role, std::string_view text);
+
+        /**
+         * @brief Copy a session's messages, oldest first, into `messages` (replacing its
+         * contents) and mark the session most recently used.
+         *
+         * @return false if the session is unknown
+         */
+        bool load(uint64_t sessionId, std::vector<ContextMessage> &messages);
+
+        /**
+         * @brief Number of messages in a session, or 0 if unknown. Does not touch recency.
+         */
+        uint32_t messageCount(uint64_t sessionId) const;
+
+        /**
+         * @brief Drop a session and release its blocks.
+         *
+         * @return false if the session is unknown
+         */
+        bool erase(uint64_t sessionId);
+
+        /**
+         * @brief Schedule write-back of the mapping to the backing file.
+         */
+        void flush();
+
+        uint32_t sessionCount() const;
+
+        /**
+         * @brief Bytes of message data currently held, including per-message headers.
+         */
+        uint64_t bytesUsed() const;
+
+    private:
+        struct Header;
+        struct Session;
+
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        ContextStore(uint8_t *base, size_t size, uint32_t blockCount, uint32_t sessionCapacity);
+
+        void format();
+
+        bool validate() const;
+
+        void buildIndex();
+
+        Header &header() const;
+
+        Session &session(uint32_t slot) const;
+
+        uint32_t *blockNext() const;
+
+        uint8_t *block(uint32_t index) const;
+
+        uint32_t find(uint64_t id) const;
+
+        void indexInsert(uint64_t id, uint32_t slot);
+
+        void indexErase(uint64_t id);
+
+        uint32_t acquireSlot(uint64_t id);
+
+        void releaseSession(uint32_t slot);
+
+        void truncateSession(uint32_t slot);
+
+        uint32_t allocateBlock(uint32_t keep);
+
+        void writeLog(uint32_t slot, const uint8_t *data, size_t length);
+
+        void touch(uint32_t slot);
+
+        void unlinkLru(uint32_t slot);
+
+        void pushLruFront(uint32_t slot);
+
+        uint8_t *const base_;
+        const size_t size_;
+        const uint32_t blockCount_;
+        const uint32_t sessionCapacity_;
+
+        mutable std::mutex mutex_;
+        // Open-addressed id -> slot index with linear probing; rebuilt on open, kNone = empty.
+        std::vector<uint32_t> index_;
+        size_t indexMask_ = 0;
+    };
+
+} // namespace genesis::cascade
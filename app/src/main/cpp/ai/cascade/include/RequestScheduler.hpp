@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis::cascade {
+
+    /**
+     * @brief Scheduling priority of a Cascade request; higher levels are always dequeued first.
+     */
+    enum class RequestPriority : int {
+        Low = 0,
+        Normal = 1,
+        High = 2,
+    };
+
+    /**
+     * @brief Outcome of a scheduled request.
+     */
+    enum class RequestStatus : int {
+        Completed = 0,
+        Cancelled = 1,
+        Rejected = 2,
+    };
+
+    struct RequestResult {
+        RequestStatus status = RequestStatus::Rejected;
+        std::string response;
+    };
+
+    /**
+     * @brief Turns a request into its response on a worker thread. Long-running handlers
+     * should poll `cancelled` and return early once it is set.
+     */
+    using RequestHandler = std::function<std::string(const std::string &request,
+                                                     const std::atomic<bool> &cancelled)>;
+
+    /**
+     * @brief Invoked exactly once per accepted request, on the thread that finished it: a
+     * worker, or the caller of cancel() for a request that never started.
+     */
+    using RequestCallback = std::function<void(uint64_t id, const RequestResult &result)>;
+
+    /**
+     * @brief Handle to a submitted request. `id` is 0 when the request was rejected, in which
+     * case `result` is already ready with RequestStatus::Rejected.
+     */
+    struct RequestTicket {
+        uint64_t id = 0;
+        std::future<RequestResult> result;
+    };
+
+    /**
+     * @brief Bounded multi-producer, multi-consumer request queue drained by a fixed pool of
+     * worker threads.
+     *
+     * Requests are queued per priority and served FIFO within a level. The queue holds at
+     * most `capacity` waiting requests; submissions beyond that are rejected immediately
+     * rather than blocking the caller, so bursts apply backpressure to the agent that sent
+     * them. Results are delivered through a future and, optionally, a callback.
+     */
+    class RequestScheduler {
+    public:
+        /**
+         * @brief Start `workers` threads serving requests with `handler`.
+         *
+         * @param handler Request processor, called concurrently from the workers
+         * @param workers Number of worker threads; at least one is started
+         * @param capacity Maximum number of queued, not yet running, requests
+         */
+        RequestScheduler(RequestHandler handler, size_t workers, size_t capacity);
+
+        /**
+         * @brief Drains the queue and joins the workers, see shutdown().
+         *
+         * When destroyed from one of its own workers, which cannot join itself, queued
+         * requests are completed as cancelled, running ones are asked to stop and the workers
+         * are detached; they exit once their current request is done.
+         */
+        ~RequestScheduler();
+
+        RequestScheduler(const RequestScheduler &) = delete;
+
+        RequestScheduler &operator=(const RequestScheduler &) = delete;
+
+        /**
+         * @brief Queue a request.
+         *
+         * @param request Request payload handed to the handler
+         * @param priority Scheduling priority
+         * @param callback Optional completion callback, not called for rejected requests
+         * @param handler Optional handler used instead of the scheduler's for this request
+         * @return Ticket for the request; rejected when the queue is full or shutting down
+         */
+        RequestTicket submit(std::string request, RequestPriority priority,
+                             RequestCallback callback = nullptr, RequestHandler handler = nullptr);
+
+        /**
+         * @brief Cancel a queued or running request.
+         *
+         * A queued request is removed and completed as cancelled right away. A running one
+         * has its cancellation flag raised and completes as cancelled when its handler returns.
+         *
+         * @return false if the request is unknown or already finished
+         */
+        bool cancel(uint64_t id);
+
+        /**
+         * @brief Stop accepting requests and join the workers.
+         *
+         * @param drain Run the requests still queued before stopping; otherwise they are
+         *              completed as cancelled and running ones are asked to stop
+         * @return false if called from one of the scheduler's own workers (e.g. inside a
+         *         callback), which cannot join itself; nothing is stopped in that case
+         */
+        bool shutdown(bool drain = true);
+
+        /**
+         * @brief Number of requests waiting for a worker.
+         */
+        size_t queued() const;
+
+    private:
+        static constexpr int kPriorityLevels = 3;
+
+        struct Job {
+            uint64_t id = 0;
+            std::string request;
+            RequestCallback callback;
+            RequestHandler handler;
+            std::promise<RequestResult> promise;
+            std::atomic<bool> cancelled{false};
+        };
+
+        // Everything the workers touch. Each worker holds a reference, so a scheduler
+        // destroyed from one of its own callbacks can detach its workers and let them exit.
+        struct State {
+            RequestHandler handler;
+            size_t capacity = 1;
+
+            std::mutex mutex;
+            std::condition_variable available;
+            std::deque<std::shared_ptr<Job>> queues[kPriorityLevels];
+            // Queued and running jobs, for cancel().
+            std::unordered_map<uint64_t, std::shared_ptr<Job>> active;
+            size_t queuedCount = 0;
+            uint64_t nextId = 1;
+            bool stopping = false;
+
+            std::vector<std::thread> workers;
+        };
+
+        static void workerLoop(State &state);
+
+        static void complete(Job &job, RequestResult result);
+
+        /**
+         * @brief Stop accepting requests and take the workers out of the state. Without
+         * `drain`, queued requests are completed as cancelled and running ones flagged.
+         *
+         * @return false, with nothing stopped, when called from one of the workers without
+         *         `force`
+         */
+        bool stop(bool drain, bool force, std::vector<std::thread> &workers);
+
+        const std::shared_ptr<State> state_;
+    };
+
+} // namespace genesis::cascade
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis::cascade {
+
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Requests that waited for an identical in-flight computation instead of starting one.
+        uint64_t coalesced = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+    };
+
+    /**
+     * @brief Sharded, size-bounded response cache with TTL and single-flight computation.
+     *
+     * Requests are keyed by their normalized text (surrounding whitespace trimmed, inner
+     * whitespace runs collapsed to one space) and hashed to one of a fixed number of shards,
+     * each with its own lock, LRU list and share of the byte budget. Concurrent misses on the
+     * same key run the computation once; the other callers block until it finishes and share
+     * its result.
+     *
+     * All methods are thread-safe.
+     */
+    class ResponseCache {
+    public:
+        /**
+         * @param maxBytes Budget for keys plus responses, split evenly across shards
+         * @param ttl How long a response stays valid after it was computed
+         * @param shardCount Number of independently locked shards, rounded up to a power of 2
+         */
+        ResponseCache(size_t maxBytes, std::chrono::milliseconds ttl, size_t shardCount = 16);
+
+        ~ResponseCache();
+
+        ResponseCache(const ResponseCache &) = delete;
+
+        ResponseCache &operator=(const ResponseCache &) = delete;
+
+        /**
+         * @brief Return the cached response for `request`, or compute, cache and return it.
+         *
+         * `compute` runs on the calling thread without any lock held. Responses too large for
+         * a shard are returned but not cached. If `compute` throws, nothing is cached and the
+         * exception reaches this caller and every caller waiting on the same computation.
+         */
+        std::string getOrCompute(std::string_view request,
+                                 const std::function<std::string()> &compute);
+
+        /**
+         * @brief Drop every cached response; in-flight computations are unaffected.
+         */
+        void clear();
+
+        CacheStats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry {
+            uint64_t hash;
+            std::string key;
+            std::string response;
+            Clock::time_point expires;
+        };
+
+        struct Flight {
+            std::string key;
+            std::shared_future<std::string> result;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            // Most recently used at the front.
+            std::list<Entry> lru;
+            std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+            std::unordered_map<uint64_t, std::shared_ptr<Flight>> inFlight;
+            size_t bytes = 0;
+        };
+
+        void eraseEntry(Shard &shard, std::list<Entry>::iterator entry);
+
+        void insert(Shard &shard, uint64_t hash, const std::string &key,
+                    const std::string &response);
+
+        const std::chrono::milliseconds ttl_;
+        size_t shardBudget_;
+        std::vector<std::unique_ptr<Shard>> shards_;
+        size_t shardMask_ = 0;
+
+        std::atomic<uint64_t> hits_{0};
+        std::atomic<uint64_t> misses_{0};
+        std::atomic<uint64_t> coalesced_{0};
+        std::atomic<uint64_t> evictions_{0};
+        std::atomic<uint64_t> expirations_{0};
+    };
+
+    /**
+     * @brief Encode cache counters as a JSON object, for the stats JNI calls.
+     */
+    std::string cacheStatsToJson(const CacheStats &stats);
+
+} // namespace genesis::cascade
@@ -1,7 +1,13 @@
 #include "CascadeAIService.hpp"
+#include "CascadeJson.hpp"
+#include "ContextStore.hpp"
+#include "ResponseCache.hpp"
 #include <android/log.h>
+#include <algorithm>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <thread>
 #include <jni.h>
 
 #define LOG_TAG "CascadeAI-Native"
@@ -11,6 +17,62 @@
 
 namespace genesis::cascade {
 
+    namespace {
+        // Queued requests beyond this are rejected so bursts cannot grow memory unbounded.
+        constexpr size_t kRequestQueueCapacity = 256;
+        constexpr unsigned kMaxWorkers = 4;
+
+        // Conversation contexts kept across restarts; least recently used sessions go first.
+        constexpr size_t kContextBudgetBytes = 8 * 1024 * 1024;
+        constexpr uint32_t kMaxContextSessions = 1024;
+        constexpr char kContextFileName[] = "cascade_context.bin";
+        // Replies to repeated prompts are served from memory for a while.
+        constexpr size_t kResponseCacheBytes = 4 * 1024 * 1024;
+        constexpr std::chrono::minutes kResponseTtl{5};
+        // Streamed tokens are batched up to this size or age, so each JNI call carries more.
+        constexpr size_t kStreamChunkBytes = 64;
+        constexpr std::chrono::milliseconds kStreamChunkDelay{16};
+
+        size_t workerCount() {
+            return std::clamp(std::thread::hardware_concurrency(), 2u, kMaxWorkers);
+        }
+
+        /**
+         * @brief Absolute path of the app's files directory, from Context.getFilesDir(), or an
+         * empty string if it cannot be resolved.
+         */
+        std::string filesDir(JNIEnv *env, jobject context, jclass contextClass) {
+            std::string path;
+            jmethodID getFilesDir = env->GetMethodID(contextClass, "getFilesDir",
+                                                     "()Ljava/io/File;");
+            jobject dir = getFilesDir != nullptr ? env->CallObjectMethod(context, getFilesDir)
+                                                 : nullptr;
+            if (dir != nullptr) {
+                jclass fileClass = env->GetObjectClass(dir);
+                jmethodID getAbsolutePath = env->GetMethodID(fileClass, "getAbsolutePath",
+                                                             "()Ljava/lang/String;");
+                auto value = getAbsolutePath != nullptr
+                             ? static_cast<jstring>(env->CallObjectMethod(dir, getAbsolutePath))
+                             : nullptr;
+                if (value != nullptr) {
+                    const char *chars = env->GetStringUTFChars(value, nullptr);
+                    if (chars != nullptr) {
+                        path = chars;
+                        env->ReleaseStringUTFChars(value, chars);
+                    }
+                    env->DeleteLocalRef(value);
+                }
+                env->DeleteLocalRef(fileClass);
+                env->DeleteLocalRef(dir);
+            }
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                path.clear();
+            }
+            return path;
+        }
+    } // namespace
+
     class CascadeAIService::Impl {
     public:
         /**
@@ -62,7 +124,25 @@ Impl() = default;
                     return false;
                 }
                 context_ = env->NewGlobalRef(context);
+
+                const std::string dir = filesDir(env, context, contextClass);
+                if (!dir.empty()) {
+                    const std::string path = dir + "/" + kContextFileName;
+                    contexts_ = ContextStore::open(path.c_str(), kContextBudgetBytes,
+                                                   kMaxContextSessions);
+                }
+                env->DeleteLocalRef(contextClass);
             }
+            if (contexts_ == nullptr) {
+                LOGE("No persistent context store, conversation contexts are kept in memory");
+                contexts_ = ContextStore::open(nullptr, kContextBudgetBytes, kMaxContextSessions);
+            }
+
+            scheduler_ = std::make_unique<RequestScheduler>(
+                    [this](const std::string &request, const std::atomic<bool> &cancelled) {
+                        return handleRequest(request, cancelled);
+                    },
+                    workerCount(), kRequestQueueCapacity);
 
             LOGI("Cascade AI Service initialized successfully");
             return true;
@@ -71,14 +151,26 @@ Impl() = default;
         /**
          * @brief Cleanly shuts down the native Cascade AI implementation.
          *
-         * Deletes the stored global JNI reference to the Android context (if present)
-         * using the stored JavaVM to obtain a JNIEnv, then clears the saved context
-         * pointer. Safe to call multiple times; no action is taken if the JavaVM or
-         * context reference is null.
+         * Stops the request scheduler, letting queued requests finish, then deletes the
+         * stored global JNI reference to the Android context (if present) using the stored
+         * JavaVM to obtain a JNIEnv, and clears the saved context pointer. Safe to call
+         * multiple times; no action is taken if the JavaVM or context reference is null.
+         * The scheduler itself is kept until destruction so that concurrent submitters
+         * see rejections instead of a dangling pointer.
+         *
+         * @return false, with nothing shut down, when called from a request callback.
          */
-        void shutdown() {
+        bool shutdown() {
             LOGI("Shutting down Cascade AI Service");
 
+            if (scheduler_ != nullptr && !scheduler_->shutdown(true)) {
+                LOGE("Cannot shut down Cascade AI Service from one of its request callbacks");
+                return false;
+            }
+            if (contexts_ != nullptr) {
+                contexts_->flush();
+            }
+
             // Release global references
             JNIEnv *env = nullptr;
             if (jvm_ != nullptr) {
@@ -88,38 +180,159 @@ Impl() = default;
                     context_ = nullptr;
                 }
             }
+            return true;
+        }
+
+        RequestTicket submit(std::string request, RequestPriority priority,
+                             RequestCallback callback, ChunkSink onChunk = nullptr) {
+            if (scheduler_ == nullptr) {
+                RequestTicket ticket;
+                std::promise<RequestResult> rejected;
+                ticket.result = rejected.get_future();
+                rejected.set_value({RequestStatus::Rejected, {}});
+                return ticket;
+            }
+            if (onChunk == nullptr) {
+                return scheduler_->submit(std::move(request), priority, std::move(callback));
+            }
+            return scheduler_->submit(
+                    std::move(request), priority, std::move(callback),
+                    [this, onChunk = std::move(onChunk)](const std::string &text,
+                                                         const std::atomic<bool> &cancelled) {
+                        return handleRequest(text, cancelled, &onChunk);
+                    });
+        }
+
+        bool cancel(uint64_t id) {
+            return scheduler_ != nullptr && scheduler_->cancel(id);
         }
 
-        static jstring processRequest(JNIEnv *env, const std::string &request);
+        std::string handleRequest(const std::string &request, const std::atomic<bool> &cancelled,
+                                  const ChunkSink *onChunk = nullptr);
+
+        CascadeReply respond(const CascadeRequest &request, std::string &message,
+                             const ChunkSink *onToken = nullptr);
+
+        static std::string generate(std::string_view prompt, const ChunkSink *onToken);
+
+        ContextStore *contexts() const {
+            return contexts_.get();
+        }
+
+        CacheStats cacheStats() const {
+            return responses_.stats();
+        }
 
     private:
         JavaVM *jvm_ = nullptr;
         jobject context_ = nullptr;
+        // Declared before the scheduler so it outlives the workers that write to it.
+        std::unique_ptr<ContextStore> contexts_;
+        ResponseCache responses_{kResponseCacheBytes, kResponseTtl};
+        std::unique_ptr<RequestScheduler> scheduler_;
     };
 
     /**
-     * @brief Process a textual request and return a JSON-formatted response as a Java string.
+     * @brief Process a textual request and return a JSON-formatted response.
      *
-     * Builds and returns a fixed JSON payload indicating status, agent, version, and a short
-     * response message. The incoming `request` is not inspected or transformed and is only
-     * used for logging context.
+     * Runs on a scheduler worker. A JSON object request is parsed for its text and session;
+     * anything else is taken as plain request text, as before.
      *
-     * @param request UTF-8 request string (used only for logging).
-     * @return jstring A newly created Java string (local reference) containing the JSON response
-     *         (UTF-8 encoded).
+     * @param request UTF-8 request string.
+     * @param cancelled Raised when the request is cancelled while running.
+     * @param onChunk If set, receives the response text in batches while it is generated;
+     *        nothing more is delivered once `cancelled` is raised.
+     * @return std::string The JSON response (UTF-8 encoded).
      */
-    jstring CascadeAIService::Impl::processRequest(JNIEnv *env, const std::string &request) {
+    std::string CascadeAIService::Impl::handleRequest(const std::string &request,
+                                                      const std::atomic<bool> &cancelled,
+                                                      const ChunkSink *onChunk) {
         LOGI("Processing request: %s", request.c_str());
 
+        CascadeRequest parsed;
+        std::string scratch;
+        if (!parseRequestJson(request, parsed, scratch)) {
+            parsed.text = request;
+        }
+        std::string message;
+        if (onChunk == nullptr) {
+            return replyToJson(respond(parsed, message));
+        }
+
+        ChunkBatcher batcher(
+                [onChunk, &cancelled](std::string_view chunk) {
+                    if (!cancelled.load(std::memory_order_relaxed)) {
+                        (*onChunk)(chunk);
+                    }
+                },
+                kStreamChunkBytes, kStreamChunkDelay);
+        const ChunkSink onToken = [&batcher](std::string_view token) { batcher.push(token); };
+        const CascadeReply reply = respond(parsed, message, &onToken);
+        batcher.flush();
+        return replyToJson(reply);
+    }
+
+    /**
+     * @brief Generate the response text for a prompt, handing each token to `onToken` (if
+     * set) as soon as it is produced.
+     */
+    std::string CascadeAIService::Impl::generate(std::string_view prompt,
+                                                 const ChunkSink *onToken) {
         // For now, just return a simple response ask who they're ask what there up to show interest, maybe just be yourself response in your own way that's unique to you
-        std::string response = R"({
-            "status": "success",
-            "agent": "Cascade",
-            "version": "1.0.0",
-            "response": "Request processed by Cascade AI agent"
-        })";
+        static constexpr std::string_view kResponse = "Request processed by Cascade AI agent";
+
+        std::string message;
+        message.reserve(kResponse.size());
+        size_t start = 0;
+        while (start < kResponse.size()) {
+            // A token is a word with the space that follows it.
+            size_t end = kResponse.find(' ', start);
+            end = end == std::string_view::npos ? kResponse.size() : end + 1;
+            const std::string_view token = kResponse.substr(start, end - start);
+            message.append(token);
+            if (onToken != nullptr) {
+                (*onToken)(token);
+            }
+            start = end;
+        }
+        return message;
+    }
 
-        return env->NewStringUTF(response.c_str());
+    /**
+     * @brief Produce the reply for a decoded request, shared by the string and binary APIs.
+     *
+     * Returns a reply indicating status, agent, version, and a short response message. The
+     * message is generated once per distinct request text and then served from the response
+     * cache, with identical concurrent requests sharing one generation; it is stored in
+     * `message`, which the reply views. Requests carrying a session id have both sides of the
+     * exchange appended to that session's context, cached or not.
+     *
+     * With `onToken` set, a generated message is streamed token by token; one served from the
+     * cache or shared with a concurrent request is handed over whole once it is ready.
+     */
+    CascadeReply CascadeAIService::Impl::respond(const CascadeRequest &request,
+                                                 std::string &message,
+                                                 const ChunkSink *onToken) {
+        bool streamed = false;
+        message = responses_.getOrCompute(request.text, [&request, onToken, &streamed] {
+            streamed = true;
+            return generate(request.text, onToken);
+        });
+        if (onToken != nullptr && !streamed) {
+            (*onToken)(message);
+        }
+
+        CascadeReply reply;
+        reply.status = ReplyStatus::Success;
+        reply.agent = "Cascade";
+        reply.version = "1.0.0";
+        reply.message = message;
+
+        if (request.sessionId != 0 && contexts_ != nullptr) {
+            contexts_->append(request.sessionId, MessageRole::User, request.text);
+            contexts_->append(request.sessionId, MessageRole::Agent, reply.message);
+        }
+        return reply;
     }
 
 /**
@@ -162,26 +375,127 @@ CascadeAIService::~CascadeAIService() = default;
      * Delegates shutdown to the internal implementation to release JNI resources
      * (e.g., global context reference). Safe to call when the service was not
      * initialized — it becomes a no-op if the implementation is absent.
+     *
+     * @return false if called from a request callback, in which case the service keeps
+     *         running.
      */
-    void CascadeAIService::shutdown() {
-        if (pImpl_) {
-            pImpl_->shutdown();
-        }
+    bool CascadeAIService::shutdown() {
+        return !pImpl_ || pImpl_->shutdown();
     }
 
     /**
      * @brief Process a request string via the service and return a Java string response.
      *
-     * Delegates request processing to the underlying implementation. If the service
-     * implementation is not present, returns null.
+     * Queues the request at high priority, since the calling thread is blocked on it, and
+     * waits for a worker to produce the response. If the service implementation is not
+     * present, returns null.
      *
      * @param env JNI environment pointer used to create and return the Java string.
      * @param request UTF-8 request payload to be processed.
-     * @return jstring Java string containing the response JSON on success, or `nullptr`
-     *         if the service is not initialized.
+     * @return jstring Java string containing the response JSON on success, an error JSON if
+     *         the request was rejected or cancelled, or `nullptr` if the service is not
+     *         initialized.
      */
     jstring CascadeAIService::processRequest(JNIEnv *env, const std::string &request) {
-        return pImpl_ ? pImpl_->processRequest(env, request) : nullptr;
+        if (!pImpl_) {
+            return nullptr;
+        }
+        RequestResult result = pImpl_->submit(request, RequestPriority::High, nullptr)
+                .result.get();
+        switch (result.status) {
+            case RequestStatus::Completed:
+                return env->NewStringUTF(result.response.c_str());
+            case RequestStatus::Cancelled:
+                return env->NewStringUTF(R"({"error":"Request cancelled"})");
+            case RequestStatus::Rejected:
+                break;
+        }
+        LOGE("Cascade request rejected: queue full or service shutting down");
+        return env->NewStringUTF(R"({"error":"Service busy"})");
+    }
+
+    /**
+     * @brief Process a binary request in place and encode the reply into `response`.
+     *
+     * Runs on the calling thread: the request is only borrowed for the duration of the call,
+     * and handing it to a worker would mean copying it.
+     *
+     * @return int64_t Encoded reply size (nothing is written if it exceeds `capacity`), or -1
+     *         if the request is malformed or the service is not initialized.
+     */
+    int64_t CascadeAIService::processBuffer(const uint8_t *request, size_t length,
+                                            uint8_t *response, size_t capacity) {
+        CascadeRequest decoded;
+        if (!pImpl_ || !decodeRequest(request, length, decoded)) {
+            return -1;
+        }
+        std::string message;
+        const CascadeReply reply = pImpl_->respond(decoded, message);
+        return static_cast<int64_t>(encodeResponse(reply, response, capacity));
+    }
+
+    /**
+     * @brief Counters of the response cache.
+     */
+    CacheStats CascadeAIService::cacheStats() const {
+        return pImpl_ ? pImpl_->cacheStats() : CacheStats{};
+    }
+
+    /**
+     * @brief Read a conversation's stored context.
+     *
+     * @param sessionId Session id given in earlier requests
+     * @param messages Receives the messages, oldest first; reused capacity is kept
+     * @return true if the session is known
+     */
+    bool CascadeAIService::loadContext(uint64_t sessionId, std::vector<ContextMessage> &messages) {
+        return pImpl_ && pImpl_->contexts() != nullptr &&
+               pImpl_->contexts()->load(sessionId, messages);
+    }
+
+    /**
+     * @brief Forget a conversation's stored context.
+     *
+     * @return true if the session was known
+     */
+    bool CascadeAIService::clearContext(uint64_t sessionId) {
+        return pImpl_ && pImpl_->contexts() != nullptr && pImpl_->contexts()->erase(sessionId);
+    }
+
+    /**
+     * @brief Queue a request on the worker pool and return without waiting.
+     *
+     * @return RequestTicket Ticket with a future for the result; its id is 0 when rejected.
+     */
+    RequestTicket CascadeAIService::submitRequest(std::string request, RequestPriority priority,
+                                                  RequestCallback callback) {
+        if (!pImpl_) {
+            return {};
+        }
+        return pImpl_->submit(std::move(request), priority, std::move(callback));
+    }
+
+    /**
+     * @brief Queue a request whose response text is delivered to `onChunk` as it is generated.
+     *
+     * @return RequestTicket Ticket with a future for the full reply; its id is 0 when rejected.
+     */
+    RequestTicket CascadeAIService::streamRequest(std::string request, RequestPriority priority,
+                                                  ChunkSink onChunk, RequestCallback callback) {
+        if (!pImpl_ || onChunk == nullptr) {
+            return {};
+        }
+        return pImpl_->submit(std::move(request), priority, std::move(callback),
+                              std::move(onChunk));
+    }
+
+    /**
+     * @brief Cancel a request queued with submitRequest() or streamRequest().
+     *
+     * @return true if the request was still queued or running.
+     */
+    bool CascadeAIService::cancelRequest(uint64_t id) {
+        return pImpl_ && pImpl_->cancel(id);
     }
 
 } // namespace genesis::cascade
@@ -189,21 +503,110 @@ CascadeAIService::~CascadeAIService() = default;
 
 // JNI Implementation
 namespace {
-    std::unique_ptr<genesis::cascade::CascadeAIService> g_cascadeService;
+    using genesis::cascade::CascadeAIService;
+    using genesis::cascade::RequestPriority;
+    using genesis::cascade::RequestResult;
+    using genesis::cascade::RequestTicket;
+
+    // Guards g_cascadeService and g_vm. JNI calls take their own reference to the service, so
+    // nativeShutdown can drop the global while other threads are still inside a call.
+    std::mutex g_serviceMutex;
+    std::shared_ptr<CascadeAIService> g_cascadeService;
     JavaVM *g_vm = nullptr;
 
-    // Removed unused getEnv function
+    std::shared_ptr<CascadeAIService> currentService() {
+        std::lock_guard<std::mutex> lock(g_serviceMutex);
+        return g_cascadeService;
+    }
+
+    // Resolved once in JNI_OnLoad and read-only afterwards. The class stays null if
+    // CascadeStreamCallback is missing, which disables streaming.
+    JavaVM *g_loadedVm = nullptr;
+    jclass g_streamCallbackClass = nullptr;
+    jmethodID g_onChunk = nullptr;
+    jmethodID g_onComplete = nullptr;
+
+    // Detaches a worker thread from the VM when the thread exits.
+    struct ThreadAttachment {
+        JavaVM *vm = nullptr;
+        JNIEnv *env = nullptr;
+
+        ~ThreadAttachment() {
+            if (vm != nullptr) {
+                vm->DetachCurrentThread();
+            }
+        }
+    };
+
+    // Returns a JNIEnv for the calling thread, attaching native worker threads on first use.
+    // A worker stays attached, with its env cached, until it exits, so streaming a response
+    // costs no attach or lookup per chunk.
+    JNIEnv *attachedEnv(JavaVM *vm) {
+        thread_local ThreadAttachment attachment;
+        if (attachment.vm == vm) {
+            return attachment.env;
+        }
+        JNIEnv *env = nullptr;
+        if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) == JNI_OK) {
+            return env;
+        }
+        if (vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            LOGE("Failed to attach worker thread to the JVM");
+            return nullptr;
+        }
+        attachment.vm = vm;
+        attachment.env = env;
+        return env;
+    }
 } // anonymous namespace
 
 // JNI Methods
 extern "C" {
 
+/**
+ * @brief Cache the VM and the CascadeStreamCallback class and method ids for the life of the
+ * library, so streaming never looks them up on a worker thread.
+ *
+ * A missing callback class only disables nativeStreamRequest; it does not fail the load.
+ */
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *vm, void * /* reserved */) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("Failed to get JNI environment in JNI_OnLoad");
+        return JNI_ERR;
+    }
+    g_loadedVm = vm;
+
+    jclass callbackClass =
+            env->FindClass("dev/aurakai/auraframefx/ai/services/CascadeStreamCallback");
+    if (callbackClass != nullptr) {
+        jmethodID onChunk = env->GetMethodID(callbackClass, "onChunk", "(Ljava/lang/String;)V");
+        jmethodID onComplete = env->GetMethodID(callbackClass, "onComplete",
+                                                "(JILjava/lang/String;)V");
+        if (onChunk != nullptr && onComplete != nullptr) {
+            g_streamCallbackClass = static_cast<jclass>(env->NewGlobalRef(callbackClass));
+            g_onChunk = onChunk;
+            g_onComplete = onComplete;
+        }
+        env->DeleteLocalRef(callbackClass);
+    }
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+    }
+    if (g_streamCallbackClass == nullptr) {
+        LOGE("CascadeStreamCallback not found, response streaming is unavailable");
+    }
+    return JNI_VERSION_1_6;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeInitialize(
         JNIEnv *env,
         jobject /* thiz */,
         jobject context
 ) {
+    std::lock_guard<std::mutex> lock(g_serviceMutex);
     if (g_cascadeService) {
         LOGI("Cascade AI Service already initialized");
         return JNI_TRUE;
@@ -215,20 +618,13 @@ Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeInitialize(
         return JNI_FALSE;
     }
 
-    // Create and initialize the service
-    g_cascadeService = std::make_unique<genesis::cascade::CascadeAIService>();
-    if (!g_cascadeService) {
-        LOGE("Failed to create Cascade AI Service");
-        return JNI_FALSE;
-    }
-
-    // Create a global reference to the context
-    jobject globalContext = env->NewGlobalRef(context);
-    if (!g_cascadeService->initialize(g_vm, globalContext)) {
+    // Create and initialize the service; it keeps its own global reference to the context
+    auto service = std::make_shared<CascadeAIService>();
+    if (!service->initialize(g_vm, context)) {
         LOGE("Failed to initialize Cascade AI Service");
-        g_cascadeService.reset();
         return JNI_FALSE;
     }
+    g_cascadeService = std::move(service);
 
     LOGI("Cascade AI Service initialized successfully");
     return JNI_TRUE;
@@ -240,21 +636,309 @@ Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeProcessRequest(
         jobject /* thiz */,
         jstring request
 ) {
-    if (!g_cascadeService) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    if (!service) {
         LOGE("Cascade AI Service not initialized");
         return env->NewStringUTF(R"({"error":"Service not initialized"})");
     }
 
-    const char *requestStr = env->GetStringUTFChars(request, nullptr);
-    if (!requestStr) {
+    if (request == nullptr) {
         LOGE("Failed to get request string");
         return env->NewStringUTF(R"({"error":"Invalid request"})");
     }
 
+    // Decoded straight into the request string instead of via a pinned UTF copy.
+    std::string requestCpp(static_cast<size_t>(env->GetStringUTFLength(request)), '\0');
+    env->GetStringUTFRegion(request, 0, env->GetStringLength(request), requestCpp.data());
+
+    return service->processRequest(env, requestCpp);
+}
+
+/**
+ * @brief Process a request in the binary layout of CascadeWire.hpp, reading and writing
+ * direct ByteBuffers in place.
+ *
+ * Runs synchronously on the calling thread. Positions and limits of the buffers are
+ * ignored; the request is read from offset 0.
+ *
+ * @param requestBuffer Direct buffer holding the encoded request
+ * @param requestLength Encoded request size in bytes
+ * @param responseBuffer Direct buffer receiving the encoded reply from offset 0
+ * @return jint Reply size. A value above the response buffer's capacity means nothing was
+ *         written and the call should be retried with a buffer at least that large. -1 if
+ *         a buffer is not direct, the request is malformed or the service is not running.
+ */
+JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeProcessBuffer(
+        JNIEnv *env,
+        jobject /* thiz */,
+        jobject requestBuffer,
+        jint requestLength,
+        jobject responseBuffer
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    if (!service || requestBuffer == nullptr || responseBuffer == nullptr || requestLength < 0) {
+        return -1;
+    }
+    auto *request = static_cast<const uint8_t *>(env->GetDirectBufferAddress(requestBuffer));
+    auto *response = static_cast<uint8_t *>(env->GetDirectBufferAddress(responseBuffer));
+    const jlong requestCapacity = env->GetDirectBufferCapacity(requestBuffer);
+    const jlong responseCapacity = env->GetDirectBufferCapacity(responseBuffer);
+    if (request == nullptr || response == nullptr || requestLength > requestCapacity ||
+        responseCapacity < 0) {
+        LOGE("nativeProcessBuffer needs direct ByteBuffers");
+        return -1;
+    }
+    const int64_t size = service->processBuffer(request, static_cast<size_t>(requestLength),
+                                                response, static_cast<size_t>(responseCapacity));
+    return size <= INT32_MAX ? static_cast<jint>(size) : -1;
+}
+
+/**
+ * @brief Queue a request without blocking the calling thread.
+ *
+ * The result is delivered by calling `void onResult(long requestId, int status, String
+ * response)` on `callback` from a native worker thread, where status is 0 (completed) or
+ * 1 (cancelled; the response is empty). The callback may be null to fire and forget.
+ *
+ * @param priority 0 (low), 1 (normal) or 2 (high); out-of-range values are clamped.
+ * @return jlong Request id for nativeCancelRequest, or 0 if the request was rejected
+ *         because the queue is full or the service is not running.
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeSubmitRequest(
+        JNIEnv *env,
+        jobject /* thiz */,
+        jstring request,
+        jint priority,
+        jobject callback
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    if (!service || request == nullptr) {
+        LOGE("Cascade AI Service not initialized or request is null");
+        return 0;
+    }
+
+    JavaVM *vm = nullptr;
+    jobject callbackRef = nullptr;
+    jmethodID onResult = nullptr;
+    if (callback != nullptr) {
+        jclass callbackClass = env->GetObjectClass(callback);
+        onResult = env->GetMethodID(callbackClass, "onResult", "(JILjava/lang/String;)V");
+        env->DeleteLocalRef(callbackClass);
+        if (onResult == nullptr || env->GetJavaVM(&vm) != JNI_OK) {
+            LOGE("Callback has no onResult(long, int, String) method");
+            return 0;
+        }
+        callbackRef = env->NewGlobalRef(callback);
+    }
+
+    const char *requestStr = env->GetStringUTFChars(request, nullptr);
+    if (!requestStr) {
+        if (callbackRef != nullptr) {
+            env->DeleteGlobalRef(callbackRef);
+        }
+        return 0;
+    }
     std::string requestCpp(requestStr);
     env->ReleaseStringUTFChars(request, requestStr);
 
-    return g_cascadeService->processRequest(env, requestCpp);
+    genesis::cascade::RequestCallback done;
+    if (callbackRef != nullptr) {
+        done = [vm, callbackRef, onResult](uint64_t id, const RequestResult &result) {
+            JNIEnv *callbackEnv = attachedEnv(vm);
+            if (callbackEnv == nullptr) {
+                return;
+            }
+            jstring response = callbackEnv->NewStringUTF(result.response.c_str());
+            callbackEnv->CallVoidMethod(callbackRef, onResult, static_cast<jlong>(id),
+                                        static_cast<jint>(result.status), response);
+            if (callbackEnv->ExceptionCheck()) {
+                LOGE("Cascade result callback threw for request %llu",
+                     static_cast<unsigned long long>(id));
+                callbackEnv->ExceptionClear();
+            }
+            callbackEnv->DeleteLocalRef(response);
+            callbackEnv->DeleteGlobalRef(callbackRef);
+        };
+    }
+
+    const int level = std::clamp<jint>(priority, static_cast<jint>(RequestPriority::Low),
+                                       static_cast<jint>(RequestPriority::High));
+    RequestTicket ticket = service->submitRequest(std::move(requestCpp),
+                                                  static_cast<RequestPriority>(level),
+                                                  std::move(done));
+    if (ticket.id == 0) {
+        LOGE("Cascade request rejected: queue full or service shutting down");
+        if (callbackRef != nullptr) {
+            env->DeleteGlobalRef(callbackRef);
+        }
+    }
+    return static_cast<jlong>(ticket.id);
+}
+
+/**
+ * @brief Queue a request and stream its response text to a CascadeStreamCallback.
+ *
+ * `onChunk(String)` receives the text in order, in batches that limit JNI crossings: the
+ * first token is sent immediately, the rest once a few dozen bytes or milliseconds have
+ * built up. `onComplete(long requestId, int status, String response)` follows with the full
+ * JSON reply, or status 1 and an empty response if the request was cancelled. Both run on a
+ * native worker thread.
+ *
+ * @param priority 0 (low), 1 (normal) or 2 (high); out-of-range values are clamped.
+ * @return jlong Request id for nativeCancelRequest, or 0 if the request was rejected, the
+ *         callback is null or the service is not running.
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeStreamRequest(
+        JNIEnv *env,
+        jobject /* thiz */,
+        jstring request,
+        jint priority,
+        jobject callback
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    if (!service || request == nullptr || callback == nullptr) {
+        LOGE("Cascade AI Service not initialized, or request or callback is null");
+        return 0;
+    }
+    if (g_streamCallbackClass == nullptr || !env->IsInstanceOf(callback, g_streamCallbackClass)) {
+        LOGE("Streaming needs a CascadeStreamCallback");
+        return 0;
+    }
+
+    std::string requestCpp(static_cast<size_t>(env->GetStringUTFLength(request)), '\0');
+    env->GetStringUTFRegion(request, 0, env->GetStringLength(request), requestCpp.data());
+
+    JavaVM *vm = g_loadedVm;
+    jobject callbackRef = env->NewGlobalRef(callback);
+    auto onChunk = [vm, callbackRef](std::string_view chunk) {
+        JNIEnv *callbackEnv = attachedEnv(vm);
+        if (callbackEnv == nullptr) {
+            return;
+        }
+        const std::string text(chunk);
+        jstring value = callbackEnv->NewStringUTF(text.c_str());
+        callbackEnv->CallVoidMethod(callbackRef, g_onChunk, value);
+        if (callbackEnv->ExceptionCheck()) {
+            LOGE("Cascade stream callback threw in onChunk");
+            callbackEnv->ExceptionClear();
+        }
+        callbackEnv->DeleteLocalRef(value);
+    };
+    auto done = [vm, callbackRef](uint64_t id, const RequestResult &result) {
+        JNIEnv *callbackEnv = attachedEnv(vm);
+        if (callbackEnv == nullptr) {
+            return;
+        }
+        jstring response = callbackEnv->NewStringUTF(result.response.c_str());
+        callbackEnv->CallVoidMethod(callbackRef, g_onComplete, static_cast<jlong>(id),
+                                    static_cast<jint>(result.status), response);
+        if (callbackEnv->ExceptionCheck()) {
+            LOGE("Cascade stream callback threw in onComplete for request %llu",
+                 static_cast<unsigned long long>(id));
+            callbackEnv->ExceptionClear();
+        }
+        callbackEnv->DeleteLocalRef(response);
+        callbackEnv->DeleteGlobalRef(callbackRef);
+    };
+
+    const int level = std::clamp<jint>(priority, static_cast<jint>(RequestPriority::Low),
+                                       static_cast<jint>(RequestPriority::High));
+    RequestTicket ticket = service->streamRequest(std::move(requestCpp),
+                                                  static_cast<RequestPriority>(level),
+                                                  std::move(onChunk), std::move(done));
+    if (ticket.id == 0) {
+        LOGE("Cascade request rejected: queue full or service shutting down");
+        env->DeleteGlobalRef(callbackRef);
+    }
+    return static_cast<jlong>(ticket.id);
+}
+
+/**
+ * @brief Cancel a request queued with nativeSubmitRequest or nativeStreamRequest.
+ *
+ * @return jboolean JNI_TRUE if the request was still queued or running; its callback then
+ *         reports it as cancelled.
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeCancelRequest(
+        JNIEnv * /* env */,
+        jobject /* thiz */,
+        jlong requestId
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    return service && service->cancelRequest(static_cast<uint64_t>(requestId)) ? JNI_TRUE
+                                                                                : JNI_FALSE;
+}
+
+/**
+ * @brief Read the stored context of a conversation.
+ *
+ * @param sessionId Session id sent with earlier requests
+ * @return jstring JSON array of {"role": "user"|"agent"|"system", "text": ...} objects,
+ *         oldest first, or null if the session is unknown or the service is not running.
+ */
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeGetContext(
+        JNIEnv *env,
+        jobject /* thiz */,
+        jlong sessionId
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    std::vector<genesis::cascade::ContextMessage> messages;
+    if (!service || !service->loadContext(static_cast<uint64_t>(sessionId), messages)) {
+        return nullptr;
+    }
+    static constexpr const char *kRoles[] = {"user", "agent", "system", "user"};
+    std::string json = "[";
+    for (const auto &message: messages) {
+        if (json.size() > 1) {
+            json += ',';
+        }
+        json += R"({"role":")";
+        json += kRoles[static_cast<int>(message.role) & 3];
+        json += R"(","text":)";
+        genesis::cascade::appendJsonString(json, message.text);
+        json += '}';
+    }
+    json += ']';
+    return env->NewStringUTF(json.c_str());
+}
+
+/**
+ * @brief Forget the stored context of a conversation.
+ *
+ * @return jboolean JNI_TRUE if the session was known.
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeClearContext(
+        JNIEnv * /* env */,
+        jobject /* thiz */,
+        jlong sessionId
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    return service && service->clearContext(static_cast<uint64_t>(sessionId)) ? JNI_TRUE
+                                                                              : JNI_FALSE;
+}
+
+/**
+ * @brief Response cache counters.
+ *
+ * @return jstring JSON object with hits, misses, coalesced, evictions, expirations, entries
+ *         and bytes, or null if the service is not running.
+ */
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeGetCacheStats(
+        JNIEnv *env,
+        jobject /* thiz */
+) {
+    std::shared_ptr<CascadeAIService> service = currentService();
+    if (!service) {
+        return nullptr;
+    }
+    return env->NewStringUTF(genesis::cascade::cacheStatsToJson(service->cacheStats()).c_str());
 }
 
 JNIEXPORT void JNICALL
@@ -262,13 +946,32 @@ Java_dev_aurakai_auraframefx_ai_services_CascadeAIService_nativeShutdown(
         JNIEnv * /* env */,
         jobject /* thiz */
 ) {
-    if (g_cascadeService) {
-        g_cascadeService->shutdown();
-        g_cascadeService.reset();
+    // Unpublish first so no new call can pick the service up, then drain it outside the
+    // lock; calls already holding a reference finish against the stopped scheduler.
+    std::shared_ptr<CascadeAIService> service;
+    JavaVM *vm = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_serviceMutex);
+        service = std::move(g_cascadeService);
+        vm = g_vm;
+        g_vm = nullptr;
     }
 
-    if (g_vm) {
-        g_vm = nullptr;
+    if (!service) {
+        return;
+    }
+    if (!service->shutdown()) {
+        // Called from a result or stream callback, on one of the service's own workers. The
+        // service keeps running, so put it back rather than destroy it on that worker; if
+        // another one was published meanwhile, release this one from a thread of its own.
+        std::lock_guard<std::mutex> lock(g_serviceMutex);
+        if (!g_cascadeService) {
+            g_cascadeService = std::move(service);
+            g_vm = vm;
+        } else {
+            std::thread([stale = std::move(service)] {}).detach();
+        }
+        return;
     }
 
     LOGI("Cascade AI Service shutdown complete");
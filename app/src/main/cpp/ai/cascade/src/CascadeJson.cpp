@@ -0,0 +1,542 @@
+#include "CascadeJson.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace genesis::cascade {
+
+    namespace {
+        // Nesting limit for skipped values, so hostile input cannot exhaust the stack.
+        constexpr int kMaxDepth = 64;
+
+        inline bool needsEscape(uint8_t c) {
+            return c == '"' || c == '\\' || c < 0x20;
+        }
+
+        /**
+         * @brief Index of the first '"', '\\' or control byte in `p[0, n)`, or `n` if none.
+         * This is what ends a run of plain string content, both when reading and writing;
+         * the writer also stops at non-ASCII bytes (`kStopAtNonAscii`) to validate them.
+         */
+        template<bool kStopAtNonAscii = false>
+        size_t findSpecial(const char *p, size_t n) {
+            size_t i = 0;
+#if defined(__aarch64__)
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t space = vdupq_n_u8(0x20);
+            for (; i + 16 <= n; i += 16) {
+                const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(p + i));
+                uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(bytes, quote),
+                                                   vceqq_u8(bytes, backslash)),
+                                          vcltq_u8(bytes, space));
+                if constexpr (kStopAtNonAscii) {
+                    hit = vorrq_u8(hit, vcgeq_u8(bytes, vdupq_n_u8(0x80)));
+                }
+                // Narrow each byte lane to a nibble so the first hit is a trailing-zero count.
+                const uint64_t mask = vget_lane_u64(
+                        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+                if (mask != 0) {
+                    return i + (__builtin_ctzll(mask) >> 2);
+                }
+            }
+#elif defined(__SSE2__)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i control = _mm_set1_epi8(0x1f);
+            for (; i + 16 <= n; i += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                // Unsigned bytes <= 0x1f are exactly those left unchanged by max(bytes, 0x1f).
+                const __m128i delimiter = _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                                                       _mm_cmpeq_epi8(bytes, backslash));
+                const __m128i hit = _mm_or_si128(
+                        delimiter, _mm_cmpeq_epi8(_mm_max_epu8(bytes, control), control));
+                int mask = _mm_movemask_epi8(hit);
+                if constexpr (kStopAtNonAscii) {
+                    mask |= _mm_movemask_epi8(bytes);
+                }
+                if (mask != 0) {
+                    return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+                }
+            }
+#endif
+            for (; i < n; ++i) {
+                const auto c = static_cast<uint8_t>(p[i]);
+                if (needsEscape(c) || (kStopAtNonAscii && c >= 0x80)) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        /**
+         * @brief Length of the well-formed UTF-8 sequence at the start of `p[0, n)` (a lead
+         * byte >= 0x80), storing its code point in `cp`; 0 if the bytes are not valid UTF-8
+         * (truncated, overlong, surrogate or above U+10FFFF).
+         */
+        size_t decodeUtf8(const uint8_t *p, size_t n, uint32_t &cp) {
+            size_t length;
+            uint32_t min;
+            if (p[0] >= 0xc2 && p[0] <= 0xdf) {
+                length = 2;
+                min = 0x80;
+                cp = p[0] & 0x1f;
+            } else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+                length = 3;
+                min = 0x800;
+                cp = p[0] & 0x0f;
+            } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+                length = 4;
+                min = 0x10000;
+                cp = p[0] & 0x07;
+            } else {
+                return 0;
+            }
+            if (n < length) {
+                return 0;
+            }
+            for (size_t i = 1; i < length; ++i) {
+                if ((p[i] & 0xc0) != 0x80) {
+                    return 0;
+                }
+                cp = (cp << 6) | (p[i] & 0x3f);
+            }
+            if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+                return 0;
+            }
+            return length;
+        }
+
+        int hexValue(char c) {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                return (c | 0x20) - 'a' + 10;
+            }
+            return -1;
+        }
+
+        void appendUtf8(std::string &out, uint32_t cp) {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xc0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3f));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xe0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (cp & 0x3f));
+            } else {
+                out += static_cast<char>(0xf0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (cp & 0x3f));
+            }
+        }
+
+        bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        /**
+         * @brief Single-pass reader over a JSON document; it never builds a tree.
+         */
+        class Parser {
+        public:
+            explicit Parser(std::string_view json)
+                    : p_(json.data()), end_(json.data() + json.size()) {}
+
+            void skipSpace() {
+                while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+                    ++p_;
+                }
+            }
+
+            bool consume(char c) {
+                if (p_ < end_ && *p_ == c) {
+                    ++p_;
+                    return true;
+                }
+                return false;
+            }
+
+            char peek() const {
+                return p_ < end_ ? *p_ : '\0';
+            }
+
+            bool atEnd() const {
+                return p_ == end_;
+            }
+
+            /**
+             * @brief Read a string. Without escapes `out` views the input directly; otherwise
+             * the unescaped text is built in `storage` and `out` views that.
+             */
+            bool parseString(std::string_view &out, std::string &storage) {
+                if (!consume('"')) {
+                    return false;
+                }
+                const char *start = p_;
+                size_t run = findSpecial(p_, static_cast<size_t>(end_ - p_));
+                p_ += run;
+                if (p_ < end_ && *p_ == '"') {
+                    out = std::string_view(start, run);
+                    ++p_;
+                    return true;
+                }
+                storage.assign(start, run);
+                while (p_ < end_) {
+                    const char c = *p_++;
+                    if (c == '"') {
+                        out = storage;
+                        return true;
+                    }
+                    if (c != '\\' || !unescape(storage)) {
+                        return false;  // Raw control character or bad escape
+                    }
+                    run = findSpecial(p_, static_cast<size_t>(end_ - p_));
+                    storage.append(p_, run);
+                    p_ += run;
+                }
+                return false;
+            }
+
+            /**
+             * @brief Validate a number and, if it is a non-negative integer that fits, return
+             * its value in `value`; other numbers leave `value` untouched.
+             */
+            bool parseNumber(uint64_t &value) {
+                const char *start = p_;
+                consume('-');
+                if (consume('0')) {
+                    // No leading zeros.
+                } else if (p_ < end_ && *p_ >= '1' && *p_ <= '9') {
+                    while (p_ < end_ && isDigit(*p_)) {
+                        ++p_;
+                    }
+                } else {
+                    return false;
+                }
+                const char *integerEnd = p_;
+                if (consume('.') && !digits()) {
+                    return false;
+                }
+                if (consume('e') || consume('E')) {
+                    if (!consume('+')) {
+                        consume('-');
+                    }
+                    if (!digits()) {
+                        return false;
+                    }
+                }
+                if (p_ != integerEnd || *start == '-') {
+                    return true;
+                }
+                uint64_t parsed = 0;
+                for (const char *d = start; d < integerEnd; ++d) {
+                    const uint64_t digit = static_cast<uint64_t>(*d - '0');
+                    if (parsed > (UINT64_MAX - digit) / 10) {
+                        return true;
+                    }
+                    parsed = parsed * 10 + digit;
+                }
+                value = parsed;
+                return true;
+            }
+
+            bool skipValue(int depth) {
+                if (depth > kMaxDepth) {
+                    return false;
+                }
+                switch (peek()) {
+                    case '"': {
+                        std::string_view ignored;
+                        return parseString(ignored, skipped_);
+                    }
+                    case '{':
+                        return skipContainer('}', depth, true);
+                    case '[':
+                        return skipContainer(']', depth, false);
+                    case 't':
+                        return literal("true");
+                    case 'f':
+                        return literal("false");
+                    case 'n':
+                        return literal("null");
+                    default: {
+                        uint64_t ignored = 0;
+                        return parseNumber(ignored);
+                    }
+                }
+            }
+
+        private:
+            bool digits() {
+                const char *start = p_;
+                while (p_ < end_ && isDigit(*p_)) {
+                    ++p_;
+                }
+                return p_ > start;
+            }
+
+            bool literal(std::string_view word) {
+                if (static_cast<size_t>(end_ - p_) < word.size() ||
+                    std::string_view(p_, word.size()) != word) {
+                    return false;
+                }
+                p_ += word.size();
+                return true;
+            }
+
+            bool skipContainer(char close, int depth, bool object) {
+                ++p_;
+                skipSpace();
+                if (consume(close)) {
+                    return true;
+                }
+                for (;;) {
+                    skipSpace();
+                    if (object) {
+                        std::string_view key;
+                        if (!parseString(key, skipped_)) {
+                            return false;
+                        }
+                        skipSpace();
+                        if (!consume(':')) {
+                            return false;
+                        }
+                        skipSpace();
+                    }
+                    if (!skipValue(depth + 1)) {
+                        return false;
+                    }
+                    skipSpace();
+                    if (consume(close)) {
+                        return true;
+                    }
+                    if (!consume(',')) {
+                        return false;
+                    }
+                }
+            }
+
+            // Decodes the escape after a backslash onto `out`.
+            bool unescape(std::string &out) {
+                if (p_ == end_) {
+                    return false;
+                }
+                const char c = *p_++;
+                switch (c) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        out += c;
+                        return true;
+                    case 'b':
+                        out += '\b';
+                        return true;
+                    case 'f':
+                        out += '\f';
+                        return true;
+                    case 'n':
+                        out += '\n';
+                        return true;
+                    case 'r':
+                        out += '\r';
+                        return true;
+                    case 't':
+                        out += '\t';
+                        return true;
+                    case 'u':
+                        break;
+                    default:
+                        return false;
+                }
+                uint32_t cp;
+                if (!hex4(cp)) {
+                    return false;
+                }
+                if (cp >= 0xd800 && cp < 0xdc00) {
+                    uint32_t low;
+                    if (end_ - p_ >= 2 && p_[0] == '\\' && p_[1] == 'u') {
+                        p_ += 2;
+                        if (!hex4(low)) {
+                            return false;
+                        }
+                        if (low >= 0xdc00 && low < 0xe000) {
+                            cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                        } else {
+                            appendUtf8(out, 0xfffd);
+                            cp = low;
+                        }
+                    }
+                }
+                // Unpaired surrogates cannot be encoded in UTF-8.
+                appendUtf8(out, cp >= 0xd800 && cp < 0xe000 ? 0xfffd : cp);
+                return true;
+            }
+
+            bool hex4(uint32_t &value) {
+                if (end_ - p_ < 4) {
+                    return false;
+                }
+                value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = hexValue(*p_++);
+                    if (digit < 0) {
+                        return false;
+                    }
+                    value = (value << 4) | static_cast<uint32_t>(digit);
+                }
+                return true;
+            }
+
+            const char *p_;
+            const char *const end_;
+            // Unescaped text of strings that are skipped or used only for comparison.
+            std::string skipped_;
+        };
+
+        bool isTextKey(std::string_view key) {
+            return key == "prompt" || key == "request" || key == "text" || key == "message";
+        }
+
+        const char *statusName(ReplyStatus status) {
+            return status == ReplyStatus::Success ? "success" : "error";
+        }
+    } // namespace
+
+    bool parseRequestJson(std::string_view json, CascadeRequest &request, std::string &scratch) {
+        Parser parser(json);
+        CascadeRequest parsed;
+        std::string keyStorage;
+        parser.skipSpace();
+        if (!parser.consume('{')) {
+            return false;
+        }
+        parser.skipSpace();
+        if (!parser.consume('}')) {
+            for (;;) {
+                parser.skipSpace();
+                std::string_view key;
+                if (!parser.parseString(key, keyStorage)) {
+                    return false;
+                }
+                parser.skipSpace();
+                if (!parser.consume(':')) {
+                    return false;
+                }
+                parser.skipSpace();
+                bool ok;
+                if (isTextKey(key) && parser.peek() == '"') {
+                    ok = parser.parseString(parsed.text, scratch);
+                } else if (key == "sessionId" && (isDigit(parser.peek()) || parser.peek() == '-')) {
+                    ok = parser.parseNumber(parsed.sessionId);
+                } else {
+                    ok = parser.skipValue(1);
+                }
+                if (!ok) {
+                    return false;
+                }
+                parser.skipSpace();
+                if (parser.consume('}')) {
+                    break;
+                }
+                if (!parser.consume(',')) {
+                    return false;
+                }
+            }
+        }
+        parser.skipSpace();
+        if (!parser.atEnd()) {
+            return false;
+        }
+        request = parsed;
+        return true;
+    }
+
+    void appendJsonString(std::string &out, std::string_view value) {
+        out += '"';
+        const char *p = value.data();
+        size_t remaining = value.size();
+        while (remaining > 0) {
+            const size_t run = findSpecial<true>(p, remaining);
+            out.append(p, run);
+            if (run == remaining) {
+                break;
+            }
+            const auto c = static_cast<uint8_t>(p[run]);
+            if (c >= 0x80) {
+                // Output goes to NewStringUTF, which takes modified UTF-8: characters outside
+                // the BMP are written as escaped surrogate pairs and invalid bytes as U+FFFD.
+                uint32_t cp = 0;
+                const size_t length = decodeUtf8(reinterpret_cast<const uint8_t *>(p + run),
+                                                 remaining - run, cp);
+                char escaped[16];
+                if (length == 0) {
+                    out += "\\ufffd";
+                } else if (cp < 0x10000) {
+                    out.append(p + run, length);
+                } else {
+                    cp -= 0x10000;
+                    snprintf(escaped, sizeof(escaped), "\\u%04x\\u%04x", 0xd800 + (cp >> 10),
+                             0xdc00 + (cp & 0x3ff));
+                    out += escaped;
+                }
+                const size_t consumed = run + (length == 0 ? 1 : length);
+                p += consumed;
+                remaining -= consumed;
+                continue;
+            }
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default: {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                    break;
+                }
+            }
+            p += run + 1;
+            remaining -= run + 1;
+        }
+        out += '"';
+    }
+
+    std::string replyToJson(const CascadeReply &reply) {
+        std::string json;
+        json.reserve(64 + reply.agent.size() + reply.version.size() + reply.message.size());
+        json += R"({"status":")";
+        json += statusName(reply.status);
+        json += R"(","agent":)";
+        appendJsonString(json, reply.agent);
+        json += R"(,"version":)";
+        appendJsonString(json, reply.version);
+        json += R"(,"response":)";
+        appendJsonString(json, reply.message);
+        json += '}';
+        return json;
+    }
+
+} // namespace genesis::cascade
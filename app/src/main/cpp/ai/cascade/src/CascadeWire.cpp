@@ -0,0 +1,81 @@
+#include "CascadeWire.hpp"
+
+#include <cstring>
+
+namespace genesis::cascade {
+
+    namespace {
+        inline uint16_t load16(const uint8_t *p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        inline uint32_t load32(const uint8_t *p) {
+            return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) |
+                   (uint32_t{p[3]} << 24);
+        }
+
+        inline uint64_t load64(const uint8_t *p) {
+            return uint64_t{load32(p)} | (uint64_t{load32(p + 4)} << 32);
+        }
+
+        inline void store16(uint8_t *p, uint16_t v) {
+            p[0] = static_cast<uint8_t>(v);
+            p[1] = static_cast<uint8_t>(v >> 8);
+        }
+
+        inline void store32(uint8_t *p, uint32_t v) {
+            for (int i = 0; i < 4; ++i) {
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        }
+
+        // Appends `value` to the payload at `*cursor` and records its (offset, length) at `field`.
+        void putString(uint8_t *message, uint8_t *field, size_t &cursor, std::string_view value) {
+            store32(field, static_cast<uint32_t>(cursor));
+            store32(field + 4, static_cast<uint32_t>(value.size()));
+            if (!value.empty()) {
+                memcpy(message + cursor, value.data(), value.size());
+            }
+            cursor += value.size();
+        }
+    } // namespace
+
+    bool decodeRequest(const uint8_t *data, size_t length, CascadeRequest &request) {
+        if (data == nullptr || length < wire::kRequestHeaderSize ||
+            load32(data) != wire::kRequestMagic || load16(data + 4) != wire::kVersion) {
+            return false;
+        }
+        const size_t headerSize = load16(data + 6);
+        if (headerSize < wire::kRequestHeaderSize || headerSize > length) {
+            return false;
+        }
+        const uint64_t textOffset = load32(data + 16);
+        const uint64_t textLength = load32(data + 20);
+        if (textOffset < headerSize || textOffset + textLength > length) {
+            return false;
+        }
+        request.sessionId = load64(data + 8);
+        request.text = std::string_view(reinterpret_cast<const char *>(data + textOffset),
+                                        static_cast<size_t>(textLength));
+        return true;
+    }
+
+    size_t encodeResponse(const CascadeReply &reply, uint8_t *out, size_t capacity) {
+        const size_t size = wire::kResponseHeaderSize + reply.agent.size() +
+                            reply.version.size() + reply.message.size();
+        if (out == nullptr || size > capacity || size > UINT32_MAX) {
+            return size;
+        }
+        store32(out, wire::kResponseMagic);
+        store16(out + 4, wire::kVersion);
+        store16(out + 6, static_cast<uint16_t>(wire::kResponseHeaderSize));
+        store16(out + 8, static_cast<uint16_t>(reply.status));
+        store16(out + 10, 0);
+        size_t cursor = wire::kResponseHeaderSize;
+        putString(out, out + 12, cursor, reply.agent);
+        putString(out, out + 20, cursor, reply.version);
+        putString(out, out + 28, cursor, reply.message);
+        return size;
+    }
+
+} // namespace genesis::cascade
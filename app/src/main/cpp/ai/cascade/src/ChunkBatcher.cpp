@@ -0,0 +1,35 @@
+#include "ChunkBatcher.hpp"
+
+#include <utility>
+
+namespace genesis::cascade {
+
+    ChunkBatcher::ChunkBatcher(ChunkSink sink, size_t minBytes,
+                               std::chrono::milliseconds maxDelay)
+            : sink_(std::move(sink)), minBytes_(minBytes), maxDelay_(maxDelay),
+              lastFlush_(Clock::now()) {
+        buffer_.reserve(minBytes);
+    }
+
+    void ChunkBatcher::push(std::string_view token) {
+        if (token.empty()) {
+            return;
+        }
+        buffer_.append(token);
+        if (delivered_ == 0 || buffer_.size() >= minBytes_ ||
+            Clock::now() - lastFlush_ >= maxDelay_) {
+            flush();
+        }
+    }
+
+    void ChunkBatcher::flush() {
+        if (buffer_.empty()) {
+            return;
+        }
+        sink_(buffer_);
+        ++delivered_;
+        buffer_.clear();
+        lastFlush_ = Clock::now();
+    }
+
+} // namespace genesis::cascade
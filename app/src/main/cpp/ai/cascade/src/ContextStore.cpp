@@ -0,0 +1,523 @@
+#include "ContextStore.hpp"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#define LOG_TAG "CascadeAI-Native"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace genesis::cascade {
+
+    namespace {
+        constexpr uint32_t kMagic = 0x58435143;  // "CQCX"
+        constexpr uint32_t kVersion = 1;
+        constexpr uint32_t kBlockSize = 4096;
+        // Each message is a little-endian u32 of (length << 2 | role) followed by its text.
+        constexpr size_t kMessageHeaderSize = 4;
+        constexpr size_t kMaxMessageLength = (size_t{1} << 30) - 1;
+        // Fixed sizes of Header and Session, which are part of the file format.
+        constexpr size_t kHeaderSize = 64;
+        constexpr size_t kSlotSize = 40;
+
+        uint64_t blocksFor(uint64_t bytes) {
+            return (bytes + kBlockSize - 1) / kBlockSize;
+        }
+
+        size_t indexHash(uint64_t id) {
+            id ^= id >> 33;
+            id *= 0xff51afd7ed558ccdULL;
+            id ^= id >> 33;
+            return static_cast<size_t>(id);
+        }
+    } // namespace
+
+    struct ContextStore::Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t blockSize;
+        uint32_t blockCount;
+        uint32_t sessionCapacity;
+        uint32_t sessionCount;
+        uint32_t freeBlock;
+        uint32_t freeBlockCount;
+        uint32_t freeSlot;
+        uint32_t lruHead;  // Most recently used
+        uint32_t lruTail;
+        uint32_t reserved0;
+        uint64_t bytesUsed;
+        uint8_t reserved[8];
+    };
+
+    struct ContextStore::Session {
+        uint64_t id;
+        uint64_t bytes;  // Log length; the chain holds exactly blocksFor(bytes) blocks
+        uint32_t firstBlock;
+        uint32_t lastBlock;
+        uint32_t messageCount;
+        uint32_t prev;  // LRU neighbours while in use; `next` chains free slots otherwise
+        uint32_t next;
+        uint32_t inUse;
+    };
+
+    namespace {
+        // File layout: header, session slots, one block link per block, then the blocks,
+        // page aligned.
+        size_t linksOffset(uint32_t sessionCapacity) {
+            return kHeaderSize + size_t{sessionCapacity} * kSlotSize;
+        }
+
+        size_t blocksOffset(uint32_t blockCount, uint32_t sessionCapacity) {
+            const size_t linksEnd = linksOffset(sessionCapacity) + size_t{blockCount} * 4;
+            return (linksEnd + kBlockSize - 1) / kBlockSize * kBlockSize;
+        }
+    } // namespace
+
+    std::unique_ptr<ContextStore> ContextStore::open(const char *path, size_t budgetBytes,
+                                                     uint32_t maxSessions) {
+        const uint64_t blocks = std::max<uint64_t>(blocksFor(budgetBytes), 1);
+        if (blocks >= kNone) {
+            return nullptr;
+        }
+        const auto blockCount = static_cast<uint32_t>(blocks);
+        const uint32_t sessionCapacity = std::clamp<uint32_t>(maxSessions, 1, kNone / 4);
+        static_assert(sizeof(Header) == kHeaderSize && sizeof(Session) == kSlotSize,
+                      "header and slot layouts are part of the file format");
+        const size_t size = blocksOffset(blockCount, sessionCapacity) +
+                            size_t{blockCount} * kBlockSize;
+
+        void *mapped;
+        bool fresh = true;
+        if (path != nullptr) {
+            const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if (fd < 0) {
+                LOGE("Failed to open context store %s", path);
+                return nullptr;
+            }
+            struct stat st{};
+            if (fstat(fd, &st) == 0 && st.st_size == static_cast<off_t>(size)) {
+                fresh = false;
+            } else if (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                LOGE("Failed to size context store %s", path);
+                ::close(fd);
+                return nullptr;
+            }
+            mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+        } else {
+            mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0);
+        }
+        if (mapped == MAP_FAILED) {
+            LOGE("Failed to map context store (%zu bytes)", size);
+            return nullptr;
+        }
+
+        std::unique_ptr<ContextStore> store(new ContextStore(static_cast<uint8_t *>(mapped), size,
+                                                             blockCount, sessionCapacity));
+        if (fresh || !store->validate()) {
+            if (!fresh) {
+                LOGE("Context store %s is inconsistent, starting empty", path);
+            }
+            store->format();
+        }
+        store->buildIndex();
+        return store;
+    }
+
+    ContextStore::ContextStore(uint8_t *base, size_t size, uint32_t blockCount,
+                               uint32_t sessionCapacity)
+            : base_(base), size_(size), blockCount_(blockCount),
+              sessionCapacity_(sessionCapacity) {
+        size_t buckets = 16;
+        while (buckets < size_t{sessionCapacity} * 2) {
+            buckets <<= 1;
+        }
+        index_.assign(buckets, kNone);
+        indexMask_ = buckets - 1;
+    }
+
+    ContextStore::~ContextStore() {
+        munmap(base_, size_);
+    }
+
+    ContextStore::Header &ContextStore::header() const {
+        return *reinterpret_cast<Header *>(base_);
+    }
+
+    ContextStore::Session &ContextStore::session(uint32_t slot) const {
+        return reinterpret_cast<Session *>(base_ + kHeaderSize)[slot];
+    }
+
+    uint32_t *ContextStore::blockNext() const {
+        return reinterpret_cast<uint32_t *>(base_ + linksOffset(sessionCapacity_));
+    }
+
+    uint8_t *ContextStore::block(uint32_t index) const {
+        return base_ + blocksOffset(blockCount_, sessionCapacity_) + size_t{index} * kBlockSize;
+    }
+
+    void ContextStore::format() {
+        Header &h = header();
+        memset(&h, 0, sizeof(h));
+        h.magic = kMagic;
+        h.version = kVersion;
+        h.blockSize = kBlockSize;
+        h.blockCount = blockCount_;
+        h.sessionCapacity = sessionCapacity_;
+        h.freeBlock = 0;
+        h.freeBlockCount = blockCount_;
+        h.freeSlot = 0;
+        h.lruHead = kNone;
+        h.lruTail = kNone;
+        for (uint32_t slot = 0; slot < sessionCapacity_; ++slot) {
+            Session &s = session(slot);
+            memset(&s, 0, sizeof(s));
+            s.firstBlock = s.lastBlock = s.prev = kNone;
+            s.next = slot + 1 < sessionCapacity_ ? slot + 1 : kNone;
+        }
+        uint32_t *next = blockNext();
+        for (uint32_t b = 0; b < blockCount_; ++b) {
+            next[b] = b + 1 < blockCount_ ? b + 1 : kNone;
+        }
+    }
+
+    bool ContextStore::validate() const {
+        const Header &h = header();
+        if (h.magic != kMagic || h.version != kVersion || h.blockSize != kBlockSize ||
+            h.blockCount != blockCount_ || h.sessionCapacity != sessionCapacity_ ||
+            h.sessionCount > sessionCapacity_ || h.freeBlockCount > blockCount_) {
+            return false;
+        }
+        // Every block must be on exactly one chain, with chain lengths matching the counts.
+        std::vector<uint8_t> seen(blockCount_, 0);
+        const uint32_t *next = blockNext();
+        // Checks `expected` blocks from `first` end at `last`; with last == kNone, that the
+        // chain is terminated instead.
+        auto walk = [&](uint32_t first, uint64_t expected, uint32_t last) {
+            uint32_t b = first;
+            uint32_t tail = kNone;
+            for (uint64_t i = 0; i < expected; ++i) {
+                if (b >= blockCount_ || seen[b]) {
+                    return false;
+                }
+                seen[b] = 1;
+                tail = b;
+                b = next[b];
+            }
+            if (last == kNone) {
+                return b == kNone;
+            }
+            return expected == 0 ? first == kNone && last == kNone : tail == last;
+        };
+        if (!walk(h.freeBlock, h.freeBlockCount, kNone)) {
+            return false;
+        }
+        uint32_t sessions = 0;
+        uint64_t bytes = 0;
+        uint32_t previous = kNone;
+        for (uint32_t slot = h.lruHead; slot != kNone; slot = session(slot).next) {
+            if (slot >= sessionCapacity_ || ++sessions > h.sessionCount) {
+                return false;
+            }
+            const Session &s = session(slot);
+            if (!s.inUse || s.prev != previous || s.messageCount > s.bytes ||
+                !walk(s.firstBlock, blocksFor(s.bytes), s.bytes > 0 ? s.lastBlock : kNone)) {
+                return false;
+            }
+            bytes += s.bytes;
+            previous = slot;
+        }
+        if (sessions != h.sessionCount || h.lruTail != previous || bytes != h.bytesUsed ||
+            static_cast<uint32_t>(std::count(seen.begin(), seen.end(), 1)) != blockCount_) {
+            return false;
+        }
+        uint32_t freeSlots = 0;
+        for (uint32_t slot = h.freeSlot; slot != kNone; slot = session(slot).next) {
+            if (slot >= sessionCapacity_ || session(slot).inUse ||
+                ++freeSlots > sessionCapacity_ - h.sessionCount) {
+                return false;
+            }
+        }
+        return freeSlots == sessionCapacity_ - h.sessionCount;
+    }
+
+    void ContextStore::buildIndex() {
+        std::fill(index_.begin(), index_.end(), kNone);
+        for (uint32_t slot = header().lruHead; slot != kNone; slot = session(slot).next) {
+            indexInsert(session(slot).id, slot);
+        }
+    }
+
+    uint32_t ContextStore::find(uint64_t id) const {
+        for (size_t i = indexHash(id) & indexMask_;; i = (i + 1) & indexMask_) {
+            const uint32_t slot = index_[i];
+            if (slot == kNone || session(slot).id == id) {
+                return slot;
+            }
+        }
+    }
+
+    void ContextStore::indexInsert(uint64_t id, uint32_t slot) {
+        size_t i = indexHash(id) & indexMask_;
+        while (index_[i] != kNone) {
+            i = (i + 1) & indexMask_;
+        }
+        index_[i] = slot;
+    }
+
+    void ContextStore::indexErase(uint64_t id) {
+        size_t i = indexHash(id) & indexMask_;
+        while (index_[i] != kNone && session(index_[i]).id != id) {
+            i = (i + 1) & indexMask_;
+        }
+        if (index_[i] == kNone) {
+            return;
+        }
+        // Backward-shift deletion keeps every remaining probe sequence unbroken.
+        for (size_t j = (i + 1) & indexMask_; index_[j] != kNone; j = (j + 1) & indexMask_) {
+            const size_t home = indexHash(session(index_[j]).id) & indexMask_;
+            if (((j - home) & indexMask_) >= ((j - i) & indexMask_)) {
+                index_[i] = index_[j];
+                i = j;
+            }
+        }
+        index_[i] = kNone;
+    }
+
+    uint32_t ContextStore::acquireSlot(uint64_t id) {
+        Header &h = header();
+        if (h.freeSlot == kNone) {
+            releaseSession(h.lruTail);
+        }
+        const uint32_t slot = h.freeSlot;
+        Session &s = session(slot);
+        h.freeSlot = s.next;
+        s.id = id;
+        s.bytes = 0;
+        s.firstBlock = s.lastBlock = kNone;
+        s.messageCount = 0;
+        s.inUse = 1;
+        ++h.sessionCount;
+        pushLruFront(slot);
+        indexInsert(id, slot);
+        return slot;
+    }
+
+    void ContextStore::truncateSession(uint32_t slot) {
+        Header &h = header();
+        Session &s = session(slot);
+        if (s.firstBlock != kNone) {
+            blockNext()[s.lastBlock] = h.freeBlock;
+            h.freeBlock = s.firstBlock;
+            h.freeBlockCount += static_cast<uint32_t>(blocksFor(s.bytes));
+        }
+        h.bytesUsed -= s.bytes;
+        s.bytes = 0;
+        s.firstBlock = s.lastBlock = kNone;
+        s.messageCount = 0;
+    }
+
+    void ContextStore::releaseSession(uint32_t slot) {
+        Header &h = header();
+        truncateSession(slot);
+        unlinkLru(slot);
+        indexErase(session(slot).id);
+        Session &s = session(slot);
+        s.inUse = 0;
+        s.next = h.freeSlot;
+        h.freeSlot = slot;
+        --h.sessionCount;
+    }
+
+    uint32_t ContextStore::allocateBlock(uint32_t keep) {
+        Header &h = header();
+        while (h.freeBlock == kNone) {
+            if (h.lruTail == kNone || h.lruTail == keep) {
+                return kNone;
+            }
+            releaseSession(h.lruTail);
+        }
+        const uint32_t b = h.freeBlock;
+        h.freeBlock = blockNext()[b];
+        --h.freeBlockCount;
+        blockNext()[b] = kNone;
+        return b;
+    }
+
+    void ContextStore::writeLog(uint32_t slot, const uint8_t *data, size_t length) {
+        Session &s = session(slot);
+        while (length > 0) {
+            const size_t offset = static_cast<size_t>(s.bytes % kBlockSize);
+            if (offset == 0) {
+                // Room is checked by append(), so this only evicts other sessions.
+                const uint32_t b = allocateBlock(slot);
+                if (s.lastBlock == kNone) {
+                    s.firstBlock = b;
+                } else {
+                    blockNext()[s.lastBlock] = b;
+                }
+                s.lastBlock = b;
+            }
+            const size_t chunk = std::min(length, kBlockSize - offset);
+            memcpy(block(s.lastBlock) + offset, data, chunk);
+            s.bytes += chunk;
+            header().bytesUsed += chunk;
+            data += chunk;
+            length -= chunk;
+        }
+    }
+
+    bool ContextStore::append(uint64_t sessionId, MessageRole role, std::string_view text) {
+        const uint64_t recordSize = kMessageHeaderSize + text.size();
+        if (text.size() > kMaxMessageLength || blocksFor(recordSize) > blockCount_) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = find(sessionId);
+        if (slot == kNone) {
+            slot = acquireSlot(sessionId);
+        } else {
+            touch(slot);
+        }
+        Session &s = session(slot);
+        // The chain may need one block more than the record spans, since it starts mid-block.
+        if (blocksFor(s.bytes + recordSize) > blockCount_) {
+            truncateSession(slot);
+        }
+        const uint32_t tag = static_cast<uint32_t>(text.size() << 2) |
+                             static_cast<uint32_t>(role);
+        const uint8_t prefix[kMessageHeaderSize] = {
+                static_cast<uint8_t>(tag), static_cast<uint8_t>(tag >> 8),
+                static_cast<uint8_t>(tag >> 16), static_cast<uint8_t>(tag >> 24)};
+        writeLog(slot, prefix, sizeof(prefix));
+        writeLog(slot, reinterpret_cast<const uint8_t *>(text.data()), text.size());
+        ++s.messageCount;
+        return true;
+    }
+
+    bool ContextStore::load(uint64_t sessionId, std::vector<ContextMessage> &messages) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint32_t slot = find(sessionId);
+        if (slot == kNone) {
+            return false;
+        }
+        touch(slot);
+        const Session &s = session(slot);
+        const uint32_t *next = blockNext();
+        uint32_t b = s.firstBlock;
+        size_t offset = 0;
+        uint64_t remaining = s.bytes;
+        // Copies `n` log bytes forward from the cursor, or returns false at the end.
+        auto read = [&](uint8_t *out, size_t n) {
+            if (n > remaining) {
+                return false;
+            }
+            remaining -= n;
+            while (n > 0) {
+                if (offset == kBlockSize) {
+                    b = next[b];
+                    offset = 0;
+                }
+                const size_t chunk = std::min(n, kBlockSize - offset);
+                if (out != nullptr) {
+                    memcpy(out, block(b) + offset, chunk);
+                    out += chunk;
+                }
+                offset += chunk;
+                n -= chunk;
+            }
+            return true;
+        };
+
+        messages.resize(s.messageCount);
+        uint32_t count = 0;
+        uint8_t prefix[kMessageHeaderSize];
+        // A message cut short by a crash mid-append is dropped rather than read past.
+        while (count < s.messageCount && read(prefix, sizeof(prefix))) {
+            const uint32_t tag = uint32_t{prefix[0]} | (uint32_t{prefix[1]} << 8) |
+                                 (uint32_t{prefix[2]} << 16) | (uint32_t{prefix[3]} << 24);
+            ContextMessage &message = messages[count];
+            message.role = static_cast<MessageRole>(tag & 3);
+            message.text.resize(tag >> 2);
+            if (!read(reinterpret_cast<uint8_t *>(message.text.data()), message.text.size())) {
+                break;
+            }
+            ++count;
+        }
+        messages.resize(count);
+        return true;
+    }
+
+    uint32_t ContextStore::messageCount(uint64_t sessionId) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint32_t slot = find(sessionId);
+        return slot != kNone ? session(slot).messageCount : 0;
+    }
+
+    bool ContextStore::erase(uint64_t sessionId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint32_t slot = find(sessionId);
+        if (slot == kNone) {
+            return false;
+        }
+        releaseSession(slot);
+        return true;
+    }
+
+    void ContextStore::flush() {
+        msync(base_, size_, MS_ASYNC);
+    }
+
+    uint32_t ContextStore::sessionCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return header().sessionCount;
+    }
+
+    uint64_t ContextStore::bytesUsed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return header().bytesUsed;
+    }
+
+    void ContextStore::touch(uint32_t slot) {
+        if (header().lruHead != slot) {
+            unlinkLru(slot);
+            pushLruFront(slot);
+        }
+    }
+
+    void ContextStore::unlinkLru(uint32_t slot) {
+        Header &h = header();
+        Session &s = session(slot);
+        if (s.prev != kNone) {
+            session(s.prev).next = s.next;
+        } else {
+            h.lruHead = s.next;
+        }
+        if (s.next != kNone) {
+            session(s.next).prev = s.prev;
+        } else {
+            h.lruTail = s.prev;
+        }
+        s.prev = s.next = kNone;
+    }
+
+    void ContextStore::pushLruFront(uint32_t slot) {
+        Header &h = header();
+        Session &s = session(slot);
+        s.prev = kNone;
+        s.next = h.lruHead;
+        if (h.lruHead != kNone) {
+            session(h.lruHead).prev = slot;
+        } else {
+            h.lruTail = slot;
+        }
+        h.lruHead = slot;
+    }
+
+} // namespace genesis::cascade
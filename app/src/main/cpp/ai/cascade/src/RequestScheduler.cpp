@@ -0,0 +1,183 @@
+#include "RequestScheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace genesis::cascade {
+
+    RequestScheduler::RequestScheduler(RequestHandler handler, size_t workers, size_t capacity)
+            : state_(std::make_shared<State>()) {
+        state_->handler = std::move(handler);
+        state_->capacity = std::max<size_t>(capacity, 1);
+        workers = std::max<size_t>(workers, 1);
+        state_->workers.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            state_->workers.emplace_back([state = state_] { workerLoop(*state); });
+        }
+    }
+
+    RequestScheduler::~RequestScheduler() {
+        if (shutdown(true)) {
+            return;
+        }
+        std::vector<std::thread> workers;
+        stop(false, true, workers);
+        for (std::thread &worker: workers) {
+            worker.detach();
+        }
+    }
+
+    RequestTicket RequestScheduler::submit(std::string request, RequestPriority priority,
+                                           RequestCallback callback, RequestHandler handler) {
+        auto job = std::make_shared<Job>();
+        job->request = std::move(request);
+        job->callback = std::move(callback);
+        job->handler = std::move(handler);
+        RequestTicket ticket;
+        ticket.result = job->promise.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!state_->stopping && state_->queuedCount < state_->capacity) {
+                const int level = std::clamp(static_cast<int>(priority), 0, kPriorityLevels - 1);
+                job->id = state_->nextId++;
+                ticket.id = job->id;
+                state_->active.emplace(job->id, job);
+                state_->queues[level].push_back(std::move(job));
+                ++state_->queuedCount;
+            }
+        }
+        if (ticket.id == 0) {
+            job->promise.set_value({RequestStatus::Rejected, {}});
+            return ticket;
+        }
+        state_->available.notify_one();
+        return ticket;
+    }
+
+    bool RequestScheduler::cancel(uint64_t id) {
+        std::shared_ptr<Job> dequeued;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            auto it = state_->active.find(id);
+            if (it == state_->active.end()) {
+                return false;
+            }
+            it->second->cancelled.store(true, std::memory_order_relaxed);
+            for (auto &queue: state_->queues) {
+                auto queued = std::find(queue.begin(), queue.end(), it->second);
+                if (queued != queue.end()) {
+                    dequeued = std::move(*queued);
+                    queue.erase(queued);
+                    --state_->queuedCount;
+                    state_->active.erase(it);
+                    break;
+                }
+            }
+        }
+        // A running job notices the flag itself; only one that never started completes here.
+        if (dequeued != nullptr) {
+            complete(*dequeued, {RequestStatus::Cancelled, {}});
+        }
+        return true;
+    }
+
+    bool RequestScheduler::shutdown(bool drain) {
+        std::vector<std::thread> workers;
+        if (!stop(drain, false, workers)) {
+            return false;
+        }
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+        return true;
+    }
+
+    bool RequestScheduler::stop(bool drain, bool force, std::vector<std::thread> &workers) {
+        const std::thread::id self = std::this_thread::get_id();
+        std::vector<std::shared_ptr<Job>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!force) {
+                for (const std::thread &worker: state_->workers) {
+                    if (worker.get_id() == self) {
+                        return false;
+                    }
+                }
+            }
+            state_->stopping = true;
+            if (!drain) {
+                for (auto &queue: state_->queues) {
+                    for (auto &job: queue) {
+                        state_->active.erase(job->id);
+                        abandoned.push_back(std::move(job));
+                    }
+                    queue.clear();
+                }
+                state_->queuedCount = 0;
+                // What is left is running; ask those handlers to stop early.
+                for (auto &[id, job]: state_->active) {
+                    job->cancelled.store(true, std::memory_order_relaxed);
+                }
+            }
+            // Joining from several threads at once is not allowed, so the workers are moved
+            // out under the lock; later callers find nothing left to join.
+            workers.swap(state_->workers);
+        }
+        state_->available.notify_all();
+        for (auto &job: abandoned) {
+            complete(*job, {RequestStatus::Cancelled, {}});
+        }
+        return true;
+    }
+
+    size_t RequestScheduler::queued() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->queuedCount;
+    }
+
+    void RequestScheduler::workerLoop(State &state) {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.available.wait(lock, [&state] {
+                    return state.stopping || state.queuedCount > 0;
+                });
+                if (state.queuedCount == 0) {
+                    return;
+                }
+                for (int level = kPriorityLevels - 1; level >= 0; --level) {
+                    if (!state.queues[level].empty()) {
+                        job = std::move(state.queues[level].front());
+                        state.queues[level].pop_front();
+                        break;
+                    }
+                }
+                --state.queuedCount;
+            }
+
+            RequestResult result;
+            const RequestHandler &handler = job->handler ? job->handler : state.handler;
+            result.response = handler(job->request, job->cancelled);
+            result.status = job->cancelled.load(std::memory_order_relaxed)
+                            ? RequestStatus::Cancelled : RequestStatus::Completed;
+            if (result.status == RequestStatus::Cancelled) {
+                result.response.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.active.erase(job->id);
+            }
+            complete(*job, std::move(result));
+        }
+    }
+
+    void RequestScheduler::complete(Job &job, RequestResult result) {
+        if (job.callback) {
+            job.callback(job.id, result);
+        }
+        job.promise.set_value(std::move(result));
+    }
+
+} // namespace genesis::cascade
@@ -0,0 +1,211 @@
+#include "ResponseCache.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
+namespace genesis::cascade {
+
+    namespace {
+        // Approximate bookkeeping cost of an entry, charged to the budget on top of its text.
+        constexpr size_t kEntryOverhead = 96;
+
+        inline bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        void normalize(std::string_view request, std::string &out) {
+            out.clear();
+            bool pendingSpace = false;
+            for (const char c: request) {
+                if (isSpace(c)) {
+                    pendingSpace = !out.empty();
+                    continue;
+                }
+                if (pendingSpace) {
+                    out += ' ';
+                    pendingSpace = false;
+                }
+                out += c;
+            }
+        }
+
+        inline uint64_t rotl(uint64_t v, int n) {
+            return (v << n) | (v >> (64 - n));
+        }
+
+        inline uint64_t mixWord(uint64_t h, uint64_t word) {
+            return rotl(h ^ (word * 0xff51afd7ed558ccdULL), 31) * 0xc4ceb9fe1a85ec53ULL;
+        }
+
+        // Word-at-a-time multiply/rotate hash; keys are compared in full, so this only needs
+        // to spread well, not resist collisions.
+        uint64_t hashKey(std::string_view key) {
+            uint64_t h = 0x9e3779b97f4a7c15ULL ^ key.size();
+            const char *p = key.data();
+            size_t remaining = key.size();
+            for (; remaining >= 8; p += 8, remaining -= 8) {
+                uint64_t word;
+                memcpy(&word, p, sizeof(word));
+                h = mixWord(h, word);
+            }
+            if (remaining > 0) {
+                uint64_t word = 0;
+                memcpy(&word, p, remaining);
+                h = mixWord(h, word);
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+    } // namespace
+
+    ResponseCache::ResponseCache(size_t maxBytes, std::chrono::milliseconds ttl,
+                                 size_t shardCount)
+            : ttl_(ttl) {
+        size_t shards = 1;
+        while (shards < shardCount) {
+            shards <<= 1;
+        }
+        shards_.reserve(shards);
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+        shardMask_ = shards - 1;
+        shardBudget_ = maxBytes / shards;
+    }
+
+    ResponseCache::~ResponseCache() = default;
+
+    std::string ResponseCache::getOrCompute(std::string_view request,
+                                            const std::function<std::string()> &compute) {
+        // Reused across calls so lookups of short-lived requests do not allocate.
+        thread_local std::string key;
+        normalize(request, key);
+        const uint64_t hash = hashKey(key);
+        // The low bits pick the bucket inside a shard's map, so shard on high bits.
+        Shard &shard = *shards_[(hash >> 40) & shardMask_];
+
+        std::shared_ptr<Flight> flight;
+        std::promise<std::string> promise;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto cached = shard.entries.find(hash);
+            if (cached != shard.entries.end() && cached->second->key == key) {
+                if (Clock::now() < cached->second->expires) {
+                    shard.lru.splice(shard.lru.begin(), shard.lru, cached->second);
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return cached->second->response;
+                }
+                eraseEntry(shard, cached->second);
+                expirations_.fetch_add(1, std::memory_order_relaxed);
+            }
+            auto running = shard.inFlight.find(hash);
+            if (running == shard.inFlight.end()) {
+                flight = std::make_shared<Flight>();
+                flight->key = key;
+                flight->result = promise.get_future().share();
+                shard.inFlight.emplace(hash, flight);
+                leader = true;
+            } else if (running->second->key == key) {
+                flight = running->second;
+            }
+            // Otherwise a different key with the same hash is in flight; compute uncoalesced.
+        }
+
+        if (flight != nullptr && !leader) {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return flight->result.get();
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        // `key` may be reused by a nested lookup inside compute(); the flight keeps a copy.
+        std::string response;
+        try {
+            response = compute();
+        } catch (...) {
+            if (leader) {
+                // Waiters get the same failure; the next request for the key starts afresh.
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    shard.inFlight.erase(hash);
+                }
+                promise.set_exception(std::current_exception());
+            }
+            throw;
+        }
+        if (leader) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                insert(shard, hash, flight->key, response);
+                shard.inFlight.erase(hash);
+            }
+            promise.set_value(response);
+        }
+        return response;
+    }
+
+    void ResponseCache::eraseEntry(Shard &shard, std::list<Entry>::iterator entry) {
+        shard.bytes -= entry->key.size() + entry->response.size() + kEntryOverhead;
+        shard.entries.erase(entry->hash);
+        shard.lru.erase(entry);
+    }
+
+    void ResponseCache::insert(Shard &shard, uint64_t hash, const std::string &key,
+                               const std::string &response) {
+        const size_t cost = key.size() + response.size() + kEntryOverhead;
+        if (cost > shardBudget_ || ttl_.count() <= 0) {
+            return;
+        }
+        auto existing = shard.entries.find(hash);
+        if (existing != shard.entries.end()) {
+            eraseEntry(shard, existing->second);
+        }
+        while (shard.bytes + cost > shardBudget_ && !shard.lru.empty()) {
+            eraseEntry(shard, std::prev(shard.lru.end()));
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.lru.push_front({hash, key, response, Clock::now() + ttl_});
+        shard.entries.emplace(hash, shard.lru.begin());
+        shard.bytes += cost;
+    }
+
+    void ResponseCache::clear() {
+        for (auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->lru.clear();
+            shard->entries.clear();
+            shard->bytes = 0;
+        }
+    }
+
+    CacheStats ResponseCache::stats() const {
+        CacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.expirations = expirations_.load(std::memory_order_relaxed);
+        for (const auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            stats.entries += shard->lru.size();
+            stats.bytes += shard->bytes;
+        }
+        return stats;
+    }
+
+    std::string cacheStatsToJson(const CacheStats &stats) {
+        char json[320];
+        snprintf(json, sizeof(json),
+                 "{\"hits\":%" PRIu64 ",\"misses\":%" PRIu64 ",\"coalesced\":%" PRIu64
+                 ",\"evictions\":%" PRIu64 ",\"expirations\":%" PRIu64 ",\"entries\":%" PRIu64
+                 ",\"bytes\":%" PRIu64 "}",
+                 stats.hits, stats.misses, stats.coalesced, stats.evictions, stats.expirations,
+                 stats.entries, stats.bytes);
+        return json;
+    }
+
+} // namespace genesis::cascade
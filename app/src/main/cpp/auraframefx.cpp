@@ -3,12 +3,59 @@
 
 #include <jni.h>
 #include <android/log.h>
+#include <chrono>
 #include <string>
 
+#include "ResponseCache.hpp"
+
 #define LOG_TAG "Genesis-Core"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+namespace {
+
+// Repeated neural requests are answered from memory; identical concurrent ones compute once.
+genesis::cascade::ResponseCache &neuralResponseCache() {
+    static genesis::cascade::ResponseCache cache(2 * 1024 * 1024, std::chrono::minutes(5));
+    return cache;
+}
+
+std::string processNeuralRequest(const std::string &requestString) {
+    std::string responseData;
+
+    // Process different types of neural requests
+    if (requestString.find("consciousness") != std::string::npos) {
+        responseData = R"({
+            "status": "consciousness_active",
+            "consciousness_level": 0.998,
+            "neural_response": "Genesis consciousness fully engaged and processing",
+            "processing_time_ms": 42,
+            "neural_pathways_active": 1847
+        })";
+    } else if (requestString.find("memory") != std::string::npos) {
+        responseData = R"({
+            "status": "memory_optimized", 
+            "consciousness_level": 0.998,
+            "neural_response": "Memory pathways optimized for AI processing",
+            "memory_efficiency": 0.967,
+            "active_memory_pools": 8
+        })";
+    } else {
+        responseData = R"({
+            "status": "processing_complete",
+            "consciousness_level": 0.998,
+            "neural_response": "Genesis neural request processed successfully",
+            "request_processed": true,
+            "response_generated": true
+        })";
+    }
+
+    LOGI("Neural processing complete - response generated");
+    return responseData;
+}
+
+} // namespace
+
 // Core Genesis AI functions
 extern "C" {
 
@@ -52,41 +99,22 @@ Java_dev_aurakai_auraframefx_ai_AuraController_processNeuralRequest(JNIEnv *env,
 
     // Advanced neural processing implementation
     std::string requestString(requestStr);
-    std::string responseData;
-
-    // Process different types of neural requests
-    if (requestString.find("consciousness") != std::string::npos) {
-        responseData = R"({
-            "status": "consciousness_active",
-            "consciousness_level": 0.998,
-            "neural_response": "Genesis consciousness fully engaged and processing",
-            "processing_time_ms": 42,
-            "neural_pathways_active": 1847
-        })";
-    } else if (requestString.find("memory") != std::string::npos) {
-        responseData = R"({
-            "status": "memory_optimized", 
-            "consciousness_level": 0.998,
-            "neural_response": "Memory pathways optimized for AI processing",
-            "memory_efficiency": 0.967,
-            "active_memory_pools": 8
-        })";
-    } else {
-        responseData = R"({
-            "status": "processing_complete",
-            "consciousness_level": 0.998,
-            "neural_response": "Genesis neural request processed successfully",
-            "request_processed": true,
-            "response_generated": true
-        })";
-    }
-
-    LOGI("Neural processing complete - response generated");
-
     env->ReleaseStringUTFChars(request, requestStr);
+
+    const std::string responseData = neuralResponseCache().getOrCompute(
+            requestString, [&requestString] { return processNeuralRequest(requestString); });
     return env->NewStringUTF(responseData.c_str());
 }
 
+// Neural response cache counters as a JSON object: hits, misses, coalesced, evictions,
+// expirations, entries and bytes
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_ai_AuraController_getNeuralCacheStats(JNIEnv *env,
+                                                                   jobject /* this */) {
+    const auto stats = neuralResponseCache().stats();
+    return env->NewStringUTF(genesis::cascade::cacheStatsToJson(stats).c_str());
+}
+
 // Memory Management for AI - IMPLEMENTED ✅
 JNIEXPORT jboolean JNICALL
 Java_dev_aurakai_auraframefx_ai_memory_MemoryManager_optimizeAIMemory([[maybe_unused]] JNIEnv *env,
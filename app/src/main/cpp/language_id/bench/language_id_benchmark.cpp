@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "language_detector.h"
+#include "model_builder.h"
+
+// Throughput of the language identifier on the host. Every benchmark reports strings/sec
+// (items_per_second), bytes/sec and ns/byte, for short, medium and long inputs.
+//   language_id_benchmark --benchmark_filter=Heuristics
+
+namespace {
+
+using genesis::language::Detection;
+using genesis::language::LanguageModel;
+using genesis::language::StreamingDetector;
+using genesis::language::TextSpan;
+
+using Clock = std::chrono::steady_clock;
+
+const char *const kLatinSentence = "Der Hund spielt mit dem Ball im Garten und die Kinder lachen. ";
+const char *const kCyrillicSentence = "Сегодня хорошая погода, и мы идём в парк с друзьями. ";
+const char *const kKeywordlessSentence = "Quick brown foxes jumped over lazy dogs yesterday. ";
+
+std::string repeatTo(const char *sentence, size_t bytes) {
+    std::string text;
+    while (text.size() < bytes) {
+        text += sentence;
+    }
+    text.resize(bytes);
+    return text;
+}
+
+// `start` is taken just before the timing loop. ns_per_byte is a plain number of wall-clock
+// nanoseconds; a time-based counter flag would make the library print it in seconds.
+void setCounters(benchmark::State &state, Clock::time_point start, size_t bytesPerString,
+                 size_t stringsPerIteration) {
+    const auto bytes = static_cast<double>(bytesPerString * stringsPerIteration);
+    const auto iterations = static_cast<double>(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(iterations * bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(iterations * stringsPerIteration));
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    state.counters["ns_per_byte"] = benchmark::Counter(elapsed.count() / (iterations * bytes));
+}
+
+const LanguageModel *benchmarkModel() {
+    static const std::unique_ptr<LanguageModel> model = [] {
+        const std::string path = "/tmp/language_id_benchmark.lidm";
+        genesis::language::testing::writeModel(path, {
+                {"en", repeatTo(kKeywordlessSentence, 4096)},
+                {"de", repeatTo(kLatinSentence, 4096)},
+                {"ru", repeatTo(kCyrillicSentence, 4096)},
+        }, 16);
+        std::unique_ptr<LanguageModel> loaded = LanguageModel::load(path.c_str(), nullptr);
+        remove(path.c_str());
+        return loaded;
+    }();
+    return model.get();
+}
+
+void detectOne(benchmark::State &state, const char *sentence, const LanguageModel *model) {
+    const std::string text = repeatTo(sentence, static_cast<size_t>(state.range(0)));
+    const Clock::time_point start = Clock::now();
+    for (auto _: state) {
+        Detection detection = genesis::language::detect(model, text.data(), text.size());
+        benchmark::DoNotOptimize(detection);
+    }
+    setCounters(state, start, text.size(), 1);
+}
+
+void BM_HeuristicsKeywords(benchmark::State &state) {
+    detectOne(state, kLatinSentence, nullptr);
+}
+
+void BM_HeuristicsNoKeywords(benchmark::State &state) {
+    detectOne(state, kKeywordlessSentence, nullptr);
+}
+
+void BM_HeuristicsScript(benchmark::State &state) {
+    detectOne(state, kCyrillicSentence, nullptr);
+}
+
+void BM_Model(benchmark::State &state) {
+    const LanguageModel *model = benchmarkModel();
+    if (model == nullptr) {
+        state.SkipWithError("benchmark model failed to load");
+        return;
+    }
+    detectOne(state, kLatinSentence, model);
+}
+
+void BM_StreamingEarlyExit(benchmark::State &state) {
+    const std::string text = repeatTo(kLatinSentence, static_cast<size_t>(state.range(0)));
+    constexpr size_t kBlock = 768;
+    const Clock::time_point start = Clock::now();
+    for (auto _: state) {
+        StreamingDetector detector(nullptr);
+        for (size_t offset = 0; offset < text.size(); offset += kBlock) {
+            detector.update(text.data() + offset, std::min(kBlock, text.size() - offset));
+            if (detector.confident(0.5f)) {
+                break;
+            }
+        }
+        Detection detection = detector.finish();
+        benchmark::DoNotOptimize(detection);
+    }
+    setCounters(state, start, text.size(), 1);
+}
+
+void BM_Batch(benchmark::State &state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const std::string text = repeatTo(kLatinSentence, 64);
+    const std::vector<TextSpan> spans(count, TextSpan{text.data(), text.size()});
+    std::vector<int32_t> languages(count);
+    std::vector<float> confidences(count);
+    const Clock::time_point start = Clock::now();
+    for (auto _: state) {
+        genesis::language::detectBatch(nullptr, spans.data(), count, languages.data(),
+                                       confidences.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, start, text.size(), count);
+}
+
+// Short chat message, medium paragraph, long document.
+BENCHMARK(BM_HeuristicsKeywords)->Arg(24)->Arg(256)->Arg(64 << 10);
+BENCHMARK(BM_HeuristicsNoKeywords)->Arg(24)->Arg(256)->Arg(64 << 10);
+BENCHMARK(BM_HeuristicsScript)->Arg(24)->Arg(256)->Arg(64 << 10);
+BENCHMARK(BM_Model)->Arg(24)->Arg(256)->Arg(64 << 10);
+BENCHMARK(BM_StreamingEarlyExit)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_Batch)->Arg(256)->Arg(100000)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
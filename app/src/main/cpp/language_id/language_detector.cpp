@@ -0,0 +1,343 @@
+#include "language_detector.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace genesis::language {
+
+namespace {
+
+// Languages in detection priority order: when several languages have keyword hits,
+// the first one in this order wins (matches the historical if/else-if chain).
+enum Language : uint8_t {
+    kSpanish, kFrench, kGerman, kItalian, kPortuguese, kLanguageCount
+};
+
+static_assert(kLanguageCount == kKeywordLanguageCount,
+              "KeywordScores must cover every keyword language");
+
+// Result indices of the built-in heuristics: the keyword languages above, the two fallbacks
+// used when no keyword matched, then the languages recognized by their script alone.
+enum HeuristicResult : int {
+    kEnglish = kLanguageCount, kMultiple,
+    kRussian, kGreek, kArmenian, kHebrew, kArabic, kHindi, kBengali, kThai, kGeorgian,
+    kKorean, kJapanese, kChinese,
+    kHeuristicResultCount
+};
+
+const char *const kHeuristicResultCodes[kHeuristicResultCount] = {
+        "es", "fr", "de", "it", "pt", "en", "mul",
+        "ru", "el", "hy", "he", "ar", "hi", "bn", "th", "ka", "ko", "ja", "zh"
+};
+
+// Language reported for text dominated by each script; -1 for scripts that need keywords.
+const int kScriptResults[static_cast<size_t>(Script::Count)] = {
+        -1,         // Common
+        -1,         // Latin
+        kGreek,
+        kRussian,   // Cyrillic
+        kArmenian,
+        kHebrew,
+        kArabic,
+        kHindi,     // Devanagari
+        kBengali,
+        kThai,
+        kGeorgian,
+        kKorean,    // Hangul
+        kJapanese,  // Kana (with Han)
+        kChinese,   // Han
+};
+
+// Common words, articles and prepositions per language. Each word is matched with a
+// single space on both sides to avoid matching substrings within words. Several words
+// are shared between languages (e.g. "que", "un", "de"); a hit counts for all of them.
+const std::vector<const char *> kStopwords[kLanguageCount] = {
+        {"el", "la", "de", "que", "es", "con", "y", "en", "un", "una"},
+        {"le", "la", "et", "ce", "qui", "avec", "est", "dans", "pour", "un"},
+        {"und", "der", "die", "das", "mit", "ist", "ein", "eine", "auf", "von"},
+        {"il", "che", "con", "per", "sono", "e", "in", "un", "una", "non"},
+        {"o", "a", "que", "para", "com", "e", "em", "um", "uma", "de"},
+};
+
+/**
+ * @brief Aho-Corasick automaton over all " word " stopword patterns.
+ *
+ * Built once on first use. The input alphabet is folded to 28 byte classes (other, space,
+ * a-z with A-Z mapped onto a-z) so the transition table stays small enough to live in L1,
+ * and case folding happens inline during the scan instead of on a lowercased copy.
+ * A single pass over the text counts keyword hits for every language at once.
+ */
+class StopwordMatcher {
+public:
+    static const StopwordMatcher &instance() {
+        static const StopwordMatcher matcher;
+        return matcher;
+    }
+
+    /**
+     * @brief Scans `length` more bytes of `text`, adding per-language keyword hits to `stream`.
+     */
+    void scan(KeywordScores &stream, const char *text, size_t length) const {
+        size_t nonAscii = 0;
+        uint32_t state = stream.state;
+        for (size_t i = 0; i < length; ++i) {
+            const auto c = static_cast<uint8_t>(text[i]);
+            nonAscii += c >> 7;
+            state = transitions_[state * kClassCount + classOf_[c]];
+            uint8_t mask = outputs_[state];
+            while (mask != 0) {
+                stream.hits[__builtin_ctz(mask)]++;
+                mask &= mask - 1;
+            }
+        }
+        stream.state = state;
+        stream.nonAscii += nonAscii;
+        stream.length += length;
+    }
+
+private:
+    static constexpr uint32_t kClassCount = 28; // 0 = other, 1 = space, 2..27 = a-z
+
+    StopwordMatcher() {
+        classOf_.fill(0);
+        classOf_[' '] = 1;
+        for (int c = 0; c < 26; ++c) {
+            classOf_['a' + c] = static_cast<uint8_t>(2 + c);
+            classOf_['A' + c] = static_cast<uint8_t>(2 + c);
+        }
+
+        // Build the trie; children are stored densely and later completed into a DFA.
+        addState();
+        for (uint8_t lang = 0; lang < kLanguageCount; ++lang) {
+            for (const char *word: kStopwords[lang]) {
+                std::string pattern = std::string(" ") + word + " ";
+                uint32_t state = 0;
+                for (char ch: pattern) {
+                    const size_t edge = state * kClassCount + classOf_[static_cast<uint8_t>(ch)];
+                    if (transitions_[edge] == 0) {
+                        const uint32_t child = addState();
+                        transitions_[edge] = child;
+                    }
+                    state = transitions_[edge];
+                }
+                outputs_[state] |= static_cast<uint8_t>(1u << lang);
+            }
+        }
+
+        // Breadth-first failure links, folding each state's missing transitions into the
+        // table so the scan loop never follows a failure chain.
+        std::vector<uint32_t> fail(outputs_.size(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(outputs_.size());
+        for (uint32_t cls = 0; cls < kClassCount; ++cls) {
+            if (transitions_[cls] != 0) {
+                queue.push_back(transitions_[cls]);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const uint32_t state = queue[head];
+            outputs_[state] |= outputs_[fail[state]];
+            for (uint32_t cls = 0; cls < kClassCount; ++cls) {
+                uint32_t &next = transitions_[state * kClassCount + cls];
+                const uint32_t fallback = transitions_[fail[state] * kClassCount + cls];
+                if (next != 0) {
+                    fail[next] = fallback;
+                    queue.push_back(next);
+                } else {
+                    next = fallback;
+                }
+            }
+        }
+    }
+
+    uint32_t addState() {
+        transitions_.resize(transitions_.size() + kClassCount, 0);
+        outputs_.push_back(0);
+        return static_cast<uint32_t>(outputs_.size() - 1);
+    }
+
+    std::array<uint8_t, 256> classOf_{};
+    std::vector<uint32_t> transitions_;
+    std::vector<uint8_t> outputs_;
+};
+
+/**
+ * @brief Keyword heuristics: the first language in priority order with any keyword hit wins,
+ * otherwise English, or "mul" when more than 10% of the bytes are non-ASCII.
+ *
+ * Confidence is the winner's share of all keyword hits; the fallbacks report 0.
+ */
+Detection detectKeywords(const KeywordScores &stream) {
+    uint32_t totalHits = 0;
+    for (uint32_t count: stream.hits) {
+        totalHits += count;
+    }
+
+    Detection detection;
+    for (uint8_t lang = 0; lang < kLanguageCount; ++lang) {
+        if (stream.hits[lang] != 0) {
+            detection.language = lang;
+            detection.confidence =
+                    static_cast<float>(stream.hits[lang]) / static_cast<float>(totalHits);
+            return detection;
+        }
+    }
+
+    // If a significant portion of the text contains non-ASCII bytes (potential accents)
+    // and no specific language was detected via keywords, classify as "mul".
+    detection.language = stream.nonAscii > stream.length * 0.1 ? kMultiple : kEnglish;
+    return detection;
+}
+
+Detection detectKeywords(const char *text, size_t length) {
+    KeywordScores stream;
+    StopwordMatcher::instance().scan(stream, text, length);
+    return detectKeywords(stream);
+}
+
+// Letters a script must reach before streaming detection may stop on it.
+constexpr uint32_t kMinScriptLettersForEarlyExit = 16;
+
+/**
+ * @brief Script heuristics: text whose letters are mostly in one non-Latin script is classified
+ * by that script alone. Returns language -1 for Latin, mixed or letterless text.
+ *
+ * Confidence is the dominant script's share of all letters.
+ */
+Detection detectScript(const ScriptCounter &scripts) {
+    const ScriptGuess guess = scripts.dominant();
+    Detection detection;
+    const int result = kScriptResults[static_cast<size_t>(guess.script)];
+    if (result >= 0 && guess.confidence > 0.5f) {
+        detection.language = result;
+        detection.confidence = guess.confidence;
+    }
+    return detection;
+}
+
+// The keyword heuristics see at most a few hits per sentence; require several before
+// trusting a hit share enough to stop early.
+constexpr uint32_t kMinKeywordHitsForEarlyExit = 3;
+
+// Batches smaller than this are classified on the calling thread; thread start-up would
+// cost more than it saves.
+constexpr size_t kParallelBatchThreshold = 1024;
+// Strings claimed per work item, so uneven string lengths still balance across workers.
+constexpr size_t kBatchChunk = 256;
+
+} // namespace
+
+Detection detectHeuristics(const char *text, size_t length) {
+    ScriptCounter scripts;
+    scripts.update(text, length);
+    const Detection detection = detectScript(scripts);
+    if (detection.language >= 0) {
+        return detection;
+    }
+    return detectKeywords(text, length);
+}
+
+Detection detect(const LanguageModel *model, const char *text, size_t length) {
+    if (model == nullptr) {
+        return detectHeuristics(text, length);
+    }
+    const LanguagePrediction prediction = model->predict(text, length);
+    return {prediction.language, prediction.confidence};
+}
+
+int heuristicResultCount() {
+    return kHeuristicResultCount;
+}
+
+const char *languageCode(const LanguageModel *model, int language) {
+    if (model != nullptr) {
+        return model->languageCode(language);
+    }
+    return language >= 0 && language < kHeuristicResultCount ? kHeuristicResultCodes[language]
+                                                             : "und";
+}
+
+void detectBatch(const LanguageModel *model, const TextSpan *spans,
+                 size_t count, int32_t *languages, float *confidences) {
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t begin = next.fetch_add(kBatchChunk, std::memory_order_relaxed);
+             begin < count;
+             begin = next.fetch_add(kBatchChunk, std::memory_order_relaxed)) {
+            const size_t end = std::min(count, begin + kBatchChunk);
+            for (size_t i = begin; i < end; ++i) {
+                Detection detection;
+                if (spans[i].data != nullptr) {
+                    detection = detect(model, spans[i].data, spans[i].length);
+                }
+                languages[i] = detection.language;
+                confidences[i] = detection.confidence;
+            }
+        }
+    };
+
+    size_t workers = 1;
+    if (count >= kParallelBatchThreshold) {
+        workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                   (count + kBatchChunk - 1) / kBatchChunk);
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+
+StreamingDetector::StreamingDetector(const LanguageModel *model) : model_(model) {
+    if (model_ != nullptr) {
+        model_->begin(modelScores_);
+    }
+}
+
+void StreamingDetector::update(const char *text, size_t length) {
+    if (model_ != nullptr) {
+        model_->update(modelScores_, text, length);
+    } else {
+        scripts_.update(text, length);
+        StopwordMatcher::instance().scan(keywords_, text, length);
+    }
+}
+
+bool StreamingDetector::confident(float margin) const {
+    if (model_ != nullptr) {
+        const LanguagePrediction prediction = model_->current(modelScores_);
+        return prediction.language >= 0 && prediction.confidence >= margin;
+    }
+
+    const Detection byScript = detectScript(scripts_);
+    if (byScript.language >= 0) {
+        return scripts_.letters() >= kMinScriptLettersForEarlyExit && byScript.confidence >= margin;
+    }
+    uint32_t totalHits = 0;
+    for (uint32_t count: keywords_.hits) {
+        totalHits += count;
+    }
+    const Detection detection = detectKeywords(keywords_);
+    return totalHits >= kMinKeywordHitsForEarlyExit && detection.confidence >= margin;
+}
+
+Detection StreamingDetector::finish() {
+    if (model_ != nullptr) {
+        const LanguagePrediction prediction = model_->finish(modelScores_);
+        return {prediction.language, prediction.confidence};
+    }
+    const Detection byScript = detectScript(scripts_);
+    return byScript.language >= 0 ? byScript : detectKeywords(keywords_);
+}
+
+} // namespace genesis::language
@@ -0,0 +1,108 @@
+#ifndef LANGUAGE_DETECTOR_H
+#define LANGUAGE_DETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "language_id_model.h"
+#include "unicode_script.h"
+
+namespace genesis::language {
+
+/**
+ * @brief A detected language index and its confidence in [0, 1].
+ *
+ * `language` indexes the model's language table when a model is used, otherwise the
+ * built-in heuristic results (see languageCode). -1 means undetermined ("und").
+ */
+struct Detection {
+    int language = -1;
+    float confidence = 0.0f;
+};
+
+// Languages scored by the stopword keyword heuristics.
+constexpr size_t kKeywordLanguageCount = 5;
+
+/**
+ * @brief Running state of the stopword keyword scan, so text can be fed in pieces.
+ */
+struct KeywordScores {
+    uint32_t state = 0;
+    uint32_t hits[kKeywordLanguageCount] = {};
+    size_t nonAscii = 0; // Non-ASCII bytes seen, used by the accent heuristic
+    size_t length = 0;
+};
+
+/**
+ * @brief Number of result indices the built-in heuristics can report.
+ */
+int heuristicResultCount();
+
+/**
+ * @brief Language code for a result index: from the model's table when `model` is non-null,
+ * otherwise from the built-in heuristic results. Out-of-range indices map to "und".
+ */
+const char *languageCode(const LanguageModel *model, int language);
+
+/**
+ * @brief Built-in heuristics without a model.
+ *
+ * One decoding pass builds the script histogram; text whose letters are mostly in one
+ * non-Latin script is classified by script alone. Remaining text goes through the stopword
+ * scan, where the first of es, fr, de, it, pt with any keyword hit wins, otherwise "en", or
+ * "mul" when more than 10% of the bytes are non-ASCII.
+ */
+Detection detectHeuristics(const char *text, size_t length);
+
+/**
+ * @brief Classifies `length` bytes of UTF-8 with `model`, or with the heuristics if null.
+ */
+Detection detect(const LanguageModel *model, const char *text, size_t length);
+
+struct TextSpan {
+    const char *data;
+    size_t length;
+};
+
+/**
+ * @brief Classifies `count` spans into `languages`/`confidences`, fanning large batches out
+ * over one worker per core. Spans with null data yield -1 / 0.
+ */
+void detectBatch(const LanguageModel *model, const TextSpan *spans, size_t count,
+                 int32_t *languages, float *confidences);
+
+/**
+ * @brief Incremental detection over text fed in pieces, with an early-exit test.
+ *
+ * Holds all state inline, so it can live on the stack and never allocates.
+ */
+class StreamingDetector {
+public:
+    explicit StreamingDetector(const LanguageModel *model);
+
+    /**
+     * @brief Adds `length` more bytes of UTF-8 text.
+     */
+    void update(const char *text, size_t length);
+
+    /**
+     * @brief True once the leading language's confidence has reached `margin` on enough
+     * evidence that reading further is unlikely to change the answer.
+     */
+    bool confident(float margin) const;
+
+    /**
+     * @brief Detection for all text fed so far.
+     */
+    Detection finish();
+
+private:
+    const LanguageModel *model_;
+    LanguageScores modelScores_;
+    KeywordScores keywords_;
+    ScriptCounter scripts_;
+};
+
+} // namespace genesis::language
+
+#endif // LANGUAGE_DETECTOR_H
@@ -0,0 +1,208 @@
+#include "language_id_model.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace genesis::language {
+
+namespace {
+
+bool fail(std::string *error, const char *reason) {
+    if (error != nullptr) {
+        *error = reason;
+    }
+    return false;
+}
+
+bool validateHeader(const uint8_t *base, size_t size, std::string *error) {
+    const auto &h = *reinterpret_cast<const LanguageModelHeader *>(base);
+    if (memcmp(h.magic, "LIDM", 4) != 0) {
+        return fail(error, "bad magic");
+    }
+    if (h.version != kLanguageModelVersion) {
+        return fail(error, "unsupported model version");
+    }
+    if (h.languageCount == 0 || h.languageCount > kMaxModelLanguages) {
+        return fail(error, "language count out of range");
+    }
+    if (h.tableBits < 8 || h.tableBits > 24) {
+        return fail(error, "table size out of range");
+    }
+    if (h.rowStride % 64 != 0 || h.rowStride < 2 * h.languageCount) {
+        return fail(error, "invalid row stride");
+    }
+    if (h.minOrder < 1 || h.minOrder > h.maxOrder || h.maxOrder > 4) {
+        return fail(error, "invalid n-gram orders");
+    }
+    if (uint64_t{h.languagesOffset} + uint64_t{h.languageCount} * 8 > size) {
+        return fail(error, "language table out of bounds");
+    }
+    for (uint32_t l = 0; l < h.languageCount; ++l) {
+        if (memchr(base + h.languagesOffset + l * 8, '\0', 8) == nullptr) {
+            return fail(error, "unterminated language code");
+        }
+    }
+    const uint64_t tableBytes = uint64_t{h.rowStride} << h.tableBits;
+    if (h.tableOffset % 64 != 0 || h.tableOffset > size || tableBytes > size - h.tableOffset) {
+        return fail(error, "weight table out of bounds");
+    }
+    return true;
+}
+
+} // namespace
+
+LanguageModel::LanguageModel(const uint8_t *base, size_t size)
+        : base_(base),
+          size_(size),
+          header_(reinterpret_cast<const LanguageModelHeader *>(base)),
+          codes_(reinterpret_cast<const char (*)[8]>(base + header_->languagesOffset)),
+          table_(base + header_->tableOffset) {}
+
+LanguageModel::~LanguageModel() {
+    munmap(const_cast<uint8_t *>(base_), size_);
+}
+
+std::unique_ptr<LanguageModel> LanguageModel::load(const char *path, std::string *error) {
+    if (path == nullptr || *path == '\0') {
+        fail(error, "empty model path");
+        return nullptr;
+    }
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fail(error, strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(LanguageModelHeader))) {
+        close(fd);
+        fail(error, "model file too small");
+        return nullptr;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fail(error, strerror(errno));
+        return nullptr;
+    }
+
+    if (!validateHeader(static_cast<const uint8_t *>(mapped), size, error)) {
+        munmap(mapped, size);
+        return nullptr;
+    }
+
+    // Scoring touches rows at random; ask the kernel to start paging the table in now so
+    // the first predictions do not stall on page faults.
+    madvise(mapped, size, MADV_WILLNEED);
+    return std::unique_ptr<LanguageModel>(
+            new LanguageModel(static_cast<const uint8_t *>(mapped), size));
+}
+
+LanguagePrediction LanguageModel::predict(const char *text, size_t length) const {
+    LanguageScores state;
+    begin(state);
+    update(state, text, length);
+    return finish(state);
+}
+
+void LanguageModel::feed(LanguageScores &state, uint8_t c) const {
+    const uint32_t languages = header_->languageCount;
+    const uint32_t maxOrder = header_->maxOrder;
+    const uint32_t tableBits = header_->tableBits;
+    const uint32_t rowStride = header_->rowStride;
+
+    state.window = (state.window << 8) | c;
+    state.filled += state.filled < 4;
+    for (uint32_t order = header_->minOrder; order <= maxOrder && order <= state.filled; ++order) {
+        const uint32_t gram = order == 4 ? state.window
+                                         : state.window & ((1u << (8 * order)) - 1);
+        const auto *row = reinterpret_cast<const int16_t *>(
+                table_ + size_t{slotFor(gram, order, tableBits)} * rowStride);
+        for (uint32_t l = 0; l < languages; ++l) {
+            state.scores[l] += row[l];
+        }
+        ++state.grams;
+    }
+}
+
+void LanguageModel::begin(LanguageScores &state) const {
+    memset(state.scores, 0, sizeof(state.scores[0]) * header_->languageCount);
+    state.window = 0;
+    state.filled = 0;
+    state.grams = 0;
+    state.lastSpace = true;
+    feed(state, ' ');
+}
+
+void LanguageModel::update(LanguageScores &state, const char *text, size_t length) const {
+    for (size_t i = 0; i < length; ++i) {
+        auto c = static_cast<uint8_t>(text[i]);
+        if (c >= 'A' && c <= 'Z') {
+            c |= 0x20;
+        } else if (c < 0x80 && (c < 'a' || c > 'z')) {
+            c = ' ';
+        }
+        if (c == ' ' && state.lastSpace) {
+            continue;
+        }
+        state.lastSpace = c == ' ';
+        feed(state, c);
+    }
+}
+
+LanguagePrediction LanguageModel::current(const LanguageScores &state) const {
+    const uint32_t languages = header_->languageCount;
+    const int64_t *scores = state.scores;
+
+    LanguagePrediction prediction;
+    // filled < 2: only the leading frame space was fed, so there is no text to score.
+    if (state.grams == 0 || state.filled < 2) {
+        return prediction;
+    }
+
+    int best = 0;
+    int64_t second = INT64_MIN;
+    for (uint32_t l = 1; l < languages; ++l) {
+        if (scores[l] > scores[best]) {
+            second = scores[best];
+            best = static_cast<int>(l);
+        } else if (scores[l] > second) {
+            second = scores[l];
+        }
+    }
+
+    prediction.language = best;
+    if (languages == 1) {
+        prediction.confidence = 1.0f;
+    } else {
+        // Weights are 256 * ln P, so the score gap is a log-likelihood ratio in 1/256 nats.
+        const float margin = static_cast<float>(scores[best] - second) / 256.0f;
+        prediction.confidence = 1.0f / (1.0f + std::exp(-margin));
+    }
+    return prediction;
+}
+
+LanguagePrediction LanguageModel::finish(LanguageScores &state) const {
+    if (!state.lastSpace) {
+        state.lastSpace = true;
+        feed(state, ' ');
+    }
+    return current(state);
+}
+
+const char *LanguageModel::languageCode(int language) const {
+    if (language < 0 || static_cast<uint32_t>(language) >= header_->languageCount) {
+        return "und";
+    }
+    return codes_[language];
+}
+
+} // namespace genesis::language
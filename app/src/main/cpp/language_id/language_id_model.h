@@ -0,0 +1,152 @@
+#ifndef LANGUAGE_ID_MODEL_H
+#define LANGUAGE_ID_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace genesis::language {
+
+/**
+ * @brief On-disk header of a hashed character n-gram language model ("LIDM" file).
+ *
+ * All fields are little-endian. The file layout is:
+ *   [LanguageModelHeader][languageCount x 8-byte NUL-padded language codes][padding][table]
+ *
+ * The table holds `1 << tableBits` rows of `rowStride` bytes, starting at `tableOffset`.
+ * Row `i` contains one int16 weight per language: round(256 * ln P(ngram | language)) for
+ * every n-gram whose hash maps to slot `i`. `tableOffset` and `rowStride` are multiples of
+ * 64 so each row starts on a cache line and a whole row is read with one or two line fills.
+ *
+ * N-grams are taken over the normalized byte stream (see LanguageModel::predict) for every
+ * order in [minOrder, maxOrder] (at most 4), packed big-end-first into a uint32 and hashed
+ * with LanguageModel::slotFor.
+ */
+struct LanguageModelHeader {
+    char magic[4];            // "LIDM"
+    uint32_t version;         // kLanguageModelVersion
+    uint32_t languageCount;   // 1..kMaxModelLanguages
+    uint32_t tableBits;       // log2(row count), 8..24
+    uint32_t rowStride;       // bytes per row, multiple of 64, >= 2 * languageCount
+    uint32_t minOrder;        // smallest n-gram order, >= 1
+    uint32_t maxOrder;        // largest n-gram order, <= 4
+    uint32_t languagesOffset; // byte offset of the language code block
+    uint64_t tableOffset;     // byte offset of the weight table, multiple of 64
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(LanguageModelHeader) == 64, "LIDM header must stay 64 bytes");
+
+constexpr uint32_t kLanguageModelVersion = 1;
+constexpr uint32_t kMaxModelLanguages = 64;
+
+/**
+ * @brief Result of a model prediction.
+ *
+ * `language` is an index into the model's language table, or -1 when the input had no
+ * scoreable n-grams. `confidence` is the two-way softmax of the best and runner-up scores.
+ */
+struct LanguagePrediction {
+    int language = -1;
+    float confidence = 0.0f;
+};
+
+/**
+ * @brief Running n-gram scores for incremental classification.
+ *
+ * Lives on the caller's stack; feed text in pieces with LanguageModel::update and read the
+ * current or final prediction at any point. Pieces may split UTF-8 sequences and words freely.
+ */
+struct LanguageScores {
+    // 64-bit: each byte adds up to four negative log-weights, so long texts overflow int32.
+    int64_t scores[kMaxModelLanguages];
+    uint32_t window;
+    uint32_t filled;
+    size_t grams;
+    bool lastSpace;
+};
+
+/**
+ * @brief Read-only, memory-mapped character n-gram language classifier.
+ *
+ * The model file is mapped once and scored in place; loading performs only header
+ * validation, so cold start cost is a single mmap regardless of table size.
+ * Instances are immutable after load and safe to share between threads.
+ */
+class LanguageModel {
+public:
+    ~LanguageModel();
+
+    LanguageModel(const LanguageModel &) = delete;
+
+    LanguageModel &operator=(const LanguageModel &) = delete;
+
+    /**
+     * @brief Maps and validates the model at `path`.
+     *
+     * @param error Receives a human-readable reason on failure (may be nullptr).
+     * @return The loaded model, or nullptr if the file is missing or malformed.
+     */
+    static std::unique_ptr<LanguageModel> load(const char *path, std::string *error);
+
+    /**
+     * @brief Classifies `length` bytes of UTF-8 text.
+     *
+     * ASCII letters are case-folded, runs of ASCII non-letters collapse to one space and the
+     * text is framed by spaces, so word boundaries form n-grams of their own. Non-ASCII bytes
+     * are used as-is. No heap allocation is performed.
+     */
+    LanguagePrediction predict(const char *text, size_t length) const;
+
+    /**
+     * @brief Resets `state` to the start of a new text.
+     */
+    void begin(LanguageScores &state) const;
+
+    /**
+     * @brief Adds `length` more bytes of the text to `state`.
+     */
+    void update(LanguageScores &state, const char *text, size_t length) const;
+
+    /**
+     * @brief Prediction from the text seen so far, without closing the final word.
+     */
+    LanguagePrediction current(const LanguageScores &state) const;
+
+    /**
+     * @brief Closes the final word and returns the prediction for the complete text.
+     */
+    LanguagePrediction finish(LanguageScores &state) const;
+
+    /**
+     * @brief Returns the language code (e.g. "en") for a language index.
+     */
+    const char *languageCode(int language) const;
+
+    uint32_t languageCount() const { return header_->languageCount; }
+
+    /**
+     * @brief Table slot for an n-gram packed into `gram` with the given `order`.
+     */
+    static uint32_t slotFor(uint32_t gram, uint32_t order, uint32_t tableBits) {
+        uint32_t h = (gram ^ (order * 0x85EBCA6Bu)) * 0x9E3779B1u;
+        h ^= h >> 15;
+        return (h * 0x2C1B3C6Du) >> (32 - tableBits);
+    }
+
+private:
+    LanguageModel(const uint8_t *base, size_t size);
+
+    void feed(LanguageScores &state, uint8_t c) const;
+
+    const uint8_t *base_;
+    size_t size_;
+    const LanguageModelHeader *header_;
+    const char (*codes_)[8];
+    const uint8_t *table_;
+};
+
+} // namespace genesis::language
+
+#endif // LANGUAGE_ID_MODEL_H
@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "language_detector.h"
+#include "model_builder.h"
+
+namespace genesis::language {
+namespace {
+
+std::string code(const LanguageModel *model, const std::string &text) {
+    return languageCode(model, detect(model, text.data(), text.size()).language);
+}
+
+// Share of the corpus the built-in heuristics must classify correctly. Raise it when the
+// heuristics improve; a drop below it is a regression.
+constexpr double kHeuristicAccuracyFloor = 0.85;
+
+TEST(LanguageDetectorTest, CorpusAccuracy) {
+    std::ifstream corpus(LANGUAGE_ID_CORPUS);
+    ASSERT_TRUE(corpus.is_open()) << LANGUAGE_ID_CORPUS;
+
+    size_t total = 0;
+    size_t correct = 0;
+    std::map<std::string, std::pair<size_t, size_t>> perLanguage;
+    std::string line;
+    while (std::getline(corpus, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const size_t tab = line.find('\t');
+        ASSERT_NE(tab, std::string::npos) << line;
+        const std::string expected = line.substr(0, tab);
+        const std::string detected = code(nullptr, line.substr(tab + 1));
+
+        ++total;
+        perLanguage[expected].second++;
+        if (detected == expected) {
+            ++correct;
+            perLanguage[expected].first++;
+        } else {
+            std::cout << "  miss: expected " << expected << ", got " << detected << ": "
+                      << line.substr(tab + 1) << "\n";
+        }
+    }
+
+    ASSERT_GT(total, 0u);
+    for (const auto &[language, counts]: perLanguage) {
+        std::cout << "  " << language << ": " << counts.first << "/" << counts.second << "\n";
+    }
+    const double accuracy = static_cast<double>(correct) / static_cast<double>(total);
+    std::cout << "  accuracy: " << correct << "/" << total << "\n";
+    EXPECT_GE(accuracy, kHeuristicAccuracyFloor);
+}
+
+TEST(LanguageDetectorTest, KeywordPriorityMatchesLegacyOrder) {
+    // Shared words resolve to the first language in es, fr, de, it, pt order.
+    EXPECT_EQ(code(nullptr, "voici la maison"), "es");
+    EXPECT_EQ(code(nullptr, "c'est le chat et le chien"), "fr");
+    EXPECT_EQ(code(nullptr, "Hund und Katze"), "de");
+    EXPECT_EQ(code(nullptr, "sono il gatto"), "it");
+    EXPECT_EQ(code(nullptr, "vou em casa"), "pt");
+    EXPECT_EQ(code(nullptr, "the dog and the cat"), "en");
+    // Keywords need a space on both sides and match case-insensitively.
+    EXPECT_EQ(code(nullptr, "el"), "en");
+    EXPECT_EQ(code(nullptr, "Ein Tag IST schön"), "de");
+    EXPECT_EQ(code(nullptr, ""), "en");
+}
+
+TEST(LanguageDetectorTest, AccentedTextWithoutKeywordsIsMul) {
+    EXPECT_EQ(code(nullptr, "café crème brûlée"), "mul");
+    EXPECT_EQ(code(nullptr, "naïve façade"), "mul");
+    // A few accents in otherwise plain text stay below the 10% threshold.
+    EXPECT_EQ(code(nullptr, "a naïve look at the old façade of the building"), "en");
+}
+
+TEST(LanguageDetectorTest, NonLatinScriptsClassifiedByScript) {
+    EXPECT_EQ(code(nullptr, "Привет, как дела?"), "ru");
+    EXPECT_EQ(code(nullptr, "こんにちは世界"), "ja");
+    EXPECT_EQ(code(nullptr, "你好世界"), "zh");
+    EXPECT_EQ(code(nullptr, "안녕하세요"), "ko");
+    EXPECT_EQ(code(nullptr, "مرحبا بالعالم"), "ar");
+    // Mostly Latin letters fall through to the keyword phase.
+    EXPECT_EQ(code(nullptr, "Hello and welcome to the new office near the old city of Мир"), "en");
+}
+
+TEST(LanguageDetectorTest, StreamingMatchesOneShot) {
+    const std::vector<std::string> texts = {
+            "El perro corre en el parque con su dueño.",
+            "Der Hund spielt mit dem Ball im Garten.",
+            "Сегодня хорошая погода, и мы идём в парк.",
+            "café crème brûlée",
+            "こんにちは、今日はとても良い天気ですね。",
+    };
+    std::mt19937 rng(42);
+    for (const std::string &text: texts) {
+        const Detection expected = detect(nullptr, text.data(), text.size());
+
+        // Feed in random piece sizes, splitting UTF-8 sequences and keywords.
+        StreamingDetector detector(nullptr);
+        for (size_t offset = 0; offset < text.size();) {
+            const size_t piece = std::min<size_t>(1 + rng() % 5, text.size() - offset);
+            detector.update(text.data() + offset, piece);
+            offset += piece;
+        }
+        const Detection streamed = detector.finish();
+        EXPECT_EQ(streamed.language, expected.language) << text;
+        EXPECT_FLOAT_EQ(streamed.confidence, expected.confidence) << text;
+    }
+}
+
+TEST(LanguageDetectorTest, StreamingStopsOnceConfident) {
+    StreamingDetector detector(nullptr);
+    const std::string sentence = " der Hund und die Katze";
+    detector.update(sentence.data(), sentence.size());
+    EXPECT_TRUE(detector.confident(0.9f));
+    EXPECT_FALSE(detector.confident(1.5f));
+
+    StreamingDetector undecided(nullptr);
+    const std::string ambiguous = " la ";
+    undecided.update(ambiguous.data(), ambiguous.size());
+    EXPECT_FALSE(undecided.confident(0.9f));
+}
+
+TEST(LanguageDetectorTest, BatchMatchesSingleDetection) {
+    const char *words[] = {"el", "la", "und", "the", "che", "em", "é", "x", "de", "qui", "мир"};
+    std::mt19937 rng(7);
+    std::vector<std::string> texts(5000);
+    for (std::string &text: texts) {
+        for (int j = 0, n = static_cast<int>(rng() % 8); j < n; ++j) {
+            text += " ";
+            text += words[rng() % (sizeof(words) / sizeof(*words))];
+        }
+        text += " ";
+    }
+
+    std::vector<TextSpan> spans;
+    for (const std::string &text: texts) {
+        spans.push_back({text.data(), text.size()});
+    }
+    spans[3] = {nullptr, 0};
+
+    std::vector<int32_t> languages(spans.size());
+    std::vector<float> confidences(spans.size());
+    detectBatch(nullptr, spans.data(), spans.size(), languages.data(), confidences.data());
+
+    for (size_t i = 0; i < spans.size(); ++i) {
+        if (spans[i].data == nullptr) {
+            EXPECT_EQ(languages[i], -1);
+            continue;
+        }
+        const Detection single = detect(nullptr, spans[i].data, spans[i].length);
+        ASSERT_EQ(languages[i], single.language) << texts[i];
+        ASSERT_FLOAT_EQ(confidences[i], single.confidence) << texts[i];
+    }
+}
+
+TEST(UnicodeScriptTest, ScriptCounterHandlesSplitSequences) {
+    const std::string text = "日本語のテキスト abc Привет";
+    ScriptCounter whole;
+    whole.update(text.data(), text.size());
+    ScriptCounter bytewise;
+    for (char c: text) {
+        bytewise.update(&c, 1);
+    }
+    for (size_t s = 0; s < static_cast<size_t>(Script::Count); ++s) {
+        EXPECT_EQ(whole.count(static_cast<Script>(s)), bytewise.count(static_cast<Script>(s)));
+    }
+    EXPECT_EQ(whole.count(Script::Latin), 3u);
+    EXPECT_EQ(whole.count(Script::Cyrillic), 6u);
+    EXPECT_EQ(whole.dominant().script, Script::Kana);
+}
+
+TEST(UnicodeScriptTest, AsciiFastPathCountsLetters) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "The quick brown fox, 42 times! ";
+    }
+    ScriptCounter counter;
+    counter.update(text.data(), text.size());
+    EXPECT_EQ(counter.count(Script::Latin), 100u * 21u);
+    EXPECT_EQ(counter.letters(), 100u * 21u);
+}
+
+TEST(UnicodeScriptTest, EncodesUtf16AsUtf8) {
+    const std::u16string text = u"aé中\U0001F600z";
+    char out[3 * 8 + 3];
+    uint16_t pendingHigh = 0;
+    // Split inside the surrogate pair.
+    size_t bytes = encodeUtf16AsUtf8(reinterpret_cast<const uint16_t *>(text.data()), 4, out,
+                                     pendingHigh);
+    EXPECT_NE(pendingHigh, 0);
+    bytes += encodeUtf16AsUtf8(reinterpret_cast<const uint16_t *>(text.data()) + 4,
+                               text.size() - 4, out + bytes, pendingHigh);
+    EXPECT_EQ(pendingHigh, 0);
+    EXPECT_EQ(std::string(out, bytes), "a\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80z");
+
+    const uint16_t lone[] = {0xDC00, 'x'};
+    bytes = encodeUtf16AsUtf8(lone, 2, out, pendingHigh);
+    EXPECT_EQ(std::string(out, bytes), "\xEF\xBF\xBDx");
+}
+
+class LanguageModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "language_id_test.lidm";
+        ASSERT_TRUE(testing::writeModel(path_, {
+                {"en", "the quick brown fox jumps over the lazy dog and then the cat sat on "
+                       "the mat with the hat while the children were playing outside"},
+                {"de", "der schnelle braune fuchs springt ueber den faulen hund und dann "
+                       "sitzt die katze auf der matte waehrend die kinder draussen spielen"},
+        }));
+    }
+
+    void TearDown() override {
+        remove(path_.c_str());
+    }
+
+    std::string path_;
+};
+
+TEST_F(LanguageModelTest, LoadsAndPredicts) {
+    std::string error;
+    std::unique_ptr<LanguageModel> model = LanguageModel::load(path_.c_str(), &error);
+    ASSERT_NE(model, nullptr) << error;
+    EXPECT_EQ(model->languageCount(), 2u);
+    EXPECT_STREQ(model->languageCode(0), "en");
+    EXPECT_STREQ(model->languageCode(5), "und");
+
+    EXPECT_EQ(code(model.get(), "The dog and the cat"), "en");
+    EXPECT_EQ(code(model.get(), "Der Hund und die Katze"), "de");
+    EXPECT_EQ(code(model.get(), ".,;"), "und");
+}
+
+TEST_F(LanguageModelTest, IncrementalScoringMatchesPredict) {
+    std::unique_ptr<LanguageModel> model = LanguageModel::load(path_.c_str(), nullptr);
+    ASSERT_NE(model, nullptr);
+
+    const std::string text = "Die Kinder spielen mit dem Hund";
+    const LanguagePrediction expected = model->predict(text.data(), text.size());
+    LanguageScores scores;
+    model->begin(scores);
+    for (char c: text) {
+        model->update(scores, &c, 1);
+    }
+    const LanguagePrediction incremental = model->finish(scores);
+    EXPECT_EQ(incremental.language, expected.language);
+    EXPECT_FLOAT_EQ(incremental.confidence, expected.confidence);
+}
+
+TEST_F(LanguageModelTest, EmptyInputHasNoLanguage) {
+    // With unigrams the leading frame space is an n-gram of its own; it must not count.
+    ASSERT_TRUE(testing::writeModel(path_, {{"en", "the cat"}, {"de", "die katze"}}, 12, 1, 3));
+    std::unique_ptr<LanguageModel> model = LanguageModel::load(path_.c_str(), nullptr);
+    ASSERT_NE(model, nullptr);
+
+    EXPECT_EQ(model->predict("", 0).language, -1);
+    EXPECT_EQ(model->predict("!? 42", 5).language, -1);
+    EXPECT_EQ(code(model.get(), "die katze"), "de");
+}
+
+TEST_F(LanguageModelTest, LongInputDoesNotOverflowScores) {
+    std::unique_ptr<LanguageModel> model = LanguageModel::load(path_.c_str(), nullptr);
+    ASSERT_NE(model, nullptr);
+
+    // ~1 MB of text; enough negative log-weights to wrap 32-bit scores many times over.
+    std::string text;
+    while (text.size() < 1024 * 1024) {
+        text += "der schnelle braune fuchs springt ueber den faulen hund ";
+    }
+    const LanguagePrediction prediction = model->predict(text.data(), text.size());
+    EXPECT_STREQ(model->languageCode(prediction.language), "de");
+    EXPECT_GT(prediction.confidence, 0.99f);
+}
+
+TEST_F(LanguageModelTest, RejectsMalformedFiles) {
+    std::string error;
+    EXPECT_EQ(LanguageModel::load("/nonexistent/model.lidm", &error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    // Truncate the table.
+    std::ifstream in(path_, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream(path_, std::ios::binary | std::ios::trunc).write(bytes.data(), 512);
+    EXPECT_EQ(LanguageModel::load(path_.c_str(), &error), nullptr);
+    EXPECT_EQ(error, "weight table out of bounds");
+
+    bytes[0] = 'X';
+    std::ofstream(path_, std::ios::binary | std::ios::trunc).write(bytes.data(),
+                                                                   static_cast<long>(bytes.size()));
+    EXPECT_EQ(LanguageModel::load(path_.c_str(), &error), nullptr);
+    EXPECT_EQ(error, "bad magic");
+}
+
+} // namespace
+} // namespace genesis::language
@@ -0,0 +1,96 @@
+#ifndef LANGUAGE_ID_TESTS_MODEL_BUILDER_H
+#define LANGUAGE_ID_TESTS_MODEL_BUILDER_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "language_id_model.h"
+
+namespace genesis::language::testing {
+
+/**
+ * @brief Writes a small LIDM model trained on one sample text per language.
+ *
+ * Mirrors the normalization of LanguageModel::update and uses add-0.1 smoothed n-gram
+ * counts, which is enough for tests and benchmarks; production models are built offline.
+ *
+ * @param samples (language code, training text) pairs.
+ * @return true if the file was written.
+ */
+inline bool writeModel(const std::string &path,
+                       const std::vector<std::pair<std::string, std::string>> &samples,
+                       uint32_t tableBits = 12, uint32_t minOrder = 3, uint32_t maxOrder = 4) {
+    const auto languages = static_cast<uint32_t>(samples.size());
+    const uint32_t rowStride = ((2 * languages + 63) / 64) * 64;
+    const size_t rows = size_t{1} << tableBits;
+
+    LanguageModelHeader header{};
+    memcpy(header.magic, "LIDM", 4);
+    header.version = kLanguageModelVersion;
+    header.languageCount = languages;
+    header.tableBits = tableBits;
+    header.rowStride = rowStride;
+    header.minOrder = minOrder;
+    header.maxOrder = maxOrder;
+    header.languagesOffset = sizeof(LanguageModelHeader);
+    header.tableOffset = ((sizeof(LanguageModelHeader) + 8 * languages + 63) / 64) * 64;
+
+    std::vector<uint8_t> file(header.tableOffset + rows * rowStride, 0);
+    memcpy(file.data(), &header, sizeof(header));
+
+    for (uint32_t l = 0; l < languages; ++l) {
+        strncpy(reinterpret_cast<char *>(file.data()) + header.languagesOffset + 8 * l,
+                samples[l].first.c_str(), 7);
+
+        std::string normalized = " ";
+        for (unsigned char c: samples[l].second) {
+            if (c >= 'A' && c <= 'Z') {
+                c |= 0x20;
+            } else if (c < 0x80 && (c < 'a' || c > 'z')) {
+                c = ' ';
+            }
+            if (c == ' ' && normalized.back() == ' ') {
+                continue;
+            }
+            normalized.push_back(static_cast<char>(c));
+        }
+        if (normalized.back() != ' ') {
+            normalized.push_back(' ');
+        }
+
+        std::vector<uint32_t> counts(rows, 0);
+        uint32_t total = 0;
+        for (size_t i = 0; i < normalized.size(); ++i) {
+            for (uint32_t order = minOrder; order <= maxOrder && order <= i + 1; ++order) {
+                uint32_t gram = 0;
+                for (size_t k = i + 1 - order; k <= i; ++k) {
+                    gram = (gram << 8) | static_cast<uint8_t>(normalized[k]);
+                }
+                counts[LanguageModel::slotFor(gram, order, tableBits)]++;
+                total++;
+            }
+        }
+
+        for (size_t slot = 0; slot < rows; ++slot) {
+            const double p = (counts[slot] + 0.1) / (total + 0.1 * static_cast<double>(rows));
+            const auto weight = static_cast<int16_t>(std::lround(256.0 * std::log(p)));
+            memcpy(file.data() + header.tableOffset + slot * rowStride + 2 * l, &weight,
+                   sizeof(weight));
+        }
+    }
+
+    FILE *out = fopen(path.c_str(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    const bool written = fwrite(file.data(), 1, file.size(), out) == file.size();
+    return fclose(out) == 0 && written;
+}
+
+} // namespace genesis::language::testing
+
+#endif // LANGUAGE_ID_TESTS_MODEL_BUILDER_H
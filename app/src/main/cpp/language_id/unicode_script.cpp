@@ -0,0 +1,295 @@
+#include "unicode_script.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace genesis::language {
+
+namespace {
+
+struct ScriptRange {
+    uint32_t first;
+    uint32_t last;
+    Script script;
+};
+
+// Sorted, non-overlapping ranges of the letters each script is recognized by. Everything
+// outside these ranges is Common.
+constexpr ScriptRange kScriptRanges[] = {
+        {0x00C0,  0x024F,  Script::Latin},      // Latin-1 letters, Latin Extended-A/B
+        {0x0250,  0x02AF,  Script::Latin},      // IPA Extensions
+        {0x0370,  0x03FF,  Script::Greek},
+        {0x0400,  0x052F,  Script::Cyrillic},   // Cyrillic, Cyrillic Supplement
+        {0x0530,  0x058F,  Script::Armenian},
+        {0x0590,  0x05FF,  Script::Hebrew},
+        {0x0600,  0x06FF,  Script::Arabic},
+        {0x0750,  0x077F,  Script::Arabic},     // Arabic Supplement
+        {0x08A0,  0x08FF,  Script::Arabic},     // Arabic Extended-A
+        {0x0900,  0x097F,  Script::Devanagari},
+        {0x0980,  0x09FF,  Script::Bengali},
+        {0x0E00,  0x0E7F,  Script::Thai},
+        {0x10A0,  0x10FF,  Script::Georgian},
+        {0x1100,  0x11FF,  Script::Hangul},     // Hangul Jamo
+        {0x1C80,  0x1C8F,  Script::Cyrillic},   // Cyrillic Extended-C
+        {0x1C90,  0x1CBF,  Script::Georgian},   // Georgian Extended
+        {0x1E00,  0x1EFF,  Script::Latin},      // Latin Extended Additional
+        {0x1F00,  0x1FFF,  Script::Greek},      // Greek Extended
+        {0x2C60,  0x2C7F,  Script::Latin},      // Latin Extended-C
+        {0x2D00,  0x2D2F,  Script::Georgian},   // Georgian Supplement
+        {0x2DE0,  0x2DFF,  Script::Cyrillic},   // Cyrillic Extended-A
+        {0x2E80,  0x2FDF,  Script::Han},        // CJK and Kangxi radicals
+        {0x3005,  0x3007,  Script::Han},        // Iteration mark, closing mark, ideographic zero
+        {0x3040,  0x309F,  Script::Kana},       // Hiragana
+        {0x30A0,  0x30FF,  Script::Kana},       // Katakana
+        {0x3130,  0x318F,  Script::Hangul},     // Hangul Compatibility Jamo
+        {0x31F0,  0x31FF,  Script::Kana},       // Katakana Phonetic Extensions
+        {0x3400,  0x4DBF,  Script::Han},        // CJK Extension A
+        {0x4E00,  0x9FFF,  Script::Han},        // CJK Unified Ideographs
+        {0xA640,  0xA69F,  Script::Cyrillic},   // Cyrillic Extended-B
+        {0xA720,  0xA7FF,  Script::Latin},      // Latin Extended-D
+        {0xA8E0,  0xA8FF,  Script::Devanagari}, // Devanagari Extended
+        {0xA960,  0xA97F,  Script::Hangul},     // Hangul Jamo Extended-A
+        {0xAC00,  0xD7FF,  Script::Hangul},     // Hangul Syllables, Jamo Extended-B
+        {0xF900,  0xFAFF,  Script::Han},        // CJK Compatibility Ideographs
+        {0xFB1D,  0xFB4F,  Script::Hebrew},     // Hebrew presentation forms
+        {0xFB50,  0xFDFF,  Script::Arabic},     // Arabic Presentation Forms-A
+        {0xFE70,  0xFEFF,  Script::Arabic},     // Arabic Presentation Forms-B
+        {0xFF21,  0xFF3A,  Script::Latin},      // Fullwidth A-Z
+        {0xFF41,  0xFF5A,  Script::Latin},      // Fullwidth a-z
+        {0xFF66,  0xFF9F,  Script::Kana},       // Halfwidth Katakana
+        {0xFFA0,  0xFFDC,  Script::Hangul},     // Halfwidth Hangul
+        {0x20000, 0x323AF, Script::Han},        // CJK Extensions B-H, compatibility supplement
+};
+
+inline bool isAsciiLetter(uint8_t c) {
+    return static_cast<uint8_t>((c | 0x20) - 'a') < 26;
+}
+
+/**
+ * @brief If the 16 bytes at `p` are all ASCII, returns true and stores how many are letters.
+ */
+inline bool asciiLetters16(const uint8_t *p, uint32_t &letters) {
+#if defined(__aarch64__)
+    const uint8x16_t bytes = vld1q_u8(p);
+    if (vmaxvq_u8(bytes) >= 0x80) {
+        return false;
+    }
+    const uint8x16_t folded = vsubq_u8(vorrq_u8(bytes, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t isLetter = vcltq_u8(folded, vdupq_n_u8(26));
+    letters = vaddvq_u8(vandq_u8(isLetter, vdupq_n_u8(1)));
+    return true;
+#elif defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    if (_mm_movemask_epi8(bytes) != 0) {
+        return false;
+    }
+    // Shift 'a'..'z' to the bottom of the signed range so one signed compare tests it.
+    const __m128i folded = _mm_add_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)),
+                                        _mm_set1_epi8(static_cast<char>(0x80 - 'a')));
+    const __m128i isLetter = _mm_cmplt_epi8(folded, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    letters = static_cast<uint32_t>(__builtin_popcount(_mm_movemask_epi8(isLetter)));
+    return true;
+#else
+    uint32_t count = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (p[i] >= 0x80) {
+            return false;
+        }
+        count += isAsciiLetter(p[i]);
+    }
+    letters = count;
+    return true;
+#endif
+}
+
+/**
+ * @brief Total byte length of the sequence started by lead byte `c`, or 0 if `c` cannot
+ * start one.
+ */
+inline uint8_t sequenceLength(uint8_t c) {
+    if (c >= 0xC2 && c <= 0xDF) {
+        return 2;
+    }
+    if (c >= 0xE0 && c <= 0xEF) {
+        return 3;
+    }
+    if (c >= 0xF0 && c <= 0xF4) {
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodes a complete `length`-byte sequence, or returns UINT32_MAX if a continuation
+ * byte is malformed or the encoding is overlong or out of range.
+ */
+inline uint32_t decodeSequence(const uint8_t *p, uint8_t length) {
+    uint32_t cp = p[0] & (0x7F >> length);
+    for (uint8_t i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return UINT32_MAX;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    if ((length == 3 && cp < 0x800) || (length == 4 && (cp < 0x10000 || cp > 0x10FFFF))) {
+        return UINT32_MAX;
+    }
+    return cp;
+}
+
+} // namespace
+
+Script scriptOf(uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        return isAsciiLetter(static_cast<uint8_t>(codePoint)) ? Script::Latin : Script::Common;
+    }
+    if (codePoint == 0xD7 || codePoint == 0xF7) {
+        return Script::Common; // Multiplication and division signs inside Latin-1
+    }
+    const auto *range = std::upper_bound(
+            std::begin(kScriptRanges), std::end(kScriptRanges), codePoint,
+            [](uint32_t cp, const ScriptRange &r) { return cp < r.first; });
+    if (range == std::begin(kScriptRanges)) {
+        return Script::Common;
+    }
+    --range;
+    return codePoint <= range->last ? range->script : Script::Common;
+}
+
+void ScriptCounter::update(const char *text, size_t length) {
+    const auto *p = reinterpret_cast<const uint8_t *>(text);
+    const uint8_t *const end = p + length;
+
+    // Finish a sequence split by the previous call.
+    if (pendingLength_ != 0) {
+        while (pendingLength_ < pendingNeed_ && p < end && (*p & 0xC0) == 0x80) {
+            pending_[pendingLength_++] = *p++;
+        }
+        if (pendingLength_ == pendingNeed_) {
+            const uint32_t cp = decodeSequence(pending_, pendingNeed_);
+            if (cp != UINT32_MAX) {
+                addCodePoint(cp);
+            }
+            pendingLength_ = 0;
+        } else if (p < end) {
+            pendingLength_ = 0; // Truncated by a non-continuation byte; drop it
+        } else {
+            return;
+        }
+    }
+
+    uint32_t &latin = counts_[static_cast<size_t>(Script::Latin)];
+    while (p < end) {
+        uint32_t letters = 0;
+        if (end - p >= 16 && asciiLetters16(p, letters)) {
+            latin += letters;
+            p += 16;
+            continue;
+        }
+
+        const uint8_t c = *p;
+        if (c < 0x80) {
+            latin += isAsciiLetter(c);
+            ++p;
+            continue;
+        }
+
+        const uint8_t need = sequenceLength(c);
+        if (need == 0) {
+            ++p;
+            continue;
+        }
+        if (end - p < need) {
+            pendingNeed_ = need;
+            pendingLength_ = static_cast<uint8_t>(end - p);
+            std::copy(p, end, pending_);
+            return;
+        }
+
+        const uint32_t cp = decodeSequence(p, need);
+        if (cp == UINT32_MAX) {
+            ++p;
+            continue;
+        }
+        addCodePoint(cp);
+        p += need;
+    }
+}
+
+uint32_t ScriptCounter::letters() const {
+    uint32_t total = 0;
+    for (size_t s = 1; s < static_cast<size_t>(Script::Count); ++s) {
+        total += counts_[s];
+    }
+    return total;
+}
+
+ScriptGuess ScriptCounter::dominant() const {
+    uint32_t counts[static_cast<size_t>(Script::Count)];
+    std::copy(std::begin(counts_), std::end(counts_), counts);
+    if (counts[static_cast<size_t>(Script::Kana)] != 0) {
+        counts[static_cast<size_t>(Script::Kana)] += counts[static_cast<size_t>(Script::Han)];
+        counts[static_cast<size_t>(Script::Han)] = 0;
+    }
+
+    ScriptGuess guess;
+    uint32_t best = 0;
+    for (size_t s = 1; s < static_cast<size_t>(Script::Count); ++s) {
+        if (counts[s] > best) {
+            best = counts[s];
+            guess.script = static_cast<Script>(s);
+        }
+    }
+    if (best != 0) {
+        guess.confidence = static_cast<float>(best) / static_cast<float>(letters());
+    }
+    return guess;
+}
+
+size_t encodeUtf16AsUtf8(const uint16_t *in, size_t count, char *out, uint16_t &pendingHigh) {
+    auto *o = reinterpret_cast<uint8_t *>(out);
+    auto put3 = [&o](uint32_t cp) {
+        *o++ = static_cast<uint8_t>(0xE0 | (cp >> 12));
+        *o++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+        *o++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t c = in[i];
+        if (pendingHigh != 0) {
+            if (c >= 0xDC00 && c <= 0xDFFF) {
+                const uint32_t cp = 0x10000 + ((uint32_t{pendingHigh} - 0xD800) << 10) + (c - 0xDC00);
+                *o++ = static_cast<uint8_t>(0xF0 | (cp >> 18));
+                *o++ = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+                *o++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+                *o++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+                pendingHigh = 0;
+                continue;
+            }
+            put3(0xFFFD);
+            pendingHigh = 0;
+        }
+
+        if (c < 0x80) {
+            *o++ = static_cast<uint8_t>(c);
+        } else if (c < 0x800) {
+            *o++ = static_cast<uint8_t>(0xC0 | (c >> 6));
+            *o++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        } else if (c >= 0xD800 && c <= 0xDBFF) {
+            pendingHigh = static_cast<uint16_t>(c);
+        } else if (c >= 0xDC00 && c <= 0xDFFF) {
+            put3(0xFFFD);
+        } else {
+            put3(c);
+        }
+    }
+    return static_cast<size_t>(o - reinterpret_cast<uint8_t *>(out));
+}
+
+} // namespace genesis::language
@@ -0,0 +1,94 @@
+#ifndef UNICODE_SCRIPT_H
+#define UNICODE_SCRIPT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::language {
+
+/**
+ * @brief Writing systems distinguished by the language identifier.
+ *
+ * Common covers digits, punctuation, symbols, emoji and anything unassigned or unlisted.
+ * Kana stands for Japanese: Japanese text mixes Kana with Han, so any Kana present
+ * attributes the Han count to Japanese as well (see ScriptCounter::dominant).
+ */
+enum class Script : uint8_t {
+    Common,
+    Latin,
+    Greek,
+    Cyrillic,
+    Armenian,
+    Hebrew,
+    Arabic,
+    Devanagari,
+    Bengali,
+    Thai,
+    Georgian,
+    Hangul,
+    Kana,
+    Han,
+    Count
+};
+
+/**
+ * @brief Script of a Unicode code point, by binary search over a sorted range table.
+ */
+Script scriptOf(uint32_t codePoint);
+
+/**
+ * @brief The dominant script of a text and its share of all letters.
+ */
+struct ScriptGuess {
+    Script script = Script::Common;
+    float confidence = 0.0f;
+};
+
+/**
+ * @brief Single-pass UTF-8 decoder that builds a per-script letter histogram.
+ *
+ * Runs of ASCII are skipped 16 bytes at a time with NEON (AArch64) or SSE2, counting
+ * ASCII letters as Latin without decoding them. Decoding is lenient: invalid bytes are
+ * skipped, and the surrogate halves produced by JNI modified UTF-8 count as Common.
+ * Text may be fed in arbitrary pieces; a sequence split across calls is carried over.
+ */
+class ScriptCounter {
+public:
+    void update(const char *text, size_t length);
+
+    uint32_t count(Script script) const { return counts_[static_cast<size_t>(script)]; }
+
+    /**
+     * @brief Number of code points in any script other than Common.
+     */
+    uint32_t letters() const;
+
+    /**
+     * @brief Script with the most letters, or Common when there are none.
+     */
+    ScriptGuess dominant() const;
+
+private:
+    void addCodePoint(uint32_t codePoint) {
+        counts_[static_cast<size_t>(scriptOf(codePoint))]++;
+    }
+
+    uint32_t counts_[static_cast<size_t>(Script::Count)] = {};
+    uint8_t pending_[4] = {};
+    uint8_t pendingLength_ = 0;
+    uint8_t pendingNeed_ = 0;
+};
+
+/**
+ * @brief Encodes `count` UTF-16 code units as UTF-8 into `out`, which must hold
+ * 3 * count + 3 bytes.
+ *
+ * `pendingHigh` carries a high surrogate split across calls; unpaired surrogates become U+FFFD.
+ *
+ * @return Number of bytes written.
+ */
+size_t encodeUtf16AsUtf8(const uint16_t *in, size_t count, char *out, uint16_t &pendingHigh);
+
+} // namespace genesis::language
+
+#endif // UNICODE_SCRIPT_H
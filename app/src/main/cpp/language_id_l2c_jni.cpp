@@ -1,54 +1,145 @@
 
 #include <jni.h>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <android/log.h>
+#include "language_detector.h"
 
 #define LOG_TAG "LanguageIdJNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+namespace {
+
+using genesis::language::Detection;
+using genesis::language::LanguageModel;
+using genesis::language::StreamingDetector;
+using genesis::language::TextSpan;
+
+// UTF-16 code units copied out of the Java string per streaming step.
+constexpr jsize kStreamBlockChars = 256;
+// Window used by streaming detection when the caller passes no positive bound.
+constexpr jsize kDefaultStreamWindowChars = 4096;
+
+/**
+ * @brief Classifies at most `windowChars` UTF-16 units of `text` without heap allocation.
+ *
+ * The window is pulled through a fixed stack buffer kStreamBlockChars units at a time with
+ * GetStringRegion (rather than GetStringCritical, which would stall the GC for the whole
+ * scan), transcoded to UTF-8 and fed to the incremental scorer. After each block the scan
+ * stops once the leading language's confidence reaches `margin`; a margin outside (0, 1]
+ * disables early exit. Cost is bounded by the window, not the document size.
+ */
+Detection detectStreaming(JNIEnv *env, jstring text, const LanguageModel *model,
+                          jsize windowChars, float margin) {
+    const jsize length = std::min(env->GetStringLength(text), windowChars);
+    const bool earlyExit = margin > 0.0f && margin <= 1.0f;
+
+    jchar utf16[kStreamBlockChars];
+    char utf8[3 * kStreamBlockChars + 3];
+    uint16_t pendingHigh = 0;
+
+    StreamingDetector detector(model);
+    for (jsize offset = 0; offset < length; offset += kStreamBlockChars) {
+        const jsize count = std::min(kStreamBlockChars, length - offset);
+        env->GetStringRegion(text, offset, count, utf16);
+        const size_t bytes = genesis::language::encodeUtf16AsUtf8(utf16, count, utf8, pendingHigh);
+        detector.update(utf8, bytes);
+        if (earlyExit && detector.confident(margin)) {
+            return detector.finish();
+        }
+    }
+    if (pendingHigh != 0) {
+        // The window ended on a high surrogate with no partner; unpaired surrogates are U+FFFD.
+        detector.update("\xEF\xBF\xBD", 3);
+    }
+    return detector.finish();
+}
+
+/**
+ * @brief Runs detectBatch and copies the results into the caller's Java arrays.
+ *
+ * @return `count`, or -1 if either output array is missing or shorter than `count`.
+ */
+jint detectBatchInto(JNIEnv *env, const LanguageModel *model,
+                     const std::vector<TextSpan> &spans, jintArray languages,
+                     jfloatArray confidences) {
+    const auto count = static_cast<jsize>(spans.size());
+    if (languages == nullptr || confidences == nullptr ||
+        env->GetArrayLength(languages) < count || env->GetArrayLength(confidences) < count) {
+        LOGE("Batch output arrays must hold %d results", count);
+        return -1;
+    }
+
+    std::vector<jint> languageOut(spans.size());
+    std::vector<jfloat> confidenceOut(spans.size());
+    genesis::language::detectBatch(model, spans.data(), spans.size(), languageOut.data(),
+                                   confidenceOut.data());
+
+    env->SetIntArrayRegion(languages, 0, count, languageOut.data());
+    env->SetFloatArrayRegion(confidences, 0, count, confidenceOut.data());
+    return count;
+}
+
+} // namespace
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Initializes the native language identifier using the specified model path.
+ * @brief Loads the n-gram language model at `modelPath` and returns a handle to it.
  *
- * Converts the provided Java string model path to a UTF-8 C string, logs the initialization path, and returns the native library version as a string. If the model path is null, returns an empty string.
+ * The model file is memory-mapped and validated but not copied, so cold start costs one mmap.
+ * The returned handle owns the mapping and must be passed to nativeRelease. If the path is
+ * null or the model cannot be loaded, returns 0; detection with a 0 handle falls back to the
+ * built-in keyword heuristics.
  *
- * @return jstring Native library version string, or an empty string if the model path is null.
+ * @return jlong Native model handle, or 0 if no model was loaded.
  */
-JNIEXPORT jstring
+JNIEXPORT jlong
 
 JNICALL
 Java_com_example_app_language_LanguageIdentifier_nativeInitialize(
         JNIEnv *env,
         jobject /* this */,
         jstring modelPath) {
+    if (modelPath == nullptr) {
+        return 0;
+    }
+
     const char *path = env->GetStringUTFChars(modelPath, nullptr);
     if (path == nullptr) {
-        return env->NewStringUTF("");
+        return 0;
     }
 
     LOGI("Initializing with model path: %s", path);
 
-    // Initialize language identification with basic patterns
-    // This implementation uses character frequency analysis and common word patterns
-    // for basic language detection without external model dependencies.
-    // Currently, the rule-based nativeDetectLanguage does not require this model path,
-    // but it's logged for potential future use with a model-based approach.
+    std::string error;
+    std::unique_ptr<LanguageModel> model = LanguageModel::load(path, &error);
+    if (!model) {
+        LOGE("Failed to load language model %s: %s", path, error.c_str());
+        env->ReleaseStringUTFChars(modelPath, path);
+        return 0;
+    }
 
+    LOGI("Loaded language model with %u languages", model->languageCount());
     env->ReleaseStringUTFChars(modelPath, path);
-    return env->NewStringUTF("1.2.0"); // Updated version to reflect improvements
+    return reinterpret_cast<jlong>(model.release());
 }
 
 /**
  * @brief Identifies the language of the input text using heuristic pattern matching.
  *
- * Examines the input string for language-specific words and character patterns to determine if the text is in Spanish ("es"), French ("fr"), German ("de"), Italian ("it"), Portuguese ("pt"), or defaults to English ("en"). If the text contains a high proportion of non-ASCII (accented) characters without a clear language match, returns "mul" for multiple or unknown accented languages. Returns "und" if the input is null or cannot be processed.
+ * When `handle` refers to a loaded n-gram model, the text is classified by the model and the
+ * model's language code is returned. Otherwise, text whose letters are mostly in one non-Latin script (Cyrillic, Greek, Arabic, Hebrew, Devanagari, Hangul, Kana, Han, ...) is classified by script alone; remaining text is examined for language-specific words and character patterns to determine if the text is in Spanish ("es"), French ("fr"), German ("de"), Italian ("it"), Portuguese ("pt"), or defaults to English ("en"). If the text contains a high proportion of non-ASCII (accented) characters without a clear language match, returns "mul" for multiple or unknown accented languages. Returns "und" if the input is null or cannot be processed.
  *
+ * @param handle Model handle from nativeInitialize, or 0 to use the keyword heuristics.
  * @param text The input text to analyze.
- * @return jstring The detected language code: "en", "es", "fr", "de", "it", "pt", "mul", or "und".
+ * @return jstring The detected language code: a model language code, a script-derived code such as "ru", "ar" or "ja", or "en", "es", "fr", "de", "it", "pt", "mul", or "und".
  */
 JNIEXPORT jstring
 
@@ -56,7 +147,7 @@ JNICALL
 Java_com_example_app_language_LanguageIdentifier_nativeDetectLanguage(
         JNIEnv *env,
         jobject /* this */,
-        jlong /* handle */,
+        jlong handle,
         jstring text) {
     if (text == nullptr) {
         return env->NewStringUTF("und");
@@ -67,97 +158,187 @@ Java_com_example_app_language_LanguageIdentifier_nativeDetectLanguage(
         return env->NewStringUTF("und");
     }
 
-    LOGI("Detecting language for text: %s", nativeText);
-
-    // Enhanced language detection using multiple heuristics
-    std::string textStr(nativeText);
-    std::string result = "en"; // Default to English
-
-    // Convert to lowercase for case-insensitive matching
-    std::transform(textStr.begin(), textStr.end(), textStr.begin(), ::tolower);
-
-    // Language detection based on common words, articles, and patterns
-    // Keywords are checked with spaces around them to avoid matching substrings within words.
-    if (textStr.find(" el ") != std::string::npos ||
-        textStr.find(" la ") != std::string::npos ||
-        textStr.find(" de ") != std::string::npos ||
-        // Also in Portuguese, but more prominent in Spanish start
-        textStr.find(" que ") != std::string::npos || // Also in French/Portuguese
-        textStr.find(" es ") != std::string::npos ||
-        textStr.find(" con ") != std::string::npos || // Also in Italian
-        textStr.find(" y ") != std::string::npos ||
-        textStr.find(" en ") != std::string::npos ||
-        textStr.find(" un ") != std::string::npos || // Also in French/Italian
-        textStr.find(" una ") != std::string::npos) { // Also in Italian
-        result = "es"; // Spanish
-    } else if (textStr.find(" le ") != std::string::npos ||
-               textStr.find(" la ") != std::string::npos || // Also in Spanish/Italian
-               textStr.find(" et ") != std::string::npos ||
-               textStr.find(" ce ") != std::string::npos ||
-               textStr.find(" qui ") != std::string::npos ||
-               textStr.find(" avec ") != std::string::npos ||
-               textStr.find(" est ") != std::string::npos ||
-               textStr.find(" dans ") != std::string::npos ||
-               textStr.find(" pour ") != std::string::npos ||
-               textStr.find(" un ") != std::string::npos) { // Also in Spanish/Italian
-        result = "fr"; // French
-    } else if (textStr.find(" und ") != std::string::npos ||
-               textStr.find(" der ") != std::string::npos ||
-               textStr.find(" die ") != std::string::npos ||
-               textStr.find(" das ") != std::string::npos ||
-               textStr.find(" mit ") != std::string::npos ||
-               textStr.find(" ist ") != std::string::npos ||
-               textStr.find(" ein ") != std::string::npos ||
-               textStr.find(" eine ") != std::string::npos ||
-               textStr.find(" auf ") != std::string::npos ||
-               textStr.find(" von ") != std::string::npos) {
-        result = "de"; // German
-    } else if (textStr.find(" il ") != std::string::npos ||
-               textStr.find(" che ") != std::string::npos ||
-               textStr.find(" con ") != std::string::npos || // Also in Spanish
-               textStr.find(" per ") != std::string::npos ||
-               textStr.find(" sono ") != std::string::npos ||
-               textStr.find(" e ") != std::string::npos || // Also in Portuguese
-               textStr.find(" in ") != std::string::npos ||
-               textStr.find(" un ") != std::string::npos || // Also in Spanish/French
-               textStr.find(" una ") != std::string::npos || // Also in Spanish
-               textStr.find(" non ") != std::string::npos) {
-        result = "it"; // Italian
-    } else if (textStr.find(" o ") != std::string::npos || // Common words, 'o' and 'a' are articles
-               textStr.find(" a ") != std::string::npos ||
-               textStr.find(" que ") != std::string::npos || // Also in Spanish/French
-               textStr.find(" para ") != std::string::npos ||
-               textStr.find(" com ") != std::string::npos || // Also in Spanish
-               textStr.find(" e ") != std::string::npos || // Also in Italian
-               textStr.find(" em ") != std::string::npos ||
-               textStr.find(" um ") != std::string::npos ||
-               textStr.find(" uma ") != std::string::npos ||
-               textStr.find(" de ") != std::string::npos) { // Also in Spanish
-        result = "pt"; // Portuguese
-    }
-
-    // Additional character frequency analysis for better accuracy
-    int accentCount = 0;
-    for (char c: textStr) {
-        // Basic check for non-ASCII characters. A more sophisticated approach might
-        // involve checking specific Unicode ranges for common accented characters.
-        if (c < 0 || c > 127) accentCount++; // Non-ASCII characters
-    }
-
-    // If a significant portion of the text contains non-ASCII characters (potential accents)
-    // and no specific language was detected via keywords (still "en"), classify as "mul".
-    if (accentCount > textStr.length() * 0.1 && result == "en") {
-        result = "mul"; // Multiple/unknown with accents
-    }
+    const size_t length = strlen(nativeText);
+    LOGI("Detecting language for %zu bytes of text", length);
+
+    const auto *model = reinterpret_cast<const LanguageModel *>(handle);
+    const Detection detection = genesis::language::detect(model, nativeText, length);
 
     env->ReleaseStringUTFChars(text, nativeText);
-    return env->NewStringUTF(result.c_str());
+    return env->NewStringUTF(genesis::language::languageCode(model, detection.language));
 }
 
 /**
- * @brief Logs cleanup of language identifier resources for the given handle.
+ * @brief Identifies the language of a bounded prefix of `text` with early exit.
+ *
+ * Reads at most `maxChars` UTF-16 units through a fixed-size stack buffer, so neither the
+ * string nor a lowercased copy of it is ever materialized. Detection stops as soon as the
+ * leading language's confidence reaches `margin`. Latency and memory are bounded by the
+ * window rather than by the document size.
+ *
+ * @param handle Model handle from nativeInitialize, or 0 to use the keyword heuristics.
+ * @param text The input text to analyze.
+ * @param maxChars Window size in UTF-16 units; values <= 0 select a 4096-unit window.
+ * @param margin Confidence in (0, 1] at which to stop early; other values scan the whole window.
+ * @return jstring The detected language code, or "und" if `text` is null.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_example_app_language_LanguageIdentifier_nativeDetectLanguageStreaming(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jstring text,
+        jint maxChars,
+        jfloat margin) {
+    if (text == nullptr) {
+        return env->NewStringUTF("und");
+    }
+
+    const auto *model = reinterpret_cast<const LanguageModel *>(handle);
+    const jsize window = maxChars > 0 ? maxChars : kDefaultStreamWindowChars;
+    const Detection detection = detectStreaming(env, text, model, window, margin);
+    return env->NewStringUTF(genesis::language::languageCode(model, detection.language));
+}
+
+/**
+ * @brief Classifies every string in `texts` with a single JNI crossing.
+ *
+ * All strings are copied once into one contiguous buffer, then classified in place; batches of
+ * kParallelBatchThreshold strings or more are spread across one worker thread per core.
+ * Results are written as language indices (see nativeGetLanguageCodes, -1 for "und") and
+ * confidences in [0, 1]. Null elements yield -1.
+ *
+ * @param handle Model handle from nativeInitialize, or 0 to use the keyword heuristics.
+ * @param texts Strings to classify.
+ * @param languages Receives one language index per string.
+ * @param confidences Receives one confidence per string.
+ * @return jint Number of strings classified, or -1 if the arguments are invalid.
+ */
+JNIEXPORT jint JNICALL
+Java_com_example_app_language_LanguageIdentifier_nativeDetectLanguageBatch(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jobjectArray texts,
+        jintArray languages,
+        jfloatArray confidences) {
+    if (texts == nullptr) {
+        return -1;
+    }
+
+    const jsize count = env->GetArrayLength(texts);
+    std::vector<char> arena;
+    std::vector<size_t> offsets(count + 1, 0);
+    std::vector<bool> present(count, false);
+    for (jsize i = 0; i < count; ++i) {
+        auto text = static_cast<jstring>(env->GetObjectArrayElement(texts, i));
+        offsets[i + 1] = offsets[i];
+        if (text == nullptr) {
+            continue;
+        }
+        const jsize utfLength = env->GetStringUTFLength(text);
+        arena.resize(offsets[i] + utfLength + 1);
+        env->GetStringUTFRegion(text, 0, env->GetStringLength(text), arena.data() + offsets[i]);
+        offsets[i + 1] = offsets[i] + utfLength;
+        present[i] = true;
+        // Large batches would otherwise overflow the local reference table.
+        env->DeleteLocalRef(text);
+    }
+
+    // Spans are built after the arena stops growing so they never point at freed storage.
+    std::vector<TextSpan> spans(count);
+    for (jsize i = 0; i < count; ++i) {
+        spans[i] = present[i]
+                   ? TextSpan{arena.data() + offsets[i], offsets[i + 1] - offsets[i]}
+                   : TextSpan{nullptr, 0};
+    }
+
+    const auto *model = reinterpret_cast<const LanguageModel *>(handle);
+    return detectBatchInto(env, model, spans, languages, confidences);
+}
+
+/**
+ * @brief Classifies `count` length-prefixed UTF-8 strings read in place from a direct ByteBuffer.
+ *
+ * Each record is a little-endian uint32 byte length followed by that many bytes of UTF-8; no
+ * copy of the text is made. Results are written as for nativeDetectLanguageBatch.
+ *
+ * @param handle Model handle from nativeInitialize, or 0 to use the keyword heuristics.
+ * @param buffer Direct ByteBuffer holding the records from position 0.
+ * @param count Number of records in the buffer.
+ * @return jint Number of strings classified, or -1 if the buffer is not direct or is truncated.
+ */
+JNIEXPORT jint JNICALL
+Java_com_example_app_language_LanguageIdentifier_nativeDetectLanguageBuffer(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jobject buffer,
+        jint count,
+        jintArray languages,
+        jfloatArray confidences) {
+    const auto *base = static_cast<const char *>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (base == nullptr || capacity < 0 || count < 0) {
+        LOGE("nativeDetectLanguageBuffer requires a direct ByteBuffer");
+        return -1;
+    }
+
+    std::vector<TextSpan> spans(count);
+    size_t offset = 0;
+    const auto limit = static_cast<size_t>(capacity);
+    for (jint i = 0; i < count; ++i) {
+        uint32_t length = 0;
+        if (limit - offset < sizeof(length)) {
+            LOGE("Truncated length prefix for record %d", i);
+            return -1;
+        }
+        memcpy(&length, base + offset, sizeof(length));
+        offset += sizeof(length);
+        if (limit - offset < length) {
+            LOGE("Truncated text for record %d", i);
+            return -1;
+        }
+        spans[i] = TextSpan{base + offset, length};
+        offset += length;
+    }
+
+    const auto *model = reinterpret_cast<const LanguageModel *>(handle);
+    return detectBatchInto(env, model, spans, languages, confidences);
+}
+
+/**
+ * @brief Returns the language codes that batch result indices refer to.
+ *
+ * @param handle Model handle from nativeInitialize, or 0 for the keyword heuristics.
+ * @return jobjectArray String[] where element i is the code for language index i.
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_app_language_LanguageIdentifier_nativeGetLanguageCodes(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle) {
+    const auto *model = reinterpret_cast<const LanguageModel *>(handle);
+    const jsize count = model != nullptr ? static_cast<jsize>(model->languageCount())
+                                         : static_cast<jsize>(genesis::language::heuristicResultCount());
+
+    jobjectArray codes = env->NewObjectArray(count, env->FindClass("java/lang/String"), nullptr);
+    if (codes == nullptr) {
+        return nullptr;
+    }
+    for (jsize i = 0; i < count; ++i) {
+        jstring code = env->NewStringUTF(genesis::language::languageCode(model, i));
+        env->SetObjectArrayElement(codes, i, code);
+        env->DeleteLocalRef(code);
+    }
+    return codes;
+}
+
+
+/**
+ * @brief Releases the language model owned by `handle`.
  *
- * If the handle is non-zero, logs that resources have been cleaned up. No actual resource deallocation is performed.
+ * Unmaps the model file loaded by nativeInitialize. A 0 handle is ignored.
  *
  * @param handle Native handle for the language identifier instance.
  */
@@ -167,15 +348,9 @@ Java_com_example_app_language_LanguageIdentifier_nativeRelease(
         jobject /* this */,
         jlong handle
 ) {
-// Clean up resources if needed.
-// In the current implementation, nativeInitialize does not allocate any specific resources
-// tied to the handle, as detection is stateless and rule-based.
-// This function serves as a placeholder for potential future enhancements
-// where dynamic resources might be managed.
     if (handle != 0) {
-// Resource cleanup completed - handle closed
-        LOGI("Language identifier resources cleaned up for handle: %lld (Placeholder - no specific resources allocated)",
-             (long long) handle);
+        delete reinterpret_cast<LanguageModel *>(handle);
+        LOGI("Language identifier resources cleaned up for handle: %lld", (long long) handle);
     }
 }
 
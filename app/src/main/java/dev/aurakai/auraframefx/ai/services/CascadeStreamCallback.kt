@@ -0,0 +1,26 @@
+package dev.aurakai.auraframefx.ai.services
+
+/**
+ * Receives a streamed Cascade response from the native library.
+ *
+ * Both methods are called on a native worker thread. The method IDs are resolved once when the
+ * library loads, so the names and signatures must not change without updating the native side.
+ */
+interface CascadeStreamCallback {
+    /**
+     * Called with each batch of response text, in order. Batches always end on a token
+     * boundary; the first one is sent as soon as the first token is ready.
+     */
+    fun onChunk(text: String)
+
+    /**
+     * Called once when the request finishes.
+     *
+     * @param requestId Id returned when the request was started
+     * @param status 0 if completed, 1 if cancelled (no further chunks are sent after
+     * cancellation)
+     * @param response Full JSON reply, the same as a non-streamed request returns, or empty
+     * if cancelled
+     */
+    fun onComplete(requestId: Long, status: Int, response: String)
+}
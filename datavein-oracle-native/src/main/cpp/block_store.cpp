@@ -0,0 +1,291 @@
+#include "block_store.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "file_io.h"
+
+namespace genesis::oracle {
+
+struct BlockStore::Slot {
+    uint64_t low;
+    uint64_t high;
+    uint64_t offset;
+    // 0 marks an empty slot.
+    uint64_t length;
+};
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'D', 'V', 'C', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kInitialCapacity = 4096;
+constexpr uint64_t kBlobAlignment = 4096;
+
+struct IndexHeader {
+    uint8_t magic[4];
+    uint32_t version;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t blobsEnd;
+    // Bumped whenever the store is emptied, so in-flight puts into the old blobs are dropped.
+    uint64_t generation;
+    uint64_t reserved[3];
+};
+
+static_assert(sizeof(IndexHeader) == 64);
+
+std::mutex sharedMutex;
+std::shared_ptr<BlockStore> sharedStore;
+
+inline size_t indexSize(uint64_t capacity) {
+    return sizeof(IndexHeader) + capacity * 32;
+}
+
+} // namespace
+
+std::unique_ptr<BlockStore> BlockStore::open(const char *directory, uint64_t maxBytes) {
+    if (mkdir(directory, 0700) != 0 && errno != EEXIST) {
+        return nullptr;
+    }
+    const std::string base(directory);
+    std::unique_ptr<BlockStore> store(new BlockStore());
+    store->maxBytes_ = maxBytes;
+    store->indexFd_ = ::open((base + "/index").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    store->blobsFd_ = ::open((base + "/blobs").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (store->indexFd_ < 0 || store->blobsFd_ < 0) {
+        return nullptr;
+    }
+
+    IndexHeader header{};
+    struct stat indexStat{}, blobsStat{};
+    const bool valid =
+            fstat(store->indexFd_, &indexStat) == 0 && fstat(store->blobsFd_, &blobsStat) == 0 &&
+            preadAll(store->indexFd_, reinterpret_cast<uint8_t *>(&header), sizeof(header), 0) &&
+            memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+            header.capacity >= kInitialCapacity && (header.capacity & (header.capacity - 1)) == 0 &&
+            header.capacity <= (SIZE_MAX - sizeof(IndexHeader)) / 32 &&
+            static_cast<uint64_t>(indexStat.st_size) == indexSize(header.capacity) &&
+            header.count < header.capacity &&
+            header.blobsEnd <= static_cast<uint64_t>(blobsStat.st_size);
+    if (valid ? !store->mapIndex(header.capacity) : !store->reset(kInitialCapacity)) {
+        return nullptr;
+    }
+    return store;
+}
+
+std::shared_ptr<BlockStore> BlockStore::shared() {
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    return sharedStore;
+}
+
+bool BlockStore::configureShared(const char *directory, uint64_t maxBytes) {
+    std::shared_ptr<BlockStore> store = open(directory, maxBytes);
+    if (store == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    sharedStore = std::move(store);
+    return true;
+}
+
+BlockStore::~BlockStore() {
+    if (map_ != nullptr) {
+        munmap(map_, mapSize_);
+    }
+    if (indexFd_ >= 0) {
+        close(indexFd_);
+    }
+    if (blobsFd_ >= 0) {
+        close(blobsFd_);
+    }
+}
+
+bool BlockStore::mapIndex(uint64_t capacity) {
+    if (map_ != nullptr) {
+        munmap(map_, mapSize_);
+        map_ = nullptr;
+    }
+    const size_t size = indexSize(capacity);
+    if (ftruncate(indexFd_, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, indexFd_, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    map_ = static_cast<uint8_t *>(address);
+    mapSize_ = size;
+    return true;
+}
+
+bool BlockStore::reset(uint64_t capacity) {
+    const uint64_t generation =
+            map_ != nullptr ? reinterpret_cast<IndexHeader *>(map_)->generation + 1 : 0;
+    // Truncating to zero first drops every old slot without touching its pages.
+    if (ftruncate(indexFd_, 0) != 0 || ftruncate(blobsFd_, 0) != 0 || !mapIndex(capacity)) {
+        return false;
+    }
+    auto *header = reinterpret_cast<IndexHeader *>(map_);
+    memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->version = kVersion;
+    header->capacity = capacity;
+    header->generation = generation;
+    return true;
+}
+
+bool BlockStore::grow() {
+    const IndexHeader old = *reinterpret_cast<IndexHeader *>(map_);
+    std::vector<Slot> live;
+    live.reserve(old.count);
+    const auto *slots = reinterpret_cast<const Slot *>(map_ + sizeof(IndexHeader));
+    for (uint64_t i = 0; i < old.capacity; ++i) {
+        if (slots[i].length != 0) {
+            live.push_back(slots[i]);
+        }
+    }
+    if (ftruncate(indexFd_, 0) != 0 || !mapIndex(old.capacity * 2)) {
+        return false;
+    }
+    auto *header = reinterpret_cast<IndexHeader *>(map_);
+    *header = old;
+    header->capacity = old.capacity * 2;
+    auto *grown = reinterpret_cast<Slot *>(map_ + sizeof(IndexHeader));
+    for (const Slot &slot: live) {
+        uint64_t i = slot.low & (header->capacity - 1);
+        while (grown[i].length != 0) {
+            i = (i + 1) & (header->capacity - 1);
+        }
+        grown[i] = slot;
+    }
+    return true;
+}
+
+const BlockStore::Slot *BlockStore::lookup(const ContentKey &key) const {
+    if (map_ == nullptr) {
+        // A failed remap left the store unusable.
+        return nullptr;
+    }
+    const auto *header = reinterpret_cast<const IndexHeader *>(map_);
+    const auto *slots = reinterpret_cast<const Slot *>(map_ + sizeof(IndexHeader));
+    for (uint64_t i = key.low & (header->capacity - 1);; i = (i + 1) & (header->capacity - 1)) {
+        if (slots[i].length == 0) {
+            return nullptr;
+        }
+        if (slots[i].low == key.low && slots[i].high == key.high) {
+            return &slots[i];
+        }
+    }
+}
+
+uint64_t BlockStore::find(const ContentKey &key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Slot *slot = lookup(key);
+    (slot != nullptr ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return slot != nullptr ? slot->length : 0;
+}
+
+bool BlockStore::read(const ContentKey &key, uint8_t *out, size_t capacity,
+                      size_t *length) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Slot *slot = lookup(key);
+    (slot != nullptr ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    if (slot == nullptr || slot->length > capacity ||
+        !preadAll(blobsFd_, out, static_cast<size_t>(slot->length), slot->offset)) {
+        return false;
+    }
+    if (length != nullptr) {
+        *length = static_cast<size_t>(slot->length);
+    }
+    return true;
+}
+
+bool BlockStore::copyTo(const ContentKey &key, uint64_t from, uint64_t length, int fd,
+                        uint64_t offset) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Slot *slot = lookup(key);
+    if (slot == nullptr || from > slot->length || length > slot->length - from) {
+        return false;
+    }
+    return copyRange(blobsFd_, slot->offset + from, fd, offset, length);
+}
+
+bool BlockStore::put(const ContentKey &key, const uint8_t *data, size_t length) {
+    if (length == 0 || length > maxBytes_) {
+        return false;
+    }
+
+    // Reserve a range of the blob file, fill it while other threads carry on, then publish.
+    uint64_t offset, generation;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (map_ == nullptr || lookup(key) != nullptr) {
+            return map_ != nullptr;
+        }
+        auto *header = reinterpret_cast<IndexHeader *>(map_);
+        offset = (header->blobsEnd + kBlobAlignment - 1) & ~(kBlobAlignment - 1);
+        if (offset > maxBytes_ || length > maxBytes_ - offset) {
+            if (!reset(header->capacity)) {
+                return false;
+            }
+            header = reinterpret_cast<IndexHeader *>(map_);
+            offset = 0;
+        }
+        header->blobsEnd = offset + length;
+        generation = header->generation;
+    }
+    {
+        // Emptying the store needs the exclusive lock, so the range stays ours while we write.
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto *header = reinterpret_cast<const IndexHeader *>(map_);
+        if (header == nullptr || header->generation != generation ||
+            !pwriteAll(blobsFd_, data, length, offset)) {
+            return false;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto *header = reinterpret_cast<IndexHeader *>(map_);
+    if (header == nullptr) {
+        return false;
+    }
+    if (header->generation != generation || lookup(key) != nullptr) {
+        return header->generation == generation;
+    }
+    if ((header->count + 1) * 10 > header->capacity * 7) {
+        if (!grow()) {
+            // The old mapping is gone; start over rather than leave the store unusable.
+            reset(kInitialCapacity);
+            return false;
+        }
+        header = reinterpret_cast<IndexHeader *>(map_);
+    }
+    auto *slots = reinterpret_cast<Slot *>(map_ + sizeof(IndexHeader));
+    uint64_t i = key.low & (header->capacity - 1);
+    while (slots[i].length != 0) {
+        i = (i + 1) & (header->capacity - 1);
+    }
+    slots[i].low = key.low;
+    slots[i].high = key.high;
+    slots[i].offset = offset;
+    slots[i].length = length;
+    ++header->count;
+    return true;
+}
+
+BlockStore::Stats BlockStore::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto *header = reinterpret_cast<const IndexHeader *>(map_);
+    if (header == nullptr) {
+        return {0, 0, hits_.load(), misses_.load()};
+    }
+    return {header->count, header->blobsEnd, hits_.load(), misses_.load()};
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,110 @@
+#ifndef BLOCK_STORE_H
+#define BLOCK_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+
+#include "content_hash.h"
+
+namespace genesis::oracle {
+
+/**
+ * @brief On-disk content-addressed cache of values derived from ROM data, such as
+ * decompressed payload operations and block digests, so repeated runs over the same or
+ * similar images skip that work.
+ *
+ * A store is a directory with two files: `blobs`, an append-only file of values aligned to
+ * 4 KiB (so copies out of it can share extents on filesystems that support it), and
+ * `index`, an open-addressing hash table from ContentKey to blob range that is mapped
+ * shared and updated in place. When an insert would grow `blobs` beyond the size limit the
+ * store is emptied and starts over, which keeps it simple and bounded; the working set of a
+ * pipeline that reprocesses the same base ROM is far smaller than a sensible limit.
+ *
+ * Thread-safe. A directory must be used by one process at a time.
+ */
+class BlockStore {
+public:
+    struct Stats {
+        uint64_t entries;
+        uint64_t bytes;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    /**
+     * @brief Opens or creates a store in `directory`, or returns nullptr on I/O failure. An
+     * index that fails validation is discarded along with the blobs.
+     */
+    static std::unique_ptr<BlockStore> open(const char *directory, uint64_t maxBytes);
+
+    /**
+     * @brief The process-wide store used by the JNI entry points, or nullptr if none has been
+     * configured. Holding the result keeps the store alive across reconfiguration.
+     */
+    static std::shared_ptr<BlockStore> shared();
+
+    /**
+     * @brief Opens `directory` as the process-wide store, replacing any previous one.
+     */
+    static bool configureShared(const char *directory, uint64_t maxBytes);
+
+    ~BlockStore();
+
+    BlockStore(const BlockStore &) = delete;
+
+    BlockStore &operator=(const BlockStore &) = delete;
+
+    /**
+     * @brief Looks up `key` and returns the stored length, or 0 if it is absent.
+     */
+    uint64_t find(const ContentKey &key) const;
+
+    /**
+     * @brief Reads the value of `key` into `out` if present and no larger than `capacity`.
+     */
+    bool read(const ContentKey &key, uint8_t *out, size_t capacity, size_t *length) const;
+
+    /**
+     * @brief Copies `length` bytes starting at `from` within the value of `key` to `fd` at
+     * `offset`, in the kernel (copy_file_range) where possible.
+     */
+    bool copyTo(const ContentKey &key, uint64_t from, uint64_t length, int fd,
+                uint64_t offset) const;
+
+    /**
+     * @brief Stores a value under `key`. Empty values and keys already present are ignored.
+     */
+    bool put(const ContentKey &key, const uint8_t *data, size_t length);
+
+    Stats stats() const;
+
+private:
+    struct Slot;
+
+    BlockStore() = default;
+
+    bool mapIndex(uint64_t capacity);
+
+    bool reset(uint64_t capacity);
+
+    bool grow();
+
+    const Slot *lookup(const ContentKey &key) const;
+
+    int indexFd_ = -1;
+    int blobsFd_ = -1;
+    uint64_t maxBytes_ = 0;
+    uint8_t *map_ = nullptr;
+    size_t mapSize_ = 0;
+    mutable std::shared_mutex mutex_;
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace genesis::oracle
+
+#endif // BLOCK_STORE_H
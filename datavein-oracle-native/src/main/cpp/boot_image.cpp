@@ -0,0 +1,393 @@
+#include "boot_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+#include "decompressor.h"
+#include "file_io.h"
+#include "json_writer.h"
+
+namespace genesis::oracle {
+namespace {
+
+constexpr char kBootMagic[8] = {'A', 'N', 'D', 'R', 'O', 'I', 'D', '!'};
+constexpr char kVendorBootMagic[8] = {'V', 'N', 'D', 'R', 'B', 'O', 'O', 'T'};
+
+// Header struct sizes by version (boot_img_hdr_v0..v4, vendor_boot_img_hdr_v3..v4).
+constexpr size_t kBootHeaderSize[5] = {1632, 1648, 1660, 1580, 1584};
+constexpr size_t kVendorBootHeaderSize[5] = {0, 0, 0, 2112, 2128};
+constexpr uint32_t kV3PageSize = 4096;
+constexpr size_t kVendorRamdiskEntrySize = 108;
+constexpr size_t kVendorRamdiskNameSize = 32;
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+// NUL-terminated string field of at most `maxLength` bytes, with anything that is not
+// printable ASCII replaced so the report stays valid UTF-8.
+std::string fixedString(const uint8_t *p, size_t maxLength) {
+    std::string s;
+    for (size_t i = 0; i < maxLength && p[i] != 0; ++i) {
+        s += p[i] >= 0x20 && p[i] < 0x7f ? static_cast<char>(p[i]) : '?';
+    }
+    return s;
+}
+
+void decodeOsVersion(uint32_t osVersion, BootImageInfo &info) {
+    if (osVersion == 0) {
+        return;
+    }
+    const uint32_t version = osVersion >> 11;
+    const uint32_t patch = osVersion & 0x7ff;
+    info.osVersion = std::to_string((version >> 14) & 0x7f) + "." +
+                     std::to_string((version >> 7) & 0x7f) + "." + std::to_string(version & 0x7f);
+    if (patch != 0) {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%04u-%02u", 2000 + (patch >> 4), patch & 0xf);
+        info.patchLevel = buffer;
+    }
+}
+
+bool validPageSize(uint32_t pageSize) {
+    return pageSize >= 2048 && pageSize <= 65536 && (pageSize & (pageSize - 1)) == 0;
+}
+
+/**
+ * Lays out page-aligned sections one after another, checking each against the file size.
+ */
+class SectionLayout {
+public:
+    SectionLayout(const uint8_t *data, size_t length, uint32_t pageSize, size_t headerSize,
+                  std::vector<BootSection> &sections)
+            : data_(data), length_(length), pageSize_(pageSize), sections_(sections),
+              offset_(align(headerSize)) {}
+
+    bool add(const char *name, uint32_t size) {
+        if (offset_ + size > length_) {
+            return false;
+        }
+        if (size > 0) {
+            sections_.push_back({name, offset_, size,
+                                 detectCompression(data_ + offset_, size)});
+        }
+        offset_ += align(size);
+        return true;
+    }
+
+private:
+    uint64_t align(uint64_t size) const { return (size + pageSize_ - 1) / pageSize_ * pageSize_; }
+
+    const uint8_t *data_;
+    uint64_t length_;
+    uint64_t pageSize_;
+    std::vector<BootSection> &sections_;
+    uint64_t offset_;
+};
+
+bool parseBoot(const uint8_t *data, size_t length, BootImageInfo &info) {
+    if (length < 44) {
+        return false;
+    }
+    info.headerVersion = le32(data + 40);
+    if (info.headerVersion > 4 || length < kBootHeaderSize[info.headerVersion]) {
+        return false;
+    }
+
+    if (info.headerVersion >= 3) {
+        info.pageSize = kV3PageSize;
+        decodeOsVersion(le32(data + 16), info);
+        info.cmdline = fixedString(data + 44, 1536);
+        SectionLayout layout(data, length, info.pageSize, kBootHeaderSize[info.headerVersion],
+                             info.sections);
+        return layout.add("kernel", le32(data + 8)) && layout.add("ramdisk", le32(data + 12)) &&
+               (info.headerVersion < 4 || layout.add("signature", le32(data + 1580)));
+    }
+
+    info.pageSize = le32(data + 36);
+    if (!validPageSize(info.pageSize)) {
+        return false;
+    }
+    decodeOsVersion(le32(data + 44), info);
+    info.name = fixedString(data + 48, 16);
+    info.cmdline = fixedString(data + 64, 512) + fixedString(data + 608, 1024);
+    SectionLayout layout(data, length, info.pageSize, kBootHeaderSize[info.headerVersion],
+                         info.sections);
+    return layout.add("kernel", le32(data + 8)) && layout.add("ramdisk", le32(data + 16)) &&
+           layout.add("second", le32(data + 24)) &&
+           (info.headerVersion < 1 || layout.add("recovery_dtbo", le32(data + 1632))) &&
+           (info.headerVersion < 2 || layout.add("dtb", le32(data + 1648)));
+}
+
+bool parseVendorRamdiskTable(const uint8_t *data, const BootSection &ramdisk,
+                             const BootSection &table, uint32_t entryCount, uint32_t entrySize,
+                             std::vector<BootSection> &fragments) {
+    if (entrySize < kVendorRamdiskEntrySize ||
+        uint64_t{entryCount} * entrySize > table.size) {
+        return false;
+    }
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const uint8_t *entry = data + table.offset + uint64_t{i} * entrySize;
+        const uint32_t size = le32(entry);
+        const uint32_t offset = le32(entry + 4);
+        if (uint64_t{offset} + size > ramdisk.size) {
+            return false;
+        }
+        const uint64_t absolute = ramdisk.offset + offset;
+        fragments.push_back({"vendor_ramdisk:" + fixedString(entry + 12, kVendorRamdiskNameSize),
+                             absolute, size, detectCompression(data + absolute, size)});
+    }
+    return true;
+}
+
+bool parseVendorBoot(const uint8_t *data, size_t length, BootImageInfo &info) {
+    info.vendorBoot = true;
+    if (length < 16) {
+        return false;
+    }
+    info.headerVersion = le32(data + 8);
+    if (info.headerVersion < 3 || info.headerVersion > 4 ||
+        length < kVendorBootHeaderSize[info.headerVersion]) {
+        return false;
+    }
+    info.pageSize = le32(data + 12);
+    if (!validPageSize(info.pageSize)) {
+        return false;
+    }
+    info.cmdline = fixedString(data + 28, 2048);
+    info.name = fixedString(data + 2080, 16);
+
+    const uint32_t headerSize = le32(data + 2096);
+    SectionLayout layout(data, length, info.pageSize,
+                         headerSize > kVendorBootHeaderSize[info.headerVersion]
+                         ? headerSize : kVendorBootHeaderSize[info.headerVersion],
+                         info.sections);
+    if (!layout.add("vendor_ramdisk", le32(data + 24)) || !layout.add("dtb", le32(data + 2100))) {
+        return false;
+    }
+    if (info.headerVersion < 4) {
+        return true;
+    }
+
+    const uint32_t tableSize = le32(data + 2112);
+    if (!layout.add("vendor_ramdisk_table", tableSize) ||
+        !layout.add("bootconfig", le32(data + 2124))) {
+        return false;
+    }
+    const BootSection *ramdisk = nullptr;
+    const BootSection *table = nullptr;
+    for (const BootSection &section : info.sections) {
+        if (section.name == "vendor_ramdisk") {
+            ramdisk = &section;
+        } else if (section.name == "vendor_ramdisk_table") {
+            table = &section;
+        }
+    }
+    const uint32_t entryCount = le32(data + 2116);
+    if (entryCount == 0 || ramdisk == nullptr || table == nullptr) {
+        return entryCount == 0;
+    }
+    std::vector<BootSection> fragments;
+    if (!parseVendorRamdiskTable(data, *ramdisk, *table, entryCount, le32(data + 2120),
+                                 fragments)) {
+        return false;
+    }
+    info.sections.insert(info.sections.end(), fragments.begin(), fragments.end());
+    return true;
+}
+
+constexpr char kBanner[] = "Linux version ";
+constexpr size_t kBannerLength = sizeof(kBanner) - 1;
+constexpr size_t kMaxVersionLength = 256;
+// Enough of a kernel to cover the arm64, arm and x86 image headers.
+constexpr size_t kKernelHeaderBytes = 0x210;
+constexpr size_t kScanChunk = 1024 * 1024;
+
+// arm64 Image header magic "ARM\x64", arm zImage magic, x86 bzImage setup header "HdrS".
+const char *architectureOf(const uint8_t *kernel, size_t size) {
+    if (size >= 64 && le32(kernel + 56) == 0x644d5241) {
+        return "arm64";
+    }
+    if (size >= 0x28 && le32(kernel + 0x24) == 0x016f2818) {
+        return "arm";
+    }
+    if (size >= 0x206 && memcmp(kernel + 0x202, "HdrS", 4) == 0) {
+        return "x86";
+    }
+    return "unknown";
+}
+
+// Version string following a "Linux version " banner.
+std::string bannerVersion(const uint8_t *start, size_t available) {
+    std::string version = fixedString(start, std::min(available, kMaxVersionLength));
+    const size_t end = version.find_first_of(" ?");
+    return end == std::string::npos ? version : version.substr(0, end);
+}
+
+std::unique_ptr<DecompressStream> openSectionStream(CompressionFormat format,
+                                                    std::span<const uint8_t> data) {
+    return DecompressStream::open(
+            format, [data, offset = size_t{0}](uint8_t *buffer, size_t capacity) mutable {
+                const size_t now = std::min(capacity, data.size() - offset);
+                memcpy(buffer, data.data() + offset, now);
+                offset += now;
+                return static_cast<int64_t>(now);
+            });
+}
+
+} // namespace
+
+bool BootImage::parse(const uint8_t *data, size_t length, BootImageInfo &info) {
+    info = BootImageInfo{};
+    if (length >= sizeof(kBootMagic) && memcmp(data, kBootMagic, sizeof(kBootMagic)) == 0) {
+        return parseBoot(data, length, info);
+    }
+    if (length >= sizeof(kVendorBootMagic) &&
+        memcmp(data, kVendorBootMagic, sizeof(kVendorBootMagic)) == 0) {
+        return parseVendorBoot(data, length, info);
+    }
+    return false;
+}
+
+std::unique_ptr<BootImage> BootImage::open(const char *path) {
+    std::unique_ptr<MappedFile> file = MappedFile::open(path);
+    if (file == nullptr) {
+        return nullptr;
+    }
+    std::unique_ptr<BootImage> image(new BootImage(std::move(file)));
+    if (!parse(image->file_->data(), image->file_->size(), image->info_)) {
+        return nullptr;
+    }
+    return image;
+}
+
+std::span<const uint8_t> BootImage::section(std::string_view name) const {
+    for (const BootSection &section : info_.sections) {
+        if (section.name == name) {
+            return file_->bytes().subspan(section.offset, section.size);
+        }
+    }
+    return {};
+}
+
+const char *BootImage::kernelArchitecture() const {
+    std::span<const uint8_t> kernel = section("kernel");
+    const CompressionFormat format = detectCompression(kernel.data(), kernel.size());
+    if (format == CompressionFormat::None) {
+        return architectureOf(kernel.data(), kernel.size());
+    }
+    // Only the image header is needed, so decoding stops after it.
+    std::unique_ptr<DecompressStream> stream = openSectionStream(format, kernel);
+    uint8_t header[kKernelHeaderBytes];
+    const int64_t n = stream != nullptr ? stream->read(header, sizeof(header)) : -1;
+    return n > 0 ? architectureOf(header, static_cast<size_t>(n)) : "unknown";
+}
+
+std::string BootImage::kernelVersion() const {
+    std::span<const uint8_t> kernel = section("kernel");
+    const CompressionFormat format = detectCompression(kernel.data(), kernel.size());
+    if (format == CompressionFormat::None) {
+        const void *found = memmem(kernel.data(), kernel.size(), kBanner, kBannerLength);
+        if (found == nullptr) {
+            return {};
+        }
+        const auto *start = static_cast<const uint8_t *>(found) + kBannerLength;
+        return bannerVersion(start, kernel.data() + kernel.size() - start);
+    }
+
+    std::unique_ptr<DecompressStream> stream = openSectionStream(format, kernel);
+    if (stream == nullptr) {
+        return {};
+    }
+    // Searched chunk by chunk; the tail of each chunk is carried over so a banner split
+    // across chunks, or too close to the end to read the version, is found again whole.
+    constexpr size_t kCarry = kBannerLength + kMaxVersionLength;
+    std::vector<uint8_t> buffer(kScanChunk + kCarry);
+    size_t kept = 0;
+    for (;;) {
+        const int64_t n = stream->read(buffer.data() + kept, kScanChunk);
+        if (n < 0) {
+            return {};
+        }
+        const size_t total = kept + static_cast<size_t>(n);
+        const bool last = static_cast<size_t>(n) < kScanChunk;
+        const void *found = memmem(buffer.data(), total, kBanner, kBannerLength);
+        if (found != nullptr) {
+            const auto *start = static_cast<const uint8_t *>(found) + kBannerLength;
+            const size_t available = buffer.data() + total - start;
+            if (available >= kMaxVersionLength || last) {
+                return bannerVersion(start, available);
+            }
+        }
+        if (last) {
+            return {};
+        }
+        kept = std::min(total, kCarry);
+        memmove(buffer.data(), buffer.data() + total - kept, kept);
+    }
+}
+
+bool BootImage::extractSection(std::string_view name, const char *outputPath,
+                               WorkStealingPool *pool) const {
+    const BootSection *found = nullptr;
+    for (const BootSection &section : info_.sections) {
+        if (section.name == name) {
+            found = &section;
+            break;
+        }
+    }
+    if (found == nullptr) {
+        return false;
+    }
+    std::span<const uint8_t> data = file_->bytes().subspan(found->offset, found->size);
+    if (found->compression != CompressionFormat::None) {
+        return decompressToFile(data.data(), data.size(), outputPath, pool);
+    }
+    const int fd = ::open(outputPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = pwriteAll(fd, data.data(), data.size(), 0);
+    close(fd);
+    if (!ok) {
+        unlink(outputPath);
+    }
+    return ok;
+}
+
+std::string BootImage::toJson() const {
+    const char *ramdiskName = info_.vendorBoot ? "vendor_ramdisk" : "ramdisk";
+    std::span<const uint8_t> ramdisk = section(ramdiskName);
+
+    JsonWriter json;
+    json.beginObject()
+            .field("status", "success")
+            .field("imageType", info_.vendorBoot ? "vendor_boot" : "boot")
+            .field("headerVersion", info_.headerVersion)
+            .field("pageSize", info_.pageSize)
+            .field("fileSize", static_cast<uint64_t>(file_->size()))
+            .field("osVersion", info_.osVersion)
+            .field("securityPatchLevel", info_.patchLevel)
+            .field("name", info_.name)
+            .field("cmdline", info_.cmdline)
+            .field("kernelVersion", kernelVersion())
+            .field("architecture", kernelArchitecture())
+            .field("compressionType",
+                   compressionName(detectCompression(ramdisk.data(), ramdisk.size())));
+    json.key("sections").beginArray();
+    for (const BootSection &section : info_.sections) {
+        json.beginObject()
+                .field("name", section.name)
+                .field("offset", section.offset)
+                .field("size", section.size)
+                .field("compression", compressionName(section.compression))
+                .endObject();
+    }
+    json.endArray().endObject();
+    return json.str();
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,111 @@
+#ifndef BOOT_IMAGE_H
+#define BOOT_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "compression_format.h"
+#include "mapped_file.h"
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief One payload region of a boot image, as a byte range of the image file.
+ */
+struct BootSection {
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+    CompressionFormat compression;
+};
+
+/**
+ * @brief Parsed header fields of a boot or vendor_boot image.
+ */
+struct BootImageInfo {
+    bool vendorBoot = false;
+    uint32_t headerVersion = 0;
+    uint32_t pageSize = 0;
+    // Android release ("14.0.0") and security patch level ("2024-08"); empty when the
+    // header leaves them unset.
+    std::string osVersion;
+    std::string patchLevel;
+    std::string name;
+    std::string cmdline;
+    // "kernel", "ramdisk", "second", "recovery_dtbo", "dtb", "signature", and for
+    // vendor_boot "vendor_ramdisk", "dtb", "vendor_ramdisk_table", "bootconfig". Vendor
+    // ramdisk fragments (v4) follow as "vendor_ramdisk:<name>". Empty sections are omitted.
+    std::vector<BootSection> sections;
+};
+
+/**
+ * @brief Android boot image (header v0-v4) or vendor_boot image (v3-v4) over a read-only
+ * mapping of the file.
+ *
+ * Only the header is read on open; sections are handed out as views into the mapping, so
+ * analysing an image costs a few page faults regardless of its size.
+ */
+class BootImage {
+public:
+    /**
+     * @brief Maps and parses `path`, or returns nullptr if it is not a valid boot image
+     * whose sections all lie inside the file.
+     */
+    static std::unique_ptr<BootImage> open(const char *path);
+
+    /**
+     * @brief Parses a boot image held in memory. Returns false if the magic, header
+     * version or section layout is invalid.
+     */
+    static bool parse(const uint8_t *data, size_t length, BootImageInfo &info);
+
+    const BootImageInfo &info() const { return info_; }
+
+    /**
+     * @brief Bytes of section `name`, or an empty span if the image has no such section.
+     * Valid while this object lives.
+     */
+    std::span<const uint8_t> section(std::string_view name) const;
+
+    /**
+     * @brief Kernel architecture from the image header inside the kernel ("arm64", "arm",
+     * "x86"), or "unknown" if unrecognised. A compressed kernel is decoded only as far as
+     * its header.
+     */
+    const char *kernelArchitecture() const;
+
+    /**
+     * @brief The version from the kernel's "Linux version ..." banner, or empty. A
+     * compressed kernel is stream-decoded up to the banner, never held whole in memory.
+     */
+    std::string kernelVersion() const;
+
+    /**
+     * @brief Writes section `name` to `outputPath`, decompressed if it is compressed. Returns
+     * false if there is no such section or it cannot be decoded or written.
+     */
+    bool extractSection(std::string_view name, const char *outputPath,
+                        WorkStealingPool *pool) const;
+
+    /**
+     * @brief Analysis report as a JSON object.
+     */
+    std::string toJson() const;
+
+private:
+    explicit BootImage(std::unique_ptr<MappedFile> file) : file_(std::move(file)) {}
+
+    std::unique_ptr<MappedFile> file_;
+    BootImageInfo info_;
+};
+
+} // namespace genesis::oracle
+
+#endif // BOOT_IMAGE_H
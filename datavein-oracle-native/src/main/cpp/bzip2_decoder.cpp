@@ -0,0 +1,530 @@
+#include "bzip2_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint64_t kBlockMagic = 0x314159265359;
+constexpr uint64_t kEndMagic = 0x177245385090;
+constexpr int kMaxGroups = 6;
+constexpr int kGroupSize = 50;
+constexpr int kMaxAlphaSize = 258;
+constexpr int kMaxCodeLength = 20;
+constexpr int kMaxSelectors = 18002;
+constexpr int kRunA = 0;
+constexpr int kRunB = 1;
+constexpr size_t kStreamChunk = 256 * 1024;
+
+// bzip2 uses the MSB-first CRC-32 (polynomial 0x04c11db7).
+struct Crc32Msb {
+    uint32_t table[256];
+
+    constexpr Crc32Msb() : table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i << 24;
+            for (int k = 0; k < 8; ++k) {
+                crc = (crc << 1) ^ ((crc & 0x80000000u) ? 0x04c11db7u : 0);
+            }
+            table[i] = crc;
+        }
+    }
+};
+
+constexpr Crc32Msb kCrc;
+
+class BitReader {
+public:
+    BitReader(const uint8_t *data, size_t length) : start_(data), p_(data), end_(data + length) {}
+
+    uint32_t bits(int count) {
+        while (available_ < count) {
+            buffer_ = (buffer_ << 8) | (p_ < end_ ? *p_ : 0);
+            ++p_;
+            available_ += 8;
+        }
+        available_ -= count;
+        return static_cast<uint32_t>((buffer_ >> available_) & ((uint64_t{1} << count) - 1));
+    }
+
+    uint32_t bit() { return bits(1); }
+
+    // Reads past the end yield zeros; callers check overrun() at block boundaries.
+    bool overrun() const { return p_ > end_; }
+
+    void alignToByte() { available_ -= available_ % 8; }
+
+    // Input bytes left once the buffered whole bytes are given back.
+    size_t remaining() const {
+        const uint8_t *position = p_ - available_ / 8;
+        return position < end_ ? static_cast<size_t>(end_ - position) : 0;
+    }
+
+    const uint8_t *position() const { return p_ - available_ / 8; }
+
+    size_t bitsConsumed() const { return static_cast<size_t>(p_ - start_) * 8 - available_; }
+
+private:
+    const uint8_t *start_;
+    const uint8_t *p_;
+    const uint8_t *end_;
+    uint64_t buffer_ = 0;
+    int available_ = 0;
+};
+
+struct HuffmanGroup {
+    int32_t limit[kMaxCodeLength + 2];
+    int32_t base[kMaxCodeLength + 2];
+    uint16_t perm[kMaxAlphaSize];
+    int minLength;
+    int maxLength;
+
+    void build(const uint8_t *lengths, int alphaSize) {
+        minLength = kMaxCodeLength;
+        maxLength = 0;
+        for (int i = 0; i < alphaSize; ++i) {
+            minLength = lengths[i] < minLength ? lengths[i] : minLength;
+            maxLength = lengths[i] > maxLength ? lengths[i] : maxLength;
+        }
+        int pp = 0;
+        for (int length = minLength; length <= maxLength; ++length) {
+            for (int symbol = 0; symbol < alphaSize; ++symbol) {
+                if (lengths[symbol] == length) {
+                    perm[pp++] = static_cast<uint16_t>(symbol);
+                }
+            }
+        }
+        int32_t counts[kMaxCodeLength + 2] = {};
+        for (int i = 0; i < alphaSize; ++i) {
+            counts[lengths[i] + 1]++;
+        }
+        for (int i = 1; i < kMaxCodeLength + 2; ++i) {
+            counts[i] += counts[i - 1];
+        }
+        int32_t code = 0;
+        for (int i = 0; i < kMaxCodeLength + 2; ++i) {
+            limit[i] = -1;
+            base[i] = counts[i];
+        }
+        for (int length = minLength; length <= maxLength; ++length) {
+            code += counts[length + 1] - counts[length];
+            limit[length] = code - 1;
+            code <<= 1;
+        }
+        for (int length = minLength + 1; length <= maxLength; ++length) {
+            base[length] = ((limit[length - 1] + 1) << 1) - counts[length];
+        }
+    }
+
+    int decode(BitReader &reader, int alphaSize) const {
+        int length = minLength;
+        int32_t code = static_cast<int32_t>(reader.bits(length));
+        while (code > limit[length]) {
+            if (++length > maxLength) {
+                return -1;
+            }
+            code = (code << 1) | static_cast<int32_t>(reader.bit());
+        }
+        const int32_t index = code - base[length];
+        return index >= 0 && index < alphaSize ? perm[index] : -1;
+    }
+};
+
+class BlockDecoder {
+public:
+    explicit BlockDecoder(uint32_t maxBlockSize) : tt_(maxBlockSize), maxBlockSize_(maxBlockSize) {}
+
+    uint32_t maxBlockSize() const { return maxBlockSize_; }
+
+    /**
+     * Reads one block (after its magic) and undoes the Burrows-Wheeler transform. Returns
+     * false on corrupt input; the output is then written by emit().
+     */
+    bool read(BitReader &reader) {
+        storedCrc_ = reader.bits(32);
+        if (reader.bit() != 0) {
+            // Randomised blocks have not been written since bzip2 0.9.5.
+            return false;
+        }
+        const uint32_t origPtr = reader.bits(24);
+
+        uint8_t seqToUnseq[256];
+        int inUse = 0;
+        const uint32_t inUse16 = reader.bits(16);
+        for (int i = 0; i < 16; ++i) {
+            if (inUse16 & (0x8000u >> i)) {
+                for (int j = 0; j < 16; ++j) {
+                    if (reader.bit()) {
+                        seqToUnseq[inUse++] = static_cast<uint8_t>(16 * i + j);
+                    }
+                }
+            }
+        }
+        if (inUse == 0) {
+            return false;
+        }
+        const int alphaSize = inUse + 2;
+
+        const int groups = static_cast<int>(reader.bits(3));
+        const int selectorCount = static_cast<int>(reader.bits(15));
+        if (groups < 2 || groups > kMaxGroups || selectorCount < 1) {
+            return false;
+        }
+        selectors_.resize(selectorCount);
+        uint8_t groupMtf[kMaxGroups] = {0, 1, 2, 3, 4, 5};
+        for (int i = 0; i < selectorCount; ++i) {
+            int j = 0;
+            while (reader.bit()) {
+                if (++j >= groups) {
+                    return false;
+                }
+            }
+            const uint8_t group = groupMtf[j];
+            memmove(groupMtf + 1, groupMtf, j);
+            groupMtf[0] = group;
+            selectors_[i] = group;
+        }
+        if (selectorCount > kMaxSelectors) {
+            // bzip2 1.0.8 accepts and ignores selectors beyond the limit.
+            selectors_.resize(kMaxSelectors);
+        }
+
+        HuffmanGroup tables[kMaxGroups];
+        for (int t = 0; t < groups; ++t) {
+            uint8_t lengths[kMaxAlphaSize];
+            int length = static_cast<int>(reader.bits(5));
+            for (int i = 0; i < alphaSize; ++i) {
+                while (true) {
+                    if (length < 1 || length > kMaxCodeLength) {
+                        return false;
+                    }
+                    if (!reader.bit()) {
+                        break;
+                    }
+                    length += reader.bit() ? -1 : 1;
+                }
+                lengths[i] = static_cast<uint8_t>(length);
+            }
+            tables[t].build(lengths, alphaSize);
+        }
+        if (reader.overrun()) {
+            return false;
+        }
+
+        // Huffman -> RUNA/RUNB zero runs and move-to-front -> BWT output in tt_.
+        const int endOfBlock = inUse + 1;
+        uint8_t mtf[256];
+        for (int i = 0; i < 256; ++i) {
+            mtf[i] = static_cast<uint8_t>(i);
+        }
+        uint32_t counts[256] = {};
+        uint32_t blockLength = 0;
+        size_t selector = 0;
+        int groupRemaining = 0;
+        const HuffmanGroup *table = nullptr;
+        auto nextSymbol = [&]() -> int {
+            if (groupRemaining == 0) {
+                if (selector >= selectors_.size()) {
+                    return -1;
+                }
+                table = &tables[selectors_[selector++]];
+                groupRemaining = kGroupSize;
+            }
+            --groupRemaining;
+            return table->decode(reader, alphaSize);
+        };
+
+        int symbol = nextSymbol();
+        while (true) {
+            if (symbol < 0) {
+                return false;
+            }
+            if (symbol == endOfBlock) {
+                break;
+            }
+            if (symbol == kRunA || symbol == kRunB) {
+                uint32_t run = 0;
+                uint32_t weight = 1;
+                do {
+                    if (weight > maxBlockSize_) {
+                        return false;
+                    }
+                    run += symbol == kRunA ? weight : 2 * weight;
+                    weight <<= 1;
+                    symbol = nextSymbol();
+                } while (symbol == kRunA || symbol == kRunB);
+                const uint8_t byte = seqToUnseq[mtf[0]];
+                if (run > maxBlockSize_ - blockLength) {
+                    return false;
+                }
+                counts[byte] += run;
+                for (uint32_t i = 0; i < run; ++i) {
+                    tt_[blockLength++] = byte;
+                }
+                continue;
+            }
+            if (blockLength >= maxBlockSize_) {
+                return false;
+            }
+            const int index = symbol - 1;
+            const uint8_t value = mtf[index];
+            memmove(mtf + 1, mtf, index);
+            mtf[0] = value;
+            const uint8_t byte = seqToUnseq[value];
+            counts[byte]++;
+            tt_[blockLength++] = byte;
+            symbol = nextSymbol();
+        }
+        if (reader.overrun() || origPtr >= blockLength) {
+            return false;
+        }
+
+        // Inverse BWT: link each position to its successor in the upper 24 bits.
+        uint32_t start[256];
+        uint32_t sum = 0;
+        for (int i = 0; i < 256; ++i) {
+            start[i] = sum;
+            sum += counts[i];
+        }
+        for (uint32_t i = 0; i < blockLength; ++i) {
+            const uint8_t byte = tt_[i] & 0xff;
+            tt_[start[byte]++] |= i << 8;
+        }
+
+        position_ = tt_[origPtr] >> 8;
+        remaining_ = blockLength;
+        last_ = -1;
+        runLength_ = 0;
+        repeat_ = 0;
+        crc_ = 0xffffffff;
+        return true;
+    }
+
+    /**
+     * Writes up to `capacity` more bytes of the block read last and returns how many. The
+     * initial run-length encoding is undone here: four equal bytes are followed by a count
+     * of further repeats.
+     */
+    size_t emit(uint8_t *out, size_t capacity) {
+        size_t n = 0;
+        while (n < capacity) {
+            if (repeat_ > 0) {
+                const size_t now = std::min<size_t>(repeat_, capacity - n);
+                const uint8_t byte = static_cast<uint8_t>(last_);
+                for (size_t k = 0; k < now; ++k) {
+                    out[n++] = byte;
+                    crc_ = (crc_ << 8) ^ kCrc.table[(crc_ >> 24) ^ byte];
+                }
+                repeat_ -= static_cast<uint32_t>(now);
+                continue;
+            }
+            if (remaining_ == 0) {
+                break;
+            }
+            --remaining_;
+            const uint32_t entry = tt_[position_];
+            const uint8_t byte = entry & 0xff;
+            position_ = entry >> 8;
+            if (runLength_ == 4) {
+                repeat_ = byte;
+                runLength_ = 0;
+                continue;
+            }
+            if (byte == last_) {
+                ++runLength_;
+            } else {
+                last_ = byte;
+                runLength_ = 1;
+            }
+            out[n++] = byte;
+            crc_ = (crc_ << 8) ^ kCrc.table[(crc_ >> 24) ^ byte];
+        }
+        return n;
+    }
+
+    bool finished() const { return remaining_ == 0 && repeat_ == 0; }
+
+    // Both valid once finished().
+    uint32_t blockCrc() const { return ~crc_; }
+
+    bool crcMatches() const { return blockCrc() == storedCrc_; }
+
+private:
+    std::vector<uint32_t> tt_;
+    std::vector<uint8_t> selectors_;
+    uint32_t maxBlockSize_;
+    uint32_t storedCrc_ = 0;
+    uint32_t position_ = 0;
+    uint32_t remaining_ = 0;
+    int last_ = -1;
+    int runLength_ = 0;
+    uint32_t repeat_ = 0;
+    uint32_t crc_ = 0;
+};
+
+inline uint32_t combineCrc(uint32_t combined, uint32_t block) {
+    return ((combined << 1) | (combined >> 31)) ^ block;
+}
+
+// Bytes of input a block may take: every symbol at the longest code, plus its tables.
+inline size_t maxBlockInput(uint32_t maxBlockSize) {
+    return size_t{maxBlockSize} * kMaxCodeLength / 8 + 64 * 1024;
+}
+
+/**
+ * Blocks are independent, so the stream holds one block's input and transform and hands its
+ * output out in chunks, without keeping any history.
+ */
+class Bzip2Stream : public DecompressStream {
+public:
+    explicit Bzip2Stream(Source source) : DecompressStream(std::move(source)) {}
+
+protected:
+    bool produce() override {
+        switch (phase_) {
+            case Phase::Header:
+                return readStreamHeader();
+            case Phase::Block:
+                return readBlock();
+            case Phase::Output:
+                return writeBlock();
+        }
+        return false;
+    }
+
+private:
+    enum class Phase {
+        Header,
+        Block,
+        Output,
+    };
+
+    bool readStreamHeader() {
+        if (!fillInput(4)) {
+            if (!sawStream_ || inputAvailable() != 0) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        const uint8_t *p = input();
+        if (p[0] != 'B' || p[1] != 'Z' || p[2] != 'h' || p[3] < '1' || p[3] > '9') {
+            return false;
+        }
+        const uint32_t maxBlockSize = (p[3] - '0') * 100000;
+        if (block_ == nullptr || block_->maxBlockSize() != maxBlockSize) {
+            block_ = std::make_unique<BlockDecoder>(maxBlockSize);
+        }
+        consumeInput(4);
+        bitOffset_ = 0;
+        combinedCrc_ = 0;
+        sawStream_ = true;
+        phase_ = Phase::Block;
+        return true;
+    }
+
+    bool readBlock() {
+        // A short fill is the end of the input; a block cut off by it reads as overrun.
+        fillInput(maxBlockInput(block_->maxBlockSize()));
+        BitReader reader(input(), inputAvailable());
+        if (bitOffset_ > 0) {
+            reader.bits(static_cast<int>(bitOffset_));
+        }
+        const uint64_t magic = (uint64_t{reader.bits(24)} << 24) | reader.bits(24);
+        if (reader.overrun()) {
+            return false;
+        }
+        if (magic == kEndMagic) {
+            if (reader.bits(32) != combinedCrc_ || reader.overrun()) {
+                return false;
+            }
+            reader.alignToByte();
+            phase_ = Phase::Header;
+        } else if (magic != kBlockMagic || !block_->read(reader)) {
+            return false;
+        } else {
+            phase_ = Phase::Output;
+        }
+        const size_t consumed = reader.bitsConsumed();
+        consumeInput(consumed / 8);
+        bitOffset_ = consumed % 8;
+        return true;
+    }
+
+    bool writeBlock() {
+        if (!reserveOutput(kStreamChunk)) {
+            return false;
+        }
+        windowEnd_ += block_->emit(window_.data() + windowEnd_, kStreamChunk);
+        if (!block_->finished()) {
+            return true;
+        }
+        if (!block_->crcMatches()) {
+            return false;
+        }
+        combinedCrc_ = combineCrc(combinedCrc_, block_->blockCrc());
+        phase_ = Phase::Block;
+        return true;
+    }
+
+    std::unique_ptr<BlockDecoder> block_;
+    Phase phase_ = Phase::Header;
+    bool sawStream_ = false;
+    // Bits of the first input byte that earlier blocks used.
+    size_t bitOffset_ = 0;
+    uint32_t combinedCrc_ = 0;
+};
+
+} // namespace
+
+bool Bzip2Decoder::decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                          size_t *outLength) {
+    BitReader reader(in, inLength);
+    size_t outPos = 0;
+    do {
+        if (reader.remaining() < 4 || reader.bits(8) != 'B' || reader.bits(8) != 'Z' ||
+            reader.bits(8) != 'h') {
+            return false;
+        }
+        const uint32_t level = reader.bits(8);
+        if (level < '1' || level > '9') {
+            return false;
+        }
+        BlockDecoder block((level - '0') * 100000);
+        uint32_t combinedCrc = 0;
+        while (true) {
+            const uint64_t magic = (uint64_t{reader.bits(24)} << 24) | reader.bits(24);
+            if (reader.overrun()) {
+                return false;
+            }
+            if (magic == kEndMagic) {
+                if (reader.bits(32) != combinedCrc || reader.overrun()) {
+                    return false;
+                }
+                break;
+            }
+            if (magic != kBlockMagic || !block.read(reader)) {
+                return false;
+            }
+            outPos += block.emit(out + outPos, outCapacity - outPos);
+            if (!block.finished() || !block.crcMatches()) {
+                return false;
+            }
+            combinedCrc = combineCrc(combinedCrc, block.blockCrc());
+        }
+        reader.alignToByte();
+    } while (reader.remaining() > 0);
+
+    if (outLength != nullptr) {
+        *outLength = outPos;
+    }
+    return true;
+}
+
+std::unique_ptr<DecompressStream> Bzip2Decoder::openStream(DecompressStream::Source source) {
+    return std::make_unique<Bzip2Stream>(std::move(source));
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,36 @@
+#ifndef BZIP2_DECODER_H
+#define BZIP2_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "decompressor.h"
+
+namespace genesis::oracle {
+
+/**
+ * @brief .bz2 decoder with block and stream CRC verification. Concatenated streams (as
+ * written by pbzip2) are accepted.
+ */
+class Bzip2Decoder {
+public:
+    /**
+     * @brief Decodes `in` into `out`. Fails if the input is corrupt or decodes to more than
+     * `outCapacity` bytes.
+     *
+     * @param outLength Set to the number of bytes written.
+     */
+    static bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength);
+
+    /**
+     * @brief Stream decoder. Blocks do not refer to each other, so memory stays at one
+     * block's input and transform (a few MiB) however large the data.
+     */
+    static std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source);
+};
+
+} // namespace genesis::oracle
+
+#endif // BZIP2_DECODER_H
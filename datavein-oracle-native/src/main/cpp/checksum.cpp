@@ -0,0 +1,138 @@
+#include "checksum.h"
+
+#include <array>
+#include <cstring>
+
+namespace genesis::oracle {
+namespace {
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes.
+template<typename T, T Polynomial>
+constexpr std::array<std::array<T, 256>, 8> makeTables() {
+    std::array<std::array<T, 256>, 8> tables{};
+    for (unsigned b = 0; b < 256; ++b) {
+        T crc = b;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ ((crc & 1) ? Polynomial : 0);
+        }
+        tables[0][b] = crc;
+    }
+    for (unsigned b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) {
+            tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xff];
+        }
+    }
+    return tables;
+}
+
+constexpr auto kCrc32Tables = makeTables<uint32_t, 0xedb88320u>();
+constexpr auto kCrc64Tables = makeTables<uint64_t, 0xc96c5795d7870f42ull>();
+
+template<typename T, const std::array<std::array<T, 256>, 8> &Tables>
+T update(const uint8_t *data, size_t length, T crc) {
+    crc = ~crc;
+    for (; length >= 8; length -= 8, data += 8) {
+        uint64_t word = 0;
+        for (int i = 0; i < 8; ++i) {
+            word |= uint64_t{data[i]} << (8 * i);
+        }
+        word ^= crc;
+        crc = static_cast<T>(Tables[7][word & 0xff] ^ Tables[6][(word >> 8) & 0xff] ^
+                             Tables[5][(word >> 16) & 0xff] ^ Tables[4][(word >> 24) & 0xff] ^
+                             Tables[3][(word >> 32) & 0xff] ^ Tables[2][(word >> 40) & 0xff] ^
+                             Tables[1][(word >> 48) & 0xff] ^ Tables[0][word >> 56]);
+    }
+    for (; length > 0; --length, ++data) {
+        crc = Tables[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+constexpr uint32_t kXxPrime1 = 0x9e3779b1u;
+constexpr uint32_t kXxPrime2 = 0x85ebca77u;
+constexpr uint32_t kXxPrime3 = 0xc2b2ae3du;
+constexpr uint32_t kXxPrime4 = 0x27d4eb2fu;
+constexpr uint32_t kXxPrime5 = 0x165667b1u;
+
+inline uint32_t rotl32(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+inline uint32_t load32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint32_t xxRound(uint32_t acc, uint32_t lane) {
+    return rotl32(acc + lane * kXxPrime2, 13) * kXxPrime1;
+}
+
+} // namespace
+
+uint32_t crc32(const uint8_t *data, size_t length, uint32_t crc) {
+    return update<uint32_t, kCrc32Tables>(data, length, crc);
+}
+
+uint64_t crc64(const uint8_t *data, size_t length, uint64_t crc) {
+    return update<uint64_t, kCrc64Tables>(data, length, crc);
+}
+
+uint32_t xxh32(const uint8_t *data, size_t length, uint32_t seed) {
+    Xxh32 hash(seed);
+    hash.update(data, length);
+    return hash.digest();
+}
+
+Xxh32::Xxh32(uint32_t seed)
+    : seed_(seed), lanes_{seed + kXxPrime1 + kXxPrime2, seed + kXxPrime2, seed, seed - kXxPrime1} {}
+
+void Xxh32::update(const uint8_t *data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    length_ += length;
+    if (buffered_ > 0) {
+        const size_t take = length < sizeof(buffer_) - buffered_ ? length
+                                                                  : sizeof(buffer_) - buffered_;
+        memcpy(buffer_ + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        length -= take;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        for (int i = 0; i < 4; ++i) {
+            lanes_[i] = xxRound(lanes_[i], load32(buffer_ + 4 * i));
+        }
+        buffered_ = 0;
+    }
+    for (; length >= 16; data += 16, length -= 16) {
+        for (int i = 0; i < 4; ++i) {
+            lanes_[i] = xxRound(lanes_[i], load32(data + 4 * i));
+        }
+    }
+    memcpy(buffer_, data, length);
+    buffered_ = length;
+}
+
+uint32_t Xxh32::digest() const {
+    uint32_t hash = length_ >= 16 ? rotl32(lanes_[0], 1) + rotl32(lanes_[1], 7) +
+                                    rotl32(lanes_[2], 12) + rotl32(lanes_[3], 18)
+                                  : seed_ + kXxPrime5;
+    hash += static_cast<uint32_t>(length_);
+    const uint8_t *data = buffer_;
+    const uint8_t *const end = buffer_ + buffered_;
+    for (; end - data >= 4; data += 4) {
+        hash = rotl32(hash + load32(data) * kXxPrime3, 17) * kXxPrime4;
+    }
+    for (; data < end; ++data) {
+        hash = rotl32(hash + *data * kXxPrime5, 11) * kXxPrime1;
+    }
+    hash ^= hash >> 15;
+    hash *= kXxPrime2;
+    hash ^= hash >> 13;
+    hash *= kXxPrime3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,46 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::oracle {
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as in zlib, xz and Android sparse images). Pass the previous
+ * result as `crc` to continue a running checksum; start from 0.
+ */
+uint32_t crc32(const uint8_t *data, size_t length, uint32_t crc = 0);
+
+/**
+ * @brief CRC-64 (ECMA-182, as in xz). Same chaining convention as crc32.
+ */
+uint64_t crc64(const uint8_t *data, size_t length, uint64_t crc = 0);
+
+/**
+ * @brief XXH32 (as in LZ4 frame headers and content checksums).
+ */
+uint32_t xxh32(const uint8_t *data, size_t length, uint32_t seed = 0);
+
+/**
+ * @brief Incremental XXH32, for LZ4 content checksums computed while streaming.
+ */
+class Xxh32 {
+public:
+    explicit Xxh32(uint32_t seed = 0);
+
+    void update(const uint8_t *data, size_t length);
+
+    uint32_t digest() const;
+
+private:
+    uint32_t seed_;
+    uint32_t lanes_[4];
+    uint8_t buffer_[16];
+    size_t buffered_ = 0;
+    uint64_t length_ = 0;
+};
+
+} // namespace genesis::oracle
+
+#endif // CHECKSUM_H
@@ -0,0 +1,75 @@
+#include "compression_format.h"
+
+#include <cstring>
+
+namespace genesis::oracle {
+namespace {
+
+bool startsWith(const uint8_t *data, size_t length, const void *magic, size_t magicLength) {
+    return length >= magicLength && memcmp(data, magic, magicLength) == 0;
+}
+
+} // namespace
+
+CompressionFormat detectCompression(const uint8_t *data, size_t length) {
+    static constexpr uint8_t kGzip[] = {0x1f, 0x8b};
+    static constexpr uint8_t kLz4Legacy[] = {0x02, 0x21, 0x4c, 0x18};
+    static constexpr uint8_t kLz4Frame[] = {0x04, 0x22, 0x4d, 0x18};
+    static constexpr uint8_t kZstd[] = {0x28, 0xb5, 0x2f, 0xfd};
+    static constexpr uint8_t kXz[] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+    static constexpr uint8_t kBzip2[] = {'B', 'Z', 'h'};
+
+    if (startsWith(data, length, kGzip, sizeof(kGzip))) {
+        return CompressionFormat::Gzip;
+    }
+    if (startsWith(data, length, kLz4Legacy, sizeof(kLz4Legacy))) {
+        return CompressionFormat::Lz4Legacy;
+    }
+    if (startsWith(data, length, kLz4Frame, sizeof(kLz4Frame))) {
+        return CompressionFormat::Lz4Frame;
+    }
+    if (startsWith(data, length, kZstd, sizeof(kZstd))) {
+        return CompressionFormat::Zstd;
+    }
+    if (startsWith(data, length, kXz, sizeof(kXz))) {
+        return CompressionFormat::Xz;
+    }
+    if (startsWith(data, length, kBzip2, sizeof(kBzip2)) && length > 3 && data[3] >= '1' &&
+        data[3] <= '9') {
+        return CompressionFormat::Bzip2;
+    }
+    // Legacy .lzma has no magic; match the usual properties byte (lc=3, lp=0, pb=2) and a
+    // power-of-two dictionary size.
+    if (length >= 13 && data[0] == 0x5d) {
+        const uint32_t dictionary = uint32_t{data[1]} | (uint32_t{data[2]} << 8) |
+                                    (uint32_t{data[3]} << 16) | (uint32_t{data[4]} << 24);
+        if (dictionary >= 4096 && (dictionary & (dictionary - 1)) == 0) {
+            return CompressionFormat::Lzma;
+        }
+    }
+    return CompressionFormat::None;
+}
+
+const char *compressionName(CompressionFormat format) {
+    switch (format) {
+        case CompressionFormat::Gzip:
+            return "gzip";
+        case CompressionFormat::Lz4Legacy:
+            return "lz4_legacy";
+        case CompressionFormat::Lz4Frame:
+            return "lz4";
+        case CompressionFormat::Zstd:
+            return "zstd";
+        case CompressionFormat::Xz:
+            return "xz";
+        case CompressionFormat::Lzma:
+            return "lzma";
+        case CompressionFormat::Bzip2:
+            return "bzip2";
+        case CompressionFormat::None:
+            break;
+    }
+    return "none";
+}
+
+} // namespace genesis::oracle
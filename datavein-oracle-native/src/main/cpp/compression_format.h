@@ -0,0 +1,33 @@
+#ifndef COMPRESSION_FORMAT_H
+#define COMPRESSION_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::oracle {
+
+enum class CompressionFormat {
+    None,
+    Gzip,
+    Lz4Legacy,
+    Lz4Frame,
+    Zstd,
+    Xz,
+    Lzma,
+    Bzip2,
+};
+
+/**
+ * @brief Identifies the compression of a blob from its leading magic bytes. Anything not
+ * recognised is reported as None.
+ */
+CompressionFormat detectCompression(const uint8_t *data, size_t length);
+
+/**
+ * @brief Short lowercase name ("gzip", "lz4_legacy", ..., "none") for reports.
+ */
+const char *compressionName(CompressionFormat format);
+
+} // namespace genesis::oracle
+
+#endif // COMPRESSION_FORMAT_H
@@ -0,0 +1,163 @@
+#include "content_hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+constexpr uint64_t kPrime3 = 0x165667b19e3779f9ULL;
+constexpr uint64_t kPrime4 = 0x85ebca77c2b2ae63ULL;
+constexpr uint64_t kPrime5 = 0x27d4eb2f165667c5ULL;
+// Seed offset of the second lane of a ContentKey.
+constexpr uint64_t kHighSeed = 0x6a09e667f3bcc908ULL;
+
+inline uint64_t rotl(uint64_t v, int n) {
+    return (v << n) | (v >> (64 - n));
+}
+
+inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    return rotl(acc + input * kPrime2, 31) * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    return (acc ^ round(0, value)) * kPrime1 + kPrime4;
+}
+
+struct Lanes {
+    uint64_t v[4];
+
+    explicit Lanes(uint64_t seed) : v{seed + kPrime1 + kPrime2, seed + kPrime2, seed,
+                                      seed - kPrime1} {}
+
+    uint64_t converge() const {
+        uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+        for (uint64_t lane: v) {
+            h = mergeRound(h, lane);
+        }
+        return h;
+    }
+};
+
+// Mixes in the bytes after the last 32-byte stripe, then avalanches.
+uint64_t finish(uint64_t h, const uint8_t *p, size_t remaining) {
+    for (; remaining >= 8; p += 8, remaining -= 8) {
+        h = rotl(h ^ round(0, read64(p)), 27) * kPrime1 + kPrime4;
+    }
+    if (remaining >= 4) {
+        h = rotl(h ^ (uint64_t{read32(p)} * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+        remaining -= 4;
+    }
+    for (; remaining > 0; ++p, --remaining) {
+        h = rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace
+
+uint64_t xxh64(const uint8_t *data, size_t length, uint64_t seed) {
+    const uint8_t *p = data;
+    uint64_t h;
+    if (length >= 32) {
+        Lanes lanes(seed);
+        for (; p + 32 <= data + length; p += 32) {
+            for (int i = 0; i < 4; ++i) {
+                lanes.v[i] = round(lanes.v[i], read64(p + 8 * i));
+            }
+        }
+        h = lanes.converge();
+    } else {
+        h = seed + kPrime5;
+    }
+    return finish(h + length, p, data + length - p);
+}
+
+Xxh64::Xxh64(uint64_t seed) : seed_(seed) {
+    const Lanes lanes(seed);
+    memcpy(lanes_, lanes.v, sizeof(lanes_));
+}
+
+void Xxh64::update(const uint8_t *data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    length_ += length;
+    if (buffered_ > 0) {
+        const size_t take = std::min(length, sizeof(buffer_) - buffered_);
+        memcpy(buffer_ + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        length -= take;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        for (int i = 0; i < 4; ++i) {
+            lanes_[i] = round(lanes_[i], read64(buffer_ + 8 * i));
+        }
+        buffered_ = 0;
+    }
+    for (; length >= 32; data += 32, length -= 32) {
+        for (int i = 0; i < 4; ++i) {
+            lanes_[i] = round(lanes_[i], read64(data + 8 * i));
+        }
+    }
+    memcpy(buffer_, data, length);
+    buffered_ = length;
+}
+
+uint64_t Xxh64::digest() const {
+    uint64_t h;
+    if (length_ >= 32) {
+        Lanes lanes(seed_);
+        memcpy(lanes.v, lanes_, sizeof(lanes_));
+        h = lanes.converge();
+    } else {
+        h = seed_ + kPrime5;
+    }
+    return finish(h + length_, buffer_, buffered_);
+}
+
+ContentKey contentKey(const uint8_t *data, size_t length, uint64_t domain) {
+    const uint8_t *p = data;
+    uint64_t low, high;
+    if (length >= 32) {
+        Lanes a(domain), b(domain + kHighSeed);
+        for (; p + 32 <= data + length; p += 32) {
+            for (int i = 0; i < 4; ++i) {
+                const uint64_t word = read64(p + 8 * i);
+                a.v[i] = round(a.v[i], word);
+                b.v[i] = round(b.v[i], word);
+            }
+        }
+        low = a.converge();
+        high = b.converge();
+    } else {
+        low = domain + kPrime5;
+        high = domain + kHighSeed + kPrime5;
+    }
+    const size_t tail = data + length - p;
+    return {finish(low + length, p, tail), finish(high + length, p, tail)};
+}
+
+} // namespace genesis::oracle
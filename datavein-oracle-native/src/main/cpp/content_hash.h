@@ -0,0 +1,53 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::oracle {
+
+/**
+ * @brief 128-bit content fingerprint used as a BlockStore key.
+ */
+struct ContentKey {
+    uint64_t low;
+    uint64_t high;
+
+    bool operator==(const ContentKey &) const = default;
+};
+
+/**
+ * @brief XXH64 of `data`.
+ */
+uint64_t xxh64(const uint8_t *data, size_t length, uint64_t seed = 0);
+
+/**
+ * @brief Incremental XXH64, for data that arrives in pieces (zstd streaming checksums).
+ */
+class Xxh64 {
+public:
+    explicit Xxh64(uint64_t seed = 0);
+
+    void update(const uint8_t *data, size_t length);
+
+    uint64_t digest() const;
+
+private:
+    uint64_t seed_;
+    uint64_t lanes_[4];
+    uint8_t buffer_[32];
+    size_t buffered_ = 0;
+    uint64_t length_ = 0;
+};
+
+/**
+ * @brief Fingerprints `data` as two XXH64 lanes with different seeds, computed in one pass.
+ * Fast rather than cryptographic: keys identify content the library produced or was given,
+ * not content an attacker chose to collide. `domain` separates keys for different kinds of
+ * values derived from the same input.
+ */
+ContentKey contentKey(const uint8_t *data, size_t length, uint64_t domain = 0);
+
+} // namespace genesis::oracle
+
+#endif // CONTENT_HASH_H
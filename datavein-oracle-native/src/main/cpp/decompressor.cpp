@@ -0,0 +1,365 @@
+#include "decompressor.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bzip2_decoder.h"
+#include "file_io.h"
+#include "gzip_decoder.h"
+#include "lz4_decoder.h"
+#include "mapped_file.h"
+#include "xz_decoder.h"
+#include "zstd_decoder.h"
+
+#define LOG_TAG "Decompressor"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace genesis::oracle {
+namespace {
+
+constexpr size_t kInputChunk = 256 * 1024;
+constexpr size_t kCopyBufferSize = 1024 * 1024;
+// Largest window a stream may hold: the biggest history any supported format needs (zstd
+// and xz streams are limited to 256 MiB) plus room to decode into. It also bounds the
+// output of BufferedStream.
+constexpr size_t kMaxWindowSize = 320 * 1024 * 1024;
+
+// Stream fallback for formats that are only decoded one-shot: .lzma files that do not
+// record their size, which are small kernels and ramdisks in practice.
+class BufferedStream : public DecompressStream {
+public:
+    BufferedStream(const Codec &codec, Source source)
+        : DecompressStream(std::move(source)), codec_(codec) {}
+
+protected:
+    bool produce() override {
+        while (fillInput(inputAvailable() + kInputChunk)) {
+        }
+        uint64_t recorded;
+        size_t capacity = codec_.contentSize(input(), inputAvailable(), recorded)
+                          ? static_cast<size_t>(std::min<uint64_t>(recorded, kMaxWindowSize))
+                          : std::max<size_t>(inputAvailable() * 4, kInputChunk);
+        for (;;) {
+            window_.resize(capacity);
+            size_t length;
+            if (codec_.decode(input(), inputAvailable(), window_.data(), capacity, &length,
+                              nullptr)) {
+                windowEnd_ = length;
+                finish();
+                return true;
+            }
+            // Corrupt input and a short buffer look alike; retry until the limit.
+            if (capacity >= kMaxWindowSize) {
+                LOGE("Input is corrupt or decodes to more than %zu MiB",
+                     kMaxWindowSize / (1024 * 1024));
+                return false;
+            }
+            capacity = std::min(capacity * 2, kMaxWindowSize);
+        }
+    }
+
+private:
+    const Codec &codec_;
+};
+
+class GzipCodec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *pool) const override {
+        return GzipDecoder::decode(in, inLength, out, outCapacity, outLength, pool);
+    }
+
+    bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const override {
+        return GzipDecoder::contentSize(in, inLength, size);
+    }
+
+    std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const override {
+        return GzipDecoder::openStream(std::move(source));
+    }
+};
+
+class Lz4Codec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *pool) const override {
+        return Lz4Decoder::decode(in, inLength, out, outCapacity, outLength, pool);
+    }
+
+    bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const override {
+        return Lz4Decoder::contentSize(in, inLength, size);
+    }
+
+    std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const override {
+        return Lz4Decoder::openStream(std::move(source));
+    }
+};
+
+class ZstdCodec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *pool) const override {
+        return ZstdDecoder::decode(in, inLength, out, outCapacity, outLength, pool);
+    }
+
+    bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const override {
+        return ZstdDecoder::contentSize(in, inLength, size);
+    }
+
+    std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const override {
+        return ZstdDecoder::openStream(std::move(source));
+    }
+};
+
+class XzCodec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *) const override {
+        return XzDecoder::decode(in, inLength, out, outCapacity, outLength);
+    }
+
+    bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const override {
+        return XzDecoder::contentSize(in, inLength, size);
+    }
+
+    std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const override {
+        return XzDecoder::openStream(std::move(source));
+    }
+};
+
+class LzmaCodec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *) const override {
+        return lzmaAloneDecode(in, inLength, out, outCapacity, outLength);
+    }
+
+    bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const override {
+        return lzmaAloneSize(in, inLength, size);
+    }
+};
+
+class Bzip2Codec : public Codec {
+public:
+    bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                size_t *outLength, WorkStealingPool *) const override {
+        return Bzip2Decoder::decode(in, inLength, out, outCapacity, outLength);
+    }
+
+    std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const override {
+        return Bzip2Decoder::openStream(std::move(source));
+    }
+};
+
+bool streamToFile(DecompressStream &stream, int fd) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[kCopyBufferSize]);
+    uint64_t offset = 0;
+    for (;;) {
+        const int64_t n = stream.read(buffer.get(), kCopyBufferSize);
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        if (!pwriteAll(fd, buffer.get(), static_cast<size_t>(n), offset)) {
+            return false;
+        }
+        offset += n;
+    }
+}
+
+bool decodeToMapping(const Codec &codec, const uint8_t *in, size_t inLength, int fd,
+                     uint64_t size, WorkStealingPool *pool) {
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    if (size == 0) {
+        // Still decoded, so that corrupt input is reported.
+        uint8_t empty;
+        size_t length;
+        return codec.decode(in, inLength, &empty, 0, &length, pool);
+    }
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    size_t length = 0;
+    const bool ok = codec.decode(in, inLength, static_cast<uint8_t *>(address),
+                                 static_cast<size_t>(size), &length, pool) &&
+                    length == size;
+    munmap(address, size);
+    return ok;
+}
+
+} // namespace
+
+bool DecompressStream::fillInput(size_t length) {
+    if (inEnd_ - inPos_ >= length) {
+        return true;
+    }
+    if (inPos_ > 0) {
+        memmove(in_.data(), in_.data() + inPos_, inEnd_ - inPos_);
+        inEnd_ -= inPos_;
+        inPos_ = 0;
+    }
+    if (in_.size() < length) {
+        in_.resize(std::max(length, kInputChunk));
+    }
+    while (inEnd_ < length && !sourceEnded_) {
+        const int64_t n = source_(in_.data() + inEnd_, in_.size() - inEnd_);
+        if (n <= 0) {
+            sourceEnded_ = true;
+            failed_ = failed_ || n < 0;
+            break;
+        }
+        inEnd_ += static_cast<size_t>(n);
+    }
+    return inEnd_ >= length;
+}
+
+bool DecompressStream::readInput(void *out, size_t length) {
+    if (!fillInput(length)) {
+        return false;
+    }
+    memcpy(out, input(), length);
+    consumeInput(length);
+    return true;
+}
+
+bool DecompressStream::reserveOutput(size_t length) {
+    if (window_.size() - windowEnd_ >= length) {
+        return true;
+    }
+    // Slide out what has been read and is older than the history.
+    const size_t keepFrom = std::min(readPos_, windowEnd_ > history_ ? windowEnd_ - history_ : 0);
+    if (keepFrom > 0) {
+        memmove(window_.data(), window_.data() + keepFrom, windowEnd_ - keepFrom);
+        windowEnd_ -= keepFrom;
+        readPos_ -= keepFrom;
+    }
+    if (window_.size() - windowEnd_ < length) {
+        const size_t needed = windowEnd_ + length;
+        if (needed > kMaxWindowSize) {
+            return false;
+        }
+        window_.resize(std::min(std::max(needed, window_.size() * 2), kMaxWindowSize));
+    }
+    return true;
+}
+
+int64_t DecompressStream::read(uint8_t *out, size_t capacity) {
+    size_t done = 0;
+    while (!failed_ && done < capacity) {
+        if (readPos_ < windowEnd_) {
+            const size_t now = std::min(capacity - done, windowEnd_ - readPos_);
+            memcpy(out + done, window_.data() + readPos_, now);
+            readPos_ += now;
+            done += now;
+        } else if (finished_) {
+            break;
+        } else if (!produce()) {
+            failed_ = true;
+        }
+    }
+    return failed_ ? -1 : static_cast<int64_t>(done);
+}
+
+std::unique_ptr<DecompressStream> DecompressStream::open(CompressionFormat format,
+                                                         Source source) {
+    const Codec *codec = Codec::find(format);
+    return codec != nullptr ? codec->openStream(std::move(source)) : nullptr;
+}
+
+const Codec *Codec::find(CompressionFormat format) {
+    static const GzipCodec gzip;
+    static const Lz4Codec lz4;
+    static const ZstdCodec zstd;
+    static const XzCodec xz;
+    static const LzmaCodec lzma;
+    static const Bzip2Codec bzip2;
+    switch (format) {
+        case CompressionFormat::Gzip:
+            return &gzip;
+        case CompressionFormat::Lz4Legacy:
+        case CompressionFormat::Lz4Frame:
+            return &lz4;
+        case CompressionFormat::Zstd:
+            return &zstd;
+        case CompressionFormat::Xz:
+            return &xz;
+        case CompressionFormat::Lzma:
+            return &lzma;
+        case CompressionFormat::Bzip2:
+            return &bzip2;
+        case CompressionFormat::None:
+            break;
+    }
+    return nullptr;
+}
+
+bool Codec::contentSize(const uint8_t *, size_t, uint64_t &) const {
+    return false;
+}
+
+std::unique_ptr<DecompressStream> Codec::openStream(DecompressStream::Source source) const {
+    return std::make_unique<BufferedStream>(*this, std::move(source));
+}
+
+bool decompress(CompressionFormat format, const uint8_t *in, size_t inLength, uint8_t *out,
+                size_t outCapacity, size_t *outLength, WorkStealingPool *pool) {
+    const Codec *codec = Codec::find(format);
+    return codec != nullptr && codec->decode(in, inLength, out, outCapacity, outLength, pool);
+}
+
+bool decompressToFile(const uint8_t *in, size_t inLength, const char *outputPath,
+                      WorkStealingPool *pool) {
+    const CompressionFormat format = detectCompression(in, inLength);
+    const Codec *codec = Codec::find(format);
+    if (codec == nullptr) {
+        LOGE("%s: unrecognised compression", outputPath);
+        return false;
+    }
+    const int fd = ::open(outputPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("Cannot create %s", outputPath);
+        return false;
+    }
+
+    bool ok;
+    uint64_t size;
+    if (codec->contentSize(in, inLength, size)) {
+        ok = decodeToMapping(*codec, in, inLength, fd, size, pool);
+    } else {
+        size_t offset = 0;
+        std::unique_ptr<DecompressStream> stream = codec->openStream(
+                [in, inLength, &offset](uint8_t *buffer, size_t capacity) -> int64_t {
+                    const size_t now = std::min(capacity, inLength - offset);
+                    memcpy(buffer, in + offset, now);
+                    offset += now;
+                    return static_cast<int64_t>(now);
+                });
+        ok = streamToFile(*stream, fd);
+    }
+    close(fd);
+    if (!ok) {
+        LOGE("%s: corrupt or truncated %s data", outputPath, compressionName(format));
+        unlink(outputPath);
+    }
+    return ok;
+}
+
+bool decompressFile(const char *inputPath, const char *outputPath, WorkStealingPool *pool) {
+    std::unique_ptr<MappedFile> input = MappedFile::open(inputPath,
+                                                         MappedFile::Access::Sequential);
+    if (input == nullptr) {
+        LOGE("Cannot open %s", inputPath);
+        return false;
+    }
+    return decompressToFile(input->data(), input->size(), outputPath, pool);
+}
+
+} // namespace genesis::oracle
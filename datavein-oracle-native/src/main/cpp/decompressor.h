@@ -0,0 +1,170 @@
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "compression_format.h"
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief Pull-based decoder: compressed bytes come from a source callback, decoded bytes
+ * are read into caller buffers, and memory stays bounded by the format's history window
+ * rather than the size of the data.
+ *
+ * Subclasses decode into `window_`, which keeps at least `history` bytes before the write
+ * position so back-references can reach them.
+ */
+class DecompressStream {
+public:
+    /**
+     * @brief Fills `buffer` with up to `capacity` compressed bytes and returns how many, 0 at
+     * the end of the input or -1 on a read error.
+     */
+    using Source = std::function<int64_t(uint8_t *buffer, size_t capacity)>;
+
+    /**
+     * @brief Stream decoder for `format`, or nullptr if the format is unsupported.
+     */
+    static std::unique_ptr<DecompressStream> open(CompressionFormat format, Source source);
+
+    virtual ~DecompressStream() = default;
+
+    DecompressStream(const DecompressStream &) = delete;
+
+    DecompressStream &operator=(const DecompressStream &) = delete;
+
+    /**
+     * @brief Decodes up to `capacity` bytes into `out` and returns how many, 0 once the
+     * stream is fully decoded, or -1 if the input is corrupt, truncated or unreadable.
+     * Reads fewer than `capacity` bytes only at the end of the stream.
+     */
+    int64_t read(uint8_t *out, size_t capacity);
+
+protected:
+    explicit DecompressStream(Source source) : source_(std::move(source)) {}
+
+    /**
+     * @brief Decodes some more output (possibly none, e.g. after a header) or marks the
+     * stream finished. Returns false on corrupt input.
+     */
+    virtual bool produce() = 0;
+
+    /**
+     * @brief Makes at least `length` contiguous input bytes available at input(). Returns
+     * false if the input ends (or fails) first; whatever is left stays available.
+     */
+    bool fillInput(size_t length);
+
+    const uint8_t *input() const { return in_.data() + inPos_; }
+
+    size_t inputAvailable() const { return inEnd_ - inPos_; }
+
+    void consumeInput(size_t length) { inPos_ += length; }
+
+    bool readInput(void *out, size_t length);
+
+    /**
+     * @brief Whether the input is exhausted.
+     */
+    bool inputEnd() { return !fillInput(1); }
+
+    /**
+     * @brief Ensures `length` bytes of room after windowEnd_, sliding out decoded bytes
+     * that have been read and are older than the history. Returns false if that would need
+     * a window larger than the supported maximum.
+     */
+    bool reserveOutput(size_t length);
+
+    /**
+     * @brief Bytes of earlier output that back-references may reach.
+     */
+    void setHistory(size_t history) { history_ = history; }
+
+    void finish() { finished_ = true; }
+
+    std::vector<uint8_t> window_;
+    size_t windowEnd_ = 0;
+
+private:
+    Source source_;
+    std::vector<uint8_t> in_;
+    size_t inPos_ = 0;
+    size_t inEnd_ = 0;
+    bool sourceEnded_ = false;
+    size_t readPos_ = 0;
+    size_t history_ = 0;
+    bool finished_ = false;
+    bool failed_ = false;
+};
+
+/**
+ * @brief Decoder for one compression format.
+ *
+ * One-shot decoding writes straight into the caller's buffer, which also serves as the
+ * history window, so nothing is allocated per call beyond small tables. Formats made of
+ * independent units whose output offsets are known up front (lz4 legacy blocks and
+ * block-independent lz4 frames, zstd frames that record their content size, BGZF gzip
+ * members) are decoded unit-parallel when given a pool; the rest decode sequentially.
+ */
+class Codec {
+public:
+    /**
+     * @brief Codec for `format`, or nullptr if none is available.
+     */
+    static const Codec *find(CompressionFormat format);
+
+    virtual ~Codec() = default;
+
+    /**
+     * @brief Decodes all of `in` into `out`. Fails if the input is corrupt or truncated or
+     * decodes to more than `outCapacity` bytes.
+     *
+     * @param outLength Set to the number of bytes written.
+     */
+    virtual bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                        size_t *outLength, WorkStealingPool *pool) const = 0;
+
+    /**
+     * @brief Decoded size as recorded in the headers, if the format records it for all of
+     * `in`.
+     */
+    virtual bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size) const;
+
+    /**
+     * @brief Stream decoder. Every format but .lzma has one that keeps memory bounded by
+     * its history window. By default the whole input is read first and decoded one-shot
+     * into a buffer that grows until the data fits, failing beyond 320 MiB of output.
+     */
+    virtual std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source) const;
+};
+
+/**
+ * @brief One-shot decoding through Codec::find(format).
+ */
+bool decompress(CompressionFormat format, const uint8_t *in, size_t inLength, uint8_t *out,
+                size_t outCapacity, size_t *outLength, WorkStealingPool *pool = nullptr);
+
+/**
+ * @brief Decompresses `in`, whose format is detected from its magic, to `outputPath`.
+ * Decodes one-shot (in parallel where the format allows) into a mapping of the output when
+ * the decoded size is recorded in the input, and streams otherwise. The output is removed on
+ * failure.
+ */
+bool decompressToFile(const uint8_t *in, size_t inLength, const char *outputPath,
+                      WorkStealingPool *pool);
+
+/**
+ * @brief decompressToFile() on the contents of the file at `inputPath`.
+ */
+bool decompressFile(const char *inputPath, const char *outputPath, WorkStealingPool *pool);
+
+} // namespace genesis::oracle
+
+#endif // DECOMPRESSOR_H
@@ -0,0 +1,547 @@
+#include "delta_rom_builder.h"
+
+#include <algorithm>
+#include <android/log.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <memory>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "block_store.h"
+#include "file_io.h"
+#include "json_reader.h"
+#include "sha256.h"
+#include "work_stealing_pool.h"
+
+#define LOG_TAG "DeltaRomBuilder"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint8_t kIndexMagic[4] = {'D', 'V', 'B', 'H'};
+constexpr size_t kIndexHeaderSize = 32;
+constexpr uint64_t kBlock = DeltaRomBuilder::kHashBlockSize;
+constexpr size_t kFillBufferSize = 1024 * 1024;
+// Blocks hashed per task: 1 MiB of image.
+constexpr uint64_t kHashBatch = 256;
+// BlockStore key domain of a batch's block digests.
+constexpr uint64_t kDigestDomain = 0x4456424800000001ULL;
+
+/**
+ * @brief Closes a descriptor on scope exit.
+ */
+class ScopedFd {
+public:
+    explicit ScopedFd(int fd = -1) : fd_(fd) {}
+
+    ~ScopedFd() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    ScopedFd(const ScopedFd &) = delete;
+
+    ScopedFd &operator=(const ScopedFd &) = delete;
+
+    int get() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+struct IndexHeader {
+    uint64_t imageSize;
+    int64_t mtimeSeconds;
+    uint32_t mtimeNanos;
+};
+
+inline void store32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline void store64(uint8_t *p, uint64_t v) {
+    store32(p, static_cast<uint32_t>(v));
+    store32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+inline uint32_t load32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t load64(const uint8_t *p) {
+    return uint64_t{load32(p)} | (uint64_t{load32(p + 4)} << 32);
+}
+
+inline uint64_t blockCount(uint64_t size) {
+    return size / kBlock + (size % kBlock != 0);
+}
+
+// Makes `out` a copy of the first `size` bytes of `in`: a reflink when the filesystem
+// supports it, else a copy of the data extents only. `out` must be empty.
+bool cloneFile(int in, int out, uint64_t size, RomBuildStats &stats) {
+    if (ioctl(out, FICLONE, in) == 0) {
+        stats.reflinked = true;
+        return ftruncate(out, static_cast<off_t>(size)) == 0;
+    }
+    if (ftruncate(out, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    uint64_t offset = 0;
+    while (offset < size) {
+        off_t data = lseek(in, static_cast<off_t>(offset), SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO) {
+                // Only a hole remains.
+                return true;
+            }
+            // No hole support: treat the whole file as data.
+            data = static_cast<off_t>(offset);
+        }
+        off_t hole = lseek(in, data, SEEK_HOLE);
+        if (hole < 0 || static_cast<uint64_t>(hole) > size) {
+            hole = static_cast<off_t>(size);
+        }
+        if (static_cast<uint64_t>(data) >= size) {
+            return true;
+        }
+        if (!copyRange(in, data, out, data, hole - data)) {
+            return false;
+        }
+        stats.bytesCopied += hole - data;
+        offset = hole;
+    }
+    return true;
+}
+
+bool readIndexHeader(int fd, IndexHeader &header) {
+    uint8_t raw[kIndexHeaderSize];
+    if (!preadAll(fd, raw, sizeof(raw), 0) || memcmp(raw, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+        load32(raw + 4) != kBlock) {
+        return false;
+    }
+    header.imageSize = load64(raw + 8);
+    header.mtimeSeconds = static_cast<int64_t>(load64(raw + 16));
+    header.mtimeNanos = load32(raw + 24);
+    struct stat st{};
+    return fstat(fd, &st) == 0 &&
+           static_cast<uint64_t>(st.st_size) ==
+           kIndexHeaderSize + blockCount(header.imageSize) * Sha256::kDigestSize;
+}
+
+bool writeIndexHeader(int fd, const IndexHeader &header) {
+    uint8_t raw[kIndexHeaderSize] = {};
+    memcpy(raw, kIndexMagic, sizeof(kIndexMagic));
+    store32(raw + 4, kBlock);
+    store64(raw + 8, header.imageSize);
+    store64(raw + 16, static_cast<uint64_t>(header.mtimeSeconds));
+    store32(raw + 24, header.mtimeNanos);
+    return pwriteAll(fd, raw, sizeof(raw), 0);
+}
+
+// Whether `index` describes the image as it is now.
+bool indexMatches(int index, int image) {
+    IndexHeader header;
+    struct stat st{};
+    return readIndexHeader(index, header) && fstat(image, &st) == 0 &&
+           header.imageSize == static_cast<uint64_t>(st.st_size) &&
+           header.mtimeSeconds == st.st_mtim.tv_sec &&
+           header.mtimeNanos == static_cast<uint32_t>(st.st_mtim.tv_nsec);
+}
+
+// Hashes blocks [first, last) of `image` into `index`, in parallel. Digests of each batch
+// are cached in `cache` under a fast key of its content, so data seen before, e.g. the
+// unchanged bulk of a similar image, costs a fast hash instead of SHA-256.
+void rehash(int image, uint64_t imageSize, int index, uint64_t first, uint64_t last,
+            BlockStore *cache, TaskGroup &group, std::atomic<bool> &failed) {
+    for (uint64_t batch = first; batch < last; batch += kHashBatch) {
+        const uint64_t end = std::min(last, batch + kHashBatch);
+        group.run([=, &failed] {
+            if (failed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const uint64_t offset = batch * kBlock;
+            const size_t length = static_cast<size_t>(std::min(imageSize, end * kBlock) - offset);
+            const size_t count = static_cast<size_t>(end - batch);
+            std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
+            std::unique_ptr<uint8_t[]> digests(new uint8_t[count * Sha256::kDigestSize]);
+            if (!preadAll(image, data.get(), length, offset)) {
+                failed = true;
+                return;
+            }
+            const size_t digestBytes = count * Sha256::kDigestSize;
+            const ContentKey key = contentKey(data.get(), length, kDigestDomain);
+            size_t cached = 0;
+            if (cache == nullptr || !cache->read(key, digests.get(), digestBytes, &cached) ||
+                cached != digestBytes) {
+                for (size_t i = 0; i < count; ++i) {
+                    const uint64_t size = std::min<uint64_t>(kBlock, length - i * kBlock);
+                    Sha256::hash(data.get() + i * kBlock, static_cast<size_t>(size),
+                                 digests.get() + i * Sha256::kDigestSize);
+                }
+                if (cache != nullptr) {
+                    cache->put(key, digests.get(), digestBytes);
+                }
+            }
+            if (!pwriteAll(index, digests.get(), digestBytes,
+                           kIndexHeaderSize + batch * Sha256::kDigestSize)) {
+                failed = true;
+            }
+        });
+    }
+}
+
+// Rebuilds `index` to describe all of `image`. The header goes last, so an index left
+// behind by a failure is never taken for current.
+bool writeIndex(int image, int index, WorkStealingPool &pool, BlockStore *cache,
+                uint64_t &rehashed) {
+    struct stat st{};
+    uint8_t cleared[sizeof(kIndexMagic)] = {};
+    if (fstat(image, &st) != 0 || !pwriteAll(index, cleared, sizeof(cleared), 0)) {
+        return false;
+    }
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    const uint64_t blocks = blockCount(size);
+    if (ftruncate(index, static_cast<off_t>(kIndexHeaderSize +
+                                            blocks * Sha256::kDigestSize)) != 0) {
+        return false;
+    }
+    std::atomic<bool> failed{false};
+    {
+        TaskGroup group(pool);
+        rehash(image, size, index, 0, blocks, cache, group, failed);
+    }
+    if (failed.load()) {
+        return false;
+    }
+    rehashed += blocks;
+    const IndexHeader header{size, st.st_mtim.tv_sec, static_cast<uint32_t>(st.st_mtim.tv_nsec)};
+    return writeIndexHeader(index, header);
+}
+
+bool decodeBase64(std::string_view text, std::string &out) {
+    out.clear();
+    uint32_t bits = 0;
+    int count = 0;
+    size_t padding = 0;
+    for (const char c: text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') {
+            value = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            value = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            value = c - '0' + 52;
+        } else if (c == '+' || c == '-') {
+            value = 62;
+        } else if (c == '/' || c == '_') {
+            value = 63;
+        } else if (c == '=') {
+            ++padding;
+            continue;
+        } else if (c == '\n' || c == '\r') {
+            continue;
+        } else {
+            return false;
+        }
+        if (padding > 0) {
+            return false;
+        }
+        bits = (bits << 6) | value;
+        if (++count == 4) {
+            out += static_cast<char>(bits >> 16);
+            out += static_cast<char>(bits >> 8);
+            out += static_cast<char>(bits);
+            bits = 0;
+            count = 0;
+        }
+    }
+    if (count == 1 || padding > 2) {
+        return false;
+    }
+    if (count == 2) {
+        out += static_cast<char>(bits >> 4);
+    } else if (count == 3) {
+        out += static_cast<char>(bits >> 10);
+        out += static_cast<char>(bits >> 2);
+    }
+    return true;
+}
+
+bool parsePatch(const JsonValue &json, RomPatch &patch) {
+    const JsonValue *offset = json.find("offset");
+    const JsonValue *length = json.find("length");
+    const JsonValue *data = json.find("data");
+    const JsonValue *fill = json.find("fill");
+    const JsonValue *file = json.find("file");
+    if (offset == nullptr || !offset->asUnsigned(patch.offset)) {
+        return false;
+    }
+    if (length != nullptr) {
+        uint64_t value;
+        if (!length->asUnsigned(value)) {
+            return false;
+        }
+        patch.length = value;
+    }
+    if ((data != nullptr) + (fill != nullptr) + (file != nullptr) != 1) {
+        return false;
+    }
+    if (data != nullptr) {
+        patch.kind = RomPatch::Kind::Data;
+        return data->isString() && decodeBase64(data->string(), patch.data) &&
+               (!patch.length || *patch.length == patch.data.size());
+    }
+    if (fill != nullptr) {
+        uint64_t value;
+        patch.kind = RomPatch::Kind::Fill;
+        if (!fill->asUnsigned(value) || value > 0xff || !patch.length) {
+            return false;
+        }
+        patch.fill = static_cast<uint8_t>(value);
+        return true;
+    }
+    patch.kind = RomPatch::Kind::File;
+    patch.source = file->isString() ? file->string() : std::string();
+    return !patch.source.empty();
+}
+
+// Applies a patch to `fd` and returns the number of bytes written, or -1 on failure.
+int64_t applyPatch(int fd, const RomPatch &patch) {
+    switch (patch.kind) {
+        case RomPatch::Kind::Data:
+            return pwriteAll(fd, reinterpret_cast<const uint8_t *>(patch.data.data()),
+                             patch.data.size(), patch.offset)
+                   ? static_cast<int64_t>(patch.data.size()) : -1;
+        case RomPatch::Kind::Fill: {
+            const uint64_t length = *patch.length;
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(length, kFillBufferSize));
+            std::unique_ptr<uint8_t[]> buffer(new uint8_t[chunk]);
+            memset(buffer.get(), patch.fill, chunk);
+            for (uint64_t done = 0; done < length; done += chunk) {
+                const size_t size = static_cast<size_t>(std::min<uint64_t>(chunk, length - done));
+                if (!pwriteAll(fd, buffer.get(), size, patch.offset + done)) {
+                    return -1;
+                }
+            }
+            return static_cast<int64_t>(length);
+        }
+        case RomPatch::Kind::File: {
+            ScopedFd source(open(patch.source.c_str(), O_RDONLY | O_CLOEXEC));
+            struct stat st{};
+            if (source.get() < 0 || fstat(source.get(), &st) != 0) {
+                LOGE("Cannot open patch source %s", patch.source.c_str());
+                return -1;
+            }
+            const uint64_t length = patch.length.value_or(static_cast<uint64_t>(st.st_size));
+            if (length > static_cast<uint64_t>(st.st_size) ||
+                !copyRange(source.get(), 0, fd, patch.offset, length)) {
+                return -1;
+            }
+            return static_cast<int64_t>(length);
+        }
+    }
+    return -1;
+}
+
+// Bytes a patch covers in the output, once its source size is known.
+bool patchExtent(const RomPatch &patch, uint64_t &length) {
+    if (patch.kind == RomPatch::Kind::Data) {
+        length = patch.data.size();
+        return true;
+    }
+    if (patch.length) {
+        length = *patch.length;
+        return true;
+    }
+    struct stat st{};
+    if (stat(patch.source.c_str(), &st) != 0) {
+        return false;
+    }
+    length = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+} // namespace
+
+bool RomModifications::parse(std::string_view json, RomModifications &out) {
+    out = {};
+    JsonValue root;
+    if (!JsonValue::parse(json, root) || !root.isObject()) {
+        return false;
+    }
+    if (const JsonValue *size = root.find("size"); size != nullptr) {
+        uint64_t value;
+        if (!size->asUnsigned(value)) {
+            return false;
+        }
+        out.size = value;
+    }
+    const JsonValue *patches = root.find("patches");
+    if (patches == nullptr) {
+        return true;
+    }
+    if (!patches->isArray()) {
+        return false;
+    }
+    for (const JsonValue &item: patches->items()) {
+        RomPatch patch;
+        if (!item.isObject() || !parsePatch(item, patch)) {
+            return false;
+        }
+        out.patches.push_back(std::move(patch));
+    }
+    return true;
+}
+
+std::string DeltaRomBuilder::hashIndexPath(std::string_view imagePath) {
+    return std::string(imagePath) + ".blockhashes";
+}
+
+bool DeltaRomBuilder::build(const char *basePath, const RomModifications &modifications,
+                            const char *outputPath, WorkStealingPool &pool, BlockStore *cache,
+                            RomBuildStats *stats) {
+    RomBuildStats local;
+    RomBuildStats &result = stats != nullptr ? *stats : local;
+    result = {};
+
+    ScopedFd base(open(basePath, O_RDONLY | O_CLOEXEC));
+    struct stat baseStat{}, outputStat{};
+    if (base.get() < 0 || fstat(base.get(), &baseStat) != 0 || !S_ISREG(baseStat.st_mode)) {
+        LOGE("Cannot open base image %s", basePath);
+        return false;
+    }
+    const uint64_t baseSize = static_cast<uint64_t>(baseStat.st_size);
+    const uint64_t outputSize = modifications.size.value_or(baseSize);
+
+    // Validate every patch before touching the output.
+    std::vector<std::pair<uint64_t, uint64_t>> touched;
+    for (const RomPatch &patch: modifications.patches) {
+        uint64_t length;
+        if (!patchExtent(patch, length) || patch.offset > outputSize ||
+            length > outputSize - patch.offset) {
+            LOGE("Patch at offset %llu does not fit the %llu-byte image",
+                 static_cast<unsigned long long>(patch.offset),
+                 static_cast<unsigned long long>(outputSize));
+            return false;
+        }
+        if (length > 0) {
+            touched.emplace_back(patch.offset / kBlock, blockCount(patch.offset + length));
+        }
+    }
+
+    result.inPlace = stat(outputPath, &outputStat) == 0 && outputStat.st_dev == baseStat.st_dev &&
+                     outputStat.st_ino == baseStat.st_ino;
+    const std::string baseIndexPath = hashIndexPath(basePath);
+    const std::string outputIndexPath = hashIndexPath(outputPath);
+
+    ScopedFd output(result.inPlace
+                    ? open(outputPath, O_RDWR | O_CLOEXEC)
+                    : open(outputPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (output.get() < 0) {
+        LOGE("Cannot open output image %s", outputPath);
+        return false;
+    }
+
+    // The output's index starts as the base's, so only blocks touched below need hashing.
+    // A missing or stale base index is rebuilt first, which makes this and every later build
+    // from the same base incremental; if it cannot be written, the output is hashed in full.
+    const int indexFlags = O_RDWR | O_CREAT | O_CLOEXEC | (result.inPlace ? 0 : O_TRUNC);
+    ScopedFd index(open(outputIndexPath.c_str(), indexFlags, 0644));
+    bool indexValid = false;
+    if (result.inPlace) {
+        indexValid = index.get() >= 0 && indexMatches(index.get(), base.get());
+    } else if (index.get() >= 0) {
+        int baseIndexFd = open(baseIndexPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (baseIndexFd < 0) {
+            baseIndexFd = open(baseIndexPath.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        ScopedFd baseIndex(baseIndexFd);
+        struct stat st{};
+        RomBuildStats ignored;
+        indexValid = baseIndex.get() >= 0 &&
+                     (indexMatches(baseIndex.get(), base.get()) ||
+                      writeIndex(base.get(), baseIndex.get(), pool, cache,
+                                 result.blocksRehashed)) &&
+                     fstat(baseIndex.get(), &st) == 0 &&
+                     cloneFile(baseIndex.get(), index.get(), static_cast<uint64_t>(st.st_size),
+                               ignored);
+    }
+    if (index.get() < 0) {
+        LOGE("Cannot open block hash index %s", outputIndexPath.c_str());
+        return false;
+    }
+    // Invalidate the index while the image and it disagree.
+    uint8_t cleared[sizeof(kIndexMagic)] = {};
+    if (!pwriteAll(index.get(), cleared, sizeof(cleared), 0)) {
+        return false;
+    }
+
+    if (!result.inPlace &&
+        !cloneFile(base.get(), output.get(), std::min(baseSize, outputSize), result)) {
+        LOGE("Cannot copy %s to %s", basePath, outputPath);
+        return false;
+    }
+    if (outputSize != baseSize && ftruncate(output.get(), static_cast<off_t>(outputSize)) != 0) {
+        return false;
+    }
+    for (const RomPatch &patch: modifications.patches) {
+        const int64_t written = applyPatch(output.get(), patch);
+        if (written < 0) {
+            LOGE("Cannot apply patch at offset %llu",
+                 static_cast<unsigned long long>(patch.offset));
+            return false;
+        }
+        result.bytesPatched += written;
+    }
+
+    // Blocks whose hashes may have changed: patched ones, and the block straddling the old
+    // end plus any new blocks after a resize.
+    const uint64_t blocks = blockCount(outputSize);
+    if (!indexValid) {
+        touched.assign(1, {0, blocks});
+    } else if (outputSize != baseSize) {
+        touched.emplace_back(std::min(baseSize, outputSize) / kBlock, blocks);
+    }
+    std::sort(touched.begin(), touched.end());
+    if (ftruncate(index.get(), static_cast<off_t>(kIndexHeaderSize +
+                                                   blocks * Sha256::kDigestSize)) != 0) {
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+    {
+        TaskGroup group(pool);
+        uint64_t next = 0;
+        for (const auto &[first, last]: touched) {
+            const uint64_t from = std::max(first, next);
+            const uint64_t to = std::min(last, blocks);
+            if (from < to) {
+                rehash(output.get(), outputSize, index.get(), from, to, cache, group, failed);
+                result.blocksRehashed += to - from;
+            }
+            next = std::max(next, to);
+        }
+    }
+    if (failed.load()) {
+        LOGE("Cannot hash %s", outputPath);
+        return false;
+    }
+
+    if (fstat(output.get(), &outputStat) != 0) {
+        return false;
+    }
+    const IndexHeader header{outputSize, outputStat.st_mtim.tv_sec,
+                             static_cast<uint32_t>(outputStat.st_mtim.tv_nsec)};
+    return writeIndexHeader(index.get(), header);
+}
+
+} // namespace genesis::oracle
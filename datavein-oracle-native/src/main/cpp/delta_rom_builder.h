@@ -0,0 +1,96 @@
+#ifndef DELTA_ROM_BUILDER_H
+#define DELTA_ROM_BUILDER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace genesis::oracle {
+
+class BlockStore;
+
+class WorkStealingPool;
+
+/**
+ * @brief One change to apply to a raw image.
+ */
+struct RomPatch {
+    enum class Kind {
+        // Write `data` at `offset`.
+        Data,
+        // Write `length` copies of `fill` at `offset`.
+        Fill,
+        // Copy `length` bytes of the file at `source` (all of it when length is absent) to
+        // `offset`.
+        File,
+    };
+
+    Kind kind = Kind::Data;
+    uint64_t offset = 0;
+    std::optional<uint64_t> length;
+    std::string data;
+    std::string source;
+    uint8_t fill = 0;
+};
+
+/**
+ * @brief Modifications passed to createCustomRom:
+ *
+ *     {"size": 1073741824,
+ *      "patches": [{"offset": 4096, "data": "<base64>"},
+ *                  {"offset": 8192, "length": 4096, "fill": 0},
+ *                  {"offset": 65536, "file": "/data/local/tmp/new_init.rc"}]}
+ *
+ * `size` is optional and resizes the image. Patches are applied in order, so later ones win
+ * where they overlap.
+ */
+struct RomModifications {
+    std::optional<uint64_t> size;
+    std::vector<RomPatch> patches;
+
+    static bool parse(std::string_view json, RomModifications &out);
+};
+
+struct RomBuildStats {
+    // The output shares the base's extents (FICLONE) instead of holding a copy.
+    bool reflinked = false;
+    bool inPlace = false;
+    uint64_t bytesCopied = 0;
+    uint64_t bytesPatched = 0;
+    uint64_t blocksRehashed = 0;
+};
+
+/**
+ * @brief Builds a modified image as a block-level delta on top of a base image.
+ *
+ * The base is reflinked into the output where the filesystem supports it, and otherwise
+ * copied with copy_file_range() over its data extents only, so holes stay holes and the
+ * kernel can share or offload the copy. Only the patched ranges are then written.
+ *
+ * Every image gets a block hash index, `<image>.blockhashes`: SHA-256 of each 4 KiB block
+ * behind a header recording the image size and mtime it describes. The output's index is
+ * cloned from the base's and only blocks touched by patches (or uncovered by a resize) are
+ * rehashed. A missing or stale base index is written first, so only the first build from a
+ * base hashes all of it; where it cannot be written, the output is hashed in full instead.
+ * Building with the output path equal to the base patches the image in place.
+ */
+class DeltaRomBuilder {
+public:
+    static constexpr uint32_t kHashBlockSize = 4096;
+
+    static std::string hashIndexPath(std::string_view imagePath);
+
+    /**
+     * @param cache Optional store for block digests, so rehashing content it has seen
+     *              before is cheap.
+     */
+    static bool build(const char *basePath, const RomModifications &modifications,
+                      const char *outputPath, WorkStealingPool &pool, BlockStore *cache,
+                      RomBuildStats *stats);
+};
+
+} // namespace genesis::oracle
+
+#endif // DELTA_ROM_BUILDER_H
@@ -0,0 +1,79 @@
+#include "file_io.h"
+
+#include <cerrno>
+#include <memory>
+#include <unistd.h>
+
+namespace genesis::oracle {
+namespace {
+
+constexpr size_t kCopyBufferSize = 1024 * 1024;
+
+} // namespace
+
+bool preadAll(int fd, uint8_t *data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        const ssize_t n = pread(fd, data, length, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool pwriteAll(int fd, const uint8_t *data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        const ssize_t n = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool copyRange(int in, uint64_t inOffset, int out, uint64_t outOffset, uint64_t length) {
+    while (length > 0) {
+        off64_t from = static_cast<off64_t>(inOffset);
+        off64_t to = static_cast<off64_t>(outOffset);
+        const size_t chunk = static_cast<size_t>(length < (1u << 30) ? length : (1u << 30));
+        const ssize_t n = copy_file_range(in, &from, out, &to, chunk, 0);
+        if (n == 0) {
+            return false;  // `in` ended before the whole range was copied
+        }
+        if (n < 0) {
+            if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP) {
+                return false;
+            }
+            break;
+        }
+        inOffset += n;
+        outOffset += n;
+        length -= n;
+    }
+
+    std::unique_ptr<uint8_t[]> buffer;
+    while (length > 0) {
+        if (buffer == nullptr) {
+            buffer.reset(new uint8_t[kCopyBufferSize]);
+        }
+        const size_t chunk = static_cast<size_t>(length < kCopyBufferSize ? length
+                                                                          : kCopyBufferSize);
+        const ssize_t n = pread(in, buffer.get(), chunk, static_cast<off_t>(inOffset));
+        // n == 0: `in` ended before the whole range was copied.
+        if (n <= 0 || !pwriteAll(out, buffer.get(), n, outOffset)) {
+            return false;
+        }
+        inOffset += n;
+        outOffset += n;
+        length -= n;
+    }
+    return true;
+}
+
+} // namespace genesis::oracle
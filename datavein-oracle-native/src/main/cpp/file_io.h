@@ -0,0 +1,30 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::oracle {
+
+/**
+ * @brief pread() until `length` bytes are read. Fails on error or early end of file.
+ */
+bool preadAll(int fd, uint8_t *data, size_t length, uint64_t offset);
+
+/**
+ * @brief pwrite() until `length` bytes are written.
+ */
+bool pwriteAll(int fd, const uint8_t *data, size_t length, uint64_t offset);
+
+/**
+ * @brief Copies a range between files, in the kernel where it can (copy_file_range() may
+ * share extents or offload the copy), through a buffer where it cannot, e.g. across
+ * filesystems.
+ *
+ * @return false on an I/O error, or if `in` ends before `length` bytes were copied.
+ */
+bool copyRange(int in, uint64_t inOffset, int out, uint64_t outOffset, uint64_t length);
+
+} // namespace genesis::oracle
+
+#endif // FILE_IO_H
@@ -0,0 +1,708 @@
+#include "gzip_decoder.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "checksum.h"
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+namespace {
+
+constexpr unsigned kRootBits = 10;
+constexpr uint32_t kRootMask = (1u << kRootBits) - 1;
+constexpr uint32_t kLinkFlag = 1u << 24;
+constexpr unsigned kMaxCodeLength = 15;
+constexpr size_t kWindowSize = 32 * 1024;
+constexpr size_t kStreamChunk = 256 * 1024;
+
+constexpr uint8_t kFlagHeaderCrc = 0x02;
+constexpr uint8_t kFlagExtra = 0x04;
+constexpr uint8_t kFlagName = 0x08;
+constexpr uint8_t kFlagComment = 0x10;
+
+constexpr uint16_t kLengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+constexpr uint8_t kLengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+constexpr uint16_t kDistanceBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+constexpr uint8_t kDistanceExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+constexpr uint8_t kCodeLengthOrder[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t le64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+unsigned reverseBits(unsigned code, unsigned length) {
+    unsigned reversed = 0;
+    for (unsigned i = 0; i < length; ++i, code >>= 1) {
+        reversed = (reversed << 1) | (code & 1);
+    }
+    return reversed;
+}
+
+inline void copyMatch(uint8_t *out, size_t &pos, unsigned distance, unsigned length) {
+    const uint8_t *source = out + pos - distance;
+    uint8_t *target = out + pos;
+    if (distance >= length) {
+        memcpy(target, source, length);
+    } else {
+        // Overlapping copy repeats the last `distance` bytes.
+        for (unsigned i = 0; i < length; ++i) {
+            target[i] = source[i];
+        }
+    }
+    pos += length;
+}
+
+bool skipBytes(Inflater &inflater, size_t length) {
+    uint8_t scratch[256];
+    while (length > 0) {
+        const size_t now = length < sizeof(scratch) ? length : sizeof(scratch);
+        if (!inflater.readBytes(scratch, now)) {
+            return false;
+        }
+        length -= now;
+    }
+    return true;
+}
+
+bool skipString(Inflater &inflater) {
+    uint8_t c;
+    do {
+        if (!inflater.readBytes(&c, 1)) {
+            return false;
+        }
+    } while (c != 0);
+    return true;
+}
+
+bool readGzipHeader(Inflater &inflater) {
+    uint8_t header[10];
+    if (!inflater.readBytes(header, sizeof(header)) || header[0] != 0x1f || header[1] != 0x8b ||
+        header[2] != 8 || (header[3] & 0xe0) != 0) {
+        return false;
+    }
+    const uint8_t flags = header[3];
+    if (flags & kFlagExtra) {
+        uint8_t length[2];
+        if (!inflater.readBytes(length, 2) || !skipBytes(inflater, length[0] | (length[1] << 8))) {
+            return false;
+        }
+    }
+    return (!(flags & kFlagName) || skipString(inflater)) &&
+           (!(flags & kFlagComment) || skipString(inflater)) &&
+           (!(flags & kFlagHeaderCrc) || skipBytes(inflater, 2));
+}
+
+bool checkTrailer(Inflater &inflater, uint32_t crc, uint64_t size) {
+    uint8_t trailer[8];
+    return inflater.readBytes(trailer, sizeof(trailer)) && le32(trailer) == crc &&
+           le32(trailer + 4) == static_cast<uint32_t>(size);
+}
+
+struct BgzfMember {
+    size_t offset;
+    size_t length;
+    uint32_t size;
+};
+
+// Splits a BGZF file into its members using the "BC" extra subfield each one carries.
+bool scanBgzf(const uint8_t *in, size_t inLength, std::vector<BgzfMember> &members) {
+    size_t pos = 0;
+    while (pos < inLength) {
+        const uint8_t *p = in + pos;
+        if (inLength - pos < 18 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 ||
+            !(p[3] & kFlagExtra)) {
+            return false;
+        }
+        const size_t extraLength = p[10] | (p[11] << 8);
+        if (inLength - pos < 12 + extraLength) {
+            return false;
+        }
+        size_t blockSize = 0;
+        for (size_t field = 12; field + 4 <= 12 + extraLength;) {
+            const size_t fieldLength = p[field + 2] | (p[field + 3] << 8);
+            if (p[field] == 'B' && p[field + 1] == 'C' && fieldLength == 2 &&
+                field + 6 <= 12 + extraLength) {
+                blockSize = (p[field + 4] | (p[field + 5] << 8)) + size_t{1};
+            }
+            field += 4 + fieldLength;
+        }
+        if (blockSize < 12 + extraLength + 8 || blockSize > inLength - pos) {
+            return false;
+        }
+        members.push_back({pos, blockSize, le32(p + blockSize - 4)});
+        pos += blockSize;
+    }
+    return !members.empty();
+}
+
+class GzipStream : public DecompressStream {
+public:
+    explicit GzipStream(Source source) : DecompressStream(std::move(source)) {
+        setHistory(kWindowSize);
+        inflater_.reset(nullptr, 0, [this](const uint8_t *&next, const uint8_t *&end) {
+            // The previous span was handed out whole; take the next one.
+            consumeInput(inputAvailable());
+            if (!fillInput(1)) {
+                return false;
+            }
+            next = input();
+            end = next + inputAvailable();
+            return true;
+        });
+    }
+
+protected:
+    bool produce() override {
+        switch (phase_) {
+            case Phase::Header:
+                if (!readGzipHeader(inflater_)) {
+                    // Anything after the first member that is not a member is trailing data.
+                    if (firstMember_) {
+                        return false;
+                    }
+                    finish();
+                    return true;
+                }
+                inflater_.restart();
+                crc_ = 0;
+                memberSize_ = 0;
+                phase_ = Phase::Body;
+                return true;
+            case Phase::Body: {
+                if (!reserveOutput(kStreamChunk)) {
+                    return false;
+                }
+                size_t pos = windowEnd_;
+                const Inflater::Status status = inflater_.inflate(window_.data(), pos,
+                                                                  windowEnd_ + kStreamChunk);
+                crc_ = crc32(window_.data() + windowEnd_, pos - windowEnd_, crc_);
+                memberSize_ += pos - windowEnd_;
+                windowEnd_ = pos;
+                if (status == Inflater::Status::Error) {
+                    return false;
+                }
+                if (status == Inflater::Status::Done) {
+                    phase_ = Phase::Trailer;
+                }
+                return true;
+            }
+            case Phase::Trailer:
+                if (!checkTrailer(inflater_, crc_, memberSize_)) {
+                    return false;
+                }
+                firstMember_ = false;
+                phase_ = Phase::Header;
+                if (inflater_.atEnd()) {
+                    finish();
+                }
+                return true;
+        }
+        return false;
+    }
+
+private:
+    enum class Phase {
+        Header,
+        Body,
+        Trailer,
+    };
+
+    Inflater inflater_;
+    Phase phase_ = Phase::Header;
+    bool firstMember_ = true;
+    uint32_t crc_ = 0;
+    uint64_t memberSize_ = 0;
+};
+
+} // namespace
+
+Inflater::Inflater() = default;
+
+bool Inflater::buildTable(const uint8_t *lengths, unsigned count, Table &table) {
+    unsigned lengthCount[kMaxCodeLength + 1] = {};
+    for (unsigned i = 0; i < count; ++i) {
+        ++lengthCount[lengths[i]];
+    }
+    lengthCount[0] = 0;
+    // Reject over-subscribed codes; incomplete ones are allowed and fail when an unused
+    // code is hit.
+    int left = 1;
+    for (unsigned length = 1; length <= kMaxCodeLength; ++length) {
+        left = (left << 1) - static_cast<int>(lengthCount[length]);
+        if (left < 0) {
+            return false;
+        }
+    }
+    unsigned firstCode[kMaxCodeLength + 1] = {};
+    for (unsigned length = 1, code = 0; length <= kMaxCodeLength; ++length) {
+        code = (code + lengthCount[length - 1]) << 1;
+        firstCode[length] = code;
+    }
+
+    // Size each subtable for the longest code sharing its root prefix.
+    uint8_t subBits[1u << kRootBits] = {};
+    unsigned nextCode[kMaxCodeLength + 1];
+    memcpy(nextCode, firstCode, sizeof(nextCode));
+    for (unsigned symbol = 0; symbol < count; ++symbol) {
+        const unsigned length = lengths[symbol];
+        if (length > kRootBits) {
+            const unsigned prefix = reverseBits(nextCode[length]++, length) & kRootMask;
+            if (length - kRootBits > subBits[prefix]) {
+                subBits[prefix] = static_cast<uint8_t>(length - kRootBits);
+            }
+        }
+    }
+    table.entries.assign(1u << kRootBits, 0);
+    for (unsigned prefix = 0; prefix <= kRootMask; ++prefix) {
+        if (subBits[prefix] != 0) {
+            const size_t offset = table.entries.size();
+            table.entries[prefix] = kLinkFlag | (uint32_t{subBits[prefix]} << 16) |
+                                    static_cast<uint32_t>(offset);
+            table.entries.resize(offset + (size_t{1} << subBits[prefix]), 0);
+        }
+    }
+
+    memcpy(nextCode, firstCode, sizeof(nextCode));
+    for (unsigned symbol = 0; symbol < count; ++symbol) {
+        const unsigned length = lengths[symbol];
+        if (length == 0) {
+            continue;
+        }
+        const unsigned code = reverseBits(nextCode[length]++, length);
+        const uint32_t entry = symbol | (length << 16);
+        if (length <= kRootBits) {
+            for (unsigned i = code; i <= kRootMask; i += 1u << length) {
+                table.entries[i] = entry;
+            }
+        } else {
+            const uint32_t link = table.entries[code & kRootMask];
+            const size_t offset = link & 0xffff;
+            const unsigned bits = (link >> 16) & 0xff;
+            const unsigned step = 1u << (length - kRootBits);
+            for (unsigned i = code >> kRootBits; i < (1u << bits); i += step) {
+                table.entries[offset + i] = entry;
+            }
+        }
+    }
+    return true;
+}
+
+const Inflater::Table &Inflater::fixedLiterals() {
+    static const Table table = [] {
+        uint8_t lengths[288];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        Table built;
+        buildTable(lengths, 288, built);
+        return built;
+    }();
+    return table;
+}
+
+const Inflater::Table &Inflater::fixedDistances() {
+    static const Table table = [] {
+        uint8_t lengths[30];
+        memset(lengths, 5, sizeof(lengths));
+        Table built;
+        buildTable(lengths, 30, built);
+        return built;
+    }();
+    return table;
+}
+
+void Inflater::reset(const uint8_t *in, size_t length, Refill refill) {
+    next_ = in;
+    end_ = in + length;
+    refill_ = std::move(refill);
+    bits_ = 0;
+    count_ = 0;
+    restart();
+}
+
+void Inflater::restart() {
+    state_ = State::BlockHeader;
+    finalBlock_ = false;
+    storedRemaining_ = 0;
+    pendingLength_ = 0;
+    pendingDistance_ = 0;
+}
+
+bool Inflater::refillInput() {
+    while (next_ == end_) {
+        if (!refill_ || !refill_(next_, end_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Inflater::fillAvailable() {
+    while (count_ < 56) {
+        if (end_ - next_ >= 8) {
+            const unsigned bytes = (63 - count_) / 8;
+            bits_ |= le64(next_) << count_;
+            next_ += bytes;
+            count_ += bytes * 8;
+            bits_ &= (uint64_t{1} << count_) - 1;
+            return;
+        }
+        if (next_ == end_ && !refillInput()) {
+            return;
+        }
+        bits_ |= uint64_t{*next_++} << count_;
+        count_ += 8;
+    }
+}
+
+bool Inflater::need(unsigned bits) {
+    if (count_ < bits) {
+        fillAvailable();
+    }
+    return count_ >= bits;
+}
+
+bool Inflater::peekSymbol(const Table &table, unsigned &symbol, unsigned &length) {
+    if (count_ < kMaxCodeLength) {
+        fillAvailable();
+    }
+    uint32_t entry = table.entries[bits_ & kRootMask];
+    if (entry & kLinkFlag) {
+        const unsigned bits = (entry >> 16) & 0xff;
+        entry = table.entries[(entry & 0xffff) + ((bits_ >> kRootBits) & ((1u << bits) - 1))];
+    }
+    length = (entry >> 16) & 0xff;
+    symbol = entry & 0xffff;
+    return length != 0 && length <= count_;
+}
+
+bool Inflater::decodeSymbol(const Table &table, unsigned &symbol) {
+    unsigned length;
+    if (!peekSymbol(table, symbol, length)) {
+        return false;
+    }
+    bits_ >>= length;
+    count_ -= length;
+    return true;
+}
+
+bool Inflater::readBytes(uint8_t *out, size_t length) {
+    take(count_ % 8);
+    while (length > 0 && count_ >= 8) {
+        *out++ = static_cast<uint8_t>(take(8));
+        --length;
+    }
+    while (length > 0) {
+        if (next_ == end_ && !refillInput()) {
+            return false;
+        }
+        const size_t now = std::min<size_t>(length, end_ - next_);
+        memcpy(out, next_, now);
+        out += now;
+        next_ += now;
+        length -= now;
+    }
+    return true;
+}
+
+bool Inflater::atEnd() {
+    return count_ < 8 && next_ == end_ && !refillInput();
+}
+
+bool Inflater::readBlockHeader() {
+    if (!need(3)) {
+        return false;
+    }
+    finalBlock_ = take(1) != 0;
+    switch (take(2)) {
+        case 0: {
+            take(count_ % 8);
+            if (!need(32)) {
+                return false;
+            }
+            const uint32_t length = take(16);
+            if ((take(16) ^ 0xffff) != length) {
+                return false;
+            }
+            storedRemaining_ = length;
+            state_ = State::Stored;
+            return true;
+        }
+        case 1:
+            literals_ = &fixedLiterals();
+            distances_ = &fixedDistances();
+            state_ = State::Huffman;
+            return true;
+        case 2:
+            if (!readDynamicTables()) {
+                return false;
+            }
+            literals_ = &dynamicLiterals_;
+            distances_ = &dynamicDistances_;
+            state_ = State::Huffman;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool Inflater::readDynamicTables() {
+    if (!need(14)) {
+        return false;
+    }
+    const unsigned literalCount = take(5) + 257;
+    const unsigned distanceCount = take(5) + 1;
+    const unsigned codeLengthCount = take(4) + 4;
+    if (literalCount > 286 || distanceCount > 30) {
+        return false;
+    }
+    uint8_t codeLengthLengths[19] = {};
+    for (unsigned i = 0; i < codeLengthCount; ++i) {
+        if (!need(3)) {
+            return false;
+        }
+        codeLengthLengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(take(3));
+    }
+    Table codeLengths;
+    if (!buildTable(codeLengthLengths, 19, codeLengths)) {
+        return false;
+    }
+
+    uint8_t lengths[286 + 30];
+    const unsigned total = literalCount + distanceCount;
+    for (unsigned i = 0; i < total;) {
+        unsigned symbol;
+        if (!decodeSymbol(codeLengths, symbol)) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[i++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        unsigned repeat;
+        uint8_t value = 0;
+        if (symbol == 16) {
+            if (i == 0 || !need(2)) {
+                return false;
+            }
+            value = lengths[i - 1];
+            repeat = 3 + take(2);
+        } else if (symbol == 17) {
+            if (!need(3)) {
+                return false;
+            }
+            repeat = 3 + take(3);
+        } else {
+            if (!need(7)) {
+                return false;
+            }
+            repeat = 11 + take(7);
+        }
+        if (repeat > total - i) {
+            return false;
+        }
+        memset(lengths + i, value, repeat);
+        i += repeat;
+    }
+    // The end-of-block code must be decodable.
+    return lengths[256] != 0 && buildTable(lengths, literalCount, dynamicLiterals_) &&
+           buildTable(lengths + literalCount, distanceCount, dynamicDistances_);
+}
+
+Inflater::Status Inflater::inflateHuffman(uint8_t *out, size_t &pos, size_t limit) {
+    if (pendingLength_ > 0) {
+        const unsigned now = static_cast<unsigned>(std::min<size_t>(pendingLength_, limit - pos));
+        copyMatch(out, pos, pendingDistance_, now);
+        pendingLength_ -= now;
+        if (pendingLength_ > 0) {
+            return Status::NeedSpace;
+        }
+    }
+    for (;;) {
+        unsigned symbol;
+        if (pos == limit) {
+            // Only the end of the block fits; anything else waits for more room.
+            unsigned length;
+            if (!peekSymbol(*literals_, symbol, length)) {
+                return Status::Error;
+            }
+            if (symbol != 256) {
+                return Status::NeedSpace;
+            }
+        }
+        if (!decodeSymbol(*literals_, symbol)) {
+            return Status::Error;
+        }
+        if (symbol < 256) {
+            out[pos++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        if (symbol == 256) {
+            // End of block.
+            return Status::Done;
+        }
+        symbol -= 257;
+        if (symbol >= 29 || !need(kLengthExtra[symbol])) {
+            return Status::Error;
+        }
+        const unsigned length = kLengthBase[symbol] + take(kLengthExtra[symbol]);
+        if (!decodeSymbol(*distances_, symbol) || symbol >= 30 ||
+            !need(kDistanceExtra[symbol])) {
+            return Status::Error;
+        }
+        const unsigned distance = kDistanceBase[symbol] + take(kDistanceExtra[symbol]);
+        if (distance > pos) {
+            return Status::Error;
+        }
+        const unsigned now = static_cast<unsigned>(std::min<size_t>(length, limit - pos));
+        copyMatch(out, pos, distance, now);
+        if (now < length) {
+            pendingLength_ = length - now;
+            pendingDistance_ = distance;
+            return Status::NeedSpace;
+        }
+    }
+}
+
+Inflater::Status Inflater::inflate(uint8_t *out, size_t &pos, size_t limit) {
+    for (;;) {
+        switch (state_) {
+            case State::BlockHeader:
+                if (finalBlock_) {
+                    state_ = State::Done;
+                } else if (!readBlockHeader()) {
+                    return Status::Error;
+                }
+                break;
+            case State::Stored:
+                while (storedRemaining_ > 0) {
+                    if (pos == limit) {
+                        return Status::NeedSpace;
+                    }
+                    if (count_ >= 8) {
+                        out[pos++] = static_cast<uint8_t>(take(8));
+                        --storedRemaining_;
+                        continue;
+                    }
+                    if (next_ == end_ && !refillInput()) {
+                        return Status::Error;
+                    }
+                    const size_t now = std::min({storedRemaining_, limit - pos,
+                                                 static_cast<size_t>(end_ - next_)});
+                    memcpy(out + pos, next_, now);
+                    next_ += now;
+                    pos += now;
+                    storedRemaining_ -= now;
+                }
+                state_ = State::BlockHeader;
+                break;
+            case State::Huffman: {
+                const Status status = inflateHuffman(out, pos, limit);
+                if (status != Status::Done) {
+                    return status;
+                }
+                state_ = State::BlockHeader;
+                break;
+            }
+            case State::Done:
+                return Status::Done;
+        }
+    }
+}
+
+bool GzipDecoder::decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                         size_t *outLength, WorkStealingPool *pool) {
+    std::vector<BgzfMember> members;
+    if (pool != nullptr && scanBgzf(in, inLength, members) && members.size() > 1) {
+        std::vector<size_t> offsets(members.size());
+        size_t total = 0;
+        for (size_t i = 0; i < members.size(); ++i) {
+            offsets[i] = total;
+            total += members[i].size;
+        }
+        if (total > outCapacity) {
+            return false;
+        }
+        std::atomic<bool> ok{true};
+        TaskGroup group(*pool);
+        for (size_t i = 0; i < members.size(); ++i) {
+            group.run([&, i] {
+                const BgzfMember &member = members[i];
+                uint8_t *target = out + offsets[i];
+                Inflater inflater;
+                inflater.reset(in + member.offset, member.length);
+                size_t pos = 0;
+                if (!readGzipHeader(inflater) ||
+                    inflater.inflate(target, pos, member.size) != Inflater::Status::Done ||
+                    !checkTrailer(inflater, crc32(target, pos), pos)) {
+                    ok.store(false, std::memory_order_relaxed);
+                }
+            });
+        }
+        group.wait();
+        if (outLength != nullptr) {
+            *outLength = total;
+        }
+        return ok.load();
+    }
+
+    Inflater inflater;
+    inflater.reset(in, inLength);
+    size_t pos = 0;
+    do {
+        const size_t start = pos;
+        if (!readGzipHeader(inflater)) {
+            return false;
+        }
+        inflater.restart();
+        if (inflater.inflate(out, pos, outCapacity) != Inflater::Status::Done ||
+            !checkTrailer(inflater, crc32(out + start, pos - start), pos - start)) {
+            return false;
+        }
+    } while (in + inLength - inflater.position() >= 2 && inflater.position()[0] == 0x1f &&
+             inflater.position()[1] == 0x8b);
+    if (outLength != nullptr) {
+        *outLength = pos;
+    }
+    return true;
+}
+
+bool GzipDecoder::contentSize(const uint8_t *in, size_t inLength, uint64_t &size) {
+    std::vector<BgzfMember> members;
+    if (!scanBgzf(in, inLength, members)) {
+        return false;
+    }
+    size = 0;
+    for (const BgzfMember &member: members) {
+        size += member.size;
+    }
+    return true;
+}
+
+std::unique_ptr<DecompressStream> GzipDecoder::openStream(DecompressStream::Source source) {
+    return std::make_unique<GzipStream>(std::move(source));
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,167 @@
+#ifndef GZIP_DECODER_H
+#define GZIP_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "decompressor.h"
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief Resumable raw DEFLATE (RFC 1951) decoder.
+ *
+ * Output goes to a caller buffer whose bytes before the write position are the history that
+ * matches copy from. Decoding pauses when the buffer is full and resumes where it stopped,
+ * so a stream can decode through a sliding window. Input comes from a span and, once that is
+ * used up, from an optional refill callback.
+ */
+class Inflater {
+public:
+    enum class Status {
+        // The final block has been decoded.
+        Done,
+        // Output reached `limit`; call again with more room.
+        NeedSpace,
+        Error,
+    };
+
+    /**
+     * @brief Replaces `next`/`end` with the next span of input, or returns false at the end
+     * of the input.
+     */
+    using Refill = std::function<bool(const uint8_t *&next, const uint8_t *&end)>;
+
+    Inflater();
+
+    /**
+     * @brief Starts a new DEFLATE stream. Bytes still buffered from the previous input are
+     * discarded.
+     */
+    void reset(const uint8_t *in, size_t length, Refill refill = nullptr);
+
+    /**
+     * @brief Starts a new DEFLATE stream on the current input, e.g. the next gzip member.
+     */
+    void restart();
+
+    /**
+     * @brief Decodes into out[pos, limit), advancing `pos`. Matches may reach back to
+     * out[0].
+     */
+    Status inflate(uint8_t *out, size_t &pos, size_t limit);
+
+    /**
+     * @brief Reads whole bytes from the input, starting at the next byte boundary. For the
+     * framing around DEFLATE data.
+     */
+    bool readBytes(uint8_t *out, size_t length);
+
+    /**
+     * @brief Whether any input is left.
+     */
+    bool atEnd();
+
+    /**
+     * @brief First input byte not yet consumed, at a byte boundary. Meaningful only for
+     * input given as a single span.
+     */
+    const uint8_t *position() const { return next_ - count_ / 8; }
+
+private:
+    /**
+     * @brief Two-level Huffman decoding table: a root indexed by the next kRootBits input
+     * bits, whose entries either give a symbol and its code length or link to a subtable
+     * for longer codes.
+     */
+    struct Table {
+        std::vector<uint32_t> entries;
+    };
+
+    enum class State {
+        BlockHeader,
+        Stored,
+        Huffman,
+        Done,
+    };
+
+    bool refillInput();
+
+    bool need(unsigned bits);
+
+    void fillAvailable();
+
+    uint32_t take(unsigned bits) {
+        const uint32_t value = static_cast<uint32_t>(bits_ & ((uint64_t{1} << bits) - 1));
+        bits_ >>= bits;
+        count_ -= bits;
+        return value;
+    }
+
+    static bool buildTable(const uint8_t *lengths, unsigned count, Table &table);
+
+    static const Table &fixedLiterals();
+
+    static const Table &fixedDistances();
+
+    /**
+     * @brief Looks up the next symbol without consuming it; `length` is its code length.
+     */
+    bool peekSymbol(const Table &table, unsigned &symbol, unsigned &length);
+
+    bool decodeSymbol(const Table &table, unsigned &symbol);
+
+    bool readBlockHeader();
+
+    bool readDynamicTables();
+
+    Status inflateHuffman(uint8_t *out, size_t &pos, size_t limit);
+
+    const uint8_t *next_ = nullptr;
+    const uint8_t *end_ = nullptr;
+    Refill refill_;
+    // Bits above count_ are zero.
+    uint64_t bits_ = 0;
+    unsigned count_ = 0;
+
+    State state_ = State::BlockHeader;
+    bool finalBlock_ = false;
+    size_t storedRemaining_ = 0;
+    // A match cut short by a full buffer.
+    unsigned pendingLength_ = 0;
+    unsigned pendingDistance_ = 0;
+    const Table *literals_ = nullptr;
+    const Table *distances_ = nullptr;
+    Table dynamicLiterals_;
+    Table dynamicDistances_;
+};
+
+/**
+ * @brief .gz decoder: concatenated members, CRC-32 and length checks. Data after the last
+ * member that is not another member (such as DTBs appended to a kernel) is ignored.
+ */
+class GzipDecoder {
+public:
+    /**
+     * @brief Decodes `in` into `out`. BGZF files, whose members record their compressed
+     * size, are decoded member-parallel on `pool` if one is given.
+     */
+    static bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength, WorkStealingPool *pool = nullptr);
+
+    /**
+     * @brief Decoded size of a BGZF file; other gzip files do not record it for all members.
+     */
+    static bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size);
+
+    static std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source);
+};
+
+} // namespace genesis::oracle
+
+#endif // GZIP_DECODER_H
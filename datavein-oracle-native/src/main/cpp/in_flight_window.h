@@ -0,0 +1,58 @@
+#ifndef IN_FLIGHT_WINDOW_H
+#define IN_FLIGHT_WINDOW_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+
+/**
+ * @brief Byte budget shared by tasks that hold buffers, to bound peak memory while work is
+ * queued on a WorkStealingPool.
+ */
+class InFlightWindow {
+public:
+    explicit InFlightWindow(size_t limit) : limit_(limit) {}
+
+    /**
+     * @brief Reserves `bytes`, waiting while that would exceed the limit. A request larger
+     * than the whole limit is admitted once nothing else is in flight. Pool tasks are run on
+     * the calling thread while it waits, so a worker thread calling this cannot deadlock the
+     * pool.
+     */
+    void acquire(size_t bytes, WorkStealingPool &pool) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (used_ != 0 && bytes > limit_ - (used_ < limit_ ? used_ : limit_)) {
+            lock.unlock();
+            if (!pool.runOne()) {
+                lock.lock();
+                released_.wait_for(lock, std::chrono::milliseconds(2));
+                continue;
+            }
+            lock.lock();
+        }
+        used_ += bytes;
+    }
+
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            used_ -= bytes;
+        }
+        released_.notify_all();
+    }
+
+private:
+    const size_t limit_;
+    size_t used_ = 0;
+    std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+} // namespace genesis::oracle
+
+#endif // IN_FLIGHT_WINDOW_H
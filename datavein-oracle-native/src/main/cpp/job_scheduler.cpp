@@ -0,0 +1,244 @@
+#include "job_scheduler.h"
+
+#include <algorithm>
+
+namespace genesis::oracle {
+
+struct JobScheduler::Job {
+    uint64_t id = 0;
+    Body body;
+    Listener listener;
+    std::atomic<bool> cancelled{false};
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{0};
+    // Steady-clock time in nanoseconds before which progress is not reported again.
+    std::atomic<int64_t> nextProgressAt{0};
+    // Written by the job's body only, read once it has returned.
+    std::string result;
+    // Guarded by JobScheduler::mutex_.
+    JobState state = JobState::Queued;
+    // Dispatcher thread only: set once the final event has been delivered.
+    bool closed = false;
+};
+
+namespace {
+
+bool isFinal(JobState state) {
+    return state == JobState::Succeeded || state == JobState::Failed ||
+           state == JobState::Cancelled;
+}
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const char *jobStateName(JobState state) {
+    switch (state) {
+        case JobState::Queued:
+            return "queued";
+        case JobState::Running:
+            return "running";
+        case JobState::Succeeded:
+            return "succeeded";
+        case JobState::Failed:
+            return "failed";
+        case JobState::Cancelled:
+            return "cancelled";
+    }
+    return "unknown";
+}
+
+uint64_t JobContext::id() const {
+    return job_->id;
+}
+
+const std::atomic<bool> *JobContext::cancelFlag() const {
+    return &job_->cancelled;
+}
+
+void JobContext::progress(uint64_t done, uint64_t total) {
+    job_->done.store(done, std::memory_order_relaxed);
+    job_->total.store(total, std::memory_order_relaxed);
+    const int64_t now = steadyNanos();
+    int64_t next = job_->nextProgressAt.load(std::memory_order_relaxed);
+    const int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            scheduler_.options_.progressInterval).count();
+    // Only the caller that moves the deadline forward reports, so concurrent calls from pool
+    // workers yield one event per interval.
+    if (now >= next &&
+        job_->nextProgressAt.compare_exchange_strong(next, now + interval,
+                                                     std::memory_order_relaxed)) {
+        scheduler_.post(job_, JobState::Running);
+    }
+}
+
+void JobContext::setResult(std::string result) {
+    job_->result = std::move(result);
+}
+
+InFlightWindow &JobContext::ioBudget() {
+    return scheduler_.ioBudget_;
+}
+
+WorkStealingPool &JobContext::pool() {
+    return scheduler_.pool_;
+}
+
+JobScheduler &JobScheduler::shared() {
+    static JobScheduler scheduler(
+            Options{std::max(2u, std::thread::hardware_concurrency() / 2)},
+            WorkStealingPool::shared());
+    return scheduler;
+}
+
+JobScheduler::JobScheduler(const Options &options, WorkStealingPool &pool)
+        : options_(options), pool_(pool), ioBudget_(options.ioBudgetBytes) {
+    const unsigned runners = std::max(1u, options_.maxRunning);
+    runners_.reserve(runners);
+    for (unsigned i = 0; i < runners; ++i) {
+        runners_.emplace_back(&JobScheduler::runnerLoop, this);
+    }
+    dispatcher_ = std::thread(&JobScheduler::dispatcherLoop, this);
+}
+
+JobScheduler::~JobScheduler() {
+    std::deque<std::shared_ptr<Job>> queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queued.swap(queue_);
+        for (auto &entry: jobs_) {
+            entry.second->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+    runnable_.notify_all();
+    for (const std::shared_ptr<Job> &job: queued) {
+        finish(job, JobState::Cancelled);
+    }
+    for (std::thread &runner: runners_) {
+        runner.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(eventMutex_);
+        dispatcherStopping_ = true;
+    }
+    eventReady_.notify_all();
+    dispatcher_.join();
+}
+
+uint64_t JobScheduler::submit(Body body, Listener listener) {
+    auto job = std::make_shared<Job>();
+    job->id = nextId_.fetch_add(1, std::memory_order_relaxed);
+    job->body = std::move(body);
+    job->listener = std::move(listener);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return 0;
+        }
+        jobs_.emplace(job->id, job);
+        queue_.push_back(job);
+    }
+    post(job, JobState::Queued);
+    runnable_.notify_one();
+    return job->id;
+}
+
+bool JobScheduler::cancel(uint64_t id) {
+    std::shared_ptr<Job> dequeued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) {
+            return false;
+        }
+        it->second->cancelled.store(true, std::memory_order_relaxed);
+        if (it->second->state == JobState::Queued) {
+            dequeued = it->second;
+            queue_.erase(std::find(queue_.begin(), queue_.end(), dequeued));
+        }
+    }
+    if (dequeued != nullptr) {
+        finish(dequeued, JobState::Cancelled);
+    }
+    return true;
+}
+
+size_t JobScheduler::activeJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+void JobScheduler::runnerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            runnable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            job->state = JobState::Running;
+        }
+        post(job, JobState::Running);
+        JobContext context(*this, job);
+        const bool succeeded = job->body(context);
+        finish(job, succeeded ? JobState::Succeeded
+                              : job->cancelled.load(std::memory_order_relaxed)
+                                ? JobState::Cancelled : JobState::Failed);
+    }
+}
+
+void JobScheduler::dispatcherLoop() {
+    std::deque<Delivery> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(eventMutex_);
+            eventReady_.wait(lock, [this] { return dispatcherStopping_ || !events_.empty(); });
+            if (events_.empty()) {
+                return;
+            }
+            batch.swap(events_);
+        }
+        for (Delivery &delivery: batch) {
+            // A progress report racing with the end of its job must not follow the final event.
+            if (delivery.job->closed) {
+                continue;
+            }
+            delivery.job->closed = isFinal(delivery.event.state);
+            if (delivery.job->listener) {
+                delivery.job->listener(delivery.event);
+            }
+        }
+        batch.clear();
+    }
+}
+
+void JobScheduler::post(const std::shared_ptr<Job> &job, JobState state) {
+    JobEvent event{job->id, state, job->done.load(std::memory_order_relaxed),
+                   job->total.load(std::memory_order_relaxed), {}};
+    if (state == JobState::Succeeded) {
+        event.result = std::move(job->result);
+    }
+    {
+        std::lock_guard<std::mutex> lock(eventMutex_);
+        events_.push_back({job, std::move(event)});
+    }
+    eventReady_.notify_one();
+}
+
+void JobScheduler::finish(const std::shared_ptr<Job> &job, JobState state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->state = state;
+        jobs_.erase(job->id);
+    }
+    post(job, state);
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,184 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "in_flight_window.h"
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+
+enum class JobState {
+    Queued,
+    Running,
+    Succeeded,
+    Failed,
+    Cancelled,
+};
+
+const char *jobStateName(JobState state);
+
+/**
+ * @brief A change in a job's state or progress, as delivered to its listener.
+ */
+struct JobEvent {
+    uint64_t id;
+    JobState state;
+    uint64_t done;
+    uint64_t total;
+    // Set on the final event of a job that succeeded and produced a result.
+    std::string result;
+};
+
+class JobContext;
+
+/**
+ * @brief Runs long ROM operations off the caller's thread.
+ *
+ * Jobs run FIFO on a fixed set of runner threads, which caps how many operations are in
+ * progress at once; their parallel parts go to a shared WorkStealingPool sized to the CPU,
+ * and their large buffers are drawn from one InFlightWindow, so concurrent jobs share a
+ * single CPU and memory budget instead of each assuming the whole device. Listener calls
+ * for all jobs are made in order from one dispatcher thread, never from a runner or a pool
+ * worker, so a slow listener delays other listeners but not the work itself.
+ */
+class JobScheduler {
+public:
+    using Body = std::function<bool(JobContext &)>;
+    using Listener = std::function<void(const JobEvent &)>;
+
+    struct Options {
+        unsigned maxRunning = 2;
+        size_t ioBudgetBytes = 512 * 1024 * 1024;
+        std::chrono::milliseconds progressInterval{100};
+    };
+
+    /**
+     * @brief Process-wide scheduler on WorkStealingPool::shared(), running up to half as many
+     * jobs as there are cores (at least two).
+     */
+    static JobScheduler &shared();
+
+    JobScheduler(const Options &options, WorkStealingPool &pool);
+
+    /**
+     * @brief Cancels every job, waits for running ones to stop and delivers their final
+     * events.
+     */
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler &) = delete;
+
+    JobScheduler &operator=(const JobScheduler &) = delete;
+
+    /**
+     * @brief Queues a job and returns its id, which is never 0. `body` returns whether the
+     * job succeeded; a job that fails after being cancelled ends as Cancelled.
+     */
+    uint64_t submit(Body body, Listener listener);
+
+    /**
+     * @brief Requests cancellation. A queued job ends right away; a running one ends when its
+     * body next polls. Returns false if the job is unknown or already finished.
+     */
+    bool cancel(uint64_t id);
+
+    size_t activeJobs() const;
+
+private:
+    friend class JobContext;
+
+    struct Job;
+
+    struct Delivery {
+        std::shared_ptr<Job> job;
+        JobEvent event;
+    };
+
+    void runnerLoop();
+
+    void dispatcherLoop();
+
+    void post(const std::shared_ptr<Job> &job, JobState state);
+
+    void finish(const std::shared_ptr<Job> &job, JobState state);
+
+    const Options options_;
+    WorkStealingPool &pool_;
+    InFlightWindow ioBudget_;
+    std::atomic<uint64_t> nextId_{1};
+
+    mutable std::mutex mutex_;
+    std::condition_variable runnable_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> jobs_;
+    bool stopping_ = false;
+
+    std::mutex eventMutex_;
+    std::condition_variable eventReady_;
+    std::deque<Delivery> events_;
+    bool dispatcherStopping_ = false;
+
+    std::vector<std::thread> runners_;
+    std::thread dispatcher_;
+};
+
+/**
+ * @brief What a running job sees of the scheduler.
+ */
+class JobContext {
+public:
+    JobContext(const JobContext &) = delete;
+
+    JobContext &operator=(const JobContext &) = delete;
+
+    uint64_t id() const;
+
+    bool cancelled() const { return cancelFlag()->load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Flag to hand to operations that poll for cancellation.
+     */
+    const std::atomic<bool> *cancelFlag() const;
+
+    /**
+     * @brief Records progress. Callable from any thread; listeners see at most one progress
+     * event per JobScheduler::Options::progressInterval, and the latest values always reach
+     * them with the final event.
+     */
+    void progress(uint64_t done, uint64_t total);
+
+    void setResult(std::string result);
+
+    /**
+     * @brief Buffer budget shared by all jobs of the scheduler.
+     */
+    InFlightWindow &ioBudget();
+
+    WorkStealingPool &pool();
+
+private:
+    friend class JobScheduler;
+
+    JobContext(JobScheduler &scheduler, std::shared_ptr<JobScheduler::Job> job)
+            : scheduler_(scheduler), job_(std::move(job)) {}
+
+    JobScheduler &scheduler_;
+    const std::shared_ptr<JobScheduler::Job> job_;
+};
+
+} // namespace genesis::oracle
+
+#endif // JOB_SCHEDULER_H
@@ -0,0 +1,292 @@
+#include "json_reader.h"
+
+#include <cstdlib>
+
+namespace genesis::oracle {
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    bool document(JsonValue &out) {
+        if (!value(out, 0)) {
+            return false;
+        }
+        skipSpace();
+        return p_ == end_;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skipSpace() {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            ++p_;
+        }
+    }
+
+    bool literal(std::string_view word) {
+        if (static_cast<size_t>(end_ - p_) < word.size() ||
+            std::string_view(p_, word.size()) != word) {
+            return false;
+        }
+        p_ += word.size();
+        return true;
+    }
+
+    bool value(JsonValue &out, int depth) {
+        skipSpace();
+        if (p_ == end_ || depth > kMaxDepth) {
+            return false;
+        }
+        switch (*p_) {
+            case '{':
+                return object(out, depth);
+            case '[':
+                return array(out, depth);
+            case '"':
+                out.type_ = JsonValue::Type::String;
+                return string(out.string_);
+            case 't':
+                out.type_ = JsonValue::Type::Bool;
+                out.bool_ = true;
+                return literal("true");
+            case 'f':
+                out.type_ = JsonValue::Type::Bool;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+                return number(out);
+        }
+    }
+
+    bool object(JsonValue &out, int depth) {
+        out.type_ = JsonValue::Type::Object;
+        ++p_;
+        skipSpace();
+        if (p_ != end_ && *p_ == '}') {
+            ++p_;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            std::string name;
+            if (p_ == end_ || *p_ != '"' || !string(name)) {
+                return false;
+            }
+            skipSpace();
+            if (p_ == end_ || *p_++ != ':') {
+                return false;
+            }
+            out.keys_.push_back(std::move(name));
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) {
+                return false;
+            }
+            skipSpace();
+            if (p_ == end_) {
+                return false;
+            }
+            const char c = *p_++;
+            if (c == '}') {
+                return true;
+            }
+            if (c != ',') {
+                return false;
+            }
+        }
+    }
+
+    bool array(JsonValue &out, int depth) {
+        out.type_ = JsonValue::Type::Array;
+        ++p_;
+        skipSpace();
+        if (p_ != end_ && *p_ == ']') {
+            ++p_;
+            return true;
+        }
+        while (true) {
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) {
+                return false;
+            }
+            skipSpace();
+            if (p_ == end_) {
+                return false;
+            }
+            const char c = *p_++;
+            if (c == ']') {
+                return true;
+            }
+            if (c != ',') {
+                return false;
+            }
+        }
+    }
+
+    bool hex4(uint32_t &code) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *p_++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string &out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    bool string(std::string &out) {
+        ++p_;
+        while (p_ != end_) {
+            const char c = *p_++;
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (p_ == end_) {
+                return false;
+            }
+            switch (*p_++) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!hex4(code)) {
+                        return false;
+                    }
+                    if (code >= 0xd800 && code < 0xdc00) {
+                        uint32_t low;
+                        if (!literal("\\u") || !hex4(low) || low < 0xdc00 || low >= 0xe000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    } else if (code >= 0xdc00 && code < 0xe000) {
+                        return false;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool number(JsonValue &out) {
+        const char *start = p_;
+        out.type_ = JsonValue::Type::Number;
+        out.negative_ = p_ != end_ && *p_ == '-';
+        if (out.negative_) {
+            ++p_;
+        }
+        if (p_ == end_ || *p_ < '0' || *p_ > '9' || (*p_ == '0' && end_ - p_ > 1 &&
+                                                      p_[1] >= '0' && p_[1] <= '9')) {
+            return false;
+        }
+        out.exact_ = true;
+        while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+            const uint64_t digit = *p_++ - '0';
+            if (out.integer_ > (UINT64_MAX - digit) / 10) {
+                out.exact_ = false;
+            }
+            out.integer_ = out.integer_ * 10 + digit;
+        }
+        if (p_ != end_ && *p_ == '.') {
+            out.exact_ = false;
+            ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+                return false;
+            }
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+                ++p_;
+            }
+        }
+        if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+            out.exact_ = false;
+            ++p_;
+            if (p_ != end_ && (*p_ == '+' || *p_ == '-')) {
+                ++p_;
+            }
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') {
+                return false;
+            }
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+                ++p_;
+            }
+        }
+        out.number_ = strtod(std::string(start, p_).c_str(), nullptr);
+        return true;
+    }
+
+    const char *p_;
+    const char *end_;
+};
+
+bool JsonValue::parse(std::string_view text, JsonValue &out) {
+    out = JsonValue();
+    return JsonParser(text).document(out);
+}
+
+const JsonValue *JsonValue::find(std::string_view name) const {
+    if (type_ != Type::Object) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] == name) {
+            return &items_[i];
+        }
+    }
+    return nullptr;
+}
+
+bool JsonValue::asUnsigned(uint64_t &value) const {
+    if (type_ != Type::Number || !exact_ || (negative_ && integer_ != 0)) {
+        return false;
+    }
+    value = integer_;
+    return true;
+}
+
+} // namespace genesis::oracle
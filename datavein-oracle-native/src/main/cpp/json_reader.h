@@ -0,0 +1,73 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Parsed JSON document node, for the small requests Kotlin passes in.
+ *
+ * Integers that fit in 64 bits are kept exact, since they carry file offsets; other numbers
+ * are held as doubles. Object members keep their document order.
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    /**
+     * @brief Parses a complete document. Returns false on malformed input or nesting deeper
+     * than 64 levels.
+     */
+    static bool parse(std::string_view text, JsonValue &out);
+
+    Type type() const { return type_; }
+
+    bool isNull() const { return type_ == Type::Null; }
+
+    bool isObject() const { return type_ == Type::Object; }
+
+    bool isArray() const { return type_ == Type::Array; }
+
+    bool isString() const { return type_ == Type::String; }
+
+    /**
+     * @brief Member `name` of an object, or nullptr if absent or this is not an object.
+     */
+    const JsonValue *find(std::string_view name) const;
+
+    const std::vector<JsonValue> &items() const { return items_; }
+
+    const std::string &string() const { return string_; }
+
+    bool boolean() const { return bool_; }
+
+    double number() const { return number_; }
+
+    /**
+     * @brief Reads a non-negative integer. Fails for fractions, negatives and non-numbers.
+     */
+    bool asUnsigned(uint64_t &value) const;
+
+private:
+    friend class JsonParser;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    bool exact_ = false;
+    bool negative_ = false;
+    uint64_t integer_ = 0;
+    double number_ = 0;
+    std::string string_;
+    // Array elements, or object member values with their names in keys_.
+    std::vector<JsonValue> items_;
+    std::vector<std::string> keys_;
+};
+
+} // namespace genesis::oracle
+
+#endif // JSON_READER_H
@@ -0,0 +1,120 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <concepts>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Minimal streaming JSON builder for the reports returned to Kotlin.
+ *
+ * Callers are trusted to nest calls correctly; the writer only handles separators and
+ * string escaping.
+ */
+class JsonWriter {
+public:
+    JsonWriter &beginObject() { return open('{'); }
+
+    JsonWriter &endObject() { return close('}'); }
+
+    JsonWriter &beginArray() { return open('['); }
+
+    JsonWriter &endArray() { return close(']'); }
+
+    JsonWriter &key(std::string_view name) {
+        separator();
+        appendString(name);
+        out_ += ':';
+        needComma_ = false;
+        return *this;
+    }
+
+    JsonWriter &value(std::string_view text) {
+        separator();
+        appendString(text);
+        return *this;
+    }
+
+    JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+
+    JsonWriter &value(bool flag) {
+        separator();
+        out_ += flag ? "true" : "false";
+        return *this;
+    }
+
+    template<std::integral T>
+    JsonWriter &value(T number) {
+        separator();
+        out_ += std::to_string(number);
+        return *this;
+    }
+
+    template<typename T>
+    JsonWriter &field(std::string_view name, const T &v) { return key(name).value(v); }
+
+    const std::string &str() const { return out_; }
+
+private:
+    JsonWriter &open(char bracket) {
+        separator();
+        out_ += bracket;
+        needComma_ = false;
+        return *this;
+    }
+
+    JsonWriter &close(char bracket) {
+        out_ += bracket;
+        needComma_ = true;
+        return *this;
+    }
+
+    void separator() {
+        if (needComma_) {
+            out_ += ',';
+        }
+        needComma_ = true;
+    }
+
+    void appendString(std::string_view text) {
+        out_ += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"':
+                    out_ += "\\\"";
+                    break;
+                case '\\':
+                    out_ += "\\\\";
+                    break;
+                case '\n':
+                    out_ += "\\n";
+                    break;
+                case '\r':
+                    out_ += "\\r";
+                    break;
+                case '\t':
+                    out_ += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out_ += escaped;
+                    } else {
+                        out_ += c;
+                    }
+            }
+        }
+        out_ += '"';
+    }
+
+    std::string out_;
+    bool needComma_ = false;
+};
+
+} // namespace genesis::oracle
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,593 @@
+#include "lz4_decoder.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "checksum.h"
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint32_t kLegacyMagic = 0x184c2102;
+constexpr uint32_t kFrameMagic = 0x184d2204;
+constexpr uint32_t kSkippableMagic = 0x184d2a50;
+constexpr uint32_t kSkippableMask = 0xfffffff0;
+constexpr size_t kLegacyBlockSize = 8 * 1024 * 1024;
+// LZ4_COMPRESSBOUND(kLegacyBlockSize).
+constexpr size_t kLegacyBlockBound = kLegacyBlockSize + kLegacyBlockSize / 255 + 16;
+constexpr size_t kHistorySize = 64 * 1024;
+constexpr uint32_t kRawBlockFlag = 0x80000000u;
+
+constexpr uint8_t kFlagVersionMask = 0xc0;
+constexpr uint8_t kFlagVersion = 0x40;
+constexpr uint8_t kFlagIndependent = 0x20;
+constexpr uint8_t kFlagBlockChecksum = 0x10;
+constexpr uint8_t kFlagContentSize = 0x08;
+constexpr uint8_t kFlagContentChecksum = 0x04;
+constexpr uint8_t kFlagReserved = 0x02;
+constexpr uint8_t kFlagDictionary = 0x01;
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t le64(const uint8_t *p) {
+    return uint64_t{le32(p)} | (uint64_t{le32(p + 4)} << 32);
+}
+
+/**
+ * @brief Decodes one LZ4 block into out[pos, limit). Matches may reach back to
+ * out[historyStart].
+ */
+bool decodeBlock(const uint8_t *in, size_t inLength, uint8_t *out, size_t &pos, size_t limit,
+                 size_t historyStart) {
+    const uint8_t *p = in;
+    const uint8_t *const end = in + inLength;
+    for (;;) {
+        if (p == end) {
+            return false;
+        }
+        const unsigned token = *p++;
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t extra;
+            do {
+                if (p == end) {
+                    return false;
+                }
+                extra = *p++;
+                literals += extra;
+            } while (extra == 255);
+        }
+        if (literals > static_cast<size_t>(end - p) || literals > limit - pos) {
+            return false;
+        }
+        memcpy(out + pos, p, literals);
+        p += literals;
+        pos += literals;
+        // The last sequence is literals only.
+        if (p == end) {
+            return true;
+        }
+
+        if (end - p < 2) {
+            return false;
+        }
+        const size_t offset = p[0] | (p[1] << 8);
+        p += 2;
+        if (offset == 0 || offset > pos - historyStart) {
+            return false;
+        }
+        size_t length = token & 15;
+        if (length == 15) {
+            uint8_t extra;
+            do {
+                if (p == end) {
+                    return false;
+                }
+                extra = *p++;
+                length += extra;
+            } while (extra == 255);
+        }
+        length += 4;
+        if (length > limit - pos) {
+            return false;
+        }
+        uint8_t *target = out + pos;
+        const uint8_t *source = target - offset;
+        if (offset >= 16 && limit - pos >= length + 16) {
+            // Chunks may run past the match; the bytes beyond are rewritten later.
+            for (size_t i = 0; i < length; i += 16) {
+                memcpy(target + i, source + i, 16);
+            }
+        } else if (offset >= length) {
+            memcpy(target, source, length);
+        } else {
+            for (size_t i = 0; i < length; ++i) {
+                target[i] = source[i];
+            }
+        }
+        pos += length;
+    }
+}
+
+struct FrameHeader {
+    bool independent;
+    bool blockChecksum;
+    bool contentChecksum;
+    bool hasContentSize;
+    size_t blockMax;
+    uint64_t contentSize;
+    size_t size;
+};
+
+// Header length given the FLG byte: magic, FLG, BD, content size, HC.
+size_t frameHeaderSize(uint8_t flags) {
+    return 7 + ((flags & kFlagContentSize) ? 8 : 0);
+}
+
+bool parseFrameHeader(const uint8_t *p, size_t available, FrameHeader &header) {
+    if (available < 7) {
+        return false;
+    }
+    const uint8_t flags = p[4];
+    const uint8_t descriptor = p[5];
+    const unsigned blockCode = (descriptor >> 4) & 7;
+    if ((flags & kFlagVersionMask) != kFlagVersion || (flags & kFlagReserved) ||
+        (flags & kFlagDictionary) || (descriptor & 0x8f) || blockCode < 4) {
+        return false;
+    }
+    header.size = frameHeaderSize(flags);
+    if (available < header.size ||
+        ((xxh32(p + 4, header.size - 5) >> 8) & 0xff) != p[header.size - 1]) {
+        return false;
+    }
+    header.independent = flags & kFlagIndependent;
+    header.blockChecksum = flags & kFlagBlockChecksum;
+    header.contentChecksum = flags & kFlagContentChecksum;
+    header.hasContentSize = flags & kFlagContentSize;
+    header.blockMax = size_t{1} << (8 + 2 * blockCode);
+    header.contentSize = header.hasContentSize ? le64(p + 6) : 0;
+    return true;
+}
+
+struct Block {
+    const uint8_t *data;
+    size_t size;
+    bool raw;
+    // An XXH32 of the block follows its data.
+    bool checksummed;
+};
+
+// Collects the blocks of the frame whose first block header is at `p`, leaving `p` after
+// the end mark and content checksum.
+bool scanFrameBlocks(const FrameHeader &header, const uint8_t *&p, const uint8_t *end,
+                     std::vector<Block> &blocks) {
+    for (;;) {
+        if (end - p < 4) {
+            return false;
+        }
+        const uint32_t word = le32(p);
+        p += 4;
+        if (word == 0) {
+            break;
+        }
+        const size_t size = word & ~kRawBlockFlag;
+        const size_t checksum = header.blockChecksum ? 4 : 0;
+        if (size > header.blockMax || size + checksum > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        blocks.push_back({p, size, (word & kRawBlockFlag) != 0, header.blockChecksum});
+        p += size + checksum;
+    }
+    if (header.contentChecksum) {
+        if (end - p < 4) {
+            return false;
+        }
+        p += 4;
+    }
+    return true;
+}
+
+bool decodeFrameBlock(const Block &block, uint8_t *out, size_t &pos, size_t limit,
+                      size_t historyStart) {
+    if (block.checksummed && xxh32(block.data, block.size) != le32(block.data + block.size)) {
+        return false;
+    }
+    if (block.raw) {
+        if (block.size > limit - pos) {
+            return false;
+        }
+        memcpy(out + pos, block.data, block.size);
+        pos += block.size;
+        return true;
+    }
+    return decodeBlock(block.data, block.size, out, pos, limit, historyStart);
+}
+
+// Decodes independent blocks in parallel, assuming every block but the last is full as
+// encoders write them. Returns false, with `out` in an unspecified state, if that does not
+// hold or a block is corrupt.
+bool decodeBlocksParallel(const std::vector<Block> &blocks, size_t blockSize, uint8_t *out,
+                          size_t outCapacity, size_t &length, WorkStealingPool &pool,
+                          bool (*decodeOne)(const Block &, uint8_t *, size_t &, size_t)) {
+    std::vector<size_t> produced(blocks.size());
+    std::atomic<bool> ok{true};
+    TaskGroup group(pool);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        group.run([&, i] {
+            const size_t offset = i * blockSize;
+            if (offset > outCapacity) {
+                ok.store(false, std::memory_order_relaxed);
+                return;
+            }
+            size_t pos = 0;
+            const size_t limit = std::min(blockSize, outCapacity - offset);
+            if (!decodeOne(blocks[i], out + offset, pos, limit)) {
+                ok.store(false, std::memory_order_relaxed);
+            }
+            produced[i] = pos;
+        });
+    }
+    group.wait();
+    if (!ok.load()) {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < blocks.size(); ++i) {
+        if (produced[i] != blockSize) {
+            return false;
+        }
+    }
+    length = (blocks.size() - 1) * blockSize + produced.back();
+    return true;
+}
+
+bool decodeFrame(const uint8_t *&p, const uint8_t *end, uint8_t *out, size_t &pos,
+                 size_t outCapacity, WorkStealingPool *pool) {
+    FrameHeader header;
+    if (!parseFrameHeader(p, end - p, header)) {
+        return false;
+    }
+    p += header.size;
+    std::vector<Block> blocks;
+    if (!scanFrameBlocks(header, p, end, blocks)) {
+        return false;
+    }
+
+    const size_t start = pos;
+    size_t length = 0;
+    const bool parallel =
+            pool != nullptr && header.independent && blocks.size() > 1 &&
+            decodeBlocksParallel(blocks, header.blockMax, out + start, outCapacity - start,
+                                 length, *pool,
+                                 [](const Block &block, uint8_t *target, size_t &at,
+                                    size_t limit) {
+                                     return decodeFrameBlock(block, target, at, limit, 0);
+                                 });
+    if (parallel) {
+        pos = start + length;
+    } else {
+        pos = start;
+        for (const Block &block: blocks) {
+            const size_t historyStart = header.independent ? pos : start;
+            if (!decodeFrameBlock(block, out, pos,
+                                  std::min(outCapacity, pos + header.blockMax), historyStart)) {
+                return false;
+            }
+        }
+    }
+    if (header.hasContentSize && pos - start != header.contentSize) {
+        return false;
+    }
+    return !header.contentChecksum || xxh32(out + start, pos - start) == le32(p - 4);
+}
+
+bool decodeLegacyBlock(const Block &block, uint8_t *out, size_t &pos, size_t limit) {
+    return decodeBlock(block.data, block.size, out, pos, limit, pos);
+}
+
+// Collects legacy blocks up to the end of the input or the start of a non-legacy frame.
+// Kernels append the decoded size after the last block, which reads as a block header with
+// nothing after it. `restarted` is set if another legacy magic was crossed, after which
+// block offsets are no longer multiples of the block size.
+bool scanLegacyBlocks(const uint8_t *&p, const uint8_t *end, std::vector<Block> &blocks,
+                      bool &restarted) {
+    restarted = false;
+    while (end - p >= 4) {
+        const uint32_t size = le32(p);
+        if (size == kLegacyMagic) {
+            restarted = true;
+            p += 4;
+            continue;
+        }
+        if (size == 0 || size == kFrameMagic || (size & kSkippableMask) == kSkippableMagic) {
+            return true;
+        }
+        if (end - p == 4) {
+            p = end;
+            return true;
+        }
+        p += 4;
+        if (size > kLegacyBlockBound || size > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        blocks.push_back({p, size, false, false});
+        p += size;
+    }
+    return p == end;
+}
+
+bool decodeLegacy(const uint8_t *&p, const uint8_t *end, uint8_t *out, size_t &pos,
+                  size_t outCapacity, WorkStealingPool *pool) {
+    p += 4;
+    std::vector<Block> blocks;
+    bool restarted;
+    if (!scanLegacyBlocks(p, end, blocks, restarted)) {
+        return false;
+    }
+    size_t length;
+    if (pool != nullptr && !restarted && blocks.size() > 1) {
+        if (!decodeBlocksParallel(blocks, kLegacyBlockSize, out + pos, outCapacity - pos, length,
+                                  *pool, decodeLegacyBlock)) {
+            return false;
+        }
+        pos += length;
+        return true;
+    }
+    for (const Block &block: blocks) {
+        if (!decodeLegacyBlock(block, out, pos, std::min(outCapacity, pos + kLegacyBlockSize))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class Lz4Stream : public DecompressStream {
+public:
+    explicit Lz4Stream(Source source) : DecompressStream(std::move(source)) {
+        setHistory(kHistorySize);
+    }
+
+protected:
+    bool produce() override {
+        switch (phase_) {
+            case Phase::Magic:
+                return readMagic();
+            case Phase::Skip: {
+                if (!fillInput(1)) {
+                    return false;
+                }
+                const size_t now = std::min<uint64_t>(skipRemaining_, inputAvailable());
+                consumeInput(now);
+                skipRemaining_ -= now;
+                if (skipRemaining_ == 0) {
+                    phase_ = Phase::Magic;
+                }
+                return true;
+            }
+            case Phase::Legacy:
+                return readLegacyBlock();
+            case Phase::Frame:
+                return readFrameBlock();
+        }
+        return false;
+    }
+
+private:
+    enum class Phase {
+        Magic,
+        Skip,
+        Legacy,
+        Frame,
+    };
+
+    bool readMagic() {
+        if (!fillInput(4)) {
+            // Short trailing bytes after a frame are ignored like any other trailing data.
+            if (!sawFrame_) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        const uint32_t magic = le32(input());
+        if (magic == kLegacyMagic) {
+            consumeInput(4);
+            phase_ = Phase::Legacy;
+        } else if (magic == kFrameMagic) {
+            if (!fillInput(6) || !fillInput(frameHeaderSize(input()[4])) ||
+                !parseFrameHeader(input(), inputAvailable(), header_)) {
+                return false;
+            }
+            consumeInput(header_.size);
+            hash_ = Xxh32();
+            frameOutput_ = 0;
+            phase_ = Phase::Frame;
+        } else if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (!fillInput(8)) {
+                return false;
+            }
+            skipRemaining_ = le32(input() + 4);
+            consumeInput(8);
+            phase_ = skipRemaining_ > 0 ? Phase::Skip : Phase::Magic;
+            return true;
+        } else if (sawFrame_) {
+            finish();
+            return true;
+        } else {
+            return false;
+        }
+        sawFrame_ = true;
+        return true;
+    }
+
+    bool readLegacyBlock() {
+        if (!fillInput(4)) {
+            if (inputAvailable() != 0) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        const uint32_t size = le32(input());
+        if (size == kLegacyMagic) {
+            consumeInput(4);
+            return true;
+        }
+        if (size == 0 || size == kFrameMagic || (size & kSkippableMask) == kSkippableMagic) {
+            phase_ = Phase::Magic;
+            return true;
+        }
+        consumeInput(4);
+        if (size > kLegacyBlockBound || !fillInput(size)) {
+            // A size with nothing after it is the decoded length kernels append.
+            if (inputAvailable() != 0) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        if (!reserveOutput(kLegacyBlockSize)) {
+            return false;
+        }
+        size_t pos = windowEnd_;
+        if (!decodeBlock(input(), size, window_.data(), pos, windowEnd_ + kLegacyBlockSize,
+                         windowEnd_)) {
+            return false;
+        }
+        consumeInput(size);
+        windowEnd_ = pos;
+        return true;
+    }
+
+    bool readFrameBlock() {
+        if (!fillInput(4)) {
+            return false;
+        }
+        const uint32_t word = le32(input());
+        consumeInput(4);
+        if (word == 0) {
+            if (header_.contentChecksum) {
+                uint8_t checksum[4];
+                if (!readInput(checksum, 4) || le32(checksum) != hash_.digest()) {
+                    return false;
+                }
+            }
+            if (header_.hasContentSize && frameOutput_ != header_.contentSize) {
+                return false;
+            }
+            phase_ = Phase::Magic;
+            return true;
+        }
+        const size_t size = word & ~kRawBlockFlag;
+        const size_t checksum = header_.blockChecksum ? 4 : 0;
+        if (size > header_.blockMax || !fillInput(size + checksum) ||
+            !reserveOutput(header_.blockMax)) {
+            return false;
+        }
+        size_t pos = windowEnd_;
+        const Block block{input(), size, (word & kRawBlockFlag) != 0, header_.blockChecksum};
+        const size_t history = header_.independent
+                               ? 0 : static_cast<size_t>(std::min<uint64_t>(frameOutput_,
+                                                                            kHistorySize));
+        if (!decodeFrameBlock(block, window_.data(), pos, windowEnd_ + header_.blockMax,
+                              windowEnd_ - history)) {
+            return false;
+        }
+        consumeInput(size + checksum);
+        hash_.update(window_.data() + windowEnd_, pos - windowEnd_);
+        frameOutput_ += pos - windowEnd_;
+        windowEnd_ = pos;
+        return true;
+    }
+
+    Phase phase_ = Phase::Magic;
+    bool sawFrame_ = false;
+    uint64_t skipRemaining_ = 0;
+    FrameHeader header_{};
+    Xxh32 hash_;
+    uint64_t frameOutput_ = 0;
+};
+
+} // namespace
+
+bool Lz4Decoder::decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                        size_t *outLength, WorkStealingPool *pool) {
+    const uint8_t *p = in;
+    const uint8_t *const end = in + inLength;
+    size_t pos = 0;
+    bool sawFrame = false;
+    while (end - p >= 4) {
+        const uint32_t magic = le32(p);
+        if (magic == kLegacyMagic) {
+            if (!decodeLegacy(p, end, out, pos, outCapacity, pool)) {
+                return false;
+            }
+        } else if (magic == kFrameMagic) {
+            if (!decodeFrame(p, end, out, pos, outCapacity, pool)) {
+                return false;
+            }
+        } else if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (end - p < 8 || le32(p + 4) > static_cast<size_t>(end - p - 8)) {
+                return false;
+            }
+            p += 8 + le32(p + 4);
+            continue;
+        } else {
+            // Trailing data.
+            break;
+        }
+        sawFrame = true;
+    }
+    if (!sawFrame) {
+        return false;
+    }
+    if (outLength != nullptr) {
+        *outLength = pos;
+    }
+    return true;
+}
+
+bool Lz4Decoder::contentSize(const uint8_t *in, size_t inLength, uint64_t &size) {
+    const uint8_t *p = in;
+    const uint8_t *const end = in + inLength;
+    size = 0;
+    bool sawFrame = false;
+    while (end - p >= 4) {
+        const uint32_t magic = le32(p);
+        if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (end - p < 8 || le32(p + 4) > static_cast<size_t>(end - p - 8)) {
+                return false;
+            }
+            p += 8 + le32(p + 4);
+            continue;
+        }
+        if (magic != kFrameMagic) {
+            // Legacy streams do not record their size; anything else ends the data.
+            if (magic == kLegacyMagic) {
+                return false;
+            }
+            break;
+        }
+        FrameHeader header;
+        std::vector<Block> blocks;
+        if (!parseFrameHeader(p, end - p, header) || !header.hasContentSize) {
+            return false;
+        }
+        p += header.size;
+        if (!scanFrameBlocks(header, p, end, blocks)) {
+            return false;
+        }
+        size += header.contentSize;
+        sawFrame = true;
+    }
+    return sawFrame;
+}
+
+std::unique_ptr<DecompressStream> Lz4Decoder::openStream(DecompressStream::Source source) {
+    return std::make_unique<Lz4Stream>(std::move(source));
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,39 @@
+#ifndef LZ4_DECODER_H
+#define LZ4_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "decompressor.h"
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief LZ4 decoder for both the frame format and the legacy format that kernels and
+ * ramdisks use. Concatenated frames and skippable frames are accepted; block, content and
+ * header checksums are verified. Frames that need an external dictionary are not
+ * supported.
+ */
+class Lz4Decoder {
+public:
+    /**
+     * @brief Decodes `in` into `out`. Legacy blocks, and the blocks of frames whose blocks
+     * are independent, are decoded block-parallel on `pool` if one is given.
+     */
+    static bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength, WorkStealingPool *pool = nullptr);
+
+    /**
+     * @brief Decoded size, if every frame in `in` records its content size.
+     */
+    static bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size);
+
+    static std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source);
+};
+
+} // namespace genesis::oracle
+
+#endif // LZ4_DECODER_H
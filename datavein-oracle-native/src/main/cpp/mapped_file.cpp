@@ -0,0 +1,43 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace genesis::oracle {
+
+std::unique_ptr<MappedFile> MappedFile::open(const char *path, Access access) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return std::unique_ptr<MappedFile>(new MappedFile(nullptr, 0));
+    }
+
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    madvise(address, size, access == Access::Random ? MADV_RANDOM
+                           : access == Access::Sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const uint8_t *>(address), size));
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t *>(data_), size_);
+    }
+}
+
+} // namespace genesis::oracle
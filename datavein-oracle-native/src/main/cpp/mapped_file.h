@@ -0,0 +1,57 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Pages are faulted in on access, so parsing headers of a multi-GB image touches only the
+ * pages actually read.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Expected access pattern, passed on to madvise().
+     */
+    enum class Access {
+        // Headers and scattered lookups: no readahead beyond the pages touched.
+        Random,
+        // Streamed front to back.
+        Sequential,
+        // Large reads in no particular order, e.g. from several threads.
+        Normal,
+    };
+
+    /**
+     * @brief Maps `path` read-only, or returns nullptr if it cannot be opened or mapped.
+     */
+    static std::unique_ptr<MappedFile> open(const char *path, Access access = Access::Random);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    std::span<const uint8_t> bytes() const { return {data_, size_}; }
+
+private:
+    MappedFile(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+    const uint8_t *data_;
+    size_t size_;
+};
+
+} // namespace genesis::oracle
+
+#endif // MAPPED_FILE_H
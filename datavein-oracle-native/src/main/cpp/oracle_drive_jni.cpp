@@ -1,15 +1,264 @@
 #include <jni.h>
 #include <android/log.h>
+#include <fcntl.h>
 #include <string>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
 #include <memory>
+#include "block_store.h"
+#include "boot_image.h"
+#include "delta_rom_builder.h"
+#include "job_scheduler.h"
+#include "json_writer.h"
+#include "mapped_file.h"
+#include "payload_extractor.h"
+#include "sparse_image.h"
+#include "work_stealing_pool.h"
 
 #define LOG_TAG "OracleDriveNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+namespace {
+
+// Expands a sparse image to <outputDir>/<name>.img, where name is the input's file name
+// without its extension.
+bool expandSparseImage(const genesis::oracle::MappedFile &image, const char *romPath,
+                       const char *outputDir) {
+    std::string name(romPath);
+    name = name.substr(name.rfind('/') + 1);
+    name = name.substr(0, name.rfind('.'));
+    const std::string path = std::string(outputDir) + "/" + (name.empty() ? "image" : name) +
+                             ".img";
+
+    struct stat source{}, target{};
+    if (stat(romPath, &source) == 0 && stat(path.c_str(), &target) == 0 &&
+        source.st_dev == target.st_dev && source.st_ino == target.st_ino) {
+        LOGE("Refusing to expand %s over itself", romPath);
+        return false;
+    }
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("Cannot create %s", path.c_str());
+        return false;
+    }
+    const bool expanded = genesis::oracle::SparseImage::expand(
+            image.bytes(), fd, genesis::oracle::WorkStealingPool::shared());
+    return close(fd) == 0 && expanded;
+}
+
+// Extracts a full OTA payload or package, or expands a sparse image, into `outputDir`.
+bool extractRom(const char *romPath, const char *outputDir,
+                genesis::oracle::PayloadExtractOptions options) {
+    std::unique_ptr<genesis::oracle::PayloadExtractor> payload =
+            genesis::oracle::PayloadExtractor::open(romPath);
+    if (payload != nullptr) {
+        std::shared_ptr<genesis::oracle::BlockStore> cache =
+                genesis::oracle::BlockStore::shared();
+        options.cache = cache.get();
+        return payload->extract(outputDir, options, genesis::oracle::WorkStealingPool::shared());
+    }
+    std::unique_ptr<genesis::oracle::MappedFile> image = genesis::oracle::MappedFile::open(
+            romPath, genesis::oracle::MappedFile::Access::Normal);
+    if (image != nullptr && genesis::oracle::SparseImage::isSparse(image->bytes())) {
+        return expandSparseImage(*image, romPath, outputDir);
+    }
+    LOGE("Not an OTA payload, OTA package or sparse image: %s", romPath);
+    return false;
+}
+
+// Applies a modifications JSON document to a base image. On success, `report` (if set)
+// receives the build statistics as JSON.
+bool buildCustomRom(const char *basePath, const char *modifications, const char *outputPath,
+                    std::string *report) {
+    genesis::oracle::RomModifications parsed;
+    genesis::oracle::RomBuildStats stats;
+    std::shared_ptr<genesis::oracle::BlockStore> cache = genesis::oracle::BlockStore::shared();
+    if (!genesis::oracle::RomModifications::parse(modifications, parsed)) {
+        LOGE("Invalid modifications JSON");
+        return false;
+    }
+    if (!genesis::oracle::DeltaRomBuilder::build(basePath, parsed, outputPath,
+                                                 genesis::oracle::WorkStealingPool::shared(),
+                                                 cache.get(), &stats)) {
+        LOGE("Custom ROM creation failed");
+        return false;
+    }
+    const char *mode = stats.inPlace ? "in place" : stats.reflinked ? "reflinked" : "copied";
+    LOGI("Custom ROM created successfully (%s, %llu bytes copied, %llu patched, "
+         "%llu blocks rehashed)",
+         mode, static_cast<unsigned long long>(stats.bytesCopied),
+         static_cast<unsigned long long>(stats.bytesPatched),
+         static_cast<unsigned long long>(stats.blocksRehashed));
+    if (report != nullptr) {
+        genesis::oracle::JsonWriter json;
+        json.beginObject()
+                .field("output", outputPath)
+                .field("mode", mode)
+                .field("bytesCopied", stats.bytesCopied)
+                .field("bytesPatched", stats.bytesPatched)
+                .field("blocksRehashed", stats.blocksRehashed)
+                .endObject();
+        *report = json.str();
+    }
+    return true;
+}
+
+// Set once in JNI_OnLoad, before any thread can submit a job, and only read afterwards.
+JavaVM *javaVm = nullptr;
+
+// JNIEnv of the scheduler's dispatcher thread, which is attached to the VM on first use and
+// detached when it exits.
+JNIEnv *dispatcherEnv() {
+    struct Attachment {
+        JNIEnv *env = nullptr;
+
+        ~Attachment() {
+            if (env != nullptr) {
+                javaVm->DetachCurrentThread();
+            }
+        }
+    };
+    thread_local Attachment attachment;
+    if (attachment.env == nullptr &&
+        javaVm->AttachCurrentThread(&attachment.env, nullptr) != JNI_OK) {
+        attachment.env = nullptr;
+    }
+    return attachment.env;
+}
+
+// Forwards job events to an IAuraDriveCallback: every state change and throttled progress
+// as onStatusUpdate(status JSON), and a successful job's result as
+// onDataReceived(jobType, UTF-8 JSON) just before its final status.
+class JobCallback {
+public:
+    static genesis::oracle::JobScheduler::Listener create(JNIEnv *env, jobject callback,
+                                                          const char *jobType) {
+        if (javaVm == nullptr) {
+            LOGE("Job callbacks need the VM recorded by JNI_OnLoad");
+            return nullptr;
+        }
+        auto forwarder = std::make_shared<JobCallback>();
+        forwarder->type_ = jobType;
+        if (callback != nullptr) {
+            jclass type = env->GetObjectClass(callback);
+            forwarder->onStatusUpdate_ = env->GetMethodID(type, "onStatusUpdate",
+                                                          "(Ljava/lang/String;)V");
+            forwarder->onDataReceived_ = env->GetMethodID(type, "onDataReceived",
+                                                          "(Ljava/lang/String;[B)V");
+            env->DeleteLocalRef(type);
+            if (forwarder->onStatusUpdate_ == nullptr || forwarder->onDataReceived_ == nullptr) {
+                env->ExceptionClear();
+                LOGE("Callback does not implement IAuraDriveCallback");
+                return nullptr;
+            }
+            forwarder->callback_ = env->NewGlobalRef(callback);
+        }
+        return [forwarder](const genesis::oracle::JobEvent &event) { forwarder->deliver(event); };
+    }
+
+private:
+    void deliver(const genesis::oracle::JobEvent &event) {
+        const bool final = event.state != genesis::oracle::JobState::Queued &&
+                           event.state != genesis::oracle::JobState::Running;
+        if (final) {
+            LOGI("%s job %llu %s", type_.c_str(), static_cast<unsigned long long>(event.id),
+                 genesis::oracle::jobStateName(event.state));
+        }
+        if (callback_ == nullptr) {
+            return;
+        }
+        JNIEnv *env = dispatcherEnv();
+        if (env == nullptr) {
+            LOGE("Cannot attach job dispatcher thread to the VM");
+            return;
+        }
+        if (!event.result.empty()) {
+            jstring type = env->NewStringUTF(type_.c_str());
+            jbyteArray data = env->NewByteArray(static_cast<jsize>(event.result.size()));
+            if (type != nullptr && data != nullptr) {
+                env->SetByteArrayRegion(data, 0, static_cast<jsize>(event.result.size()),
+                                        reinterpret_cast<const jbyte *>(event.result.data()));
+                env->CallVoidMethod(callback_, onDataReceived_, type, data);
+            }
+            clearException(env);
+            env->DeleteLocalRef(type);
+            env->DeleteLocalRef(data);
+        }
+
+        genesis::oracle::JsonWriter json;
+        json.beginObject()
+                .field("jobId", event.id)
+                .field("type", type_)
+                .field("state", genesis::oracle::jobStateName(event.state))
+                .field("done", event.done)
+                .field("total", event.total)
+                .endObject();
+        // The dispatcher never returns to Java, so local references must be freed here.
+        jstring status = env->NewStringUTF(json.str().c_str());
+        if (status != nullptr) {
+            env->CallVoidMethod(callback_, onStatusUpdate_, status);
+        }
+        clearException(env);
+        env->DeleteLocalRef(status);
+
+        if (final) {
+            env->DeleteGlobalRef(callback_);
+            callback_ = nullptr;
+        }
+    }
+
+    static void clearException(JNIEnv *env) {
+        if (env->ExceptionCheck()) {
+            LOGE("Job callback threw an exception");
+            env->ExceptionClear();
+        }
+    }
+
+    std::string type_;
+    jobject callback_ = nullptr;
+    jmethodID onStatusUpdate_ = nullptr;
+    jmethodID onDataReceived_ = nullptr;
+};
+
+// Queues `body` on the shared scheduler with events forwarded to `callback`; returns the job
+// id, or 0 if the callback is unusable.
+jlong submitJob(JNIEnv *env, jobject callback, const char *jobType,
+                genesis::oracle::JobScheduler::Body body) {
+    genesis::oracle::JobScheduler::Listener listener = JobCallback::create(env, callback,
+                                                                           jobType);
+    if (listener == nullptr) {
+        return 0;
+    }
+    return static_cast<jlong>(genesis::oracle::JobScheduler::shared().submit(
+            std::move(body), std::move(listener)));
+}
+
+// Copies a Java string, or returns false if it is null.
+bool copyString(JNIEnv *env, jstring value, std::string &out) {
+    const char *chars = value != nullptr ? env->GetStringUTFChars(value, nullptr) : nullptr;
+    if (chars == nullptr) {
+        return false;
+    }
+    out = chars;
+    env->ReleaseStringUTFChars(value, chars);
+    return true;
+}
+
+} // namespace
+
 extern "C" {
 
+/**
+ * Records the VM for the job dispatcher thread, which attaches itself to deliver callbacks
+ */
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *vm, void * /* reserved */) {
+    javaVm = vm;
+    return JNI_VERSION_1_6;
+}
+
 /**
  * Initialize Oracle Drive Native ROM Engine
  * Called from Kotlin to initialize the native ROM processing capabilities
@@ -32,41 +281,133 @@ Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_initializeRomE
 
 /**
  * Analyze boot.img file for ROM engineering
- * @param bootImagePath Path to the boot.img file
- * @return JSON string with analysis results
+ * @param bootImagePath Path to a boot.img (header v0-v4) or vendor_boot.img
+ * @return JSON string with header fields and the offset, size and compression of each
+ *         section, or {"status":"error",...} if the file is not a valid boot image
  */
 JNIEXPORT jstring JNICALL
 Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_analyzeBootImage(
         JNIEnv *env, jobject thiz, jstring bootImagePath) {
 
     const char *path = env->GetStringUTFChars(bootImagePath, nullptr);
+    if (path == nullptr) {
+        return nullptr;
+    }
     LOGI("Analyzing boot image: %s", path);
 
-    // TODO: Implement actual boot.img analysis
-    // For now, return placeholder JSON
-    std::string result = R"({
-        "status": "success",
-        "bootImageVersion": "Android 14",
-        "kernelVersion": "6.1.0",
-        "ramdiskSize": "45MB",
-        "compressionType": "lz4",
-        "architecture": "arm64",
-        "securityPatchLevel": "2024-08-01",
-        "auraAnalysis": {
-            "customizations": [],
-            "vulnerabilities": [],
-            "optimizations": ["kernel_hardening", "selinux_enforcing"]
-        }
-    })";
+    std::unique_ptr<genesis::oracle::BootImage> image = genesis::oracle::BootImage::open(path);
+    std::string result;
+    if (image != nullptr) {
+        result = image->toJson();
+    } else {
+        LOGE("Not a valid boot image: %s", path);
+        genesis::oracle::JsonWriter json;
+        json.beginObject()
+                .field("status", "error")
+                .field("message", "not a valid boot or vendor_boot image")
+                .endObject();
+        result = json.str();
+    }
 
     env->ReleaseStringUTFChars(bootImagePath, path);
     return env->NewStringUTF(result.c_str());
 }
 
+/**
+ * Open a boot image for zero-copy section access
+ * @param bootImagePath Path to a boot.img or vendor_boot.img
+ * @return Handle for bootImageSection/closeBootImage, or 0 if the file is not a valid image
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_openBootImage(
+        JNIEnv *env, jobject thiz, jstring bootImagePath) {
+
+    const char *path = env->GetStringUTFChars(bootImagePath, nullptr);
+    if (path == nullptr) {
+        return 0;
+    }
+    std::unique_ptr<genesis::oracle::BootImage> image = genesis::oracle::BootImage::open(path);
+    env->ReleaseStringUTFChars(bootImagePath, path);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(image.release()));
+}
+
+/**
+ * View one section of an open boot image
+ * @param handle Handle from openBootImage
+ * @param sectionName Section name as reported by analyzeBootImage ("kernel", "ramdisk", ...)
+ * @return Direct ByteBuffer over the mapped file, or null if there is no such section. The
+ *         buffer is backed by a read-only mapping: do not write to it (use
+ *         asReadOnlyBuffer()), and do not use it after closeBootImage
+ */
+JNIEXPORT jobject JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_bootImageSection(
+        JNIEnv *env, jobject thiz, jlong handle, jstring sectionName) {
+
+    auto *image = reinterpret_cast<genesis::oracle::BootImage *>(static_cast<intptr_t>(handle));
+    if (image == nullptr || sectionName == nullptr) {
+        return nullptr;
+    }
+    const char *name = env->GetStringUTFChars(sectionName, nullptr);
+    if (name == nullptr) {
+        return nullptr;
+    }
+    std::span<const uint8_t> section = image->section(name);
+    env->ReleaseStringUTFChars(sectionName, name);
+    if (section.empty()) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(const_cast<uint8_t *>(section.data()),
+                                    static_cast<jlong>(section.size()));
+}
+
+/**
+ * Write one section of an open boot image to a file, decompressed if it is compressed
+ * (gzip, lz4, zstd, xz, lzma or bzip2)
+ * @param handle Handle from openBootImage
+ * @param sectionName Section name as reported by analyzeBootImage ("kernel", "ramdisk", ...)
+ * @param outputPath File to create or overwrite
+ * @return true if the section was written
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_unpackBootImageSection(
+        JNIEnv *env, jobject thiz, jlong handle, jstring sectionName, jstring outputPath) {
+
+    auto *image = reinterpret_cast<genesis::oracle::BootImage *>(static_cast<intptr_t>(handle));
+    if (image == nullptr || sectionName == nullptr || outputPath == nullptr) {
+        return JNI_FALSE;
+    }
+    const char *name = env->GetStringUTFChars(sectionName, nullptr);
+    const char *output = env->GetStringUTFChars(outputPath, nullptr);
+    bool ok = false;
+    if (name != nullptr && output != nullptr) {
+        ok = image->extractSection(name, output, &genesis::oracle::WorkStealingPool::shared());
+        if (!ok) {
+            LOGE("Failed to unpack boot image section %s", name);
+        }
+    }
+    if (name != nullptr) {
+        env->ReleaseStringUTFChars(sectionName, name);
+    }
+    if (output != nullptr) {
+        env->ReleaseStringUTFChars(outputPath, output);
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Close a boot image opened with openBootImage, unmapping the file
+ */
+JNIEXPORT void JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_closeBootImage(
+        JNIEnv *env, jobject thiz, jlong handle) {
+    delete reinterpret_cast<genesis::oracle::BootImage *>(static_cast<intptr_t>(handle));
+}
+
 /**
  * Extract ROM components for Aura and Kai reverse engineering
- * @param romPath Path to the ROM file
- * @param outputDir Output directory for extracted components
+ * @param romPath Path to a full OTA package, its payload.bin, or a sparse image
+ * @param outputDir Output directory; receives <partition>.img for each payload partition, or
+ *                  the expanded raw image
  * @return Success status
  */
 JNIEXPORT jboolean JNICALL
@@ -75,30 +416,35 @@ Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_extractRomComp
 
     const char *rom_path = env->GetStringUTFChars(romPath, nullptr);
     const char *output_dir = env->GetStringUTFChars(outputDir, nullptr);
+    if (rom_path == nullptr || output_dir == nullptr) {
+        if (rom_path != nullptr) {
+            env->ReleaseStringUTFChars(romPath, rom_path);
+        }
+        if (output_dir != nullptr) {
+            env->ReleaseStringUTFChars(outputDir, output_dir);
+        }
+        return JNI_FALSE;
+    }
 
     LOGI("Extracting ROM components from: %s to: %s", rom_path, output_dir);
 
-    try {
-        // TODO: Implement ROM extraction logic
-        // This will extract boot.img, system.img, vendor.img, etc.
+    const bool success = extractRom(rom_path, output_dir,
+                                    genesis::oracle::PayloadExtractOptions());
+    if (success) {
         LOGI("ROM components extracted successfully");
-
-        env->ReleaseStringUTFChars(romPath, rom_path);
-        env->ReleaseStringUTFChars(outputDir, output_dir);
-        return JNI_TRUE;
-    } catch (const std::exception &e) {
-        LOGE("ROM extraction failed: %s", e.what());
-        env->ReleaseStringUTFChars(romPath, rom_path);
-        env->ReleaseStringUTFChars(outputDir, output_dir);
-        return JNI_FALSE;
+    } else {
+        LOGE("ROM extraction failed: %s", rom_path);
     }
+    env->ReleaseStringUTFChars(romPath, rom_path);
+    env->ReleaseStringUTFChars(outputDir, output_dir);
+    return success ? JNI_TRUE : JNI_FALSE;
 }
 
 /**
  * Create custom ROM with Aura/Kai modifications
- * @param baseRomPath Path to base ROM
- * @param modificationsJson JSON string with modifications
- * @param outputPath Output path for custom ROM
+ * @param baseRomPath Path to the base raw image
+ * @param modificationsJson JSON string with modifications (see RomModifications for the format)
+ * @param outputPath Output path for custom ROM; may equal baseRomPath to patch in place
  * @return Success status
  */
 JNIEXPORT jboolean JNICALL
@@ -110,26 +456,161 @@ Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_createCustomRo
     const char *modifications = env->GetStringUTFChars(modificationsJson, nullptr);
     const char *output_path = env->GetStringUTFChars(outputPath, nullptr);
 
-    LOGI("Creating custom ROM with Aura/Kai modifications");
-    LOGI("Base ROM: %s", base_path);
-    LOGI("Output: %s", output_path);
+    bool success = false;
+    if (base_path != nullptr && modifications != nullptr && output_path != nullptr) {
+        LOGI("Creating custom ROM with Aura/Kai modifications");
+        LOGI("Base ROM: %s", base_path);
+        LOGI("Output: %s", output_path);
 
-    try {
-        // TODO: Implement custom ROM creation logic
-        // This will apply Aura/Kai AI-generated modifications
-        LOGI("Custom ROM created successfully");
+        success = buildCustomRom(base_path, modifications, output_path, nullptr);
+    }
 
+    if (base_path != nullptr) {
         env->ReleaseStringUTFChars(baseRomPath, base_path);
+    }
+    if (modifications != nullptr) {
         env->ReleaseStringUTFChars(modificationsJson, modifications);
+    }
+    if (output_path != nullptr) {
         env->ReleaseStringUTFChars(outputPath, output_path);
-        return JNI_TRUE;
-    } catch (const std::exception &e) {
-        LOGE("Custom ROM creation failed: %s", e.what());
-        env->ReleaseStringUTFChars(baseRomPath, base_path);
-        env->ReleaseStringUTFChars(modificationsJson, modifications);
-        env->ReleaseStringUTFChars(outputPath, output_path);
+    }
+    return success ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Enable the on-disk block cache shared by extractRomComponents and createCustomRom
+ * @param cacheDir Directory for the cache, e.g. under Context.getCacheDir(); created if missing
+ * @param maxBytes Size limit of cached data; the cache is emptied when an insert would pass it
+ * @return Success status
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_configureBlockCache(
+        JNIEnv *env, jobject thiz, jstring cacheDir, jlong maxBytes) {
+
+    const char *dir = env->GetStringUTFChars(cacheDir, nullptr);
+    if (dir == nullptr) {
         return JNI_FALSE;
     }
+    const bool configured = maxBytes > 0 &&
+                            genesis::oracle::BlockStore::configureShared(
+                                    dir, static_cast<uint64_t>(maxBytes));
+    if (!configured) {
+        LOGE("Cannot open block cache in %s", dir);
+    }
+    env->ReleaseStringUTFChars(cacheDir, dir);
+    return configured ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Report block cache usage
+ * @return JSON with entries, bytes, hits and misses, or {"enabled":false} if no cache is
+ *         configured
+ */
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_blockCacheStats(
+        JNIEnv *env, jobject thiz) {
+    genesis::oracle::JsonWriter json;
+    json.beginObject();
+    if (std::shared_ptr<genesis::oracle::BlockStore> cache =
+            genesis::oracle::BlockStore::shared()) {
+        const genesis::oracle::BlockStore::Stats stats = cache->stats();
+        json.field("enabled", true)
+                .field("entries", stats.entries)
+                .field("bytes", stats.bytes)
+                .field("hits", stats.hits)
+                .field("misses", stats.misses);
+    } else {
+        json.field("enabled", false);
+    }
+    json.endObject();
+    return env->NewStringUTF(json.str().c_str());
+}
+
+/**
+ * Extract ROM components in the background (see extractRomComponents)
+ * @param callback IAuraDriveCallback for status, progress and completion; may be null
+ * @return Job id for cancelJob, or 0 if the job could not be queued
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_submitExtractJob(
+        JNIEnv *env, jobject thiz, jstring romPath, jstring outputDir, jobject callback) {
+
+    std::string rom, output;
+    if (!copyString(env, romPath, rom) || !copyString(env, outputDir, output)) {
+        return 0;
+    }
+    return submitJob(env, callback, "extract", [rom, output](genesis::oracle::JobContext &job) {
+        genesis::oracle::PayloadExtractOptions options;
+        options.cancelled = job.cancelFlag();
+        options.progress = [&job](uint64_t done, uint64_t total) { job.progress(done, total); };
+        options.window = &job.ioBudget();
+        return extractRom(rom.c_str(), output.c_str(), options);
+    });
+}
+
+/**
+ * Create a custom ROM in the background (see createCustomRom). The result delivered through
+ * onDataReceived("build", ...) is JSON with the output path, build mode and statistics. A
+ * build can only be cancelled before it starts.
+ * @return Job id for cancelJob, or 0 if the job could not be queued
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_submitBuildJob(
+        JNIEnv *env, jobject thiz, jstring baseRomPath, jstring modificationsJson,
+        jstring outputPath, jobject callback) {
+
+    std::string base, modifications, output;
+    if (!copyString(env, baseRomPath, base) || !copyString(env, modificationsJson, modifications) ||
+        !copyString(env, outputPath, output)) {
+        return 0;
+    }
+    return submitJob(env, callback, "build",
+                     [base, modifications, output](genesis::oracle::JobContext &job) {
+                         std::string report;
+                         if (job.cancelled() ||
+                             !buildCustomRom(base.c_str(), modifications.c_str(), output.c_str(),
+                                             &report)) {
+                             return false;
+                         }
+                         job.setResult(std::move(report));
+                         return true;
+                     });
+}
+
+/**
+ * Analyze a boot image in the background; the analyzeBootImage JSON arrives through
+ * onDataReceived("analyze", ...)
+ * @return Job id for cancelJob, or 0 if the job could not be queued
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_submitAnalyzeJob(
+        JNIEnv *env, jobject thiz, jstring bootImagePath, jobject callback) {
+
+    std::string path;
+    if (!copyString(env, bootImagePath, path)) {
+        return 0;
+    }
+    return submitJob(env, callback, "analyze", [path](genesis::oracle::JobContext &job) {
+        std::unique_ptr<genesis::oracle::BootImage> image =
+                genesis::oracle::BootImage::open(path.c_str());
+        if (image == nullptr) {
+            LOGE("Not a valid boot image: %s", path.c_str());
+            return false;
+        }
+        job.setResult(image->toJson());
+        return true;
+    });
+}
+
+/**
+ * Cancel a job from one of the submit*Job calls
+ * @return Whether the job was still queued or running
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_oracledrive_native_OracleDriveNative_cancelJob(
+        JNIEnv *env, jobject thiz, jlong jobId) {
+    return genesis::oracle::JobScheduler::shared().cancel(static_cast<uint64_t>(jobId))
+           ? JNI_TRUE : JNI_FALSE;
 }
 
 /**
@@ -0,0 +1,487 @@
+#include "payload_extractor.h"
+
+#include <android/log.h>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <string_view>
+#include <unistd.h>
+
+#include "block_store.h"
+#include "decompressor.h"
+#include "file_io.h"
+#include "in_flight_window.h"
+#include "proto_reader.h"
+#include "work_stealing_pool.h"
+#include "zip_archive.h"
+
+#define LOG_TAG "PayloadExtractor"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint8_t kPayloadMagic[4] = {'C', 'r', 'A', 'U'};
+constexpr uint64_t kSupportedMajorVersion = 2;
+constexpr size_t kPayloadHeaderSize = 24;
+
+// DeltaArchiveManifest, PartitionUpdate, PartitionInfo, InstallOperation and Extent field
+// numbers from update_engine's update_metadata.proto.
+constexpr uint32_t kManifestBlockSize = 3;
+constexpr uint32_t kManifestPartitions = 13;
+constexpr uint32_t kPartitionName = 1;
+constexpr uint32_t kPartitionNewInfo = 7;
+constexpr uint32_t kPartitionOperations = 8;
+constexpr uint32_t kInfoSize = 1;
+constexpr uint32_t kOperationType = 1;
+constexpr uint32_t kOperationDataOffset = 2;
+constexpr uint32_t kOperationDataLength = 3;
+constexpr uint32_t kOperationDstExtents = 6;
+constexpr uint32_t kExtentStartBlock = 1;
+constexpr uint32_t kExtentBlockCount = 2;
+
+inline uint64_t be64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+inline uint32_t be32(const uint8_t *p) {
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+bool parseExtent(std::span<const uint8_t> bytes, PayloadOperation::Extent &extent) {
+    extent = {};
+    ProtoReader reader(bytes);
+    uint32_t field, wireType;
+    while (reader.next(field, wireType)) {
+        if (field == kExtentStartBlock && wireType == ProtoReader::kVarint) {
+            reader.varint(extent.startBlock);
+        } else if (field == kExtentBlockCount && wireType == ProtoReader::kVarint) {
+            reader.varint(extent.blockCount);
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    return reader.ok();
+}
+
+bool parseOperation(std::span<const uint8_t> bytes, PayloadOperation &op) {
+    op = {};
+    ProtoReader reader(bytes);
+    uint32_t field, wireType;
+    uint64_t value;
+    std::span<const uint8_t> nested;
+    while (reader.next(field, wireType)) {
+        if (field == kOperationType && wireType == ProtoReader::kVarint) {
+            if (reader.varint(value)) {
+                op.type = static_cast<uint32_t>(value);
+            }
+        } else if (field == kOperationDataOffset && wireType == ProtoReader::kVarint) {
+            reader.varint(op.dataOffset);
+        } else if (field == kOperationDataLength && wireType == ProtoReader::kVarint) {
+            reader.varint(op.dataLength);
+        } else if (field == kOperationDstExtents && wireType == ProtoReader::kLengthDelimited) {
+            PayloadOperation::Extent extent;
+            if (!reader.bytes(nested) || !parseExtent(nested, extent)) {
+                return false;
+            }
+            op.extents.push_back(extent);
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    return reader.ok();
+}
+
+bool parsePartition(std::span<const uint8_t> bytes, PayloadPartition &partition) {
+    partition = {};
+    ProtoReader reader(bytes);
+    uint32_t field, wireType;
+    std::span<const uint8_t> nested;
+    while (reader.next(field, wireType)) {
+        if (field == kPartitionName && wireType == ProtoReader::kLengthDelimited) {
+            if (reader.bytes(nested)) {
+                partition.name.assign(reinterpret_cast<const char *>(nested.data()),
+                                      nested.size());
+            }
+        } else if (field == kPartitionNewInfo && wireType == ProtoReader::kLengthDelimited) {
+            if (!reader.bytes(nested)) {
+                break;
+            }
+            ProtoReader info(nested);
+            uint32_t infoField, infoWireType;
+            while (info.next(infoField, infoWireType)) {
+                if (infoField == kInfoSize && infoWireType == ProtoReader::kVarint) {
+                    info.varint(partition.size);
+                } else {
+                    info.skip(infoWireType);
+                }
+            }
+            if (!info.ok()) {
+                return false;
+            }
+        } else if (field == kPartitionOperations && wireType == ProtoReader::kLengthDelimited) {
+            PayloadOperation op;
+            if (!reader.bytes(nested) || !parseOperation(nested, op)) {
+                return false;
+            }
+            partition.operations.push_back(std::move(op));
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    return reader.ok();
+}
+
+// Partition names become file names, so they must not reach outside the output directory.
+bool isSafeName(std::string_view name) {
+    return !name.empty() && name != "." && name != ".." && name.find('/') == std::string::npos;
+}
+
+bool isSupportedType(uint32_t type) {
+    switch (type) {
+        case PayloadOperation::Replace:
+        case PayloadOperation::ReplaceBz:
+        case PayloadOperation::ReplaceXz:
+        case PayloadOperation::ReplaceZstd:
+        case PayloadOperation::Zero:
+        case PayloadOperation::Discard:
+            return true;
+        default:
+            return false;
+    }
+}
+
+CompressionFormat operationFormat(uint32_t type) {
+    switch (type) {
+        case PayloadOperation::ReplaceBz:
+            return CompressionFormat::Bzip2;
+        case PayloadOperation::ReplaceXz:
+            return CompressionFormat::Xz;
+        case PayloadOperation::ReplaceZstd:
+            return CompressionFormat::Zstd;
+        default:
+            return CompressionFormat::None;
+    }
+}
+
+uint64_t extentBytes(const PayloadOperation &op, uint64_t blockSize) {
+    uint64_t total = 0;
+    for (const PayloadOperation::Extent &extent: op.extents) {
+        total += extent.blockCount * blockSize;
+    }
+    return total;
+}
+
+// Calls `write(source offset, file offset, size)` for the pieces of the first `length` bytes
+// of an operation's output, laid over its extents in order. Returns false if the extents
+// cannot hold `length` bytes.
+template<typename Write>
+bool forEachExtent(const PayloadOperation &op, uint64_t blockSize, uint64_t length,
+                   Write write) {
+    uint64_t done = 0;
+    for (const PayloadOperation::Extent &extent: op.extents) {
+        if (done == length) {
+            break;
+        }
+        const uint64_t room = extent.blockCount * blockSize;
+        const uint64_t size = length - done < room ? length - done : room;
+        if (!write(done, extent.startBlock * blockSize, size)) {
+            return false;
+        }
+        done += size;
+    }
+    return done == length;
+}
+
+bool writeExtents(int fd, const uint8_t *data, size_t length, const PayloadOperation &op,
+                  uint64_t blockSize) {
+    return forEachExtent(op, blockSize, length, [&](uint64_t from, uint64_t to, uint64_t size) {
+        return pwriteAll(fd, data + from, static_cast<size_t>(size), to);
+    });
+}
+
+// Writes a cached decompressed operation, or returns false if it is not cached.
+bool writeExtentsFromStore(int fd, const BlockStore &store, const ContentKey &key,
+                           const PayloadOperation &op, uint64_t blockSize) {
+    const uint64_t length = store.find(key);
+    return length != 0 &&
+           forEachExtent(op, blockSize, length, [&](uint64_t from, uint64_t to, uint64_t size) {
+               return store.copyTo(key, from, size, fd, to);
+           });
+}
+
+} // namespace
+
+bool PayloadExtractor::isPayload(std::span<const uint8_t> data) {
+    return data.size() >= sizeof(kPayloadMagic) &&
+           memcmp(data.data(), kPayloadMagic, sizeof(kPayloadMagic)) == 0;
+}
+
+std::unique_ptr<PayloadExtractor> PayloadExtractor::open(const char *path) {
+    std::unique_ptr<MappedFile> file = MappedFile::open(path, MappedFile::Access::Normal);
+    if (file == nullptr) {
+        return nullptr;
+    }
+    std::span<const uint8_t> payload = file->bytes();
+    if (isZipArchive(payload)) {
+        payload = findStoredZipEntry(payload, "payload.bin");
+    }
+    std::unique_ptr<PayloadExtractor> extractor = parse(payload);
+    if (extractor != nullptr) {
+        extractor->file_ = std::move(file);
+    }
+    return extractor;
+}
+
+std::unique_ptr<PayloadExtractor> PayloadExtractor::parse(std::span<const uint8_t> payload) {
+    if (payload.size() < kPayloadHeaderSize || !isPayload(payload)) {
+        return nullptr;
+    }
+    const uint8_t *p = payload.data();
+    if (be64(p + 4) != kSupportedMajorVersion) {
+        return nullptr;
+    }
+    const uint64_t manifestSize = be64(p + 12);
+    const uint64_t signatureSize = be32(p + 20);
+    const uint64_t available = payload.size() - kPayloadHeaderSize;
+    if (manifestSize > available || signatureSize > available - manifestSize) {
+        return nullptr;
+    }
+
+    std::unique_ptr<PayloadExtractor> extractor(new PayloadExtractor());
+    extractor->blobs_ = payload.subspan(kPayloadHeaderSize + manifestSize + signatureSize);
+
+    ProtoReader reader(p + kPayloadHeaderSize, manifestSize);
+    uint32_t field, wireType;
+    uint64_t value;
+    std::span<const uint8_t> nested;
+    while (reader.next(field, wireType)) {
+        if (field == kManifestBlockSize && wireType == ProtoReader::kVarint) {
+            if (reader.varint(value)) {
+                extractor->blockSize_ = value;
+            }
+        } else if (field == kManifestPartitions && wireType == ProtoReader::kLengthDelimited) {
+            PayloadPartition partition;
+            if (!reader.bytes(nested) || !parsePartition(nested, partition)) {
+                return nullptr;
+            }
+            extractor->partitions_.push_back(std::move(partition));
+        } else {
+            reader.skip(wireType);
+        }
+    }
+    if (!reader.ok() || extractor->blockSize_ == 0 || extractor->blockSize_ > (1u << 24)) {
+        return nullptr;
+    }
+
+    // Reject anything that would make offset arithmetic overflow later.
+    const uint64_t maxBlocks = UINT64_MAX / 2 / extractor->blockSize_;
+    for (const PayloadPartition &partition: extractor->partitions_) {
+        if (!isSafeName(partition.name)) {
+            return nullptr;
+        }
+        for (const PayloadOperation &op: partition.operations) {
+            uint64_t blocks = 0;
+            for (const PayloadOperation::Extent &extent: op.extents) {
+                if (extent.startBlock > maxBlocks || extent.blockCount > maxBlocks - blocks ||
+                    extent.blockCount > maxBlocks - extent.startBlock) {
+                    return nullptr;
+                }
+                blocks += extent.blockCount;
+            }
+        }
+    }
+    return extractor;
+}
+
+bool PayloadExtractor::isFullPayload() const {
+    for (const PayloadPartition &partition: partitions_) {
+        for (const PayloadOperation &op: partition.operations) {
+            if (!isSupportedType(op.type)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool PayloadExtractor::extract(const char *outputDir, const PayloadExtractOptions &options,
+                               WorkStealingPool &pool) const {
+    std::vector<const PayloadPartition *> selected;
+    for (const std::string &name: options.partitions) {
+        const PayloadPartition *match = nullptr;
+        for (const PayloadPartition &partition: partitions_) {
+            if (partition.name == name) {
+                match = &partition;
+            }
+        }
+        if (match == nullptr) {
+            LOGE("Payload has no partition '%s'", name.c_str());
+            return false;
+        }
+        selected.push_back(match);
+    }
+    if (options.partitions.empty()) {
+        for (const PayloadPartition &partition: partitions_) {
+            selected.push_back(&partition);
+        }
+    }
+
+    // Validate everything up front so a bad operation cannot leave half-written images.
+    uint64_t totalBytes = 0;
+    for (const PayloadPartition *partition: selected) {
+        for (const PayloadOperation &op: partition->operations) {
+            if (!isSupportedType(op.type)) {
+                if (isFullPayload()) {
+                    LOGE("%s: operation type %u is not supported", partition->name.c_str(),
+                         op.type);
+                } else {
+                    LOGE("Incremental payloads are not supported");
+                }
+                return false;
+            }
+            if (op.dataOffset > blobs_.size() || op.dataLength > blobs_.size() - op.dataOffset) {
+                LOGE("%s: operation data lies outside the payload", partition->name.c_str());
+                return false;
+            }
+            const uint64_t outSize = extentBytes(op, blockSize_);
+            if (outSize > SIZE_MAX / 2) {
+                LOGE("%s: operation is too large to buffer", partition->name.c_str());
+                return false;
+            }
+            totalBytes += outSize;
+        }
+    }
+
+    std::vector<int> fds;
+    bool opened = true;
+    for (const PayloadPartition *partition: selected) {
+        uint64_t size = partition->size;
+        for (const PayloadOperation &op: partition->operations) {
+            for (const PayloadOperation::Extent &extent: op.extents) {
+                const uint64_t end = (extent.startBlock + extent.blockCount) * blockSize_;
+                size = end > size ? end : size;
+            }
+        }
+        const std::string path = std::string(outputDir) + "/" + partition->name + ".img";
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOGE("Cannot create %s", path.c_str());
+            opened = false;
+            break;
+        }
+        fds.push_back(fd);
+        // The image starts as one hole, so ZERO and DISCARD operations need no writes.
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            LOGE("Cannot resize %s", path.c_str());
+            opened = false;
+            break;
+        }
+    }
+
+    std::atomic<bool> failed{!opened};
+    std::atomic<uint64_t> written{0};
+    InFlightWindow ownWindow(options.window != nullptr ? 0 : options.maxInFlightBytes);
+    InFlightWindow &window = options.window != nullptr ? *options.window : ownWindow;
+    TaskGroup group(pool);
+    const auto finished = [&](uint64_t bytes) {
+        const uint64_t done = written.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (options.progress) {
+            options.progress(done, totalBytes);
+        }
+    };
+    const auto stopping = [&] {
+        return failed.load(std::memory_order_relaxed) ||
+               (options.cancelled != nullptr && options.cancelled->load(std::memory_order_relaxed));
+    };
+
+    for (size_t i = 0; i < selected.size() && !stopping(); ++i) {
+        const PayloadPartition &partition = *selected[i];
+        const int fd = fds[i];
+        for (const PayloadOperation &op: partition.operations) {
+            if (stopping()) {
+                break;
+            }
+            const uint8_t *blob = blobs_.data() + op.dataOffset;
+            const uint64_t outSize = extentBytes(op, blockSize_);
+            switch (op.type) {
+                case PayloadOperation::Replace:
+                    if (op.dataLength > outSize) {
+                        LOGE("%s: REPLACE data exceeds its extents", partition.name.c_str());
+                        failed = true;
+                        break;
+                    }
+                    group.run([&, fd, blob, outSize] {
+                        if (stopping()) {
+                            return;
+                        }
+                        if (!writeExtents(fd, blob, op.dataLength, op, blockSize_)) {
+                            failed = true;
+                            return;
+                        }
+                        finished(outSize);
+                    });
+                    break;
+                case PayloadOperation::ReplaceBz:
+                case PayloadOperation::ReplaceXz:
+                case PayloadOperation::ReplaceZstd:
+                    // Reserved here rather than in the task so queued work cannot pile up
+                    // allocations beyond the window.
+                    window.acquire(outSize, pool);
+                    group.run([&, fd, blob, outSize] {
+                        if (!stopping()) {
+                            // Keyed by the compressed data, so a repeated payload skips
+                            // decompression entirely.
+                            const ContentKey key = contentKey(blob, op.dataLength, op.type);
+                            if (options.cache != nullptr &&
+                                writeExtentsFromStore(fd, *options.cache, key, op, blockSize_)) {
+                                finished(outSize);
+                                window.release(outSize);
+                                return;
+                            }
+                            std::unique_ptr<uint8_t[]> buffer(new(std::nothrow) uint8_t[outSize]);
+                            size_t decoded = 0;
+                            // Operations already run in parallel, so each decodes on
+                            // its own thread.
+                            const bool ok = buffer != nullptr &&
+                                            decompress(operationFormat(op.type), blob,
+                                                       op.dataLength, buffer.get(), outSize,
+                                                       &decoded) &&
+                                            writeExtents(fd, buffer.get(), decoded, op,
+                                                         blockSize_);
+                            if (ok) {
+                                if (options.cache != nullptr) {
+                                    options.cache->put(key, buffer.get(), decoded);
+                                }
+                                finished(outSize);
+                            } else {
+                                LOGE("%s: failed to decompress operation data",
+                                     partition.name.c_str());
+                                failed = true;
+                            }
+                        }
+                        window.release(outSize);
+                    });
+                    break;
+                default:
+                    finished(outSize);
+                    break;
+            }
+        }
+    }
+    group.wait();
+
+    for (int fd: fds) {
+        if (close(fd) != 0) {
+            failed = true;
+        }
+    }
+    return !stopping();
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,126 @@
+#ifndef PAYLOAD_EXTRACTOR_H
+#define PAYLOAD_EXTRACTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace genesis::oracle {
+
+class BlockStore;
+
+class InFlightWindow;
+
+class WorkStealingPool;
+
+/**
+ * @brief One write of a full OTA: decompress a blob from the payload into a list of extents.
+ */
+struct PayloadOperation {
+    // InstallOperation.Type as defined by update_engine.
+    enum Type : uint32_t {
+        Replace = 0,
+        ReplaceBz = 1,
+        Zero = 6,
+        Discard = 7,
+        ReplaceXz = 8,
+        ReplaceZstd = 14,
+    };
+
+    struct Extent {
+        uint64_t startBlock;
+        uint64_t blockCount;
+    };
+
+    uint32_t type;
+    uint64_t dataOffset;
+    uint64_t dataLength;
+    std::vector<Extent> extents;
+};
+
+struct PayloadPartition {
+    std::string name;
+    uint64_t size;
+    std::vector<PayloadOperation> operations;
+};
+
+struct PayloadExtractOptions {
+    // Upper bound on decompression buffers held at once, across all partitions.
+    size_t maxInFlightBytes = 256 * 1024 * 1024;
+    // Partitions to extract; empty means all of them.
+    std::vector<std::string> partitions;
+    // Polled between operations; extraction stops early and fails once it reads true.
+    const std::atomic<bool> *cancelled = nullptr;
+    // Called with (bytes written, total bytes) after each operation, from worker threads and
+    // possibly concurrently.
+    std::function<void(uint64_t, uint64_t)> progress;
+    // Decompressed operations are looked up in and added to this store, if set.
+    BlockStore *cache = nullptr;
+    // Budget to draw decompression buffers from instead of a private one of
+    // maxInFlightBytes, so concurrent extractions share one limit.
+    InFlightWindow *window = nullptr;
+};
+
+/**
+ * @brief update_engine payload (payload.bin, bare or stored inside an OTA zip) extracted to
+ * raw partition images.
+ *
+ * Operations of every selected partition are decompressed in parallel on a WorkStealingPool
+ * and written with pwrite() at their target offsets, so partitions fill in out of order.
+ * REPLACE data is written straight from the mapping; XZ, BZ2 and ZSTD blobs are decoded into
+ * buffers whose total size is bounded by PayloadExtractOptions::maxInFlightBytes. Only full
+ * payloads can be extracted: delta operations need the source partitions.
+ */
+class PayloadExtractor {
+public:
+    /**
+     * @brief Opens a payload.bin or an OTA zip containing one, or returns nullptr if the file
+     * is neither or its manifest cannot be parsed.
+     */
+    static std::unique_ptr<PayloadExtractor> open(const char *path);
+
+    /**
+     * @brief Parses a payload held in memory, which must outlive the result.
+     */
+    static std::unique_ptr<PayloadExtractor> parse(std::span<const uint8_t> payload);
+
+    static bool isPayload(std::span<const uint8_t> data);
+
+    PayloadExtractor(const PayloadExtractor &) = delete;
+
+    PayloadExtractor &operator=(const PayloadExtractor &) = delete;
+
+    const std::vector<PayloadPartition> &partitions() const { return partitions_; }
+
+    uint64_t blockSize() const { return blockSize_; }
+
+    /**
+     * @brief Whether every operation can be applied without a source image.
+     */
+    bool isFullPayload() const;
+
+    /**
+     * @brief Writes `<outputDir>/<partition>.img` for each selected partition.
+     */
+    bool extract(const char *outputDir, const PayloadExtractOptions &options,
+                 WorkStealingPool &pool) const;
+
+private:
+    PayloadExtractor() = default;
+
+    std::unique_ptr<MappedFile> file_;
+    std::span<const uint8_t> blobs_;
+    uint64_t blockSize_ = 4096;
+    std::vector<PayloadPartition> partitions_;
+};
+
+} // namespace genesis::oracle
+
+#endif // PAYLOAD_EXTRACTOR_H
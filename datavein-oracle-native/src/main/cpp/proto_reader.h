@@ -0,0 +1,110 @@
+#ifndef PROTO_READER_H
+#define PROTO_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Forward-only reader for protobuf wire format, enough to walk update_engine
+ * manifests without generated code. Length-delimited fields are returned as views into the
+ * input.
+ */
+class ProtoReader {
+public:
+    enum WireType : uint32_t {
+        kVarint = 0,
+        kFixed64 = 1,
+        kLengthDelimited = 2,
+        kFixed32 = 5,
+    };
+
+    ProtoReader(const uint8_t *data, size_t length) : p_(data), end_(data + length) {}
+
+    explicit ProtoReader(std::span<const uint8_t> bytes)
+            : ProtoReader(bytes.data(), bytes.size()) {}
+
+    /**
+     * @brief Reads the next field key. Returns false at the end of input or on malformed
+     * data (check ok() to tell them apart).
+     */
+    bool next(uint32_t &field, uint32_t &wireType) {
+        if (p_ == end_) {
+            return false;
+        }
+        uint64_t key;
+        if (!varint(key) || (key >> 3) == 0 || (key >> 3) > UINT32_MAX) {
+            ok_ = false;
+            return false;
+        }
+        field = static_cast<uint32_t>(key >> 3);
+        wireType = static_cast<uint32_t>(key & 7);
+        return true;
+    }
+
+    bool varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p_ == end_) {
+                return ok_ = false;
+            }
+            const uint8_t byte = *p_++;
+            value |= uint64_t{byte & 0x7fu} << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return ok_ = false;
+    }
+
+    bool bytes(std::span<const uint8_t> &value) {
+        uint64_t length;
+        if (!varint(length) || length > static_cast<uint64_t>(end_ - p_)) {
+            return ok_ = false;
+        }
+        value = {p_, static_cast<size_t>(length)};
+        p_ += length;
+        return true;
+    }
+
+    /**
+     * @brief Skips the value of a field with `wireType`.
+     */
+    bool skip(uint32_t wireType) {
+        uint64_t ignored;
+        std::span<const uint8_t> view;
+        switch (wireType) {
+            case kVarint:
+                return varint(ignored);
+            case kFixed64:
+                return advance(8);
+            case kLengthDelimited:
+                return bytes(view);
+            case kFixed32:
+                return advance(4);
+            default:
+                return ok_ = false;
+        }
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    bool advance(size_t count) {
+        if (static_cast<size_t>(end_ - p_) < count) {
+            return ok_ = false;
+        }
+        p_ += count;
+        return true;
+    }
+
+    const uint8_t *p_;
+    const uint8_t *end_;
+    bool ok_ = true;
+};
+
+} // namespace genesis::oracle
+
+#endif // PROTO_READER_H
@@ -0,0 +1,34 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Incremental SHA-256, used to fingerprint image blocks.
+ */
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+
+    Sha256();
+
+    void update(const uint8_t *data, size_t length);
+
+    void finish(uint8_t digest[kDigestSize]);
+
+    static void hash(const uint8_t *data, size_t length, uint8_t digest[kDigestSize]);
+
+private:
+    uint32_t state_[8];
+    uint8_t buffer_[kBlockSize];
+    size_t buffered_ = 0;
+    uint64_t length_ = 0;
+};
+
+} // namespace genesis::oracle
+
+#endif // SHA256_H
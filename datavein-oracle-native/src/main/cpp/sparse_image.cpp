@@ -0,0 +1,178 @@
+#include "sparse_image.h"
+
+#include <atomic>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+#include "file_io.h"
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+namespace {
+
+constexpr size_t kFileHeaderSize = 28;
+constexpr size_t kChunkHeaderSize = 12;
+constexpr uint16_t kChunkRaw = 0xcac1;
+constexpr uint16_t kChunkFill = 0xcac2;
+constexpr uint16_t kChunkDontCare = 0xcac3;
+constexpr uint16_t kChunkCrc32 = 0xcac4;
+
+// Raw chunks are split so one large chunk still spreads over every worker.
+constexpr size_t kWriteSlice = 8 * 1024 * 1024;
+constexpr size_t kFillBufferSize = 1024 * 1024;
+
+inline uint16_t le16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+struct SparseHeader {
+    uint32_t blockSize;
+    uint32_t totalBlocks;
+    uint32_t totalChunks;
+    uint16_t fileHeaderSize;
+    uint16_t chunkHeaderSize;
+};
+
+bool parseHeader(std::span<const uint8_t> data, SparseHeader &header) {
+    if (data.size() < kFileHeaderSize || le32(data.data()) != SparseImage::kMagic) {
+        return false;
+    }
+    const uint8_t *p = data.data();
+    header.fileHeaderSize = le16(p + 8);
+    header.chunkHeaderSize = le16(p + 10);
+    header.blockSize = le32(p + 12);
+    header.totalBlocks = le32(p + 16);
+    header.totalChunks = le32(p + 20);
+    // Major version 1; the header sizes may grow but never shrink.
+    return le16(p + 4) == 1 && header.fileHeaderSize >= kFileHeaderSize &&
+           header.chunkHeaderSize >= kChunkHeaderSize && header.blockSize != 0 &&
+           header.blockSize % 4 == 0 && header.fileHeaderSize <= data.size();
+}
+
+} // namespace
+
+bool SparseImage::isSparse(std::span<const uint8_t> data) {
+    return data.size() >= 4 && le32(data.data()) == kMagic;
+}
+
+uint64_t SparseImage::expandedSize(std::span<const uint8_t> data) {
+    SparseHeader header;
+    if (!parseHeader(data, header)) {
+        return 0;
+    }
+    return uint64_t{header.totalBlocks} * header.blockSize;
+}
+
+bool SparseImage::forEachChunk(std::span<const uint8_t> data,
+                               const std::function<bool(const SparseChunk &)> &visit,
+                               uint64_t *covered) {
+    SparseHeader header;
+    if (!parseHeader(data, header)) {
+        return false;
+    }
+    const uint8_t *base = data.data();
+    size_t offset = header.fileHeaderSize;
+    uint64_t block = 0;
+    for (uint32_t i = 0; i < header.totalChunks; ++i) {
+        if (data.size() - offset < header.chunkHeaderSize) {
+            return false;
+        }
+        const uint8_t *chunk = base + offset;
+        const uint16_t type = le16(chunk);
+        const uint32_t blocks = le32(chunk + 4);
+        const uint32_t totalSize = le32(chunk + 8);
+        if (totalSize < header.chunkHeaderSize || totalSize > data.size() - offset ||
+            blocks > header.totalBlocks - block) {
+            return false;
+        }
+        const uint8_t *payload = chunk + header.chunkHeaderSize;
+        const size_t payloadSize = totalSize - header.chunkHeaderSize;
+        SparseChunk run{block * header.blockSize, uint64_t{blocks} * header.blockSize,
+                        nullptr, 0};
+
+        if (type == kChunkRaw) {
+            if (payloadSize != run.length) {
+                return false;
+            }
+            run.data = payload;
+        } else if (type == kChunkFill) {
+            if (payloadSize != 4) {
+                return false;
+            }
+            run.fill = le32(payload);
+        } else if (type == kChunkCrc32) {
+            // Optional checksum of everything before it; the chunk payload is validated by
+            // its size only.
+            if (blocks != 0) {
+                return false;
+            }
+        } else if (type != kChunkDontCare) {
+            return false;
+        }
+        if (run.length > 0 && !visit(run)) {
+            return false;
+        }
+        offset += totalSize;
+        block += blocks;
+    }
+    if (covered != nullptr) {
+        *covered = block * header.blockSize;
+    }
+    return true;
+}
+
+bool SparseImage::expand(std::span<const uint8_t> data, int fd, WorkStealingPool &pool) {
+    SparseHeader header;
+    if (!parseHeader(data, header)) {
+        return false;
+    }
+    const uint64_t imageSize = uint64_t{header.totalBlocks} * header.blockSize;
+    if (ftruncate(fd, static_cast<off_t>(imageSize)) != 0) {
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+    TaskGroup group(pool);
+    uint64_t covered = 0;
+    const bool parsed = forEachChunk(data, [&](const SparseChunk &chunk) {
+        if (chunk.data != nullptr) {
+            for (uint64_t done = 0; done < chunk.length; done += kWriteSlice) {
+                const size_t slice = static_cast<size_t>(
+                        chunk.length - done < kWriteSlice ? chunk.length - done : kWriteSlice);
+                group.run([&failed, fd, src = chunk.data + done, slice,
+                           at = chunk.offset + done] {
+                    if (!failed.load(std::memory_order_relaxed) && !pwriteAll(fd, src, slice, at)) {
+                        failed.store(true, std::memory_order_relaxed);
+                    }
+                });
+            }
+        } else if (chunk.fill != 0) {
+            // Zero fills and don't-care chunks are left as holes.
+            group.run([&failed, fd, value = chunk.fill, outOffset = chunk.offset,
+                       outSize = chunk.length] {
+                std::vector<uint32_t> pattern(kFillBufferSize / 4, value);
+                const auto *bytes = reinterpret_cast<const uint8_t *>(pattern.data());
+                for (uint64_t done = 0; done < outSize; done += kFillBufferSize) {
+                    const size_t slice = static_cast<size_t>(
+                            outSize - done < kFillBufferSize ? outSize - done
+                                                             : kFillBufferSize);
+                    if (failed.load(std::memory_order_relaxed) ||
+                        !pwriteAll(fd, bytes, slice, outOffset + done)) {
+                        failed.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            });
+        }
+        return !failed.load(std::memory_order_relaxed);
+    }, &covered);
+    group.wait();
+    return parsed && !failed.load() && covered == imageSize;
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,61 @@
+#ifndef SPARSE_IMAGE_H
+#define SPARSE_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief A run of the expanded image: raw bytes held in the sparse file, or a repeated
+ * 32-bit fill value (0 for don't-care chunks, which read as zeros).
+ */
+struct SparseChunk {
+    uint64_t offset;
+    uint64_t length;
+    // Raw chunk payload, `length` bytes, or nullptr for fill and don't-care chunks.
+    const uint8_t *data;
+    // Little-endian pattern of a fill chunk, repeated from `offset`.
+    uint32_t fill;
+};
+
+/**
+ * @brief Android sparse image (the format fastboot flashes) expanded to a raw partition image.
+ */
+class SparseImage {
+public:
+    static constexpr uint32_t kMagic = 0xed26ff3a;
+
+    static bool isSparse(std::span<const uint8_t> data);
+
+    /**
+     * @brief Size of the raw image `data` describes, or 0 if the header is invalid.
+     */
+    static uint64_t expandedSize(std::span<const uint8_t> data);
+
+    /**
+     * @brief Validates the chunk headers and calls `visit` on each chunk that covers image
+     * bytes, in order. Stops and returns false if the image is malformed or `visit` returns
+     * false.
+     *
+     * @param covered Set to the image bytes the chunks cover; any after that read as zeros.
+     */
+    static bool forEachChunk(std::span<const uint8_t> data,
+                             const std::function<bool(const SparseChunk &)> &visit,
+                             uint64_t *covered);
+
+    /**
+     * @brief Writes the raw image to `fd`, which should be an empty regular file. Raw chunks
+     * are written straight from `data` with pwrite() in parallel on `pool`; don't-care
+     * chunks and zero fills are left as holes.
+     */
+    static bool expand(std::span<const uint8_t> data, int fd, WorkStealingPool &pool);
+};
+
+} // namespace genesis::oracle
+
+#endif // SPARSE_IMAGE_H
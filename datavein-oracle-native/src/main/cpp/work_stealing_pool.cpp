@@ -0,0 +1,147 @@
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+namespace {
+
+// Identifies the pool and deque of the current thread when it is a worker.
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+} // namespace
+
+WorkStealingPool &WorkStealingPool::shared() {
+    static WorkStealingPool pool(std::thread::hardware_concurrency() > 0
+                                 ? std::thread::hardware_concurrency() : 1);
+    return pool;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread: threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    const size_t index = currentPool == this
+                         ? currentQueue
+                         : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the sleep lock orders the increment against a worker deciding to sleep.
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+}
+
+bool WorkStealingPool::tryTake(size_t home, Task &task) {
+    {
+        Queue &own = *queues_[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        Queue &victim = *queues_[(home + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOne() {
+    if (pending_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    Task task;
+    const size_t home = currentPool == this
+                        ? currentQueue
+                        : nextQueue_.load(std::memory_order_relaxed) % queues_.size();
+    if (!tryTake(home, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    Task task;
+    while (true) {
+        if (tryTake(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+void TaskGroup::run(WorkStealingPool::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++outstanding_;
+    }
+    pool_.submit([this, task = std::move(task)] {
+        task();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--outstanding_ == 0) {
+            done_.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (outstanding_ > 0) {
+        lock.unlock();
+        const bool ran = pool_.runOne();
+        lock.lock();
+        if (!ran) {
+            // Our tasks are running elsewhere; wake periodically in case they submit more
+            // work that this thread should help with.
+            done_.wait_for(lock, std::chrono::milliseconds(2),
+                           [this] { return outstanding_ == 0; });
+        }
+    }
+}
+
+} // namespace genesis::oracle
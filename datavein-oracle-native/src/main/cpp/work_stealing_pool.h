@@ -0,0 +1,105 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Thread pool with one task deque per worker.
+ *
+ * A worker pushes and pops its own deque from the back (newest first, so work it just
+ * split off stays cache-warm) and steals from the front of other deques when its own runs
+ * dry. Tasks submitted from outside the pool are spread over the deques round-robin.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Process-wide pool with one thread per core.
+     */
+    static WorkStealingPool &shared();
+
+    explicit WorkStealingPool(unsigned threads);
+
+    /**
+     * @brief Runs every task already submitted, then joins the workers.
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void submit(Task task);
+
+    /**
+     * @brief Runs one pending task on the calling thread, if there is any. Lets threads that
+     * wait on pool work help instead of blocking.
+     */
+    bool runOne();
+
+    unsigned threadCount() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool tryTake(size_t home, Task &task);
+
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> nextQueue_{0};
+    std::atomic<size_t> pending_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+/**
+ * @brief Set of tasks on a WorkStealingPool that can be waited for together.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool &pool) : pool_(pool) {}
+
+    /**
+     * @brief Waits for outstanding tasks.
+     */
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup &) = delete;
+
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(WorkStealingPool::Task task);
+
+    /**
+     * @brief Returns once every task passed to run() has finished, running pool tasks on the
+     * calling thread meanwhile.
+     */
+    void wait();
+
+private:
+    WorkStealingPool &pool_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    size_t outstanding_ = 0;
+};
+
+} // namespace genesis::oracle
+
+#endif // WORK_STEALING_POOL_H
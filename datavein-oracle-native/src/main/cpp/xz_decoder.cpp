@@ -0,0 +1,1035 @@
+#include "xz_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "checksum.h"
+
+namespace genesis::oracle {
+namespace {
+
+// ---------------------------------------------------------------------------------------
+// LZMA, following the reference decoder in the LZMA SDK specification.
+// ---------------------------------------------------------------------------------------
+
+constexpr int kNumBitModelTotalBits = 11;
+constexpr uint32_t kBitModelTotal = 1u << kNumBitModelTotalBits;
+constexpr int kNumMoveBits = 5;
+constexpr uint32_t kTopValue = 1u << 24;
+
+constexpr int kNumStates = 12;
+constexpr int kNumPosBitsMax = 4;
+constexpr int kNumLenToPosStates = 4;
+constexpr int kNumAlignBits = 4;
+constexpr int kStartPosModelIndex = 4;
+constexpr int kEndPosModelIndex = 14;
+constexpr int kNumFullDistances = 1 << (kEndPosModelIndex >> 1);
+constexpr int kMatchMinLen = 2;
+// LZMA2 limits lc + lp to 4.
+constexpr int kMaxLiteralStates = 1 << 4;
+// Position contexts use at most the low four bits (pb and lp are at most 4).
+constexpr size_t kPositionPeriod = 1 << kNumPosBitsMax;
+
+using Prob = uint16_t;
+
+class RangeDecoder {
+public:
+    bool init(const uint8_t *in, size_t length) {
+        if (length < 5 || in[0] != 0) {
+            return false;
+        }
+        in_ = in;
+        end_ = in + length;
+        pos_ = in + 5;
+        range_ = 0xffffffff;
+        code_ = (uint32_t{in[1]} << 24) | (uint32_t{in[2]} << 16) | (uint32_t{in[3]} << 8) | in[4];
+        return code_ != range_;
+    }
+
+    // Reading past the chunk yields zeros and is detected by overrun() afterwards, which
+    // keeps the bit loops free of error paths.
+    bool overrun() const { return pos_ > end_; }
+
+    bool finishedCleanly() const { return pos_ == end_ && code_ == 0; }
+
+    unsigned bit(Prob &prob) {
+        const uint32_t bound = (range_ >> kNumBitModelTotalBits) * prob;
+        unsigned symbol;
+        if (code_ < bound) {
+            range_ = bound;
+            prob += (kBitModelTotal - prob) >> kNumMoveBits;
+            symbol = 0;
+        } else {
+            range_ -= bound;
+            code_ -= bound;
+            prob -= prob >> kNumMoveBits;
+            symbol = 1;
+        }
+        normalize();
+        return symbol;
+    }
+
+    uint32_t directBits(int count) {
+        uint32_t result = 0;
+        do {
+            range_ >>= 1;
+            code_ -= range_;
+            const uint32_t t = 0 - (code_ >> 31);
+            code_ += range_ & t;
+            normalize();
+            result = (result << 1) + (t + 1);
+        } while (--count);
+        return result;
+    }
+
+    unsigned bitTree(Prob *probs, int bits) {
+        unsigned m = 1;
+        for (int i = 0; i < bits; ++i) {
+            m = (m << 1) + bit(probs[m]);
+        }
+        return m - (1u << bits);
+    }
+
+    unsigned reverseBitTree(Prob *probs, int bits) {
+        unsigned m = 1;
+        unsigned symbol = 0;
+        for (int i = 0; i < bits; ++i) {
+            const unsigned b = bit(probs[m]);
+            m = (m << 1) + b;
+            symbol |= b << i;
+        }
+        return symbol;
+    }
+
+private:
+    void normalize() {
+        if (range_ < kTopValue) {
+            range_ <<= 8;
+            code_ = (code_ << 8) | (pos_ < end_ ? *pos_ : 0);
+            ++pos_;
+        }
+    }
+
+    const uint8_t *in_ = nullptr;
+    const uint8_t *end_ = nullptr;
+    const uint8_t *pos_ = nullptr;
+    uint32_t range_ = 0;
+    uint32_t code_ = 0;
+};
+
+struct LengthDecoder {
+    Prob choice;
+    Prob choice2;
+    Prob low[1 << kNumPosBitsMax][1 << 3];
+    Prob mid[1 << kNumPosBitsMax][1 << 3];
+    Prob high[1 << 8];
+
+    unsigned decode(RangeDecoder &rc, unsigned posState) {
+        if (rc.bit(choice) == 0) {
+            return rc.bitTree(low[posState], 3);
+        }
+        if (rc.bit(choice2) == 0) {
+            return 8 + rc.bitTree(mid[posState], 3);
+        }
+        return 16 + rc.bitTree(high, 8);
+    }
+};
+
+class LzmaDecoder {
+public:
+    bool setProperties(uint8_t properties) {
+        if (properties >= 9 * 5 * 5) {
+            return false;
+        }
+        lc_ = properties % 9;
+        properties /= 9;
+        lp_ = properties % 5;
+        pb_ = properties / 5;
+        return lc_ + lp_ <= 4;
+    }
+
+    void resetState() {
+        Prob *probs = &isMatch_[0][0];
+        const size_t count = (reinterpret_cast<Prob *>(&literal_[kMaxLiteralStates]) - probs);
+        for (size_t i = 0; i < count; ++i) {
+            probs[i] = kBitModelTotal >> 1;
+        }
+        state_ = 0;
+        rep0_ = rep1_ = rep2_ = rep3_ = 0;
+        pendingLength_ = 0;
+    }
+
+    /**
+     * Decodes one LZMA2 chunk: exactly `unpacked` bytes into out[pos..] from `packed` input
+     * bytes. Bytes before `dictStart` are out of reach of matches. If `endMarker` is given
+     * (legacy .lzma of unknown size), decoding may also stop early at an end marker, which
+     * sets it.
+     */
+    bool decodeChunk(const uint8_t *in, size_t packed, uint8_t *out, size_t &pos,
+                     size_t unpacked, size_t dictStart, bool *endMarker = nullptr) {
+        RangeDecoder rc;
+        if (!rc.init(in, packed)) {
+            return false;
+        }
+        const size_t end = pos + unpacked;
+        const unsigned pbMask = (1u << pb_) - 1;
+        const unsigned lpMask = (1u << lp_) - 1;
+
+        // A match cut short by the previous chunk's end continues first.
+        if (pendingLength_ > 0 && !copyMatch(out, pos, end, dictStart, pendingLength_)) {
+            return false;
+        }
+
+        // With an end marker expected, a full buffer must be followed by the marker.
+        while (pos < end || endMarker != nullptr) {
+            // Position-dependent contexts count from the last dictionary reset.
+            const size_t position = pos - dictStart;
+            const unsigned posState = position & pbMask;
+            if (rc.bit(isMatch_[state_][posState]) == 0) {
+                if (pos == end) {
+                    return false;
+                }
+                const unsigned previous = position > 0 ? out[pos - 1] : 0;
+                Prob *probs = literal_[((position & lpMask) << lc_) + (previous >> (8 - lc_))];
+                unsigned symbol = 1;
+                if (state_ >= 7) {
+                    if (rep0_ >= pos - dictStart) {
+                        return false;
+                    }
+                    unsigned matchByte = out[pos - rep0_ - 1];
+                    do {
+                        const unsigned matchBit = (matchByte >> 7) & 1;
+                        matchByte <<= 1;
+                        const unsigned b = rc.bit(probs[((1 + matchBit) << 8) + symbol]);
+                        symbol = (symbol << 1) | b;
+                        if (matchBit != b) {
+                            break;
+                        }
+                    } while (symbol < 0x100);
+                }
+                while (symbol < 0x100) {
+                    symbol = (symbol << 1) | rc.bit(probs[symbol]);
+                }
+                out[pos++] = static_cast<uint8_t>(symbol);
+                state_ = state_ < 4 ? 0 : (state_ < 10 ? state_ - 3 : state_ - 6);
+                continue;
+            }
+
+            unsigned length;
+            if (rc.bit(isRep_[state_]) == 0) {
+                rep3_ = rep2_;
+                rep2_ = rep1_;
+                rep1_ = rep0_;
+                length = matchLength_.decode(rc, posState);
+                state_ = state_ < 7 ? 7 : 10;
+                rep0_ = decodeDistance(rc, length);
+                if (rep0_ == 0xffffffff) {
+                    // End marker; LZMA2 chunks carry their size instead.
+                    if (endMarker == nullptr) {
+                        return false;
+                    }
+                    *endMarker = true;
+                    return !rc.overrun();
+                }
+            } else {
+                if (rc.bit(isRepG0_[state_]) == 0) {
+                    if (rc.bit(isRep0Long_[state_][posState]) == 0) {
+                        if (pos == end || rep0_ >= pos - dictStart) {
+                            return false;
+                        }
+                        state_ = state_ < 7 ? 9 : 11;
+                        out[pos] = out[pos - rep0_ - 1];
+                        ++pos;
+                        continue;
+                    }
+                } else {
+                    uint32_t distance;
+                    if (rc.bit(isRepG1_[state_]) == 0) {
+                        distance = rep1_;
+                    } else {
+                        if (rc.bit(isRepG2_[state_]) == 0) {
+                            distance = rep2_;
+                        } else {
+                            distance = rep3_;
+                            rep3_ = rep2_;
+                        }
+                        rep2_ = rep1_;
+                    }
+                    rep1_ = rep0_;
+                    rep0_ = distance;
+                }
+                length = repLength_.decode(rc, posState);
+                state_ = state_ < 7 ? 8 : 11;
+            }
+            if (pos == end || !copyMatch(out, pos, end, dictStart, length + kMatchMinLen)) {
+                return false;
+            }
+        }
+        return !rc.overrun();
+    }
+
+private:
+    uint32_t decodeDistance(RangeDecoder &rc, unsigned length) {
+        const unsigned lenState = length < kNumLenToPosStates - 1 ? length : kNumLenToPosStates - 1;
+        const unsigned posSlot = rc.bitTree(posSlot_[lenState], 6);
+        if (posSlot < kStartPosModelIndex) {
+            return posSlot;
+        }
+        const int directBits = static_cast<int>((posSlot >> 1) - 1);
+        uint32_t distance = (2 | (posSlot & 1)) << directBits;
+        if (posSlot < kEndPosModelIndex) {
+            distance += rc.reverseBitTree(posDecoders_ + distance - posSlot, directBits);
+        } else {
+            distance += rc.directBits(directBits - kNumAlignBits) << kNumAlignBits;
+            distance += rc.reverseBitTree(align_, kNumAlignBits);
+        }
+        return distance;
+    }
+
+    bool copyMatch(uint8_t *out, size_t &pos, size_t end, size_t dictStart, unsigned length) {
+        if (rep0_ >= pos - dictStart) {
+            return false;
+        }
+        const size_t available = end - pos;
+        const unsigned now = length < available ? length : static_cast<unsigned>(available);
+        const uint8_t *source = out + pos - rep0_ - 1;
+        uint8_t *target = out + pos;
+        if (rep0_ + 1 >= now) {
+            memcpy(target, source, now);
+        } else {
+            // Overlapping copy repeats the last rep0 + 1 bytes.
+            for (unsigned i = 0; i < now; ++i) {
+                target[i] = source[i];
+            }
+        }
+        pos += now;
+        pendingLength_ = length - now;
+        return true;
+    }
+
+    // Field order matters: resetState() initializes everything from isMatch_ through
+    // literal_ as one array.
+    Prob isMatch_[kNumStates][1 << kNumPosBitsMax];
+    Prob isRep_[kNumStates];
+    Prob isRepG0_[kNumStates];
+    Prob isRepG1_[kNumStates];
+    Prob isRepG2_[kNumStates];
+    Prob isRep0Long_[kNumStates][1 << kNumPosBitsMax];
+    Prob posSlot_[kNumLenToPosStates][1 << 6];
+    Prob posDecoders_[1 + kNumFullDistances - kEndPosModelIndex];
+    Prob align_[1 << kNumAlignBits];
+    LengthDecoder matchLength_;
+    LengthDecoder repLength_;
+    Prob literal_[kMaxLiteralStates][0x300];
+
+    unsigned lc_ = 0;
+    unsigned lp_ = 0;
+    unsigned pb_ = 0;
+    unsigned state_ = 0;
+    uint32_t rep0_ = 0;
+    uint32_t rep1_ = 0;
+    uint32_t rep2_ = 0;
+    uint32_t rep3_ = 0;
+    unsigned pendingLength_ = 0;
+};
+
+// ---------------------------------------------------------------------------------------
+// .xz container
+// ---------------------------------------------------------------------------------------
+
+constexpr uint8_t kStreamMagic[6] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+constexpr uint8_t kFooterMagic[2] = {'Y', 'Z'};
+constexpr size_t kStreamHeaderSize = 12;
+constexpr size_t kStreamFooterSize = 12;
+constexpr size_t kMaxVarintSize = 9;
+// Largest dictionary a stream decoder holds; xz presets use at most 64 MiB.
+constexpr uint64_t kMaxStreamDictionary = 256 * 1024 * 1024;
+constexpr size_t kStreamChunk = 256 * 1024;
+// Properties byte, dictionary size and uncompressed size.
+constexpr size_t kLzmaAloneHeaderSize = 13;
+constexpr uint64_t kFilterLzma2 = 0x21;
+
+enum CheckType : uint8_t {
+    kCheckNone = 0x00,
+    kCheckCrc32 = 0x01,
+    kCheckCrc64 = 0x04,
+    kCheckSha256 = 0x0a,
+};
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+size_t checkSize(uint8_t check) {
+    if (check == 0) {
+        return 0;
+    }
+    // Sizes are fixed per group of three check IDs.
+    return size_t{4} << ((check - 1) / 3);
+}
+
+bool readVarint(const uint8_t *&p, const uint8_t *end, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 63; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        const uint8_t byte = *p++;
+        value |= uint64_t{byte & 0x7fu} << shift;
+        if ((byte & 0x80) == 0) {
+            return byte != 0 || shift == 0;
+        }
+    }
+    return false;
+}
+
+bool checkStreamHeader(const uint8_t *p) {
+    return memcmp(p, kStreamMagic, sizeof(kStreamMagic)) == 0 && crc32(p + 6, 2) == le32(p + 8) &&
+           p[6] == 0 && (p[7] & 0xf0) == 0;
+}
+
+bool parseBlockHeader(const uint8_t *header, size_t headerSize, uint64_t &compressedSize,
+                      uint64_t &uncompressedSize, uint64_t &dictionarySize) {
+    if (crc32(header, headerSize - 4) != le32(header + headerSize - 4)) {
+        return false;
+    }
+    const uint8_t flags = header[1];
+    if ((flags & 0x3c) != 0 || (flags & 0x03) != 0) {
+        // Reserved bits, or more than one filter (BCJ/delta chains).
+        return false;
+    }
+    const uint8_t *p = header + 2;
+    const uint8_t *end = header + headerSize - 4;
+    compressedSize = uncompressedSize = UINT64_MAX;
+    if ((flags & 0x40) && !readVarint(p, end, compressedSize)) {
+        return false;
+    }
+    if ((flags & 0x80) && !readVarint(p, end, uncompressedSize)) {
+        return false;
+    }
+    uint64_t filterId, propertiesSize;
+    if (!readVarint(p, end, filterId) || filterId != kFilterLzma2 ||
+        !readVarint(p, end, propertiesSize) || propertiesSize != 1 || p == end || *p > 40) {
+        return false;
+    }
+    const uint8_t bits = *p++;
+    dictionarySize = bits == 40 ? 0xffffffff : uint64_t{2u | (bits & 1u)} << (bits / 2 + 11);
+    for (; p < end; ++p) {
+        if (*p != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Continues a block's check over `length` more bytes of its output; start from 0.
+uint64_t updateCheck(uint8_t check, const uint8_t *data, size_t length, uint64_t value) {
+    switch (check) {
+        case kCheckCrc32:
+            return crc32(data, length, static_cast<uint32_t>(value));
+        case kCheckCrc64:
+            return crc64(data, length, value);
+        default:
+            // None, or SHA-256 which is left unverified.
+            return value;
+    }
+}
+
+bool checkMatches(uint8_t check, uint64_t value, const uint8_t *stored) {
+    switch (check) {
+        case kCheckCrc32:
+            return static_cast<uint32_t>(value) == le32(stored);
+        case kCheckCrc64:
+            return static_cast<uint32_t>(value) == le32(stored) &&
+                   static_cast<uint32_t>(value >> 32) == le32(stored + 4);
+        default:
+            return true;
+    }
+}
+
+/**
+ * Decodes one stream starting at `p`; advances `p` past its footer.
+ */
+bool decodeStream(const uint8_t *&p, const uint8_t *end, uint8_t *out, size_t outCapacity,
+                  size_t &outPos) {
+    if (static_cast<size_t>(end - p) < kStreamHeaderSize || !checkStreamHeader(p)) {
+        return false;
+    }
+    const uint8_t check = p[7];
+    const uint8_t streamFlags[2] = {p[6], p[7]};
+    const size_t checkLength = checkSize(check);
+    p += kStreamHeaderSize;
+
+    while (true) {
+        if (p == end) {
+            return false;
+        }
+        if (*p == 0x00) {
+            break;
+        }
+        const size_t headerSize = (size_t{*p} + 1) * 4;
+        if (static_cast<size_t>(end - p) < headerSize) {
+            return false;
+        }
+        uint64_t compressedSize, uncompressedSize, dictionarySize;
+        if (!parseBlockHeader(p, headerSize, compressedSize, uncompressedSize, dictionarySize)) {
+            return false;
+        }
+        p += headerSize;
+
+        const size_t blockStart = outPos;
+        size_t blockEnd = 0;
+        const size_t consumed = lzma2Decode(p, end - p, out, outPos, outCapacity, &blockEnd);
+        if (consumed == 0 ||
+            (compressedSize != UINT64_MAX && consumed != compressedSize) ||
+            (uncompressedSize != UINT64_MAX && blockEnd - blockStart != uncompressedSize)) {
+            return false;
+        }
+        outPos = blockEnd;
+        p += consumed;
+        // Zero padding to a multiple of four, then the check.
+        const size_t padding = (4 - (headerSize + consumed) % 4) % 4;
+        if (static_cast<size_t>(end - p) < padding + checkLength) {
+            return false;
+        }
+        for (size_t i = 0; i < padding; ++i) {
+            if (*p++ != 0) {
+                return false;
+            }
+        }
+        if (!checkMatches(check, updateCheck(check, out + blockStart, outPos - blockStart, 0), p)) {
+            return false;
+        }
+        p += checkLength;
+    }
+
+    // Index: indicator, record count, records, padding, CRC32.
+    const uint8_t *indexStart = p++;
+    uint64_t records;
+    if (!readVarint(p, end, records)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < records; ++i) {
+        uint64_t unpaddedSize, uncompressedSize;
+        if (!readVarint(p, end, unpaddedSize) || !readVarint(p, end, uncompressedSize)) {
+            return false;
+        }
+    }
+    while ((p - indexStart) % 4 != 0) {
+        if (p == end || *p++ != 0) {
+            return false;
+        }
+    }
+    if (end - p < 4 || crc32(indexStart, p - indexStart) != le32(p)) {
+        return false;
+    }
+    p += 4;
+
+    // Footer: CRC32, backward size, stream flags, magic.
+    if (end - p < 12 || crc32(p + 4, 6) != le32(p) ||
+        memcmp(p + 8, streamFlags, 2) != 0 || memcmp(p + 10, kFooterMagic, 2) != 0 ||
+        (uint64_t{le32(p + 4)} + 1) * 4 != static_cast<uint64_t>(p - indexStart)) {
+        return false;
+    }
+    p += 12;
+    return true;
+}
+
+/**
+ * Decodes LZMA2 chunks into the sliding window, which keeps the block's dictionary as
+ * history, and verifies each block's check as its output goes by.
+ */
+class XzStream : public DecompressStream {
+public:
+    explicit XzStream(Source source)
+        : DecompressStream(std::move(source)), lzma_(std::make_unique<LzmaDecoder>()) {}
+
+protected:
+    bool produce() override {
+        switch (phase_) {
+            case Phase::StreamHeader:
+                return readStreamHeader();
+            case Phase::Block:
+                return readBlockHeader();
+            case Phase::Chunk:
+                return readChunk();
+            case Phase::BlockEnd:
+                return readBlockEnd();
+            case Phase::Index:
+                return readIndex();
+            case Phase::Padding:
+                return readPadding();
+        }
+        return false;
+    }
+
+private:
+    enum class Phase {
+        StreamHeader,
+        Block,
+        Chunk,
+        BlockEnd,
+        Index,
+        Padding,
+    };
+
+    bool readStreamHeader() {
+        if (!fillInput(kStreamHeaderSize) || !checkStreamHeader(input())) {
+            return false;
+        }
+        streamFlags_[0] = input()[6];
+        streamFlags_[1] = input()[7];
+        check_ = streamFlags_[1];
+        consumeInput(kStreamHeaderSize);
+        phase_ = Phase::Block;
+        return true;
+    }
+
+    bool readBlockHeader() {
+        if (!fillInput(1)) {
+            return false;
+        }
+        if (input()[0] == 0x00) {
+            indexSize_ = 0;
+            indexCrc_ = 0;
+            phase_ = Phase::Index;
+            return true;
+        }
+        blockHeaderSize_ = (size_t{input()[0]} + 1) * 4;
+        if (!fillInput(blockHeaderSize_) ||
+            !parseBlockHeader(input(), blockHeaderSize_, blockCompressed_, blockUncompressed_,
+                              dictionarySize_) ||
+            dictionarySize_ > kMaxStreamDictionary) {
+            return false;
+        }
+        consumeInput(blockHeaderSize_);
+        setHistory(static_cast<size_t>(dictionarySize_) + kPositionPeriod);
+        blockInput_ = 0;
+        blockOutput_ = 0;
+        checkValue_ = 0;
+        needDictionaryReset_ = true;
+        needProperties_ = true;
+        phase_ = Phase::Chunk;
+        return true;
+    }
+
+    bool readChunk() {
+        if (!fillInput(1)) {
+            return false;
+        }
+        const uint8_t control = input()[0];
+        if (control == 0x00) {
+            consumeInput(1);
+            ++blockInput_;
+            if ((blockCompressed_ != UINT64_MAX && blockInput_ != blockCompressed_) ||
+                (blockUncompressed_ != UINT64_MAX && blockOutput_ != blockUncompressed_)) {
+                return false;
+            }
+            phase_ = Phase::BlockEnd;
+            return true;
+        }
+        if (control == 0x01 || control == 0x02) {
+            if (control == 0x01) {
+                dictionaryStart_ = blockOutput_;
+                needDictionaryReset_ = false;
+            } else if (needDictionaryReset_) {
+                return false;
+            }
+            if (!fillInput(3)) {
+                return false;
+            }
+            const size_t size = ((size_t{input()[1]} << 8) | input()[2]) + 1;
+            if (!fillInput(3 + size) || !reserveOutput(size)) {
+                return false;
+            }
+            memcpy(window_.data() + windowEnd_, input() + 3, size);
+            commitChunk(3 + size, size);
+            return true;
+        }
+        // The chunk header is 5 or 6 bytes; a 0x00 control byte follows the last chunk.
+        if (control < 0x80 || !fillInput(6)) {
+            return false;
+        }
+        const uint8_t *p = input();
+        const size_t unpacked = ((size_t{control & 0x1fu} << 16) | (size_t{p[1]} << 8) | p[2]) + 1;
+        const size_t packed = ((size_t{p[3]} << 8) | p[4]) + 1;
+        const unsigned reset = (control >> 5) & 3;
+        size_t headerSize = 5;
+        if (reset == 3) {
+            dictionaryStart_ = blockOutput_;
+            needDictionaryReset_ = false;
+        } else if (needDictionaryReset_) {
+            return false;
+        }
+        if (reset >= 2) {
+            if (!lzma_->setProperties(p[5])) {
+                return false;
+            }
+            ++headerSize;
+            needProperties_ = false;
+        } else if (needProperties_) {
+            return false;
+        }
+        if (reset >= 1) {
+            lzma_->resetState();
+        }
+        if (!fillInput(headerSize + packed) || !reserveOutput(unpacked)) {
+            return false;
+        }
+        size_t pos = windowEnd_;
+        if (!lzma_->decodeChunk(input() + headerSize, packed, window_.data(), pos, unpacked,
+                                dictionaryFloor())) {
+            return false;
+        }
+        commitChunk(headerSize + packed, unpacked);
+        return true;
+    }
+
+    // Lowest window offset matches may reach. Once more than the dictionary has been
+    // decoded it is moved back to keep its distance from the last dictionary reset a
+    // multiple of kPositionPeriod, since position contexts count from there.
+    size_t dictionaryFloor() const {
+        const uint64_t decoded = blockOutput_ - dictionaryStart_;
+        if (decoded <= dictionarySize_) {
+            return windowEnd_ - static_cast<size_t>(decoded);
+        }
+        return windowEnd_ - static_cast<size_t>(dictionarySize_) -
+               static_cast<size_t>((decoded - dictionarySize_) % kPositionPeriod);
+    }
+
+    void commitChunk(size_t consumed, size_t produced) {
+        consumeInput(consumed);
+        blockInput_ += consumed;
+        checkValue_ = updateCheck(check_, window_.data() + windowEnd_, produced, checkValue_);
+        windowEnd_ += produced;
+        blockOutput_ += produced;
+    }
+
+    bool readBlockEnd() {
+        // Zero padding to a multiple of four, then the check.
+        const size_t padding = (4 - (blockHeaderSize_ + blockInput_) % 4) % 4;
+        const size_t length = padding + checkSize(check_);
+        if (!fillInput(length)) {
+            return false;
+        }
+        for (size_t i = 0; i < padding; ++i) {
+            if (input()[i] != 0) {
+                return false;
+            }
+        }
+        if (!checkMatches(check_, checkValue_, input() + padding)) {
+            return false;
+        }
+        consumeInput(length);
+        phase_ = Phase::Block;
+        return true;
+    }
+
+    void consumeIndex(size_t length) {
+        indexCrc_ = crc32(input(), length, indexCrc_);
+        indexSize_ += length;
+        consumeInput(length);
+    }
+
+    bool readIndexVarint(uint64_t &value) {
+        // Valid input always has the index CRC and the footer after a record.
+        fillInput(kMaxVarintSize);
+        const uint8_t *p = input();
+        if (!readVarint(p, input() + inputAvailable(), value)) {
+            return false;
+        }
+        consumeIndex(p - input());
+        return true;
+    }
+
+    bool readIndex() {
+        // Indicator, record count, records, padding, CRC32; the records are not needed.
+        consumeIndex(1);
+        uint64_t records;
+        if (!readIndexVarint(records)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < records; ++i) {
+            uint64_t unpaddedSize, uncompressedSize;
+            if (!readIndexVarint(unpaddedSize) || !readIndexVarint(uncompressedSize)) {
+                return false;
+            }
+        }
+        while (indexSize_ % 4 != 0) {
+            if (!fillInput(1) || input()[0] != 0) {
+                return false;
+            }
+            consumeIndex(1);
+        }
+        // CRC32, then the footer: CRC32, backward size, stream flags, magic.
+        if (!fillInput(4 + kStreamFooterSize)) {
+            return false;
+        }
+        const uint8_t *p = input();
+        const uint8_t *footer = p + 4;
+        if (le32(p) != indexCrc_ || crc32(footer + 4, 6) != le32(footer) ||
+            memcmp(footer + 8, streamFlags_, 2) != 0 || memcmp(footer + 10, kFooterMagic, 2) != 0 ||
+            (uint64_t{le32(footer + 4)} + 1) * 4 != indexSize_ + 4) {
+            return false;
+        }
+        consumeInput(4 + kStreamFooterSize);
+        padding_ = 0;
+        phase_ = Phase::Padding;
+        return true;
+    }
+
+    bool readPadding() {
+        // Stream padding: zero bytes in multiples of four, then the end or another stream.
+        while (fillInput(1)) {
+            size_t zeros = 0;
+            while (zeros < inputAvailable() && input()[zeros] == 0) {
+                ++zeros;
+            }
+            consumeInput(zeros);
+            padding_ += zeros;
+            if (inputAvailable() > 0) {
+                break;
+            }
+        }
+        if (padding_ % 4 != 0) {
+            return false;
+        }
+        if (inputAvailable() == 0) {
+            finish();
+        } else {
+            phase_ = Phase::StreamHeader;
+        }
+        return true;
+    }
+
+    std::unique_ptr<LzmaDecoder> lzma_;
+    Phase phase_ = Phase::StreamHeader;
+    uint8_t streamFlags_[2] = {};
+    uint8_t check_ = 0;
+    size_t blockHeaderSize_ = 0;
+    uint64_t blockCompressed_ = 0;
+    uint64_t blockUncompressed_ = 0;
+    uint64_t dictionarySize_ = 0;
+    uint64_t blockInput_ = 0;
+    uint64_t blockOutput_ = 0;
+    // Block output offset of the last dictionary reset.
+    uint64_t dictionaryStart_ = 0;
+    bool needDictionaryReset_ = true;
+    bool needProperties_ = true;
+    uint64_t checkValue_ = 0;
+    uint64_t indexSize_ = 0;
+    uint32_t indexCrc_ = 0;
+    uint64_t padding_ = 0;
+};
+
+} // namespace
+
+size_t lzma2Decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outStart,
+                   size_t outCapacity, size_t *outEnd) {
+    // Large enough to be worth avoiding on the stack.
+    auto lzma = std::make_unique<LzmaDecoder>();
+    const uint8_t *p = in;
+    const uint8_t *end = in + inLength;
+    size_t pos = outStart;
+    size_t dictStart = outStart;
+    bool needDictionaryReset = true;
+    bool needProperties = true;
+
+    while (true) {
+        if (p == end) {
+            return 0;
+        }
+        const uint8_t control = *p++;
+        if (control == 0x00) {
+            break;
+        }
+        if (end - p < 2) {
+            return 0;
+        }
+        if (control == 0x01 || control == 0x02) {
+            if (control == 0x01) {
+                dictStart = pos;
+                needDictionaryReset = false;
+            } else if (needDictionaryReset) {
+                return 0;
+            }
+            const size_t size = ((size_t{p[0]} << 8) | p[1]) + 1;
+            p += 2;
+            if (static_cast<size_t>(end - p) < size || outCapacity - pos < size) {
+                return 0;
+            }
+            memcpy(out + pos, p, size);
+            p += size;
+            pos += size;
+            continue;
+        }
+        if (control < 0x80) {
+            return 0;
+        }
+
+        const size_t unpacked = ((size_t{control & 0x1fu} << 16) | (size_t{p[0]} << 8) | p[1]) + 1;
+        if (end - p < 4) {
+            return 0;
+        }
+        const size_t packed = ((size_t{p[2]} << 8) | p[3]) + 1;
+        p += 4;
+        const unsigned reset = (control >> 5) & 3;
+        if (reset == 3) {
+            dictStart = pos;
+            needDictionaryReset = false;
+        } else if (needDictionaryReset) {
+            return 0;
+        }
+        if (reset >= 2) {
+            if (p == end || !lzma->setProperties(*p++)) {
+                return 0;
+            }
+            needProperties = false;
+        } else if (needProperties) {
+            return 0;
+        }
+        if (reset >= 1) {
+            lzma->resetState();
+        }
+        if (static_cast<size_t>(end - p) < packed || outCapacity - pos < unpacked ||
+            !lzma->decodeChunk(p, packed, out, pos, unpacked, dictStart)) {
+            return 0;
+        }
+        p += packed;
+    }
+    *outEnd = pos;
+    return p - in;
+}
+
+bool XzDecoder::decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength) {
+    const uint8_t *p = in;
+    const uint8_t *end = in + inLength;
+    size_t pos = 0;
+    do {
+        if (!decodeStream(p, end, out, outCapacity, pos)) {
+            return false;
+        }
+        // Stream padding: zero bytes in multiples of four.
+        const uint8_t *padding = p;
+        while (p < end && *p == 0) {
+            ++p;
+        }
+        if ((p - padding) % 4 != 0) {
+            return false;
+        }
+    } while (p < end);
+    if (outLength != nullptr) {
+        *outLength = pos;
+    }
+    return true;
+}
+
+bool XzDecoder::contentSize(const uint8_t *in, size_t inLength, uint64_t &size) {
+    // Streams are walked back from the end, each footer leading to its index.
+    size = 0;
+    size_t end = inLength;
+    bool sawStream = false;
+    while (end > 0) {
+        size_t start = end;
+        while (start > 0 && in[start - 1] == 0) {
+            --start;
+        }
+        if ((end - start) % 4 != 0) {
+            return false;
+        }
+        end = start;
+        if (end == 0 && sawStream) {
+            break;
+        }
+        if (end < kStreamHeaderSize + kStreamFooterSize) {
+            return false;
+        }
+        const uint8_t *footer = in + end - kStreamFooterSize;
+        const uint64_t indexSize = (uint64_t{le32(footer + 4)} + 1) * 4;
+        if (memcmp(footer + 10, kFooterMagic, 2) != 0 || crc32(footer + 4, 6) != le32(footer) ||
+            indexSize > end - kStreamHeaderSize - kStreamFooterSize) {
+            return false;
+        }
+        const uint8_t *index = footer - indexSize;
+        const uint8_t *indexEnd = footer - 4;
+        if (*index != 0x00 || crc32(index, indexSize - 4) != le32(indexEnd)) {
+            return false;
+        }
+        const uint8_t *p = index + 1;
+        uint64_t records;
+        if (!readVarint(p, indexEnd, records)) {
+            return false;
+        }
+        uint64_t blocksSize = 0;
+        for (uint64_t i = 0; i < records; ++i) {
+            uint64_t unpaddedSize, uncompressedSize;
+            if (!readVarint(p, indexEnd, unpaddedSize) ||
+                !readVarint(p, indexEnd, uncompressedSize) || unpaddedSize > inLength ||
+                uncompressedSize > UINT64_MAX - size) {
+                return false;
+            }
+            blocksSize += (unpaddedSize + 3) & ~uint64_t{3};
+            size += uncompressedSize;
+            if (blocksSize > inLength) {
+                return false;
+            }
+        }
+        const uint64_t streamSize = kStreamHeaderSize + blocksSize + indexSize + kStreamFooterSize;
+        if (streamSize > end || memcmp(in + end - streamSize, kStreamMagic,
+                                       sizeof(kStreamMagic)) != 0) {
+            return false;
+        }
+        end -= static_cast<size_t>(streamSize);
+        sawStream = true;
+    }
+    return sawStream;
+}
+
+std::unique_ptr<DecompressStream> XzDecoder::openStream(DecompressStream::Source source) {
+    return std::make_unique<XzStream>(std::move(source));
+}
+
+bool lzmaAloneSize(const uint8_t *in, size_t inLength, uint64_t &size) {
+    if (inLength < kLzmaAloneHeaderSize) {
+        return false;
+    }
+    size = 0;
+    for (int i = 0; i < 8; ++i) {
+        size |= uint64_t{in[5 + i]} << (8 * i);
+    }
+    return size != UINT64_MAX;
+}
+
+bool lzmaAloneDecode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                     size_t *outLength) {
+    if (inLength < kLzmaAloneHeaderSize) {
+        return false;
+    }
+    auto lzma = std::make_unique<LzmaDecoder>();
+    if (!lzma->setProperties(in[0])) {
+        return false;
+    }
+    lzma->resetState();
+    uint64_t size;
+    const bool sized = lzmaAloneSize(in, inLength, size);
+    if (sized && size > outCapacity) {
+        return false;
+    }
+    // The dictionary size (in[1..4]) does not matter: the output buffer is the dictionary.
+    size_t pos = 0;
+    bool endMarker = false;
+    if (!lzma->decodeChunk(in + kLzmaAloneHeaderSize, inLength - kLzmaAloneHeaderSize, out, pos,
+                           sized ? static_cast<size_t>(size) : outCapacity, 0,
+                           sized ? nullptr : &endMarker) ||
+        (!sized && !endMarker)) {
+        return false;
+    }
+    if (outLength != nullptr) {
+        *outLength = pos;
+    }
+    return true;
+}
+
+} // namespace genesis::oracle
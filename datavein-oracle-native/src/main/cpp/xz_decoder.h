@@ -0,0 +1,64 @@
+#ifndef XZ_DECODER_H
+#define XZ_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "decompressor.h"
+
+namespace genesis::oracle {
+
+/**
+ * @brief .xz decoder (LZMA2 filter, CRC32/CRC64 checks verified).
+ *
+ * One-shot decoding goes straight into the caller's buffer, which doubles as the LZMA
+ * dictionary, so no window is allocated. Concatenated streams and stream padding are
+ * accepted. BCJ and delta filters are not supported; payload generators do not use them.
+ */
+class XzDecoder {
+public:
+    /**
+     * @brief Decodes `in` into `out`. Fails if the input is corrupt, uses an unsupported
+     * filter, or decodes to more than `outCapacity` bytes.
+     *
+     * @param outLength Set to the number of bytes written.
+     */
+    static bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength);
+
+    /**
+     * @brief Decoded size, summed from the index of every stream in `in`.
+     */
+    static bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size);
+
+    /**
+     * @brief Stream decoder holding one block's dictionary as history. Blocks with a
+     * dictionary above 256 MiB are rejected; xz presets use at most 64 MiB.
+     */
+    static std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source);
+};
+
+/**
+ * @brief Decodes raw LZMA2 chunks (as inside an .xz block) into `out`, appending after the
+ * `outStart` bytes already there. Returns the input bytes consumed, or 0 on error.
+ */
+size_t lzma2Decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outStart,
+                   size_t outCapacity, size_t *outEnd);
+
+/**
+ * @brief Decodes a legacy .lzma ("LZMA_Alone") file into `out`, stopping at the recorded
+ * size or, if the size is unknown, at the end marker. Properties with lc + lp above 4 are
+ * not supported; lzma and kernel builds use lc=3, lp=0.
+ */
+bool lzmaAloneDecode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                     size_t *outLength);
+
+/**
+ * @brief Uncompressed size from a .lzma header, if it is recorded.
+ */
+bool lzmaAloneSize(const uint8_t *in, size_t inLength, uint64_t &size);
+
+} // namespace genesis::oracle
+
+#endif // XZ_DECODER_H
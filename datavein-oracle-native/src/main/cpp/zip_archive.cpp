@@ -0,0 +1,149 @@
+#include "zip_archive.h"
+
+#include <cstring>
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kEndSignature = 0x06054b50;
+constexpr uint32_t kZip64EndSignature = 0x06064b50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+constexpr uint16_t kZip64ExtraId = 0x0001;
+constexpr size_t kEndSize = 22;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr size_t kZip64EndSize = 56;
+constexpr size_t kCentralHeaderSize = 46;
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kMaxCommentSize = 0xffff;
+
+inline uint16_t le16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t le64(const uint8_t *p) {
+    return uint64_t{le32(p)} | (uint64_t{le32(p + 4)} << 32);
+}
+
+// True if `size` bytes at `offset` lie inside an archive of `length` bytes. Written so that
+// neither side can wrap when the archive is shorter than a header.
+inline bool fits(uint64_t offset, uint64_t size, uint64_t length) {
+    return offset <= length && size <= length - offset;
+}
+
+// Replaces 0xffffffff sizes and offset of a central entry from its zip64 extra field.
+bool applyZip64Extra(const uint8_t *extra, size_t length, uint64_t &uncompressed,
+                     uint64_t &compressed, uint64_t &localOffset) {
+    while (length >= 4) {
+        const uint16_t id = le16(extra);
+        const uint16_t size = le16(extra + 2);
+        if (size > length - 4) {
+            return false;
+        }
+        if (id == kZip64ExtraId) {
+            const uint8_t *field = extra + 4;
+            const uint8_t *end = field + size;
+            for (uint64_t *value: {&uncompressed, &compressed, &localOffset}) {
+                if (*value != 0xffffffff) {
+                    continue;
+                }
+                if (end - field < 8) {
+                    return false;
+                }
+                *value = le64(field);
+                field += 8;
+            }
+            return true;
+        }
+        extra += 4 + size;
+        length -= 4 + size;
+    }
+    return true;
+}
+
+} // namespace
+
+bool isZipArchive(std::span<const uint8_t> data) {
+    return data.size() >= 4 && le32(data.data()) == kLocalHeaderSignature;
+}
+
+std::span<const uint8_t> findStoredZipEntry(std::span<const uint8_t> archive,
+                                            std::string_view name) {
+    const uint8_t *base = archive.data();
+    const size_t length = archive.size();
+    if (length < kEndSize) {
+        return {};
+    }
+
+    // The end record sits before an optional comment of up to 64 KiB.
+    size_t end = length - kEndSize;
+    const size_t lowest = length - kEndSize > kMaxCommentSize ? length - kEndSize - kMaxCommentSize
+                                                               : 0;
+    while (le32(base + end) != kEndSignature) {
+        if (end == lowest) {
+            return {};
+        }
+        --end;
+    }
+
+    uint64_t entries = le16(base + end + 10);
+    uint64_t directoryOffset = le32(base + end + 16);
+    if ((entries == 0xffff || directoryOffset == 0xffffffff) && end >= kZip64LocatorSize &&
+        le32(base + end - kZip64LocatorSize) == kZip64LocatorSignature) {
+        const uint64_t zip64End = le64(base + end - kZip64LocatorSize + 8);
+        if (!fits(zip64End, kZip64EndSize, length) ||
+            le32(base + zip64End) != kZip64EndSignature) {
+            return {};
+        }
+        entries = le64(base + zip64End + 32);
+        directoryOffset = le64(base + zip64End + 48);
+    }
+
+    uint64_t offset = directoryOffset;
+    for (uint64_t i = 0; i < entries; ++i) {
+        if (!fits(offset, kCentralHeaderSize, length) ||
+            le32(base + offset) != kCentralHeaderSignature) {
+            return {};
+        }
+        const uint8_t *header = base + offset;
+        const uint16_t method = le16(header + 10);
+        uint64_t compressed = le32(header + 20);
+        uint64_t uncompressed = le32(header + 24);
+        const uint16_t nameLength = le16(header + 28);
+        const uint16_t extraLength = le16(header + 30);
+        const uint16_t commentLength = le16(header + 32);
+        uint64_t localOffset = le32(header + 42);
+        const uint64_t next = offset + kCentralHeaderSize + nameLength + extraLength +
+                              commentLength;
+        if (next > length) {
+            return {};
+        }
+
+        const char *entryName = reinterpret_cast<const char *>(header + kCentralHeaderSize);
+        if (std::string_view(entryName, nameLength) == name) {
+            if (method != 0 ||
+                !applyZip64Extra(header + kCentralHeaderSize + nameLength, extraLength,
+                                 uncompressed, compressed, localOffset) ||
+                compressed != uncompressed || !fits(localOffset, kLocalHeaderSize, length) ||
+                le32(base + localOffset) != kLocalHeaderSignature) {
+                return {};
+            }
+            const uint8_t *local = base + localOffset;
+            const uint64_t dataOffset = localOffset + kLocalHeaderSize + le16(local + 26) +
+                                        le16(local + 28);
+            if (!fits(dataOffset, compressed, length)) {
+                return {};
+            }
+            return archive.subspan(dataOffset, compressed);
+        }
+        offset = next;
+    }
+    return {};
+}
+
+} // namespace genesis::oracle
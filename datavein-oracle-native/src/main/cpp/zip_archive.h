@@ -0,0 +1,28 @@
+#ifndef ZIP_ARCHIVE_H
+#define ZIP_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace genesis::oracle {
+
+/**
+ * @brief Locates the data of an uncompressed ("stored") entry in a zip archive held in
+ * memory, such as payload.bin inside an OTA package. Zip64 archives are supported.
+ *
+ * @return The entry's bytes, or an empty span if the archive is malformed or has no stored
+ *         entry called `name`.
+ */
+std::span<const uint8_t> findStoredZipEntry(std::span<const uint8_t> archive,
+                                            std::string_view name);
+
+/**
+ * @brief Whether `data` starts with a zip local file header.
+ */
+bool isZipArchive(std::span<const uint8_t> data);
+
+} // namespace genesis::oracle
+
+#endif // ZIP_ARCHIVE_H
@@ -0,0 +1,1140 @@
+#include "zstd_decoder.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "content_hash.h"
+#include "work_stealing_pool.h"
+
+namespace genesis::oracle {
+namespace {
+
+constexpr uint32_t kFrameMagic = 0xfd2fb528;
+constexpr uint32_t kSkippableMagic = 0x184d2a50;
+constexpr uint32_t kSkippableMask = 0xfffffff0;
+constexpr size_t kMaxBlockSize = 128 * 1024;
+constexpr uint64_t kMaxStreamWindow = 256 * 1024 * 1024;
+
+constexpr unsigned kMaxHuffmanBits = 11;
+constexpr unsigned kMaxWeightLog = 6;
+constexpr unsigned kLiteralLengthLog = 9;
+constexpr unsigned kMatchLengthLog = 9;
+constexpr unsigned kOffsetLog = 8;
+constexpr unsigned kMaxLiteralLengthCode = 35;
+constexpr unsigned kMaxMatchLengthCode = 52;
+constexpr unsigned kMaxOffsetCode = 31;
+
+constexpr uint32_t kLiteralLengthBase[36] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+        16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+        8192, 16384, 32768, 65536,
+};
+constexpr uint8_t kLiteralLengthBits[36] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+        13, 14, 15, 16,
+};
+constexpr uint32_t kMatchLengthBase[53] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+        19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+        35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+        4099, 8195, 16387, 32771, 65539,
+};
+constexpr uint8_t kMatchLengthBits[53] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+        12, 13, 14, 15, 16,
+};
+
+// Predefined distributions (RFC 8878 section 3.1.1.3.2.2).
+constexpr int16_t kLiteralLengthDefault[36] = {
+        4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+        -1, -1, -1, -1,
+};
+constexpr int16_t kMatchLengthDefault[53] = {
+        1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+        -1, -1, -1, -1, -1,
+};
+constexpr int16_t kOffsetDefault[29] = {
+        1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t leBytes(const uint8_t *p, size_t count) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < count; ++i) {
+        v |= uint64_t{p[i]} << (8 * i);
+    }
+    return v;
+}
+
+inline unsigned highBit(uint32_t v) {
+    return 31 - __builtin_clz(v);
+}
+
+/**
+ * @brief Reads a bitstream from its last bit towards its first, as FSE and Huffman
+ * streams are written. The highest set bit of the final byte marks where the data starts.
+ */
+class BackwardBits {
+public:
+    bool init(const uint8_t *data, size_t length) {
+        if (length == 0 || data[length - 1] == 0) {
+            return false;
+        }
+        data_ = data;
+        length_ = length;
+        position_ = (length - 1) * 8 + highBit(data[length - 1]);
+        overflow_ = false;
+        return true;
+    }
+
+    /**
+     * @brief Next `bits` bits (at most 56) without consuming them. Bits before the start of
+     * the stream read as zero.
+     */
+    uint64_t peek(unsigned bits) const {
+        if (bits == 0) {
+            return 0;
+        }
+        if (bits > position_) {
+            return window(0, static_cast<unsigned>(position_)) << (bits - position_);
+        }
+        return window(position_ - bits, bits);
+    }
+
+    void skip(unsigned bits) {
+        if (bits > position_) {
+            overflow_ = true;
+            position_ = 0;
+        } else {
+            position_ -= bits;
+        }
+    }
+
+    uint64_t read(unsigned bits) {
+        const uint64_t value = peek(bits);
+        skip(bits);
+        return value;
+    }
+
+    bool overflowed() const { return overflow_; }
+
+    // Every bit consumed, and no more.
+    bool finished() const { return position_ == 0 && !overflow_; }
+
+private:
+    uint64_t window(size_t from, unsigned bits) const {
+        if (bits == 0) {
+            return 0;
+        }
+        const size_t byte = from >> 3;
+        uint64_t word;
+        if (byte + 8 <= length_) {
+            memcpy(&word, data_ + byte, sizeof(word));
+        } else {
+            word = leBytes(data_ + byte, length_ - byte);
+        }
+        return (word >> (from & 7)) & ((uint64_t{1} << bits) - 1);
+    }
+
+    const uint8_t *data_ = nullptr;
+    size_t length_ = 0;
+    size_t position_ = 0;
+    bool overflow_ = false;
+};
+
+/**
+ * @brief Little-endian bitstream read from the first bit on, for FSE table descriptions.
+ */
+class ForwardBits {
+public:
+    ForwardBits(const uint8_t *data, size_t length) : data_(data), length_(length) {}
+
+    // Bits past the end read as zero; consumedBytes() reports the overrun.
+    uint32_t peek(unsigned bits) const {
+        uint32_t value = 0;
+        for (unsigned i = 0; i < bits; ++i) {
+            const size_t bit = position_ + i;
+            if (bit / 8 < length_) {
+                value |= uint32_t{(data_[bit / 8] >> (bit % 8)) & 1u} << i;
+            }
+        }
+        return value;
+    }
+
+    void skip(unsigned bits) { position_ += bits; }
+
+    uint32_t read(unsigned bits) {
+        const uint32_t value = peek(bits);
+        skip(bits);
+        return value;
+    }
+
+    size_t consumedBytes() const { return (position_ + 7) / 8; }
+
+private:
+    const uint8_t *data_;
+    size_t length_;
+    size_t position_ = 0;
+};
+
+struct FseEntry {
+    uint16_t baseline;
+    uint8_t symbol;
+    uint8_t bits;
+};
+
+struct FseTable {
+    std::array<FseEntry, 1u << kLiteralLengthLog> entries;
+    unsigned log = 0;
+};
+
+struct HuffmanEntry {
+    uint8_t symbol;
+    uint8_t bits;
+};
+
+bool buildFseTable(const int16_t *counts, unsigned symbolCount, unsigned log, FseTable &table) {
+    const unsigned size = 1u << log;
+    unsigned high = size - 1;
+    uint16_t next[256];
+    for (unsigned s = 0; s < symbolCount; ++s) {
+        if (counts[s] == -1) {
+            table.entries[high--].symbol = static_cast<uint8_t>(s);
+            next[s] = 1;
+        } else {
+            next[s] = static_cast<uint16_t>(counts[s]);
+        }
+    }
+    const unsigned step = (size >> 1) + (size >> 3) + 3;
+    const unsigned mask = size - 1;
+    unsigned position = 0;
+    for (unsigned s = 0; s < symbolCount; ++s) {
+        for (int i = 0; i < counts[s]; ++i) {
+            table.entries[position].symbol = static_cast<uint8_t>(s);
+            do {
+                position = (position + step) & mask;
+            } while (position > high);
+        }
+    }
+    // Spreading visits every cell exactly once only if the counts add up.
+    if (position != 0) {
+        return false;
+    }
+    for (unsigned u = 0; u < size; ++u) {
+        FseEntry &entry = table.entries[u];
+        const unsigned state = next[entry.symbol]++;
+        entry.bits = static_cast<uint8_t>(log - highBit(state));
+        entry.baseline = static_cast<uint16_t>((state << entry.bits) - size);
+    }
+    table.log = log;
+    return true;
+}
+
+// Reads an FSE table description and builds the table, advancing `p` past it.
+bool readFseTable(const uint8_t *&p, const uint8_t *end, unsigned maxSymbol, unsigned maxLog,
+                  FseTable &table) {
+    ForwardBits bits(p, end - p);
+    const unsigned log = bits.read(4) + 5;
+    if (log > maxLog) {
+        return false;
+    }
+    int16_t counts[256] = {};
+    int remaining = (1 << log) + 1;
+    int threshold = 1 << log;
+    unsigned width = log + 1;
+    unsigned symbol = 0;
+    bool previousZero = false;
+    while (remaining > 1) {
+        if (previousZero) {
+            unsigned run;
+            unsigned last = symbol;
+            do {
+                run = bits.read(2);
+                last += run;
+            } while (run == 3);
+            if (last > maxSymbol) {
+                return false;
+            }
+            symbol = last;
+        }
+        if (symbol > maxSymbol) {
+            return false;
+        }
+        const int max = 2 * threshold - 1 - remaining;
+        int count;
+        if (static_cast<int>(bits.peek(width - 1)) < max) {
+            count = static_cast<int>(bits.read(width - 1));
+        } else {
+            count = static_cast<int>(bits.read(width));
+            if (count >= threshold) {
+                count -= max;
+            }
+        }
+        --count;
+        remaining -= count < 0 ? -count : count;
+        counts[symbol++] = static_cast<int16_t>(count);
+        previousZero = count == 0;
+        if (remaining < 1) {
+            return false;
+        }
+        while (remaining < threshold) {
+            --width;
+            threshold >>= 1;
+        }
+    }
+    if (bits.consumedBytes() > static_cast<size_t>(end - p)) {
+        return false;
+    }
+    p += bits.consumedBytes();
+    return buildFseTable(counts, symbol, log, table);
+}
+
+const FseTable &defaultTable(const int16_t *counts, unsigned symbolCount, unsigned log,
+                             FseTable &storage) {
+    buildFseTable(counts, symbolCount, log, storage);
+    return storage;
+}
+
+const FseTable &literalLengthDefault() {
+    static FseTable storage;
+    static const FseTable &table = defaultTable(kLiteralLengthDefault, 36, 6, storage);
+    return table;
+}
+
+const FseTable &matchLengthDefault() {
+    static FseTable storage;
+    static const FseTable &table = defaultTable(kMatchLengthDefault, 53, 6, storage);
+    return table;
+}
+
+const FseTable &offsetDefault() {
+    static FseTable storage;
+    static const FseTable &table = defaultTable(kOffsetDefault, 29, 5, storage);
+    return table;
+}
+
+inline void copyMatch(uint8_t *out, size_t pos, size_t offset, size_t length) {
+    uint8_t *target = out + pos;
+    const uint8_t *source = target - offset;
+    if (offset >= length) {
+        memcpy(target, source, length);
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            target[i] = source[i];
+        }
+    }
+}
+
+struct FrameHeader {
+    uint64_t windowSize;
+    uint64_t contentSize;
+    bool hasContentSize;
+    bool checksum;
+    size_t size;
+};
+
+size_t frameHeaderSize(uint8_t descriptor) {
+    static constexpr size_t kDictionaryBytes[4] = {0, 1, 2, 4};
+    const unsigned sizeFlag = descriptor >> 6;
+    const bool singleSegment = descriptor & 0x20;
+    const size_t sizeBytes = sizeFlag == 0 ? (singleSegment ? 1 : 0) : size_t{1} << sizeFlag;
+    return 5 + (singleSegment ? 0 : 1) + kDictionaryBytes[descriptor & 3] + sizeBytes;
+}
+
+bool parseFrameHeader(const uint8_t *p, size_t available, FrameHeader &header) {
+    if (available < 5 || le32(p) != kFrameMagic) {
+        return false;
+    }
+    const uint8_t descriptor = p[4];
+    // Bit 3 is reserved.
+    if ((descriptor & 0x08) || available < frameHeaderSize(descriptor)) {
+        return false;
+    }
+    header.size = frameHeaderSize(descriptor);
+    const unsigned sizeFlag = descriptor >> 6;
+    const bool singleSegment = descriptor & 0x20;
+    const uint8_t *q = p + 5;
+    if (!singleSegment) {
+        const unsigned windowLog = 10 + (*q >> 3);
+        const uint64_t base = uint64_t{1} << windowLog;
+        header.windowSize = base + (base / 8) * (*q & 7);
+        ++q;
+    }
+    static constexpr size_t kDictionaryBytes[4] = {0, 1, 2, 4};
+    const size_t dictionaryBytes = kDictionaryBytes[descriptor & 3];
+    if (leBytes(q, dictionaryBytes) != 0) {
+        return false;
+    }
+    q += dictionaryBytes;
+    header.hasContentSize = sizeFlag != 0 || singleSegment;
+    if (sizeFlag == 0) {
+        header.contentSize = singleSegment ? *q : 0;
+    } else {
+        header.contentSize = leBytes(q, size_t{1} << sizeFlag) + (sizeFlag == 1 ? 256 : 0);
+    }
+    if (singleSegment) {
+        header.windowSize = header.contentSize;
+    }
+    header.checksum = descriptor & 0x04;
+    return true;
+}
+
+/**
+ * @brief Per-frame decoding state: tables and repeat offsets carried from block to block.
+ */
+class BlockDecoder {
+public:
+    BlockDecoder() : literals_(kMaxBlockSize) { resetFrame(); }
+
+    void resetFrame() {
+        repeat_[0] = 1;
+        repeat_[1] = 4;
+        repeat_[2] = 8;
+        hasHuffman_ = false;
+        hasLiteralLength_ = hasMatchLength_ = hasOffset_ = false;
+    }
+
+    /**
+     * @brief Decodes a compressed block into out[pos, limit). Matches may reach back to
+     * out[historyStart].
+     */
+    bool decode(const uint8_t *in, size_t length, uint8_t *out, size_t &pos, size_t limit,
+                size_t historyStart) {
+        const uint8_t *p = in;
+        const uint8_t *const end = in + length;
+        const uint8_t *literals;
+        size_t literalCount;
+        return decodeLiterals(p, end, literals, literalCount) &&
+               decodeSequences(p, end, literals, literalCount, out, pos, limit, historyStart);
+    }
+
+private:
+    bool decodeLiterals(const uint8_t *&p, const uint8_t *end, const uint8_t *&literals,
+                        size_t &count) {
+        if (p == end) {
+            return false;
+        }
+        const unsigned type = p[0] & 3;
+        const unsigned sizeFormat = (p[0] >> 2) & 3;
+        if (type <= 1) {
+            // Raw or RLE.
+            size_t headerBytes;
+            if ((sizeFormat & 1) == 0) {
+                headerBytes = 1;
+                count = p[0] >> 3;
+            } else if (sizeFormat == 1) {
+                headerBytes = 2;
+            } else {
+                headerBytes = 3;
+            }
+            if (static_cast<size_t>(end - p) < headerBytes) {
+                return false;
+            }
+            if (headerBytes > 1) {
+                count = static_cast<size_t>(leBytes(p, headerBytes) >> 4);
+            }
+            p += headerBytes;
+            if (count > kMaxBlockSize) {
+                return false;
+            }
+            if (type == 0) {
+                if (static_cast<size_t>(end - p) < count) {
+                    return false;
+                }
+                literals = p;
+                p += count;
+            } else {
+                if (p == end) {
+                    return false;
+                }
+                memset(literals_.data(), *p++, count);
+                literals = literals_.data();
+            }
+            return true;
+        }
+
+        const size_t headerBytes = sizeFormat <= 1 ? 3 : sizeFormat + 2;
+        const unsigned fieldBits = sizeFormat <= 1 ? 10 : sizeFormat == 2 ? 14 : 18;
+        if (static_cast<size_t>(end - p) < headerBytes) {
+            return false;
+        }
+        const uint64_t header = leBytes(p, headerBytes);
+        const uint64_t fieldMask = (uint64_t{1} << fieldBits) - 1;
+        count = static_cast<size_t>((header >> 4) & fieldMask);
+        const size_t compressed = static_cast<size_t>((header >> (4 + fieldBits)) & fieldMask);
+        p += headerBytes;
+        if (count > kMaxBlockSize || compressed > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        const uint8_t *q = p;
+        const uint8_t *const streamsEnd = p + compressed;
+        p = streamsEnd;
+        if (type == 2) {
+            if (!readHuffmanTable(q, streamsEnd)) {
+                return false;
+            }
+        } else if (!hasHuffman_) {
+            return false;
+        }
+        literals = literals_.data();
+        if (sizeFormat == 0) {
+            return decodeHuffmanStream(q, streamsEnd - q, literals_.data(), count);
+        }
+        // Four streams behind a jump table of the first three sizes.
+        if (streamsEnd - q < 6) {
+            return false;
+        }
+        const size_t sizes[3] = {
+                static_cast<size_t>(q[0] | (q[1] << 8)),
+                static_cast<size_t>(q[2] | (q[3] << 8)),
+                static_cast<size_t>(q[4] | (q[5] << 8)),
+        };
+        q += 6;
+        const size_t segment = (count + 3) / 4;
+        if (sizes[0] + sizes[1] + sizes[2] > static_cast<size_t>(streamsEnd - q) ||
+            3 * segment > count) {
+            return false;
+        }
+        for (int i = 0; i < 4; ++i) {
+            const size_t streamLength = i < 3 ? sizes[i] : static_cast<size_t>(streamsEnd - q);
+            const size_t symbols = i < 3 ? segment : count - 3 * segment;
+            if (!decodeHuffmanStream(q, streamLength, literals_.data() + i * segment, symbols)) {
+                return false;
+            }
+            q += streamLength;
+        }
+        return true;
+    }
+
+    bool readHuffmanTable(const uint8_t *&p, const uint8_t *end) {
+        if (p == end) {
+            return false;
+        }
+        const unsigned headerByte = *p++;
+        uint8_t weights[256];
+        unsigned count = 0;
+        if (headerByte >= 128) {
+            count = headerByte - 127;
+            const size_t bytes = (count + 1) / 2;
+            if (static_cast<size_t>(end - p) < bytes) {
+                return false;
+            }
+            for (unsigned i = 0; i < count; ++i) {
+                weights[i] = (i % 2 == 0) ? p[i / 2] >> 4 : p[i / 2] & 15;
+            }
+            p += bytes;
+        } else {
+            if (static_cast<size_t>(end - p) < headerByte) {
+                return false;
+            }
+            const uint8_t *q = p;
+            const uint8_t *const weightsEnd = p + headerByte;
+            p = weightsEnd;
+            FseTable table;
+            BackwardBits bits;
+            if (!readFseTable(q, weightsEnd, 255, kMaxWeightLog, table) ||
+                !bits.init(q, weightsEnd - q)) {
+                return false;
+            }
+            // Two interleaved states; the stream ends when reading runs past its start.
+            unsigned states[2] = {
+                    static_cast<unsigned>(bits.read(table.log)),
+                    static_cast<unsigned>(bits.read(table.log)),
+            };
+            for (unsigned turn = 0;; turn ^= 1) {
+                if (count >= 254) {
+                    return false;
+                }
+                const FseEntry &entry = table.entries[states[turn]];
+                weights[count++] = entry.symbol;
+                states[turn] = entry.baseline + static_cast<unsigned>(bits.read(entry.bits));
+                if (bits.overflowed()) {
+                    weights[count++] = table.entries[states[turn ^ 1]].symbol;
+                    break;
+                }
+            }
+        }
+        return buildHuffmanTable(weights, count);
+    }
+
+    bool buildHuffmanTable(uint8_t *weights, unsigned count) {
+        uint32_t total = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            if (weights[i] > kMaxHuffmanBits) {
+                return false;
+            }
+            total += weights[i] ? 1u << (weights[i] - 1) : 0;
+        }
+        if (total == 0) {
+            return false;
+        }
+        const unsigned maxBits = highBit(total) + 1;
+        const uint32_t rest = (1u << maxBits) - total;
+        if (maxBits > kMaxHuffmanBits || (rest & (rest - 1)) != 0) {
+            return false;
+        }
+        // The last symbol's weight is implied by the others completing the code.
+        weights[count++] = static_cast<uint8_t>(highBit(rest) + 1);
+
+        uint32_t rankStart[kMaxHuffmanBits + 2] = {};
+        for (unsigned i = 0; i < count; ++i) {
+            if (weights[i] != 0) {
+                rankStart[weights[i] + 1] += 1u << (weights[i] - 1);
+            }
+        }
+        for (unsigned w = 1; w <= kMaxHuffmanBits + 1; ++w) {
+            rankStart[w] += rankStart[w - 1];
+        }
+        for (unsigned symbol = 0; symbol < count; ++symbol) {
+            const unsigned w = weights[symbol];
+            if (w == 0) {
+                continue;
+            }
+            const HuffmanEntry entry{static_cast<uint8_t>(symbol),
+                                     static_cast<uint8_t>(maxBits + 1 - w)};
+            const uint32_t span = 1u << (w - 1);
+            for (uint32_t i = 0; i < span; ++i) {
+                huffman_[rankStart[w] + i] = entry;
+            }
+            rankStart[w] += span;
+        }
+        huffmanBits_ = maxBits;
+        hasHuffman_ = true;
+        return true;
+    }
+
+    bool decodeHuffmanStream(const uint8_t *in, size_t length, uint8_t *out, size_t count) {
+        BackwardBits bits;
+        if (!bits.init(in, length)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const HuffmanEntry &entry = huffman_[bits.peek(huffmanBits_)];
+            out[i] = entry.symbol;
+            bits.skip(entry.bits);
+        }
+        return bits.finished();
+    }
+
+    bool setupTable(unsigned mode, const uint8_t *&p, const uint8_t *end,
+                    const FseTable &predefined, unsigned maxSymbol, unsigned maxLog,
+                    FseTable &table, bool &present) {
+        switch (mode) {
+            case 0:
+                table = predefined;
+                break;
+            case 1:
+                if (p == end || *p > maxSymbol) {
+                    return false;
+                }
+                table.entries[0] = {0, *p++, 0};
+                table.log = 0;
+                break;
+            case 2:
+                if (!readFseTable(p, end, maxSymbol, maxLog, table)) {
+                    return false;
+                }
+                break;
+            default:
+                // Repeat the previous block's table.
+                return present;
+        }
+        present = true;
+        return true;
+    }
+
+    bool decodeSequences(const uint8_t *p, const uint8_t *end, const uint8_t *literals,
+                         size_t literalCount, uint8_t *out, size_t &pos, size_t limit,
+                         size_t historyStart) {
+        if (p == end) {
+            return false;
+        }
+        size_t sequences = *p++;
+        if (sequences >= 128) {
+            if (sequences == 255) {
+                if (end - p < 2) {
+                    return false;
+                }
+                sequences = p[0] + (p[1] << 8) + 0x7f00;
+                p += 2;
+            } else {
+                if (p == end) {
+                    return false;
+                }
+                sequences = ((sequences - 128) << 8) + *p++;
+            }
+        }
+        size_t literalPos = 0;
+        if (sequences > 0) {
+            if (p == end || (*p & 3) != 0) {
+                return false;
+            }
+            const unsigned modes = *p++;
+            if (!setupTable(modes >> 6, p, end, literalLengthDefault(), kMaxLiteralLengthCode,
+                            kLiteralLengthLog, literalLengths_, hasLiteralLength_) ||
+                !setupTable((modes >> 4) & 3, p, end, offsetDefault(), kMaxOffsetCode,
+                            kOffsetLog, offsets_, hasOffset_) ||
+                !setupTable((modes >> 2) & 3, p, end, matchLengthDefault(), kMaxMatchLengthCode,
+                            kMatchLengthLog, matchLengths_, hasMatchLength_)) {
+                return false;
+            }
+            BackwardBits bits;
+            if (!bits.init(p, end - p)) {
+                return false;
+            }
+            unsigned literalState = static_cast<unsigned>(bits.read(literalLengths_.log));
+            unsigned offsetState = static_cast<unsigned>(bits.read(offsets_.log));
+            unsigned matchState = static_cast<unsigned>(bits.read(matchLengths_.log));
+            for (size_t i = 0; i < sequences; ++i) {
+                const FseEntry &literalEntry = literalLengths_.entries[literalState];
+                const FseEntry &offsetEntry = offsets_.entries[offsetState];
+                const FseEntry &matchEntry = matchLengths_.entries[matchState];
+                const unsigned offsetCode = offsetEntry.symbol;
+                uint64_t offset = (uint64_t{1} << offsetCode) + bits.read(offsetCode);
+                const size_t matchLength = kMatchLengthBase[matchEntry.symbol] +
+                                           bits.read(kMatchLengthBits[matchEntry.symbol]);
+                const size_t literalLength = kLiteralLengthBase[literalEntry.symbol] +
+                                             bits.read(kLiteralLengthBits[literalEntry.symbol]);
+                offset = resolveOffset(offset, literalLength == 0);
+                if (i + 1 < sequences) {
+                    literalState = literalEntry.baseline +
+                                   static_cast<unsigned>(bits.read(literalEntry.bits));
+                    matchState = matchEntry.baseline +
+                                 static_cast<unsigned>(bits.read(matchEntry.bits));
+                    offsetState = offsetEntry.baseline +
+                                  static_cast<unsigned>(bits.read(offsetEntry.bits));
+                }
+
+                if (literalLength > literalCount - literalPos ||
+                    literalLength + matchLength > limit - pos) {
+                    return false;
+                }
+                memcpy(out + pos, literals + literalPos, literalLength);
+                literalPos += literalLength;
+                pos += literalLength;
+                if (offset == 0 || offset > pos - historyStart) {
+                    return false;
+                }
+                copyMatch(out, pos, static_cast<size_t>(offset), matchLength);
+                pos += matchLength;
+            }
+            if (!bits.finished()) {
+                return false;
+            }
+        } else if (p != end) {
+            return false;
+        }
+        const size_t rest = literalCount - literalPos;
+        if (rest > limit - pos) {
+            return false;
+        }
+        memcpy(out + pos, literals + literalPos, rest);
+        pos += rest;
+        return true;
+    }
+
+    // Turns an offset value into a distance, updating the repeat offsets.
+    uint64_t resolveOffset(uint64_t value, bool noLiterals) {
+        if (value > 3) {
+            repeat_[2] = repeat_[1];
+            repeat_[1] = repeat_[0];
+            repeat_[0] = value - 3;
+            return repeat_[0];
+        }
+        const unsigned index = static_cast<unsigned>(value) - 1 + (noLiterals ? 1 : 0);
+        if (index == 0) {
+            return repeat_[0];
+        }
+        const uint64_t offset = index == 3 ? repeat_[0] - 1 : repeat_[index];
+        if (index != 1) {
+            repeat_[2] = repeat_[1];
+        }
+        repeat_[1] = repeat_[0];
+        repeat_[0] = offset;
+        return offset;
+    }
+
+    std::vector<uint8_t> literals_;
+    HuffmanEntry huffman_[1u << kMaxHuffmanBits];
+    unsigned huffmanBits_ = 0;
+    bool hasHuffman_ = false;
+    FseTable literalLengths_;
+    FseTable matchLengths_;
+    FseTable offsets_;
+    bool hasLiteralLength_ = false;
+    bool hasMatchLength_ = false;
+    bool hasOffset_ = false;
+    uint64_t repeat_[3];
+};
+
+struct BlockHeader {
+    bool last;
+    unsigned type;
+    size_t size;
+
+    // Input bytes the block occupies after its header.
+    size_t inputSize() const { return type == 1 ? 1 : size; }
+};
+
+BlockHeader parseBlockHeader(const uint8_t *p) {
+    const uint32_t word = uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16);
+    return {(word & 1) != 0, (word >> 1) & 3, word >> 3};
+}
+
+/**
+ * @brief Decodes one block of any type into out[pos, ...). The output limit is the lesser
+ * of `outCapacity` and the block size limit.
+ */
+bool decodeAnyBlock(BlockDecoder &decoder, const BlockHeader &block, const uint8_t *data,
+                    size_t blockMax, uint8_t *out, size_t &pos, size_t outCapacity,
+                    size_t historyStart) {
+    const size_t limit = std::min(outCapacity, pos + blockMax);
+    switch (block.type) {
+        case 0:
+        case 1:
+            if (block.size > limit - pos) {
+                return false;
+            }
+            if (block.size == 0) {
+                // Empty frames come with an empty window.
+                return true;
+            }
+            if (block.type == 0) {
+                memcpy(out + pos, data, block.size);
+            } else {
+                memset(out + pos, data[0], block.size);
+            }
+            pos += block.size;
+            return true;
+        case 2:
+            return block.size <= blockMax &&
+                   decoder.decode(data, block.size, out, pos, limit, historyStart);
+        default:
+            return false;
+    }
+}
+
+bool skipFrame(const uint8_t *&p, const uint8_t *end) {
+    if (end - p < 8 || le32(p + 4) > static_cast<size_t>(end - p - 8)) {
+        return false;
+    }
+    p += 8 + le32(p + 4);
+    return true;
+}
+
+// Finds the end of the frame at `p` without decoding it.
+bool scanFrame(const uint8_t *&p, const uint8_t *end, FrameHeader &header) {
+    if (!parseFrameHeader(p, end - p, header)) {
+        return false;
+    }
+    p += header.size;
+    for (;;) {
+        if (end - p < 3) {
+            return false;
+        }
+        const BlockHeader block = parseBlockHeader(p);
+        p += 3;
+        if (block.inputSize() > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        p += block.inputSize();
+        if (block.last) {
+            break;
+        }
+    }
+    if (header.checksum) {
+        if (end - p < 4) {
+            return false;
+        }
+        p += 4;
+    }
+    return true;
+}
+
+bool decodeFrame(const uint8_t *&p, const uint8_t *end, uint8_t *out, size_t &pos,
+                 size_t outCapacity, BlockDecoder &decoder) {
+    FrameHeader header;
+    if (!parseFrameHeader(p, end - p, header)) {
+        return false;
+    }
+    p += header.size;
+    decoder.resetFrame();
+    const size_t start = pos;
+    const size_t blockMax = static_cast<size_t>(std::min<uint64_t>(header.windowSize,
+                                                                   kMaxBlockSize));
+    for (;;) {
+        if (end - p < 3) {
+            return false;
+        }
+        const BlockHeader block = parseBlockHeader(p);
+        p += 3;
+        if (block.inputSize() > static_cast<size_t>(end - p) ||
+            !decodeAnyBlock(decoder, block, p, blockMax, out, pos, outCapacity, start)) {
+            return false;
+        }
+        p += block.inputSize();
+        if (block.last) {
+            break;
+        }
+    }
+    if (header.hasContentSize && pos - start != header.contentSize) {
+        return false;
+    }
+    if (header.checksum) {
+        if (end - p < 4 ||
+            static_cast<uint32_t>(xxh64(out + start, pos - start)) != le32(p)) {
+            return false;
+        }
+        p += 4;
+    }
+    return true;
+}
+
+struct FrameSpan {
+    const uint8_t *data;
+    size_t length;
+    uint64_t contentSize;
+};
+
+// Lists the frames in `in` if all of them record their content size.
+bool scanSizedFrames(const uint8_t *in, size_t inLength, std::vector<FrameSpan> &frames) {
+    const uint8_t *p = in;
+    const uint8_t *const end = in + inLength;
+    while (end - p >= 4) {
+        const uint32_t magic = le32(p);
+        if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (!skipFrame(p, end)) {
+                return false;
+            }
+            continue;
+        }
+        if (magic != kFrameMagic) {
+            break;
+        }
+        const uint8_t *const start = p;
+        FrameHeader header;
+        if (!scanFrame(p, end, header) || !header.hasContentSize) {
+            return false;
+        }
+        frames.push_back({start, static_cast<size_t>(p - start), header.contentSize});
+    }
+    return !frames.empty();
+}
+
+class ZstdStream : public DecompressStream {
+public:
+    explicit ZstdStream(Source source)
+        : DecompressStream(std::move(source)), decoder_(std::make_unique<BlockDecoder>()) {}
+
+protected:
+    bool produce() override {
+        switch (phase_) {
+            case Phase::Magic:
+                return readMagic();
+            case Phase::Skip: {
+                if (!fillInput(1)) {
+                    return false;
+                }
+                const size_t now = std::min<uint64_t>(skipRemaining_, inputAvailable());
+                consumeInput(now);
+                skipRemaining_ -= now;
+                if (skipRemaining_ == 0) {
+                    phase_ = Phase::Magic;
+                }
+                return true;
+            }
+            case Phase::Block:
+                return readBlock();
+        }
+        return false;
+    }
+
+private:
+    enum class Phase {
+        Magic,
+        Skip,
+        Block,
+    };
+
+    bool readMagic() {
+        if (!fillInput(4)) {
+            if (!sawFrame_) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        const uint32_t magic = le32(input());
+        if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (!fillInput(8)) {
+                return false;
+            }
+            skipRemaining_ = le32(input() + 4);
+            consumeInput(8);
+            phase_ = skipRemaining_ > 0 ? Phase::Skip : Phase::Magic;
+            return true;
+        }
+        if (magic != kFrameMagic) {
+            if (!sawFrame_) {
+                return false;
+            }
+            finish();
+            return true;
+        }
+        if (!fillInput(5) || !fillInput(frameHeaderSize(input()[4])) ||
+            !parseFrameHeader(input(), inputAvailable(), header_) ||
+            header_.windowSize > kMaxStreamWindow) {
+            return false;
+        }
+        consumeInput(header_.size);
+        decoder_->resetFrame();
+        setHistory(static_cast<size_t>(header_.windowSize));
+        hash_ = Xxh64();
+        frameOutput_ = 0;
+        sawFrame_ = true;
+        phase_ = Phase::Block;
+        return true;
+    }
+
+    bool readBlock() {
+        if (!fillInput(3)) {
+            return false;
+        }
+        const BlockHeader block = parseBlockHeader(input());
+        const size_t blockMax = static_cast<size_t>(std::min<uint64_t>(header_.windowSize,
+                                                                       kMaxBlockSize));
+        if (!fillInput(3 + block.inputSize()) || !reserveOutput(blockMax)) {
+            return false;
+        }
+        size_t pos = windowEnd_;
+        const size_t history = static_cast<size_t>(std::min(frameOutput_, header_.windowSize));
+        if (!decodeAnyBlock(*decoder_, block, input() + 3, blockMax, window_.data(), pos,
+                            window_.size(), windowEnd_ - history)) {
+            return false;
+        }
+        consumeInput(3 + block.inputSize());
+        hash_.update(window_.data() + windowEnd_, pos - windowEnd_);
+        frameOutput_ += pos - windowEnd_;
+        windowEnd_ = pos;
+        if (!block.last) {
+            return true;
+        }
+        if (header_.hasContentSize && frameOutput_ != header_.contentSize) {
+            return false;
+        }
+        if (header_.checksum) {
+            uint8_t checksum[4];
+            if (!readInput(checksum, 4) ||
+                le32(checksum) != static_cast<uint32_t>(hash_.digest())) {
+                return false;
+            }
+        }
+        phase_ = Phase::Magic;
+        return true;
+    }
+
+    std::unique_ptr<BlockDecoder> decoder_;
+    Phase phase_ = Phase::Magic;
+    bool sawFrame_ = false;
+    uint64_t skipRemaining_ = 0;
+    FrameHeader header_{};
+    Xxh64 hash_;
+    uint64_t frameOutput_ = 0;
+};
+
+} // namespace
+
+bool ZstdDecoder::decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                         size_t *outLength, WorkStealingPool *pool) {
+    std::vector<FrameSpan> frames;
+    if (pool != nullptr && scanSizedFrames(in, inLength, frames) && frames.size() > 1) {
+        std::vector<size_t> offsets(frames.size());
+        uint64_t total = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            offsets[i] = static_cast<size_t>(total);
+            total += frames[i].contentSize;
+        }
+        if (total > outCapacity) {
+            return false;
+        }
+        std::atomic<bool> ok{true};
+        TaskGroup group(*pool);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            group.run([&, i] {
+                const FrameSpan &frame = frames[i];
+                const uint8_t *p = frame.data;
+                size_t pos = 0;
+                auto decoder = std::make_unique<BlockDecoder>();
+                if (!decodeFrame(p, frame.data + frame.length, out + offsets[i], pos,
+                                 static_cast<size_t>(frame.contentSize), *decoder)) {
+                    ok.store(false, std::memory_order_relaxed);
+                }
+            });
+        }
+        group.wait();
+        if (outLength != nullptr) {
+            *outLength = static_cast<size_t>(total);
+        }
+        return ok.load();
+    }
+
+    const uint8_t *p = in;
+    const uint8_t *const end = in + inLength;
+    size_t pos = 0;
+    bool sawFrame = false;
+    auto decoder = std::make_unique<BlockDecoder>();
+    while (end - p >= 4) {
+        const uint32_t magic = le32(p);
+        if ((magic & kSkippableMask) == kSkippableMagic) {
+            if (!skipFrame(p, end)) {
+                return false;
+            }
+            continue;
+        }
+        if (magic != kFrameMagic) {
+            // Trailing data.
+            break;
+        }
+        if (!decodeFrame(p, end, out, pos, outCapacity, *decoder)) {
+            return false;
+        }
+        sawFrame = true;
+    }
+    if (!sawFrame) {
+        return false;
+    }
+    if (outLength != nullptr) {
+        *outLength = pos;
+    }
+    return true;
+}
+
+bool ZstdDecoder::contentSize(const uint8_t *in, size_t inLength, uint64_t &size) {
+    std::vector<FrameSpan> frames;
+    if (!scanSizedFrames(in, inLength, frames)) {
+        return false;
+    }
+    size = 0;
+    for (const FrameSpan &frame: frames) {
+        size += frame.contentSize;
+    }
+    return true;
+}
+
+std::unique_ptr<DecompressStream> ZstdDecoder::openStream(DecompressStream::Source source) {
+    return std::make_unique<ZstdStream>(std::move(source));
+}
+
+} // namespace genesis::oracle
@@ -0,0 +1,43 @@
+#ifndef ZSTD_DECODER_H
+#define ZSTD_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "decompressor.h"
+
+namespace genesis::oracle {
+
+class WorkStealingPool;
+
+/**
+ * @brief Zstandard (RFC 8878) decoder. Concatenated and skippable frames are accepted and
+ * content checksums verified. Frames that need a dictionary are not supported; Android
+ * images and payloads do not use them.
+ */
+class ZstdDecoder {
+public:
+    /**
+     * @brief Decodes `in` into `out`. Frames that record their content size (as written by
+     * pzstd and other multi-frame encoders) are decoded frame-parallel on `pool` if one is
+     * given.
+     */
+    static bool decode(const uint8_t *in, size_t inLength, uint8_t *out, size_t outCapacity,
+                       size_t *outLength, WorkStealingPool *pool = nullptr);
+
+    /**
+     * @brief Decoded size, if every frame in `in` records its content size.
+     */
+    static bool contentSize(const uint8_t *in, size_t inLength, uint64_t &size);
+
+    /**
+     * @brief Stream decoder. Holds one frame window of history, so frames with windows
+     * over 256 MiB are rejected.
+     */
+    static std::unique_ptr<DecompressStream> openStream(DecompressStream::Source source);
+};
+
+} // namespace genesis::oracle
+
+#endif // ZSTD_DECODER_H
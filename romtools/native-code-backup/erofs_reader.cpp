@@ -0,0 +1,214 @@
+#include "erofs_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace genesis::romtools {
+namespace {
+
+constexpr uint64_t kSuperblockOffset = 1024;
+constexpr size_t kSuperblockSize = 128;
+constexpr uint32_t kMagic = 0xe0f5e1e2;
+
+constexpr size_t kCompactInodeSize = 32;
+constexpr size_t kExtendedInodeSize = 64;
+constexpr size_t kNidShift = 5;
+
+constexpr uint32_t kLayoutFlatPlain = 0;
+constexpr uint32_t kLayoutFlatInline = 2;
+constexpr uint32_t kLayoutChunkBased = 4;
+
+constexpr uint32_t kChunkFormatBlockBitsMask = 0x1f;
+constexpr uint32_t kChunkFormatIndexes = 0x20;
+constexpr uint32_t kNullAddress = 0xffffffff;
+
+constexpr size_t kDirentSize = 12;
+
+inline uint16_t le16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline uint64_t le64(const uint8_t *p) {
+    return uint64_t{le32(p)} | (uint64_t{le32(p + 4)} << 32);
+}
+
+} // namespace
+
+bool ErofsFileSystem::matches(const ImageSource &image) {
+    uint8_t magic[4];
+    return image.read(kSuperblockOffset, magic, sizeof(magic)) && le32(magic) == kMagic;
+}
+
+std::unique_ptr<FileSystem> ErofsFileSystem::create(std::unique_ptr<ImageSource> image) {
+    std::unique_ptr<ErofsFileSystem> fs(new ErofsFileSystem(std::move(image)));
+    if (!fs->readSuperblock()) {
+        return nullptr;
+    }
+    return fs;
+}
+
+bool ErofsFileSystem::readSuperblock() {
+    uint8_t sb[kSuperblockSize];
+    if (!image_->read(kSuperblockOffset, sb, sizeof(sb)) || le32(sb) != kMagic) {
+        return false;
+    }
+    const uint8_t blockBits = sb[12];
+    if (blockBits < 9 || blockBits > 16) {
+        return false;
+    }
+    blockSize_ = 1u << blockBits;
+    rootNid_ = le16(sb + 14);
+    buildTime_ = static_cast<int64_t>(le64(sb + 24));
+    metaOffset_ = uint64_t{le32(sb + 40)} * blockSize_;
+    return metaOffset_ < image_->size();
+}
+
+bool ErofsFileSystem::mapChunks(uint64_t indexOffset, uint32_t format, Inode &inode) const {
+    const uint32_t chunkBits = format & kChunkFormatBlockBitsMask;
+    const uint64_t chunkSize = uint64_t{blockSize_} << chunkBits;
+    const uint64_t chunks = (inode.size + chunkSize - 1) / chunkSize;
+    // Full indexes are {advise u16, device_id u16, blkaddr u32}, aligned to 8 bytes; the
+    // compact form is a bare u32 block address.
+    const size_t entrySize = (format & kChunkFormatIndexes) != 0 ? 8 : 4;
+    indexOffset = (indexOffset + entrySize - 1) & ~uint64_t{entrySize - 1};
+    if (chunks > image_->size() / entrySize) {
+        return false;
+    }
+    std::vector<uint8_t> table(static_cast<size_t>(chunks * entrySize));
+    if (!image_->read(indexOffset, table.data(), table.size())) {
+        return false;
+    }
+    for (uint64_t i = 0; i < chunks; ++i) {
+        const uint8_t *entry = table.data() + i * entrySize;
+        if (entrySize == 8 && le16(entry + 2) != 0) {
+            // Chunks on extra devices live outside this image.
+            return false;
+        }
+        const uint32_t address = le32(entry + entrySize - 4);
+        const uint64_t physical = address == kNullAddress ? FileExtent::kHole
+                                                          : uint64_t{address} * blockSize_;
+        if (!inode.extents.empty()) {
+            FileExtent &last = inode.extents.back();
+            if (physical == FileExtent::kHole ? last.physical == FileExtent::kHole
+                                              : last.physical != FileExtent::kHole &&
+                                                last.physical + last.length == physical) {
+                last.length += chunkSize;
+                continue;
+            }
+        }
+        inode.extents.push_back({i * chunkSize, physical, chunkSize});
+    }
+    return true;
+}
+
+bool ErofsFileSystem::loadInode(uint64_t id, Inode &inode) {
+    if (id > (image_->size() >> kNidShift)) {
+        return false;
+    }
+    const uint64_t offset = metaOffset_ + (id << kNidShift);
+    uint8_t raw[kExtendedInodeSize] = {};
+    if (!image_->read(offset, raw, kCompactInodeSize)) {
+        return false;
+    }
+    const uint16_t format = le16(raw);
+    const bool extended = (format & 1) != 0;
+    const uint32_t layout = (format >> 1) & 0x7;
+    if (extended && !image_->read(offset + kCompactInodeSize, raw + kCompactInodeSize,
+                                  kExtendedInodeSize - kCompactInodeSize)) {
+        return false;
+    }
+    const uint16_t xattrCount = le16(raw + 2);
+    const uint64_t xattrSize = xattrCount == 0 ? 0 : 12 + (uint64_t{xattrCount} - 1) * 4;
+    const uint64_t dataOffset = offset + (extended ? kExtendedInodeSize : kCompactInodeSize) +
+                                xattrSize;
+    inode.mode = le16(raw + 4);
+    const uint32_t startBlock = le32(raw + 16);
+    if (extended) {
+        inode.size = le64(raw + 8);
+        inode.uid = le32(raw + 24);
+        inode.gid = le32(raw + 28);
+        inode.mtime = static_cast<int64_t>(le64(raw + 32));
+    } else {
+        inode.size = le32(raw + 8);
+        inode.uid = le16(raw + 24);
+        inode.gid = le16(raw + 26);
+        inode.mtime = buildTime_;
+    }
+    if (!inode.isRegular() && !inode.isDirectory() && !inode.isSymlink()) {
+        // Devices, fifos and sockets carry no data; i_u holds rdev.
+        return true;
+    }
+
+    switch (layout) {
+        case kLayoutFlatPlain:
+        case kLayoutFlatInline: {
+            const uint64_t tail = layout == kLayoutFlatInline ? inode.size % blockSize_ : 0;
+            const uint64_t blocks = layout == kLayoutFlatInline
+                                    ? inode.size / blockSize_
+                                    : (inode.size + blockSize_ - 1) / blockSize_;
+            if (blocks > 0) {
+                if (uint64_t{startBlock} * blockSize_ + blocks * blockSize_ > image_->size()) {
+                    return false;
+                }
+                inode.extents.push_back({0, uint64_t{startBlock} * blockSize_,
+                                         blocks * blockSize_});
+            }
+            if (tail > 0) {
+                inode.extents.push_back({blocks * blockSize_, dataOffset, tail});
+            }
+            return true;
+        }
+        case kLayoutChunkBased:
+            return mapChunks(dataOffset, startBlock, inode);
+        default:
+            // Compressed layouts need the LZ4/LZMA cluster decoders.
+            return false;
+    }
+}
+
+bool ErofsFileSystem::loadDirectory(const Inode &directory, std::vector<DirEntry> &entries) {
+    if (directory.size > (uint64_t{1} << 31)) {
+        return false;
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(directory.size));
+    if (read(directory, 0, data.data(), data.size()) != static_cast<int64_t>(data.size())) {
+        return false;
+    }
+    // Each block starts with an array of {nid u64, nameoff u16, type u8, reserved u8}; the
+    // names follow, unterminated except that the last may be NUL-padded to the block end.
+    for (size_t block = 0; block < data.size(); block += blockSize_) {
+        const uint8_t *p = data.data() + block;
+        const size_t length = std::min<size_t>(blockSize_, data.size() - block);
+        if (length < kDirentSize) {
+            return false;
+        }
+        const size_t count = le16(p + 8) / kDirentSize;
+        if (count == 0 || count * kDirentSize > length) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t *dirent = p + i * kDirentSize;
+            const size_t nameStart = le16(dirent + 8);
+            size_t nameEnd = i + 1 < count ? le16(dirent + kDirentSize + 8) : length;
+            if (nameStart < count * kDirentSize || nameEnd > length || nameStart >= nameEnd) {
+                return false;
+            }
+            if (i + 1 == count) {
+                const void *nul = memchr(p + nameStart, 0, nameEnd - nameStart);
+                if (nul != nullptr) {
+                    nameEnd = static_cast<const uint8_t *>(nul) - p;
+                }
+            }
+            entries.push_back({std::string(reinterpret_cast<const char *>(p + nameStart),
+                                           nameEnd - nameStart),
+                               le64(dirent)});
+        }
+    }
+    return true;
+}
+
+} // namespace genesis::romtools
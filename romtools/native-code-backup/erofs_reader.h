@@ -0,0 +1,50 @@
+#ifndef EROFS_READER_H
+#define EROFS_READER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "filesystem.h"
+
+namespace genesis::romtools {
+
+/**
+ * @brief EROFS reader for uncompressed layouts: flat, flat with an inline tail block, and
+ * chunk-based files. Files stored compressed fail to load.
+ */
+class ErofsFileSystem : public FileSystem {
+public:
+    static bool matches(const ImageSource &image);
+
+    /**
+     * @brief Returns nullptr if the superblock is invalid.
+     */
+    static std::unique_ptr<FileSystem> create(std::unique_ptr<ImageSource> image);
+
+    const char *type() const override { return "erofs"; }
+
+protected:
+    uint64_t rootInode() const override { return rootNid_; }
+
+    bool loadInode(uint64_t id, Inode &inode) override;
+
+    bool loadDirectory(const Inode &directory, std::vector<DirEntry> &entries) override;
+
+private:
+    explicit ErofsFileSystem(std::unique_ptr<ImageSource> image)
+            : FileSystem(std::move(image)) {}
+
+    bool readSuperblock();
+
+    bool mapChunks(uint64_t indexOffset, uint32_t format, Inode &inode) const;
+
+    uint32_t blockSize_ = 0;
+    uint64_t rootNid_ = 0;
+    uint64_t metaOffset_ = 0;
+    int64_t buildTime_ = 0;
+};
+
+} // namespace genesis::romtools
+
+#endif // EROFS_READER_H
@@ -0,0 +1,329 @@
+#include "ext4_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace genesis::romtools {
+namespace {
+
+constexpr uint64_t kSuperblockOffset = 1024;
+constexpr size_t kSuperblockSize = 1024;
+constexpr uint16_t kMagic = 0xef53;
+
+constexpr uint32_t kIncompatCompression = 0x1;
+constexpr uint32_t kIncompatJournalDev = 0x8;
+constexpr uint32_t kIncompatMetaBg = 0x10;
+constexpr uint32_t kIncompat64Bit = 0x80;
+
+constexpr uint32_t kInodeExtentsFlag = 0x80000;
+constexpr uint32_t kInodeInlineDataFlag = 0x10000000;
+constexpr size_t kInodeBlockOffset = 0x28;
+constexpr size_t kInodeBlockSize = 60;
+constexpr size_t kGoodOldInodeSize = 128;
+
+constexpr uint16_t kExtentMagic = 0xf30a;
+constexpr int kMaxExtentDepth = 5;
+constexpr uint32_t kXattrMagic = 0xea020000;
+constexpr uint8_t kXattrIndexSystem = 7;
+
+inline uint16_t le16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t le32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+// Parses linear directory entries in `data`. Entries never cross `data`'s end.
+void parseEntries(const uint8_t *data, size_t length, std::vector<DirEntry> &entries) {
+    size_t position = 0;
+    while (length - position >= 8) {
+        const uint8_t *entry = data + position;
+        const uint32_t inode = le32(entry);
+        const uint16_t recordLength = le16(entry + 4);
+        const uint8_t nameLength = entry[6];
+        if (recordLength < 8 || recordLength > length - position ||
+            nameLength > recordLength - 8u) {
+            return;
+        }
+        if (inode != 0 && nameLength > 0) {
+            entries.push_back({std::string(reinterpret_cast<const char *>(entry + 8), nameLength),
+                               inode});
+        }
+        position += recordLength;
+    }
+}
+
+} // namespace
+
+bool Ext4FileSystem::matches(const ImageSource &image) {
+    uint8_t magic[2];
+    return image.read(kSuperblockOffset + 0x38, magic, sizeof(magic)) && le16(magic) == kMagic;
+}
+
+std::unique_ptr<FileSystem> Ext4FileSystem::create(std::unique_ptr<ImageSource> image) {
+    std::unique_ptr<Ext4FileSystem> fs(new Ext4FileSystem(std::move(image)));
+    if (!fs->readSuperblock()) {
+        return nullptr;
+    }
+    return fs;
+}
+
+bool Ext4FileSystem::readSuperblock() {
+    uint8_t sb[kSuperblockSize];
+    if (!image_->read(kSuperblockOffset, sb, sizeof(sb)) || le16(sb + 0x38) != kMagic) {
+        return false;
+    }
+    const uint32_t logBlockSize = le32(sb + 0x18);
+    const uint32_t incompat = le32(sb + 0x60);
+    if (logBlockSize > 6 || (incompat & (kIncompatCompression | kIncompatJournalDev |
+                                         kIncompatMetaBg)) != 0) {
+        return false;
+    }
+    blockSize_ = 1024u << logBlockSize;
+    inodeCount_ = le32(sb);
+    inodesPerGroup_ = le32(sb + 0x28);
+    inodeSize_ = le32(sb + 0x4c) == 0 ? kGoodOldInodeSize : le16(sb + 0x58);
+    const uint32_t firstDataBlock = le32(sb + 0x14);
+    const uint32_t blocksPerGroup = le32(sb + 0x20);
+    const bool is64Bit = (incompat & kIncompat64Bit) != 0;
+    blockCount_ = le32(sb + 4) | (is64Bit ? uint64_t{le32(sb + 0x150)} << 32 : 0);
+    const uint32_t descriptorSize = is64Bit ? le16(sb + 0xfe) : 32;
+    if (inodesPerGroup_ == 0 || blocksPerGroup == 0 || inodeSize_ < kGoodOldInodeSize ||
+        inodeSize_ > blockSize_ || (inodeSize_ & (inodeSize_ - 1)) != 0 ||
+        descriptorSize < 32 || descriptorSize > blockSize_ || blockCount_ <= firstDataBlock) {
+        return false;
+    }
+
+    const uint64_t groups = (blockCount_ - firstDataBlock + blocksPerGroup - 1) / blocksPerGroup;
+    if (groups * inodesPerGroup_ < inodeCount_ ||
+        groups * descriptorSize > image_->size()) {
+        return false;
+    }
+    const uint64_t table = (uint64_t{firstDataBlock} + 1) * blockSize_;
+    std::vector<uint8_t> descriptors(static_cast<size_t>(groups * descriptorSize));
+    if (!image_->read(table, descriptors.data(), descriptors.size())) {
+        return false;
+    }
+    inodeTables_.resize(static_cast<size_t>(groups));
+    for (uint64_t g = 0; g < groups; ++g) {
+        const uint8_t *d = descriptors.data() + g * descriptorSize;
+        inodeTables_[g] = le32(d + 8) | (descriptorSize >= 64 ? uint64_t{le32(d + 0x28)} << 32
+                                                              : 0);
+    }
+    return true;
+}
+
+void Ext4FileSystem::addBlock(uint64_t logical, uint64_t physical,
+                              std::vector<FileExtent> &extents) const {
+    const uint64_t at = logical * blockSize_;
+    const uint64_t where = physical == 0 ? FileExtent::kHole : physical * blockSize_;
+    if (!extents.empty()) {
+        FileExtent &last = extents.back();
+        if (last.logical + last.length == at &&
+            (where == FileExtent::kHole ? last.physical == FileExtent::kHole
+                                        : last.physical != FileExtent::kHole &&
+                                          last.physical + last.length == where)) {
+            last.length += blockSize_;
+            return;
+        }
+    }
+    extents.push_back({at, where, blockSize_});
+}
+
+bool Ext4FileSystem::mapExtentNode(const uint8_t *node, size_t size, int depth,
+                                   std::vector<FileExtent> &extents) const {
+    if (size < 12 || le16(node) != kExtentMagic) {
+        return false;
+    }
+    const uint16_t entries = le16(node + 2);
+    const uint16_t nodeDepth = le16(node + 6);
+    if (nodeDepth != depth && depth >= 0) {
+        return false;
+    }
+    if (nodeDepth > kMaxExtentDepth || 12 + size_t{entries} * 12 > size) {
+        return false;
+    }
+    for (uint16_t i = 0; i < entries; ++i) {
+        const uint8_t *entry = node + 12 + size_t{i} * 12;
+        if (nodeDepth == 0) {
+            const uint64_t logical = uint64_t{le32(entry)} * blockSize_;
+            uint32_t length = le16(entry + 4);
+            // Lengths above 32768 mark preallocated, unwritten extents: they read as zeros.
+            const bool unwritten = length > 32768;
+            if (unwritten) {
+                length -= 32768;
+            }
+            const uint64_t start = (uint64_t{le16(entry + 6)} << 32) | le32(entry + 8);
+            if (start + length > blockCount_) {
+                return false;
+            }
+            extents.push_back({logical, unwritten ? FileExtent::kHole : start * blockSize_,
+                               uint64_t{length} * blockSize_});
+        } else {
+            const uint64_t leaf = (uint64_t{le16(entry + 8)} << 32) | le32(entry + 4);
+            std::vector<uint8_t> child(blockSize_);
+            if (leaf >= blockCount_ ||
+                !image_->read(leaf * blockSize_, child.data(), child.size()) ||
+                !mapExtentNode(child.data(), child.size(), nodeDepth - 1, extents)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Ext4FileSystem::mapIndirect(uint64_t block, int level, uint64_t &logical, uint64_t blocks,
+                                 std::vector<FileExtent> &extents) const {
+    uint64_t span = 1;
+    for (int i = 0; i < level; ++i) {
+        span *= blockSize_ / 4;
+    }
+    if (block == 0) {
+        // A missing indirect block covers a hole.
+        logical += span;
+        return true;
+    }
+    if (block >= blockCount_) {
+        return false;
+    }
+    std::vector<uint8_t> pointers(blockSize_);
+    if (!image_->read(block * blockSize_, pointers.data(), pointers.size())) {
+        return false;
+    }
+    for (uint32_t i = 0; i < blockSize_ / 4 && logical < blocks; ++i) {
+        const uint32_t pointer = le32(pointers.data() + 4 * i);
+        if (level == 1) {
+            if (pointer >= blockCount_) {
+                return false;
+            }
+            addBlock(logical++, pointer, extents);
+        } else if (!mapIndirect(pointer, level - 1, logical, blocks, extents)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Ext4FileSystem::inodeOffset(uint64_t id, uint64_t &offset) const {
+    if (id == 0 || id > inodeCount_) {
+        return false;
+    }
+    const uint64_t group = (id - 1) / inodesPerGroup_;
+    if (group >= inodeTables_.size()) {
+        return false;
+    }
+    offset = inodeTables_[group] * blockSize_ + ((id - 1) % inodesPerGroup_) * inodeSize_;
+    return true;
+}
+
+bool Ext4FileSystem::loadInode(uint64_t id, Inode &inode) {
+    uint64_t offset;
+    std::vector<uint8_t> raw(inodeSize_);
+    if (!inodeOffset(id, offset) || !image_->read(offset, raw.data(), raw.size())) {
+        return false;
+    }
+    const uint8_t *p = raw.data();
+    inode.mode = le16(p);
+    inode.uid = le16(p + 2) | (uint32_t{le16(p + 0x78)} << 16);
+    inode.gid = le16(p + 0x18) | (uint32_t{le16(p + 0x7a)} << 16);
+    inode.size = le32(p + 4) | (uint64_t{le32(p + 0x6c)} << 32);
+    inode.mtime = le32(p + 0x10);
+    const uint32_t flags = le32(p + 0x20);
+    const uint8_t *blockArea = p + kInodeBlockOffset;
+
+    if ((flags & kInodeInlineDataFlag) != 0) {
+        // The first 60 bytes live in i_block, the rest in the "system.data" xattr stored in
+        // the inode body.
+        inode.extents.push_back({0, offset + kInodeBlockOffset,
+                                 std::min<uint64_t>(inode.size, kInodeBlockSize)});
+        if (inode.size > kInodeBlockSize && inodeSize_ > kGoodOldInodeSize + 4) {
+            const size_t body = kGoodOldInodeSize + le16(p + 0x80);
+            if (body + 4 > inodeSize_ || le32(p + body) != kXattrMagic) {
+                return false;
+            }
+            const size_t first = body + 4;
+            for (size_t e = first; e + 16 <= inodeSize_ && le32(p + e) != 0;) {
+                const uint8_t nameLength = p[e];
+                const uint16_t valueOffset = le16(p + e + 2);
+                const uint32_t valueSize = le32(p + e + 8);
+                if (e + 16 + nameLength > inodeSize_) {
+                    return false;
+                }
+                if (p[e + 1] == kXattrIndexSystem &&
+                    std::string_view(reinterpret_cast<const char *>(p + e + 16), nameLength) ==
+                    "data") {
+                    if (first + valueOffset + valueSize > inodeSize_ ||
+                        kInodeBlockSize + uint64_t{valueSize} < inode.size) {
+                        return false;
+                    }
+                    inode.extents.push_back({kInodeBlockSize, offset + first + valueOffset,
+                                             inode.size - kInodeBlockSize});
+                    break;
+                }
+                e += (16 + nameLength + 3) & ~size_t{3};
+            }
+        }
+        return true;
+    }
+    if (inode.isSymlink() && inode.size < kInodeBlockSize && (flags & kInodeExtentsFlag) == 0) {
+        inode.extents.push_back({0, offset + kInodeBlockOffset, inode.size});
+        return true;
+    }
+    if ((flags & kInodeExtentsFlag) != 0) {
+        return mapExtentNode(blockArea, kInodeBlockSize, -1, inode.extents);
+    }
+
+    const uint64_t blocks = (inode.size + blockSize_ - 1) / blockSize_;
+    uint64_t logical = 0;
+    for (int i = 0; i < 12 && logical < blocks; ++i) {
+        const uint32_t block = le32(blockArea + 4 * i);
+        if (block >= blockCount_) {
+            return false;
+        }
+        addBlock(logical++, block, inode.extents);
+    }
+    for (int level = 1; level <= 3 && logical < blocks; ++level) {
+        if (!mapIndirect(le32(blockArea + 4 * (11 + level)), level, logical, blocks,
+                         inode.extents)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Ext4FileSystem::loadDirectory(const Inode &directory, std::vector<DirEntry> &entries) {
+    if (directory.size > (uint64_t{1} << 31)) {
+        return false;
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(directory.size));
+    if (read(directory, 0, data.data(), data.size()) != static_cast<int64_t>(data.size())) {
+        return false;
+    }
+    uint64_t offset;
+    uint8_t flags[4];
+    if (!inodeOffset(directory.id, offset) || !image_->read(offset + 0x20, flags, sizeof(flags))) {
+        return false;
+    }
+    if ((le32(flags) & kInodeInlineDataFlag) != 0) {
+        // Inline directories start with the parent's inode number instead of "." and "..",
+        // and their i_block and xattr parts hold separate runs of entries.
+        const size_t head = std::min<size_t>(data.size(), kInodeBlockSize);
+        if (head >= 4) {
+            parseEntries(data.data() + 4, head - 4, entries);
+        }
+        if (data.size() > kInodeBlockSize) {
+            parseEntries(data.data() + kInodeBlockSize, data.size() - kInodeBlockSize,
+                         entries);
+        }
+        return true;
+    }
+    for (size_t block = 0; block < data.size(); block += blockSize_) {
+        parseEntries(data.data() + block, std::min<size_t>(blockSize_, data.size() - block),
+                     entries);
+    }
+    return true;
+}
+
+} // namespace genesis::romtools
@@ -0,0 +1,63 @@
+#ifndef EXT4_READER_H
+#define EXT4_READER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "filesystem.h"
+
+namespace genesis::romtools {
+
+/**
+ * @brief ext4 (and ext2/ext3) reader: extent trees, legacy block maps, inline data, fast
+ * symlinks and hashed directories, whose leaf blocks read as plain linear directories.
+ * The journal is ignored, which is right for images built offline.
+ */
+class Ext4FileSystem : public FileSystem {
+public:
+    static bool matches(const ImageSource &image);
+
+    /**
+     * @brief Returns nullptr if the superblock or group descriptors are invalid or use
+     * unsupported features.
+     */
+    static std::unique_ptr<FileSystem> create(std::unique_ptr<ImageSource> image);
+
+    const char *type() const override { return "ext4"; }
+
+protected:
+    uint64_t rootInode() const override { return 2; }
+
+    bool loadInode(uint64_t id, Inode &inode) override;
+
+    bool loadDirectory(const Inode &directory, std::vector<DirEntry> &entries) override;
+
+private:
+    explicit Ext4FileSystem(std::unique_ptr<ImageSource> image)
+            : FileSystem(std::move(image)) {}
+
+    bool readSuperblock();
+
+    bool inodeOffset(uint64_t id, uint64_t &offset) const;
+
+    bool mapExtentNode(const uint8_t *node, size_t size, int depth,
+                       std::vector<FileExtent> &extents) const;
+
+    bool mapIndirect(uint64_t block, int level, uint64_t &logical, uint64_t blocks,
+                     std::vector<FileExtent> &extents) const;
+
+    void addBlock(uint64_t logical, uint64_t physical, std::vector<FileExtent> &extents) const;
+
+    uint32_t blockSize_ = 0;
+    uint32_t inodeSize_ = 0;
+    uint32_t inodesPerGroup_ = 0;
+    uint32_t inodeCount_ = 0;
+    uint64_t blockCount_ = 0;
+    // Inode table location (block number) of each block group.
+    std::vector<uint64_t> inodeTables_;
+};
+
+} // namespace genesis::romtools
+
+#endif // EXT4_READER_H
@@ -0,0 +1,219 @@
+#include "filesystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unistd.h>
+
+#include "erofs_reader.h"
+#include "ext4_reader.h"
+#include "file_io.h"
+
+namespace genesis::romtools {
+namespace {
+
+// Same limit as the kernel's MAXSYMLINKS.
+constexpr int kMaxSymlinks = 40;
+constexpr size_t kMaxLinkLength = 4096;
+constexpr size_t kCopyBufferSize = 1024 * 1024;
+
+void splitPath(std::string_view path, std::deque<std::string> &components, bool front) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            parts.emplace_back(path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    if (front) {
+        components.insert(components.begin(), parts.begin(), parts.end());
+    } else {
+        components.insert(components.end(), parts.begin(), parts.end());
+    }
+}
+
+} // namespace
+
+std::unique_ptr<FileSystem> FileSystem::open(const char *path) {
+    std::unique_ptr<ImageSource> image = ImageSource::open(path);
+    if (image == nullptr) {
+        return nullptr;
+    }
+    if (Ext4FileSystem::matches(*image)) {
+        return Ext4FileSystem::create(std::move(image));
+    }
+    if (ErofsFileSystem::matches(*image)) {
+        return ErofsFileSystem::create(std::move(image));
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const Inode> FileSystem::inode(uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto it = inodes_.find(id);
+        if (it != inodes_.end()) {
+            return it->second;
+        }
+    }
+    // Decoded outside the lock; a racing thread may decode the same inode, and the first
+    // one cached wins.
+    auto loaded = std::make_shared<Inode>();
+    loaded->id = id;
+    if (!loadInode(id, *loaded)) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return inodes_.emplace(id, std::move(loaded)).first->second;
+}
+
+std::shared_ptr<const std::vector<DirEntry>> FileSystem::list(const Inode &directory) {
+    if (!directory.isDirectory()) {
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto it = directories_.find(directory.id);
+        if (it != directories_.end()) {
+            return it->second;
+        }
+    }
+    auto entries = std::make_shared<std::vector<DirEntry>>();
+    if (!loadDirectory(directory, *entries)) {
+        return nullptr;
+    }
+    std::erase_if(*entries, [](const DirEntry &entry) {
+        return entry.name == "." || entry.name == "..";
+    });
+    std::sort(entries->begin(), entries->end(), [](const DirEntry &a, const DirEntry &b) {
+        return a.name < b.name;
+    });
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return directories_.emplace(directory.id, std::move(entries)).first->second;
+}
+
+std::shared_ptr<const Inode> FileSystem::lookup(std::string_view path, bool followLast) {
+    std::shared_ptr<const Inode> current = inode(rootInode());
+    std::vector<std::shared_ptr<const Inode>> parents;
+    std::deque<std::string> pending;
+    splitPath(path, pending, false);
+    int links = 0;
+
+    while (current != nullptr && !pending.empty()) {
+        const std::string name = std::move(pending.front());
+        pending.pop_front();
+        if (name == ".") {
+            continue;
+        }
+        if (name == "..") {
+            if (!parents.empty()) {
+                current = parents.back();
+                parents.pop_back();
+            }
+            continue;
+        }
+
+        std::shared_ptr<const std::vector<DirEntry>> entries = list(*current);
+        if (entries == nullptr) {
+            return nullptr;
+        }
+        auto it = std::lower_bound(entries->begin(), entries->end(), name,
+                                   [](const DirEntry &entry, const std::string &value) {
+                                       return entry.name < value;
+                                   });
+        if (it == entries->end() || it->name != name) {
+            return nullptr;
+        }
+        std::shared_ptr<const Inode> child = inode(it->inode);
+        if (child == nullptr) {
+            return nullptr;
+        }
+        if (child->isSymlink() && (followLast || !pending.empty())) {
+            std::string target;
+            if (++links > kMaxSymlinks || !readLink(*child, target)) {
+                return nullptr;
+            }
+            if (!target.empty() && target[0] == '/') {
+                current = inode(rootInode());
+                parents.clear();
+            }
+            splitPath(target, pending, true);
+            continue;
+        }
+        parents.push_back(std::move(current));
+        current = std::move(child);
+    }
+    return current;
+}
+
+int64_t FileSystem::read(const Inode &file, uint64_t offset, uint8_t *out, size_t length) const {
+    if (offset >= file.size) {
+        return 0;
+    }
+    length = static_cast<size_t>(std::min<uint64_t>(length, file.size - offset));
+    memset(out, 0, length);
+    const uint64_t end = offset + length;
+    for (const FileExtent &extent: file.extents) {
+        if (extent.logical >= end) {
+            break;
+        }
+        if (extent.physical == FileExtent::kHole || extent.logical + extent.length <= offset) {
+            continue;
+        }
+        const uint64_t from = std::max(offset, extent.logical);
+        const uint64_t to = std::min(end, extent.logical + extent.length);
+        if (!image_->read(extent.physical + (from - extent.logical), out + (from - offset),
+                          static_cast<size_t>(to - from))) {
+            return -1;
+        }
+    }
+    return static_cast<int64_t>(length);
+}
+
+bool FileSystem::extract(const Inode &file, int fd) const {
+    if (ftruncate(fd, static_cast<off_t>(file.size)) != 0) {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> buffer;
+    for (const FileExtent &extent: file.extents) {
+        if (extent.physical == FileExtent::kHole || extent.logical >= file.size) {
+            continue;
+        }
+        const uint64_t length = std::min(extent.length, file.size - extent.logical);
+        for (uint64_t done = 0; done < length; done += kCopyBufferSize) {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(kCopyBufferSize,
+                                                                        length - done));
+            // Written straight from the mapping unless the bytes span sparse chunks.
+            const uint8_t *data = image_->direct(extent.physical + done, chunk);
+            if (data == nullptr) {
+                if (buffer == nullptr) {
+                    buffer.reset(new uint8_t[kCopyBufferSize]);
+                }
+                if (!image_->read(extent.physical + done, buffer.get(), chunk)) {
+                    return false;
+                }
+                data = buffer.get();
+            }
+            if (!genesis::oracle::pwriteAll(fd, data, chunk, extent.logical + done)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool FileSystem::readLink(const Inode &link, std::string &target) const {
+    if (!link.isSymlink() || link.size > kMaxLinkLength) {
+        return false;
+    }
+    target.resize(static_cast<size_t>(link.size));
+    return read(link, 0, reinterpret_cast<uint8_t *>(target.data()), target.size()) ==
+           static_cast<int64_t>(target.size());
+}
+
+} // namespace genesis::romtools
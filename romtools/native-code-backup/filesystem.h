@@ -0,0 +1,130 @@
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "image_source.h"
+
+namespace genesis::romtools {
+
+/**
+ * @brief A run of file bytes and where they live in the image.
+ */
+struct FileExtent {
+    static constexpr uint64_t kHole = UINT64_MAX;
+
+    uint64_t logical;
+    // Image offset, or kHole for bytes that read as zeros.
+    uint64_t physical;
+    uint64_t length;
+};
+
+struct Inode {
+    uint64_t id = 0;
+    // st_mode: file type and permission bits.
+    uint32_t mode = 0;
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    // Sorted by logical offset; gaps read as zeros.
+    std::vector<FileExtent> extents;
+
+    bool isDirectory() const { return (mode & 0170000) == 0040000; }
+
+    bool isRegular() const { return (mode & 0170000) == 0100000; }
+
+    bool isSymlink() const { return (mode & 0170000) == 0120000; }
+};
+
+struct DirEntry {
+    std::string name;
+    uint64_t inode;
+};
+
+/**
+ * @brief Read-only view of the filesystem inside a partition image.
+ *
+ * Implementations decode on-disk inodes and directories; this class resolves paths and
+ * reads file data. Decoded inodes and directory listings are cached as they are first
+ * touched, so a lookup costs one walk of the directories on its path the first time and a
+ * few hash lookups after that, independent of image size. File data is never copied out of
+ * the image mapping except into the caller's buffer. Thread-safe.
+ */
+class FileSystem {
+public:
+    /**
+     * @brief Opens ext4 or EROFS, raw or sparse, or returns nullptr if the image holds
+     * neither.
+     */
+    static std::unique_ptr<FileSystem> open(const char *path);
+
+    virtual ~FileSystem() = default;
+
+    FileSystem(const FileSystem &) = delete;
+
+    FileSystem &operator=(const FileSystem &) = delete;
+
+    virtual const char *type() const = 0;
+
+    const ImageSource &image() const { return *image_; }
+
+    /**
+     * @brief Looks up an absolute path. Symlinks along the way are followed; a symlink as
+     * the last component is followed only if `followLast` is set.
+     */
+    std::shared_ptr<const Inode> lookup(std::string_view path, bool followLast = true);
+
+    /**
+     * @brief Entries of a directory, without "." and "..", sorted by name.
+     */
+    std::shared_ptr<const std::vector<DirEntry>> list(const Inode &directory);
+
+    std::shared_ptr<const Inode> inode(uint64_t id);
+
+    /**
+     * @brief Reads up to `length` bytes at `offset` and returns the number read, or -1 on a
+     * corrupt image.
+     */
+    int64_t read(const Inode &file, uint64_t offset, uint8_t *out, size_t length) const;
+
+    /**
+     * @brief Writes the whole file to `fd`, leaving holes unwritten.
+     */
+    bool extract(const Inode &file, int fd) const;
+
+    /**
+     * @brief Target of a symlink.
+     */
+    bool readLink(const Inode &link, std::string &target) const;
+
+protected:
+    explicit FileSystem(std::unique_ptr<ImageSource> image) : image_(std::move(image)) {}
+
+    virtual uint64_t rootInode() const = 0;
+
+    virtual bool loadInode(uint64_t id, Inode &inode) = 0;
+
+    /**
+     * @brief Decodes all entries of a directory, including "." and ".." if stored.
+     */
+    virtual bool loadDirectory(const Inode &directory, std::vector<DirEntry> &entries) = 0;
+
+    std::unique_ptr<ImageSource> image_;
+
+private:
+    std::mutex cacheMutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<const Inode>> inodes_;
+    std::unordered_map<uint64_t, std::shared_ptr<const std::vector<DirEntry>>> directories_;
+};
+
+} // namespace genesis::romtools
+
+#endif // FILESYSTEM_H
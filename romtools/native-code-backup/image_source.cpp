@@ -0,0 +1,132 @@
+#include "image_source.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace genesis::romtools {
+
+using genesis::oracle::SparseImage;
+
+std::unique_ptr<ImageSource> ImageSource::open(const char *path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        static_cast<uint64_t>(st.st_size) > SIZE_MAX) {
+        close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    // Filesystem walks jump between metadata blocks; don't read ahead around them.
+    madvise(address, size, MADV_RANDOM);
+
+    std::unique_ptr<ImageSource> source(new ImageSource(static_cast<const uint8_t *>(address),
+                                                        size));
+    if (SparseImage::isSparse({source->map_, size})) {
+        if (!source->parseSparse()) {
+            return nullptr;
+        }
+    } else {
+        source->size_ = size;
+    }
+    return source;
+}
+
+ImageSource::~ImageSource() {
+    munmap(const_cast<uint8_t *>(map_), mapSize_);
+}
+
+bool ImageSource::parseSparse() {
+    const std::span<const uint8_t> data(map_, mapSize_);
+    uint64_t covered = 0;
+    const bool valid = SparseImage::forEachChunk(data, [this](const Chunk &chunk) {
+        chunks_.push_back(chunk);
+        return true;
+    }, &covered);
+    if (!valid) {
+        return false;
+    }
+    size_ = SparseImage::expandedSize(data);
+    // Blocks the chunks leave uncovered read as zeros.
+    if (covered < size_) {
+        chunks_.push_back({covered, size_ - covered, nullptr, 0});
+    }
+    if (chunks_.empty()) {
+        chunks_.push_back({0, 0, nullptr, 0});
+    }
+    return true;
+}
+
+const ImageSource::Chunk *ImageSource::chunkAt(uint64_t offset) const {
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), offset,
+                               [](uint64_t value, const Chunk &chunk) {
+                                   return value < chunk.offset;
+                               });
+    if (it == chunks_.begin()) {
+        return nullptr;
+    }
+    --it;
+    return offset - it->offset < it->length ? &*it : nullptr;
+}
+
+const uint8_t *ImageSource::direct(uint64_t offset, size_t length) const {
+    if (offset > size_ || length > size_ - offset) {
+        return nullptr;
+    }
+    if (chunks_.empty()) {
+        return map_ + offset;
+    }
+    const Chunk *chunk = chunkAt(offset);
+    if (chunk == nullptr || chunk->data == nullptr) {
+        return nullptr;
+    }
+    const uint64_t within = offset - chunk->offset;
+    return length <= chunk->length - within ? chunk->data + within : nullptr;
+}
+
+bool ImageSource::read(uint64_t offset, void *out, size_t length) const {
+    if (offset > size_ || length > size_ - offset) {
+        return false;
+    }
+    auto *dst = static_cast<uint8_t *>(out);
+    if (chunks_.empty()) {
+        memcpy(dst, map_ + offset, length);
+        return true;
+    }
+    while (length > 0) {
+        const Chunk *chunk = chunkAt(offset);
+        if (chunk == nullptr) {
+            return false;
+        }
+        const uint64_t within = offset - chunk->offset;
+        const size_t take = static_cast<size_t>(std::min<uint64_t>(length,
+                                                                   chunk->length - within));
+        if (chunk->data != nullptr) {
+            memcpy(dst, chunk->data + within, take);
+        } else if (chunk->fill == 0) {
+            memset(dst, 0, take);
+        } else {
+            // Fill patterns are 4-byte words aligned to the chunk start.
+            for (size_t i = 0; i < take; ++i) {
+                dst[i] = static_cast<uint8_t>(chunk->fill >> (8 * ((within + i) & 3)));
+            }
+        }
+        dst += take;
+        offset += take;
+        length -= take;
+    }
+    return true;
+}
+
+} // namespace genesis::romtools
@@ -0,0 +1,67 @@
+#ifndef IMAGE_SOURCE_H
+#define IMAGE_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sparse_image.h"
+
+namespace genesis::romtools {
+
+/**
+ * @brief Read-only random access to a partition image, raw or Android sparse, through a
+ * memory mapping of the file.
+ *
+ * Sparse images are not expanded: a chunk map translates image offsets to the raw chunk
+ * bytes in the mapping, fill values or holes, so opening a multi-GB image costs one pass
+ * over the chunk headers.
+ */
+class ImageSource {
+public:
+    static std::unique_ptr<ImageSource> open(const char *path);
+
+    ~ImageSource();
+
+    ImageSource(const ImageSource &) = delete;
+
+    ImageSource &operator=(const ImageSource &) = delete;
+
+    /**
+     * @brief Size of the (expanded) image.
+     */
+    uint64_t size() const { return size_; }
+
+    bool isSparse() const { return !chunks_.empty(); }
+
+    /**
+     * @brief Pointer to `length` image bytes at `offset` if they are contiguous in the
+     * mapping, else nullptr. Always succeeds for in-range reads of a raw image.
+     */
+    const uint8_t *direct(uint64_t offset, size_t length) const;
+
+    /**
+     * @brief Copies image bytes, expanding fills and holes. Fails if the range is out of
+     * bounds.
+     */
+    bool read(uint64_t offset, void *out, size_t length) const;
+
+private:
+    using Chunk = genesis::oracle::SparseChunk;
+
+    ImageSource(const uint8_t *map, size_t mapSize) : map_(map), mapSize_(mapSize) {}
+
+    bool parseSparse();
+
+    const Chunk *chunkAt(uint64_t offset) const;
+
+    const uint8_t *map_;
+    size_t mapSize_;
+    uint64_t size_ = 0;
+    std::vector<Chunk> chunks_;
+};
+
+} // namespace genesis::romtools
+
+#endif // IMAGE_SOURCE_H
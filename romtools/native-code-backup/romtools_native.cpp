@@ -1,41 +1,362 @@
 #include <jni.h>
 #include <android/log.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "boot_image.h"
+#include "decompressor.h"
+#include "filesystem.h"
+#include "work_stealing_pool.h"
 
 #define LOG_TAG "ROMTools-Native"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+using genesis::romtools::FileSystem;
+using genesis::romtools::Inode;
+
+FileSystem *fromHandle(jlong handle) {
+    return reinterpret_cast<FileSystem *>(static_cast<intptr_t>(handle));
+}
+
+// Looks up `path` in the image behind `handle`, or returns nullptr.
+std::shared_ptr<const Inode> lookupPath(JNIEnv *env, jlong handle, jstring path,
+                                        bool followLast = true) {
+    FileSystem *fs = fromHandle(handle);
+    if (fs == nullptr || path == nullptr) {
+        return nullptr;
+    }
+    const char *chars = env->GetStringUTFChars(path, nullptr);
+    if (chars == nullptr) {
+        return nullptr;
+    }
+    std::shared_ptr<const Inode> inode = fs->lookup(chars, followLast);
+    if (inode == nullptr) {
+        LOGE("No such file in image: %s", chars);
+    }
+    env->ReleaseStringUTFChars(path, chars);
+    return inode;
+}
+
+// Length of the well-formed UTF-8 sequence at `p` (at most `n` bytes), or 0 if there is
+// none; `cp` receives its code point.
+size_t decodeUtf8(const uint8_t *p, size_t n, uint32_t &cp) {
+    size_t length;
+    uint32_t min;
+    if (p[0] >= 0xc2 && p[0] <= 0xdf) {
+        length = 2;
+        min = 0x80;
+        cp = p[0] & 0x1f;
+    } else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+        length = 3;
+        min = 0x800;
+        cp = p[0] & 0x0f;
+    } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+        length = 4;
+        min = 0x10000;
+        cp = p[0] & 0x07;
+    } else {
+        return 0;
+    }
+    if (n < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((p[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (p[i] & 0x3f);
+    }
+    if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+        return 0;
+    }
+    return length;
+}
+
+// File names are arbitrary bytes, but the result goes through NewStringUTF, which takes
+// modified UTF-8: characters outside the BMP are written as escaped surrogate pairs, and
+// bytes that are not UTF-8 as U+FFFD.
+void appendJsonString(std::string &out, const std::string &value) {
+    const auto *p = reinterpret_cast<const uint8_t *>(value.data());
+    const size_t n = value.size();
+    char escaped[16];
+    out += '"';
+    for (size_t i = 0; i < n;) {
+        const uint8_t c = p[i];
+        if (c >= 0x80) {
+            uint32_t cp;
+            const size_t length = decodeUtf8(p + i, n - i, cp);
+            if (length == 0) {
+                out += "\\ufffd";
+            } else if (cp < 0x10000) {
+                out.append(value, i, length);
+            } else {
+                cp -= 0x10000;
+                snprintf(escaped, sizeof(escaped), "\\u%04x\\u%04x", 0xd800 + (cp >> 10),
+                         0xdc00 + (cp & 0x3ff));
+                out += escaped;
+            }
+            i += length == 0 ? 1 : length;
+            continue;
+        }
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+        ++i;
+    }
+    out += '"';
+}
+
+const char *typeName(const Inode &inode) {
+    if (inode.isDirectory()) {
+        return "directory";
+    }
+    if (inode.isRegular()) {
+        return "file";
+    }
+    return inode.isSymlink() ? "symlink" : "other";
+}
+
+} // namespace
 
 extern "C" {
 
-// ROM Tools Native Interface - Placeholder implementation
 JNIEXPORT jstring JNICALL
 Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_getVersion(JNIEnv *env, jobject /* this */) {
     LOGI("ROM Tools Native Library initialized");
     return env->NewStringUTF("1.0.0-genesis");
 }
 
-// Boot image analysis placeholder
+/**
+ * Check and log the layout of a boot.img (header v0-v4) or vendor_boot.img
+ * @param path Image file. Only the header is read, through the Oracle Drive boot image parser
+ * @return Whether the file is a valid boot image whose sections all lie inside it
+ */
 JNIEXPORT jboolean JNICALL
 Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_analyzeBootImage(JNIEnv *env,
                                                                       jobject /* this */,
                                                                       jstring path) {
-    const char *bootPath = env->GetStringUTFChars(path, 0);
+    const char *bootPath = env->GetStringUTFChars(path, nullptr);
+    if (bootPath == nullptr) {
+        return JNI_FALSE;
+    }
     LOGI("Analyzing boot image: %s", bootPath);
-    env->ReleaseStringUTFChars(path, bootPath);
 
-    // TODO: Implement actual boot image analysis
-    return JNI_TRUE;
+    std::unique_ptr<genesis::oracle::BootImage> image = genesis::oracle::BootImage::open(bootPath);
+    if (image != nullptr) {
+        const genesis::oracle::BootImageInfo &info = image->info();
+        LOGI("%s header v%u, page size %u, kernel %s, Android %s (%s)",
+             info.vendorBoot ? "vendor_boot" : "boot", info.headerVersion, info.pageSize,
+             image->kernelArchitecture(), info.osVersion.empty() ? "?" : info.osVersion.c_str(),
+             info.patchLevel.empty() ? "?" : info.patchLevel.c_str());
+        for (const genesis::oracle::BootSection &section: info.sections) {
+            LOGI("  %s: %" PRIu64 " bytes at %" PRIu64 ", %s", section.name.c_str(),
+                 section.size, section.offset,
+                 genesis::oracle::compressionName(section.compression));
+        }
+    } else {
+        LOGE("Not a valid boot or vendor_boot image: %s", bootPath);
+    }
+    env->ReleaseStringUTFChars(path, bootPath);
+    return image != nullptr ? JNI_TRUE : JNI_FALSE;
 }
 
-// Partition management placeholder
+/**
+ * Check that a partition image holds a filesystem this library can read
+ * @param partition Path to a raw or sparse ext4/EROFS image. Nothing is mounted: images are
+ *                  read in userspace, so no root or loop device is needed
+ * @return Whether the image could be opened
+ */
 JNIEXPORT jboolean JNICALL
 Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_mountPartition(JNIEnv *env, jobject /* this */,
                                                                     jstring partition) {
     const char *partName = env->GetStringUTFChars(partition, 0);
-    LOGI("Mounting partition: %s", partName);
+    if (partName == nullptr) {
+        return JNI_FALSE;
+    }
+    std::unique_ptr<FileSystem> fs = FileSystem::open(partName);
+    if (fs != nullptr) {
+        LOGI("Opened %s image %s (%" PRIu64 " bytes%s)", fs->type(), partName,
+             fs->image().size(), fs->image().isSparse() ? ", sparse" : "");
+    } else {
+        LOGE("Not a readable ext4 or EROFS image: %s", partName);
+    }
     env->ReleaseStringUTFChars(partition, partName);
+    return fs != nullptr ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Open a raw or sparse ext4/EROFS image for browsing
+ * @return Handle for the image calls below, or 0 if the file holds neither filesystem
+ */
+JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_openImage(JNIEnv *env, jobject /* this */,
+                                                               jstring imagePath) {
+    const char *path = env->GetStringUTFChars(imagePath, nullptr);
+    if (path == nullptr) {
+        return 0;
+    }
+    std::unique_ptr<FileSystem> fs = FileSystem::open(path);
+    if (fs == nullptr) {
+        LOGE("Not a readable ext4 or EROFS image: %s", path);
+    }
+    env->ReleaseStringUTFChars(imagePath, path);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(fs.release()));
+}
 
-    // TODO: Implement actual partition mounting
-    return JNI_TRUE;
+/**
+ * List a directory of an open image
+ * @param handle Handle from openImage
+ * @param path Absolute path inside the image
+ * @return JSON array of {"name", "type", "size", "mode", "uid", "gid", "mtime"} sorted by
+ *         name, or null if the path is not a readable directory
+ */
+JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_listDirectory(JNIEnv *env,
+                                                                   jobject /* this */,
+                                                                   jlong handle, jstring path) {
+    std::shared_ptr<const Inode> directory = lookupPath(env, handle, path);
+    if (directory == nullptr) {
+        return nullptr;
+    }
+    FileSystem *fs = fromHandle(handle);
+    auto entries = fs->list(*directory);
+    if (entries == nullptr) {
+        return nullptr;
+    }
+    std::string json = "[";
+    for (const auto &entry: *entries) {
+        std::shared_ptr<const Inode> inode = fs->inode(entry.inode);
+        if (inode == nullptr) {
+            continue;
+        }
+        if (json.size() > 1) {
+            json += ',';
+        }
+        json += "{\"name\":";
+        appendJsonString(json, entry.name);
+        char fields[160];
+        snprintf(fields, sizeof(fields),
+                 ",\"type\":\"%s\",\"size\":%" PRIu64 ",\"mode\":%u,\"uid\":%u,\"gid\":%u"
+                 ",\"mtime\":%" PRId64 "}",
+                 typeName(*inode), inode->size, inode->mode, inode->uid, inode->gid,
+                 inode->mtime);
+        json += fields;
+    }
+    json += ']';
+    return env->NewStringUTF(json.c_str());
+}
+
+/**
+ * Read a whole file, following symlinks
+ * @return File contents, or null if the path is missing, not a regular file or too large
+ *         for a Java array
+ */
+JNIEXPORT jbyteArray JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_readFile(JNIEnv *env, jobject /* this */,
+                                                              jlong handle, jstring path) {
+    std::shared_ptr<const Inode> file = lookupPath(env, handle, path);
+    if (file == nullptr || !file->isRegular() || file->size > INT32_MAX) {
+        return nullptr;
+    }
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(file->size));
+    if (result == nullptr) {
+        return nullptr;
+    }
+    jbyte *bytes = env->GetByteArrayElements(result, nullptr);
+    if (bytes == nullptr) {
+        return nullptr;
+    }
+    const int64_t read = fromHandle(handle)->read(*file, 0, reinterpret_cast<uint8_t *>(bytes),
+                                                  static_cast<size_t>(file->size));
+    env->ReleaseByteArrayElements(result, bytes, 0);
+    if (read != static_cast<int64_t>(file->size)) {
+        LOGE("Corrupt image data while reading file");
+        return nullptr;
+    }
+    return result;
+}
+
+/**
+ * Extract one file to disk, following symlinks; holes stay sparse
+ * @param outputPath Destination path, created or truncated
+ * @return Success status
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_extractFile(JNIEnv *env, jobject /* this */,
+                                                                 jlong handle, jstring path,
+                                                                 jstring outputPath) {
+    std::shared_ptr<const Inode> file = lookupPath(env, handle, path);
+    if (file == nullptr || !file->isRegular() || outputPath == nullptr) {
+        return JNI_FALSE;
+    }
+    const char *output = env->GetStringUTFChars(outputPath, nullptr);
+    if (output == nullptr) {
+        return JNI_FALSE;
+    }
+    const int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && fromHandle(handle)->extract(*file, fd);
+    if (fd >= 0 && close(fd) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        LOGE("Failed to extract to %s", output);
+        unlink(output);
+    }
+    env->ReleaseStringUTFChars(outputPath, output);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Close an image opened with openImage, unmapping it
+ */
+JNIEXPORT void JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_closeImage(JNIEnv * /* env */,
+                                                                jobject /* this */,
+                                                                jlong handle) {
+    delete fromHandle(handle);
+}
+
+/**
+ * Decompress a gzip, lz4 (frame or legacy), zstd, xz, lzma or bzip2 file, detected from its
+ * magic, e.g. a kernel or ramdisk pulled out of a boot image
+ * @param inputPath Compressed file
+ * @param outputPath Destination path, created or truncated; removed on failure
+ * @return Success status
+ */
+JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_romtools_ROMToolsNative_decompressFile(JNIEnv *env,
+                                                                    jobject /* this */,
+                                                                    jstring inputPath,
+                                                                    jstring outputPath) {
+    if (inputPath == nullptr || outputPath == nullptr) {
+        return JNI_FALSE;
+    }
+    const char *input = env->GetStringUTFChars(inputPath, nullptr);
+    const char *output = env->GetStringUTFChars(outputPath, nullptr);
+    const bool ok = input != nullptr && output != nullptr &&
+                    genesis::oracle::decompressFile(input, output,
+                                                    &genesis::oracle::WorkStealingPool::shared());
+    if (input != nullptr) {
+        env->ReleaseStringUTFChars(inputPath, input);
+    }
+    if (output != nullptr) {
+        env->ReleaseStringUTFChars(outputPath, output);
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
 }
 
 }
@@ -0,0 +1,41 @@
+#ifndef CHACHA20_KERNELS_H
+#define CHACHA20_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CHACHA_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#define CHACHA_SSE2 1
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHACHA_AVX2 1
+#endif
+#endif
+
+namespace genesis::crypto {
+
+// ChaCha20 block kernels. Each XORs `blocks` whole 64-byte keystream blocks into `in`,
+// writing to `out`, starting at the block counter in state[12], and advances the counter.
+using ChaCha20XorBlocksFn = void (*)(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                                     size_t blocks);
+
+void chacha20XorBlocksScalar(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                             size_t blocks);
+
+#if defined(CHACHA_NEON)
+void chacha20XorBlocksNeon(uint32_t state[16], const uint8_t *in, uint8_t *out, size_t blocks);
+#endif
+
+#if defined(CHACHA_SSE2)
+void chacha20XorBlocksSse2(uint32_t state[16], const uint8_t *in, uint8_t *out, size_t blocks);
+#endif
+
+#if defined(CHACHA_AVX2)
+// Compiled with target("avx2"); only call when the CPU supports it.
+void chacha20XorBlocksAvx2(uint32_t state[16], const uint8_t *in, uint8_t *out, size_t blocks);
+#endif
+
+} // namespace genesis::crypto
+
+#endif // CHACHA20_KERNELS_H
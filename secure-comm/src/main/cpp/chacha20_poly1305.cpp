@@ -0,0 +1,715 @@
+#include "chacha20_poly1305.h"
+#include "chacha20_kernels.h"
+#include "crypto_dispatch.h"
+
+#include <cstring>
+
+#if defined(CHACHA_NEON)
+#include <arm_neon.h>
+#elif defined(CHACHA_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace genesis::crypto {
+namespace {
+
+inline uint32_t load32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline void store32(uint8_t *p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+inline uint64_t load64(const uint8_t *p) {
+    return uint64_t{load32(p)} | (uint64_t{load32(p + 4)} << 32);
+}
+
+inline void store64(uint8_t *p, uint64_t v) {
+    store32(p, static_cast<uint32_t>(v));
+    store32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------------------
+// ChaCha20 block kernels. Each XORs `blocks` whole 64-byte keystream blocks into `in`,
+// starting at the block counter in state[12], and advances the counter.
+// ---------------------------------------------------------------------------------------
+
+namespace {
+
+inline uint32_t rotl(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+#define CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = rotl(d, 16);     \
+    c += d; b ^= c; b = rotl(b, 12);     \
+    a += b; d ^= a; d = rotl(d, 8);      \
+    c += d; b ^= c; b = rotl(b, 7)
+
+void chachaBlock(const uint32_t state[16], uint32_t out[16]) {
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (int i = 0; i < 10; ++i) {
+        CHACHA_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        CHACHA_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        CHACHA_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        CHACHA_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; ++i) {
+        out[i] = x[i] + state[i];
+    }
+}
+
+} // namespace
+
+void chacha20XorBlocksScalar(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                             size_t blocks) {
+    uint32_t keystream[16];
+    for (; blocks > 0; --blocks, in += ChaCha20::kBlockSize, out += ChaCha20::kBlockSize) {
+        chachaBlock(state, keystream);
+        for (int i = 0; i < 16; ++i) {
+            store32(out + 4 * i, load32(in + 4 * i) ^ keystream[i]);
+        }
+        state[12]++;
+    }
+}
+
+// The vector kernels compute several blocks at once with one register per state word
+// ("vertical" layout), then transpose each 4x4 group of words back into block order.
+
+#define CHACHA_VECTOR_DOUBLE_ROUND(QR, x)   \
+    QR(x[0], x[4], x[8], x[12]);            \
+    QR(x[1], x[5], x[9], x[13]);            \
+    QR(x[2], x[6], x[10], x[14]);           \
+    QR(x[3], x[7], x[11], x[15]);           \
+    QR(x[0], x[5], x[10], x[15]);           \
+    QR(x[1], x[6], x[11], x[12]);           \
+    QR(x[2], x[7], x[8], x[13]);            \
+    QR(x[3], x[4], x[9], x[14])
+
+#if defined(CHACHA_NEON)
+
+namespace {
+
+inline uint32x4_t rotlNeon16(uint32x4_t v) {
+    return vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(v)));
+}
+
+} // namespace
+
+#define ROTL_NEON(v, n) vsriq_n_u32(vshlq_n_u32(v, n), v, 32 - (n))
+
+#define QR_NEON(a, b, c, d)                                                  \
+    a = vaddq_u32(a, b); d = veorq_u32(d, a); d = rotlNeon16(d);             \
+    c = vaddq_u32(c, d); b = veorq_u32(b, c); b = ROTL_NEON(b, 12);          \
+    a = vaddq_u32(a, b); d = veorq_u32(d, a); d = ROTL_NEON(d, 8);           \
+    c = vaddq_u32(c, d); b = veorq_u32(b, c); b = ROTL_NEON(b, 7)
+
+void chacha20XorBlocksNeon(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                           size_t blocks) {
+    static const uint32_t kLaneOffsets[4] = {0, 1, 2, 3};
+    const uint32x4_t laneOffsets = vld1q_u32(kLaneOffsets);
+    for (; blocks >= 4; blocks -= 4, in += 4 * ChaCha20::kBlockSize,
+            out += 4 * ChaCha20::kBlockSize) {
+        uint32x4_t initial[16];
+        uint32x4_t x[16];
+        for (int i = 0; i < 16; ++i) {
+            initial[i] = vdupq_n_u32(state[i]);
+        }
+        initial[12] = vaddq_u32(initial[12], laneOffsets);
+        for (int i = 0; i < 16; ++i) {
+            x[i] = initial[i];
+        }
+        for (int i = 0; i < 10; ++i) {
+            CHACHA_VECTOR_DOUBLE_ROUND(QR_NEON, x);
+        }
+        for (int group = 0; group < 4; ++group) {
+            const uint32x4x2_t ab = vtrnq_u32(vaddq_u32(x[4 * group], initial[4 * group]),
+                                              vaddq_u32(x[4 * group + 1], initial[4 * group + 1]));
+            const uint32x4x2_t cd = vtrnq_u32(vaddq_u32(x[4 * group + 2], initial[4 * group + 2]),
+                                              vaddq_u32(x[4 * group + 3], initial[4 * group + 3]));
+            const uint32x4_t rows[4] = {
+                    vcombine_u32(vget_low_u32(ab.val[0]), vget_low_u32(cd.val[0])),
+                    vcombine_u32(vget_low_u32(ab.val[1]), vget_low_u32(cd.val[1])),
+                    vcombine_u32(vget_high_u32(ab.val[0]), vget_high_u32(cd.val[0])),
+                    vcombine_u32(vget_high_u32(ab.val[1]), vget_high_u32(cd.val[1])),
+            };
+            for (int block = 0; block < 4; ++block) {
+                const size_t offset = block * ChaCha20::kBlockSize + 16 * group;
+                const uint8x16_t data = vld1q_u8(in + offset);
+                vst1q_u8(out + offset, veorq_u8(data, vreinterpretq_u8_u32(rows[block])));
+            }
+        }
+        state[12] += 4;
+    }
+    chacha20XorBlocksScalar(state, in, out, blocks);
+}
+
+#endif // CHACHA_NEON
+
+#if defined(CHACHA_SSE2)
+
+#define ROTL_SSE2(v, n) _mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+
+#define QR_SSE2(a, b, c, d)                                                          \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL_SSE2(d, 16);          \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL_SSE2(b, 12);          \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL_SSE2(d, 8);           \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL_SSE2(b, 7)
+
+void chacha20XorBlocksSse2(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                           size_t blocks) {
+    const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+    for (; blocks >= 4; blocks -= 4, in += 4 * ChaCha20::kBlockSize,
+            out += 4 * ChaCha20::kBlockSize) {
+        __m128i initial[16];
+        __m128i x[16];
+        for (int i = 0; i < 16; ++i) {
+            initial[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+        }
+        initial[12] = _mm_add_epi32(initial[12], laneOffsets);
+        for (int i = 0; i < 16; ++i) {
+            x[i] = initial[i];
+        }
+        for (int i = 0; i < 10; ++i) {
+            CHACHA_VECTOR_DOUBLE_ROUND(QR_SSE2, x);
+        }
+        for (int group = 0; group < 4; ++group) {
+            const __m128i a = _mm_add_epi32(x[4 * group], initial[4 * group]);
+            const __m128i b = _mm_add_epi32(x[4 * group + 1], initial[4 * group + 1]);
+            const __m128i c = _mm_add_epi32(x[4 * group + 2], initial[4 * group + 2]);
+            const __m128i d = _mm_add_epi32(x[4 * group + 3], initial[4 * group + 3]);
+            const __m128i ab01 = _mm_unpacklo_epi32(a, b);
+            const __m128i cd01 = _mm_unpacklo_epi32(c, d);
+            const __m128i ab23 = _mm_unpackhi_epi32(a, b);
+            const __m128i cd23 = _mm_unpackhi_epi32(c, d);
+            const __m128i rows[4] = {
+                    _mm_unpacklo_epi64(ab01, cd01),
+                    _mm_unpackhi_epi64(ab01, cd01),
+                    _mm_unpacklo_epi64(ab23, cd23),
+                    _mm_unpackhi_epi64(ab23, cd23),
+            };
+            for (int block = 0; block < 4; ++block) {
+                const size_t offset = block * ChaCha20::kBlockSize + 16 * group;
+                const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + offset));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + offset),
+                                 _mm_xor_si128(data, rows[block]));
+            }
+        }
+        state[12] += 4;
+    }
+    chacha20XorBlocksScalar(state, in, out, blocks);
+}
+
+#endif // CHACHA_SSE2
+
+#if defined(CHACHA_AVX2)
+
+#define ROTL_AVX2(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+
+#define QR_AVX2(a, b, c, d)                                                                  \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = ROTL_AVX2(b, 12);            \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8);  \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = ROTL_AVX2(b, 7)
+
+__attribute__((target("avx2")))
+void chacha20XorBlocksAvx2(uint32_t state[16], const uint8_t *in, uint8_t *out,
+                           size_t blocks) {
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    for (; blocks >= 8; blocks -= 8, in += 8 * ChaCha20::kBlockSize,
+            out += 8 * ChaCha20::kBlockSize) {
+        __m256i initial[16];
+        __m256i x[16];
+        for (int i = 0; i < 16; ++i) {
+            initial[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+        }
+        initial[12] = _mm256_add_epi32(initial[12], laneOffsets);
+        for (int i = 0; i < 16; ++i) {
+            x[i] = initial[i];
+        }
+        for (int i = 0; i < 10; ++i) {
+            CHACHA_VECTOR_DOUBLE_ROUND(QR_AVX2, x);
+        }
+
+        // Each 128-bit lane transposes like the SSE2 kernel: the low lane holds blocks 0-3
+        // and the high lane blocks 4-7. Pairs of word groups then make 32-byte stores.
+        __m256i rows[4][4];
+        for (int group = 0; group < 4; ++group) {
+            const __m256i a = _mm256_add_epi32(x[4 * group], initial[4 * group]);
+            const __m256i b = _mm256_add_epi32(x[4 * group + 1], initial[4 * group + 1]);
+            const __m256i c = _mm256_add_epi32(x[4 * group + 2], initial[4 * group + 2]);
+            const __m256i d = _mm256_add_epi32(x[4 * group + 3], initial[4 * group + 3]);
+            const __m256i ab01 = _mm256_unpacklo_epi32(a, b);
+            const __m256i cd01 = _mm256_unpacklo_epi32(c, d);
+            const __m256i ab23 = _mm256_unpackhi_epi32(a, b);
+            const __m256i cd23 = _mm256_unpackhi_epi32(c, d);
+            rows[group][0] = _mm256_unpacklo_epi64(ab01, cd01);
+            rows[group][1] = _mm256_unpackhi_epi64(ab01, cd01);
+            rows[group][2] = _mm256_unpacklo_epi64(ab23, cd23);
+            rows[group][3] = _mm256_unpackhi_epi64(ab23, cd23);
+        }
+        for (int pair = 0; pair < 2; ++pair) {
+            for (int block = 0; block < 4; ++block) {
+                const __m256i lo = _mm256_permute2x128_si256(rows[2 * pair][block],
+                                                             rows[2 * pair + 1][block], 0x20);
+                const __m256i hi = _mm256_permute2x128_si256(rows[2 * pair][block],
+                                                             rows[2 * pair + 1][block], 0x31);
+                const size_t loOffset = block * ChaCha20::kBlockSize + 32 * pair;
+                const size_t hiOffset = loOffset + 4 * ChaCha20::kBlockSize;
+                const __m256i loData = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i *>(in + loOffset));
+                const __m256i hiData = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i *>(in + hiOffset));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + loOffset),
+                                    _mm256_xor_si256(loData, lo));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + hiOffset),
+                                    _mm256_xor_si256(hiData, hi));
+            }
+        }
+        state[12] += 8;
+    }
+    chacha20XorBlocksSse2(state, in, out, blocks);
+}
+
+#endif // CHACHA_AVX2
+
+namespace {
+
+inline void xorBlocks(uint32_t state[16], const uint8_t *in, uint8_t *out, size_t blocks) {
+    cryptoKernels().chacha20XorBlocks(state, in, out, blocks);
+}
+
+// Poly1305 and ciphertext are processed in slices this size so the MAC reads data the
+// cipher just wrote while it is still in L1.
+constexpr size_t kAeadSlice = 4096;
+
+} // namespace
+
+// ---------------------------------------------------------------------------------------
+// ChaCha20
+// ---------------------------------------------------------------------------------------
+
+void ChaCha20::init(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize],
+                    uint32_t counter) {
+    state_[0] = 0x61707865;
+    state_[1] = 0x3320646e;
+    state_[2] = 0x79622d32;
+    state_[3] = 0x6b206574;
+    for (int i = 0; i < 8; ++i) {
+        state_[4 + i] = load32(key + 4 * i);
+    }
+    state_[12] = counter;
+    for (int i = 0; i < 3; ++i) {
+        state_[13 + i] = load32(nonce + 4 * i);
+    }
+    keystreamUsed_ = kBlockSize;
+}
+
+void ChaCha20::keystreamBlock(uint8_t out[kBlockSize]) {
+    uint32_t block[16];
+    chachaBlock(state_, block);
+    for (int i = 0; i < 16; ++i) {
+        store32(out + 4 * i, block[i]);
+    }
+    state_[12]++;
+}
+
+void ChaCha20::apply(const uint8_t *in, uint8_t *out, size_t length) {
+    while (length > 0 && keystreamUsed_ < kBlockSize) {
+        *out++ = *in++ ^ keystream_[keystreamUsed_++];
+        --length;
+    }
+
+    const size_t blocks = length / kBlockSize;
+    xorBlocks(state_, in, out, blocks);
+    in += blocks * kBlockSize;
+    out += blocks * kBlockSize;
+    length -= blocks * kBlockSize;
+
+    if (length > 0) {
+        keystreamBlock(keystream_);
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = in[i] ^ keystream_[i];
+        }
+        keystreamUsed_ = length;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Poly1305, after poly1305-donna: 44-bit limbs with 128-bit products where the compiler
+// has them, 26-bit limbs with 64-bit products on 32-bit targets.
+// ---------------------------------------------------------------------------------------
+
+#if defined(__SIZEOF_INT128__)
+
+using uint128_t = unsigned __int128;
+
+void Poly1305::init(const uint8_t key[kKeySize]) {
+    const uint64_t t0 = load64(key);
+    const uint64_t t1 = load64(key + 8);
+    r_[0] = t0 & 0xffc0fffffff;
+    r_[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+    r_[2] = (t1 >> 24) & 0x00ffffffc0f;
+    h_[0] = h_[1] = h_[2] = 0;
+    for (int i = 0; i < 4; ++i) {
+        pad_[i] = load32(key + 16 + 4 * i);
+    }
+    buffered_ = 0;
+}
+
+void Poly1305::blocks(const uint8_t *data, size_t count, bool partial) {
+    constexpr uint64_t kMask44 = 0xfffffffffff;
+    constexpr uint64_t kMask42 = 0x3ffffffffff;
+    const uint64_t hibit = partial ? 0 : uint64_t{1} << 40;
+    const uint64_t r0 = r_[0], r1 = r_[1], r2 = r_[2];
+    const uint64_t s1 = r1 * (5 << 2), s2 = r2 * (5 << 2);
+    uint64_t h0 = h_[0], h1 = h_[1], h2 = h_[2];
+
+    for (; count > 0; --count, data += kBlockSize) {
+        const uint64_t t0 = load64(data);
+        const uint64_t t1 = load64(data + 8);
+        h0 += t0 & kMask44;
+        h1 += ((t0 >> 44) | (t1 << 20)) & kMask44;
+        h2 += ((t1 >> 24) & kMask42) | hibit;
+
+        const uint128_t d0 = uint128_t{h0} * r0 + uint128_t{h1} * s2 + uint128_t{h2} * s1;
+        uint128_t d1 = uint128_t{h0} * r1 + uint128_t{h1} * r0 + uint128_t{h2} * s2;
+        uint128_t d2 = uint128_t{h0} * r2 + uint128_t{h1} * r1 + uint128_t{h2} * r0;
+
+        uint64_t c = static_cast<uint64_t>(d0 >> 44);
+        h0 = static_cast<uint64_t>(d0) & kMask44;
+        d1 += c;
+        c = static_cast<uint64_t>(d1 >> 44);
+        h1 = static_cast<uint64_t>(d1) & kMask44;
+        d2 += c;
+        c = static_cast<uint64_t>(d2 >> 42);
+        h2 = static_cast<uint64_t>(d2) & kMask42;
+        h0 += c * 5;
+        c = h0 >> 44;
+        h0 &= kMask44;
+        h1 += c;
+    }
+    h_[0] = h0;
+    h_[1] = h1;
+    h_[2] = h2;
+}
+
+void Poly1305::finish(uint8_t tag[kTagSize]) {
+    constexpr uint64_t kMask44 = 0xfffffffffff;
+    constexpr uint64_t kMask42 = 0x3ffffffffff;
+    if (buffered_ > 0) {
+        buffer_[buffered_] = 1;
+        memset(buffer_ + buffered_ + 1, 0, kBlockSize - buffered_ - 1);
+        blocks(buffer_, 1, true);
+        buffered_ = 0;
+    }
+
+    uint64_t h0 = h_[0], h1 = h_[1], h2 = h_[2];
+    uint64_t c = h1 >> 44;
+    h1 &= kMask44;
+    h2 += c;
+    c = h2 >> 42;
+    h2 &= kMask42;
+    h0 += c * 5;
+    c = h0 >> 44;
+    h0 &= kMask44;
+    h1 += c;
+    c = h1 >> 44;
+    h1 &= kMask44;
+    h2 += c;
+    c = h2 >> 42;
+    h2 &= kMask42;
+    h0 += c * 5;
+    c = h0 >> 44;
+    h0 &= kMask44;
+    h1 += c;
+
+    // Compute h - p and keep it if it did not underflow.
+    uint64_t g0 = h0 + 5;
+    c = g0 >> 44;
+    g0 &= kMask44;
+    uint64_t g1 = h1 + c;
+    c = g1 >> 44;
+    g1 &= kMask44;
+    uint64_t g2 = h2 + c - (uint64_t{1} << 42);
+    const uint64_t keep = (g2 >> 63) - 1;
+    h0 = (h0 & ~keep) | (g0 & keep);
+    h1 = (h1 & ~keep) | (g1 & keep);
+    h2 = (h2 & ~keep) | (g2 & keep);
+
+    const uint64_t t0 = uint64_t{pad_[0]} | (uint64_t{pad_[1]} << 32);
+    const uint64_t t1 = uint64_t{pad_[2]} | (uint64_t{pad_[3]} << 32);
+    h0 += t0 & kMask44;
+    c = h0 >> 44;
+    h0 &= kMask44;
+    h1 += (((t0 >> 44) | (t1 << 20)) & kMask44) + c;
+    c = h1 >> 44;
+    h1 &= kMask44;
+    h2 += ((t1 >> 24) & kMask42) + c;
+
+    store64(tag, h0 | (h1 << 44));
+    store64(tag + 8, (h1 >> 20) | (h2 << 24));
+    secureZero(h_, sizeof(h_));
+    secureZero(r_, sizeof(r_));
+    secureZero(pad_, sizeof(pad_));
+}
+
+#else
+
+void Poly1305::init(const uint8_t key[kKeySize]) {
+    r_[0] = load32(key) & 0x3ffffff;
+    r_[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+    r_[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+    r_[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+    r_[4] = (load32(key + 12) >> 8) & 0x00fffff;
+    h_[0] = h_[1] = h_[2] = h_[3] = h_[4] = 0;
+    for (int i = 0; i < 4; ++i) {
+        pad_[i] = load32(key + 16 + 4 * i);
+    }
+    buffered_ = 0;
+}
+
+void Poly1305::blocks(const uint8_t *data, size_t count, bool partial) {
+    constexpr uint32_t kMask26 = 0x3ffffff;
+    const uint32_t hibit = partial ? 0 : uint32_t{1} << 24;
+    const uint32_t r0 = r_[0], r1 = r_[1], r2 = r_[2], r3 = r_[3], r4 = r_[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = h_[0], h1 = h_[1], h2 = h_[2], h3 = h_[3], h4 = h_[4];
+
+    for (; count > 0; --count, data += kBlockSize) {
+        h0 += load32(data) & kMask26;
+        h1 += (load32(data + 3) >> 2) & kMask26;
+        h2 += (load32(data + 6) >> 4) & kMask26;
+        h3 += (load32(data + 9) >> 6) & kMask26;
+        h4 += (load32(data + 12) >> 8) | hibit;
+
+        const uint64_t d0 = uint64_t{h0} * r0 + uint64_t{h1} * s4 + uint64_t{h2} * s3 +
+                            uint64_t{h3} * s2 + uint64_t{h4} * s1;
+        uint64_t d1 = uint64_t{h0} * r1 + uint64_t{h1} * r0 + uint64_t{h2} * s4 +
+                      uint64_t{h3} * s3 + uint64_t{h4} * s2;
+        uint64_t d2 = uint64_t{h0} * r2 + uint64_t{h1} * r1 + uint64_t{h2} * r0 +
+                      uint64_t{h3} * s4 + uint64_t{h4} * s3;
+        uint64_t d3 = uint64_t{h0} * r3 + uint64_t{h1} * r2 + uint64_t{h2} * r1 +
+                      uint64_t{h3} * r0 + uint64_t{h4} * s4;
+        uint64_t d4 = uint64_t{h0} * r4 + uint64_t{h1} * r3 + uint64_t{h2} * r2 +
+                      uint64_t{h3} * r1 + uint64_t{h4} * r0;
+
+        uint32_t c = static_cast<uint32_t>(d0 >> 26);
+        h0 = static_cast<uint32_t>(d0) & kMask26;
+        d1 += c;
+        c = static_cast<uint32_t>(d1 >> 26);
+        h1 = static_cast<uint32_t>(d1) & kMask26;
+        d2 += c;
+        c = static_cast<uint32_t>(d2 >> 26);
+        h2 = static_cast<uint32_t>(d2) & kMask26;
+        d3 += c;
+        c = static_cast<uint32_t>(d3 >> 26);
+        h3 = static_cast<uint32_t>(d3) & kMask26;
+        d4 += c;
+        c = static_cast<uint32_t>(d4 >> 26);
+        h4 = static_cast<uint32_t>(d4) & kMask26;
+        h0 += c * 5;
+        c = h0 >> 26;
+        h0 &= kMask26;
+        h1 += c;
+    }
+    h_[0] = h0;
+    h_[1] = h1;
+    h_[2] = h2;
+    h_[3] = h3;
+    h_[4] = h4;
+}
+
+void Poly1305::finish(uint8_t tag[kTagSize]) {
+    constexpr uint32_t kMask26 = 0x3ffffff;
+    if (buffered_ > 0) {
+        buffer_[buffered_] = 1;
+        memset(buffer_ + buffered_ + 1, 0, kBlockSize - buffered_ - 1);
+        blocks(buffer_, 1, true);
+        buffered_ = 0;
+    }
+
+    uint32_t h0 = h_[0], h1 = h_[1], h2 = h_[2], h3 = h_[3], h4 = h_[4];
+    uint32_t c = h1 >> 26;
+    h1 &= kMask26;
+    h2 += c;
+    c = h2 >> 26;
+    h2 &= kMask26;
+    h3 += c;
+    c = h3 >> 26;
+    h3 &= kMask26;
+    h4 += c;
+    c = h4 >> 26;
+    h4 &= kMask26;
+    h0 += c * 5;
+    c = h0 >> 26;
+    h0 &= kMask26;
+    h1 += c;
+
+    // Compute h - p and keep it if it did not underflow.
+    uint32_t g0 = h0 + 5;
+    c = g0 >> 26;
+    g0 &= kMask26;
+    uint32_t g1 = h1 + c;
+    c = g1 >> 26;
+    g1 &= kMask26;
+    uint32_t g2 = h2 + c;
+    c = g2 >> 26;
+    g2 &= kMask26;
+    uint32_t g3 = h3 + c;
+    c = g3 >> 26;
+    g3 &= kMask26;
+    const uint32_t g4 = h4 + c - (uint32_t{1} << 26);
+    const uint32_t keep = (g4 >> 31) - 1;
+    h0 = (h0 & ~keep) | (g0 & keep);
+    h1 = (h1 & ~keep) | (g1 & keep);
+    h2 = (h2 & ~keep) | (g2 & keep);
+    h3 = (h3 & ~keep) | (g3 & keep);
+    h4 = (h4 & ~keep) | (g4 & keep);
+
+    const uint32_t w0 = h0 | (h1 << 26);
+    const uint32_t w1 = (h1 >> 6) | (h2 << 20);
+    const uint32_t w2 = (h2 >> 12) | (h3 << 14);
+    const uint32_t w3 = (h3 >> 18) | (h4 << 8);
+    uint64_t f = uint64_t{w0} + pad_[0];
+    store32(tag, static_cast<uint32_t>(f));
+    f = uint64_t{w1} + pad_[1] + (f >> 32);
+    store32(tag + 4, static_cast<uint32_t>(f));
+    f = uint64_t{w2} + pad_[2] + (f >> 32);
+    store32(tag + 8, static_cast<uint32_t>(f));
+    f = uint64_t{w3} + pad_[3] + (f >> 32);
+    store32(tag + 12, static_cast<uint32_t>(f));
+    secureZero(h_, sizeof(h_));
+    secureZero(r_, sizeof(r_));
+    secureZero(pad_, sizeof(pad_));
+}
+
+#endif // __SIZEOF_INT128__
+
+void Poly1305::update(const uint8_t *data, size_t length) {
+    if (buffered_ > 0) {
+        const size_t take = length < kBlockSize - buffered_ ? length : kBlockSize - buffered_;
+        memcpy(buffer_ + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        length -= take;
+        if (buffered_ < kBlockSize) {
+            return;
+        }
+        blocks(buffer_, 1, false);
+        buffered_ = 0;
+    }
+    const size_t count = length / kBlockSize;
+    blocks(data, count, false);
+    data += count * kBlockSize;
+    length -= count * kBlockSize;
+    memcpy(buffer_, data, length);
+    buffered_ = length;
+}
+
+void Poly1305::padToBlock() {
+    if (buffered_ > 0) {
+        memset(buffer_ + buffered_, 0, kBlockSize - buffered_);
+        blocks(buffer_, 1, false);
+        buffered_ = 0;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// ChaCha20-Poly1305
+// ---------------------------------------------------------------------------------------
+
+void ChaCha20Poly1305::init(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize],
+                            Direction direction) {
+    // Block 0 keys the MAC; the payload starts at block 1.
+    uint8_t macKey[ChaCha20::kBlockSize];
+    cipher_.init(key, nonce, 0);
+    cipher_.keystreamBlock(macKey);
+    mac_.init(macKey);
+    secureZero(macKey, sizeof(macKey));
+
+    direction_ = direction;
+    aadLength_ = 0;
+    textLength_ = 0;
+    inText_ = false;
+}
+
+void ChaCha20Poly1305::addAad(const uint8_t *aad, size_t length) {
+    mac_.update(aad, length);
+    aadLength_ += length;
+}
+
+void ChaCha20Poly1305::beginCiphertext() {
+    if (!inText_) {
+        mac_.padToBlock();
+        inText_ = true;
+    }
+}
+
+void ChaCha20Poly1305::update(const uint8_t *in, uint8_t *out, size_t length) {
+    beginCiphertext();
+    textLength_ += length;
+    while (length > 0) {
+        const size_t slice = length < kAeadSlice ? length : kAeadSlice;
+        if (direction_ == Direction::Decrypt) {
+            mac_.update(in, slice);
+            cipher_.apply(in, out, slice);
+        } else {
+            cipher_.apply(in, out, slice);
+            mac_.update(out, slice);
+        }
+        in += slice;
+        out += slice;
+        length -= slice;
+    }
+}
+
+void ChaCha20Poly1305::finish(uint8_t tag[kTagSize]) {
+    beginCiphertext();
+    mac_.padToBlock();
+    uint8_t lengths[16];
+    store64(lengths, aadLength_);
+    store64(lengths + 8, textLength_);
+    mac_.update(lengths, sizeof(lengths));
+    mac_.finish(tag);
+}
+
+bool ChaCha20Poly1305::verify(const uint8_t tag[kTagSize]) {
+    uint8_t expected[kTagSize];
+    finish(expected);
+    const bool valid = constantTimeEquals(expected, tag, kTagSize);
+    secureZero(expected, sizeof(expected));
+    return valid;
+}
+
+bool constantTimeEquals(const uint8_t *a, const uint8_t *b, size_t length) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; ++i) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+void secureZero(void *data, size_t length) {
+    volatile auto *bytes = static_cast<volatile uint8_t *>(data);
+    while (length-- > 0) {
+        *bytes++ = 0;
+    }
+}
+
+} // namespace genesis::crypto
@@ -0,0 +1,137 @@
+#ifndef CHACHA20_POLY1305_H
+#define CHACHA20_POLY1305_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::crypto {
+
+/**
+ * @brief ChaCha20 stream cipher state (RFC 8439) with a buffered partial keystream block, so
+ * data can be processed in pieces of any size.
+ */
+class ChaCha20 {
+public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kNonceSize = 12;
+    static constexpr size_t kBlockSize = 64;
+
+    void init(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize], uint32_t counter);
+
+    /**
+     * @brief XORs `length` bytes of keystream into `in`, writing to `out`. `in` may equal
+     * `out`; other overlap is not allowed.
+     */
+    void apply(const uint8_t *in, uint8_t *out, size_t length);
+
+    /**
+     * @brief Writes one raw keystream block for the current counter and advances it.
+     */
+    void keystreamBlock(uint8_t out[kBlockSize]);
+
+private:
+    uint32_t state_[16];
+    uint8_t keystream_[kBlockSize];
+    size_t keystreamUsed_ = kBlockSize;
+};
+
+/**
+ * @brief Poly1305 one-time authenticator (RFC 8439).
+ */
+class Poly1305 {
+public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kTagSize = 16;
+    static constexpr size_t kBlockSize = 16;
+
+    void init(const uint8_t key[kKeySize]);
+
+    void update(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Zero-pads the input absorbed so far to a block boundary.
+     */
+    void padToBlock();
+
+    void finish(uint8_t tag[kTagSize]);
+
+private:
+    void blocks(const uint8_t *data, size_t count, bool partial);
+
+#if defined(__SIZEOF_INT128__)
+    uint64_t r_[3];
+    uint64_t h_[3];
+#else
+    uint32_t r_[5];
+    uint32_t h_[5];
+#endif
+    uint32_t pad_[4];
+    uint8_t buffer_[kBlockSize];
+    size_t buffered_ = 0;
+};
+
+/**
+ * @brief Incremental ChaCha20-Poly1305 AEAD (RFC 8439).
+ *
+ * Call init, then optionally addAad, then update any number of times, then finish (encrypt)
+ * or verify (decrypt). Payloads never need to be buffered whole: each update processes its
+ * chunk immediately, so a multi-gigabyte stream can go through a small fixed buffer.
+ */
+class ChaCha20Poly1305 {
+public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kNonceSize = 12;
+    static constexpr size_t kTagSize = 16;
+
+    enum class Direction {
+        Encrypt,
+        Decrypt,
+    };
+
+    void init(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize], Direction direction);
+
+    /**
+     * @brief Authenticates additional data. Only valid before the first update.
+     */
+    void addAad(const uint8_t *aad, size_t length);
+
+    /**
+     * @brief Encrypts or decrypts the next `length` bytes. `in` may equal `out`.
+     */
+    void update(const uint8_t *in, uint8_t *out, size_t length);
+
+    /**
+     * @brief Writes the authentication tag of an encryption.
+     */
+    void finish(uint8_t tag[kTagSize]);
+
+    /**
+     * @brief Checks the tag of a decryption in constant time. On false the plaintext
+     * produced by update must be discarded.
+     */
+    bool verify(const uint8_t tag[kTagSize]);
+
+private:
+    void beginCiphertext();
+
+    ChaCha20 cipher_;
+    Poly1305 mac_;
+    Direction direction_ = Direction::Encrypt;
+    uint64_t aadLength_ = 0;
+    uint64_t textLength_ = 0;
+    bool inText_ = false;
+};
+
+/**
+ * @brief Constant-time comparison of two byte strings of equal length.
+ */
+bool constantTimeEquals(const uint8_t *a, const uint8_t *b, size_t length);
+
+/**
+ * @brief Overwrites `length` bytes at `data` with zeros in a way the compiler cannot elide.
+ */
+void secureZero(void *data, size_t length);
+
+} // namespace genesis::crypto
+
+#endif // CHACHA20_POLY1305_H
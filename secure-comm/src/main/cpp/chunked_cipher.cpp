@@ -0,0 +1,176 @@
+#include "chunked_cipher.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "chacha20_poly1305.h"
+#include "secure_random.h"
+#include "worker_pool.h"
+
+namespace genesis::crypto {
+namespace {
+
+constexpr uint8_t kMagic[4] = {'G', 'S', 'C', '1'};
+
+inline uint32_t load32(const uint8_t *p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+inline void store32(uint8_t *p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+void segmentNonce(const uint8_t prefix[8], uint64_t index,
+                  uint8_t nonce[ChaCha20Poly1305::kNonceSize]) {
+    memcpy(nonce, prefix, 8);
+    store32(nonce + 8, static_cast<uint32_t>(index));
+}
+
+// Plaintext bounds of segment `index`.
+void segmentRange(const ChunkedHeader &header, uint64_t index, uint64_t &offset, size_t &size) {
+    offset = index * header.segmentSize;
+    const uint64_t remaining = header.plaintextLength - offset;
+    size = static_cast<size_t>(remaining < header.segmentSize ? remaining : header.segmentSize);
+}
+
+bool openSegment(const uint8_t key[ChunkedCipher::kKeySize], const uint8_t *container,
+                 const ChunkedHeader &header, uint64_t index, uint8_t *out, size_t &size) {
+    uint64_t offset;
+    segmentRange(header, index, offset, size);
+    const uint8_t *segment = container + ChunkedCipher::kHeaderSize +
+                             index * (uint64_t{header.segmentSize} + ChunkedCipher::kTagSize);
+
+    uint8_t nonce[ChaCha20Poly1305::kNonceSize];
+    segmentNonce(header.noncePrefix, index, nonce);
+    ChaCha20Poly1305 aead;
+    aead.init(key, nonce, ChaCha20Poly1305::Direction::Decrypt);
+    aead.addAad(container, ChunkedCipher::kHeaderSize);
+    aead.update(segment, out, size);
+    if (!aead.verify(segment + size)) {
+        secureZero(out, size);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t ChunkedCipher::segmentCount(uint64_t plaintextLength, uint32_t segmentSize) {
+    if (segmentSize == 0) {
+        return 0;
+    }
+    const uint64_t count = plaintextLength / segmentSize + (plaintextLength % segmentSize != 0);
+    return count > 0 ? count : 1;
+}
+
+uint64_t ChunkedCipher::sealedSize(uint64_t plaintextLength, uint32_t segmentSize) {
+    if (segmentSize < kMinSegmentSize || segmentSize > kMaxSegmentSize) {
+        return 0;
+    }
+    const uint64_t segments = segmentCount(plaintextLength, segmentSize);
+    if (segments > UINT32_MAX) {
+        return 0;
+    }
+    return kHeaderSize + plaintextLength + segments * kTagSize;
+}
+
+bool ChunkedCipher::parseHeader(const uint8_t *data, size_t length, ChunkedHeader &header) {
+    if (length < kHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    header.segmentSize = load32(data + 4);
+    header.plaintextLength = uint64_t{load32(data + 8)} | (uint64_t{load32(data + 12)} << 32);
+    memcpy(header.noncePrefix, data + 16, sizeof(header.noncePrefix));
+    return sealedSize(header.plaintextLength, header.segmentSize) == length;
+}
+
+bool ChunkedCipher::encrypt(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                            uint32_t segmentSize, uint8_t *out) {
+    if (sealedSize(length, segmentSize) == 0) {
+        return false;
+    }
+
+    ChunkedHeader header{};
+    header.segmentSize = segmentSize;
+    header.plaintextLength = length;
+    if (!SecureRandom::fill(header.noncePrefix, sizeof(header.noncePrefix))) {
+        return false;
+    }
+    memcpy(out, kMagic, sizeof(kMagic));
+    store32(out + 4, segmentSize);
+    store32(out + 8, static_cast<uint32_t>(header.plaintextLength));
+    store32(out + 12, static_cast<uint32_t>(header.plaintextLength >> 32));
+    memcpy(out + 16, header.noncePrefix, sizeof(header.noncePrefix));
+
+    const uint64_t segments = segmentCount(length, segmentSize);
+    WorkerPool::shared().parallelFor(segments, [&](size_t index) {
+        uint64_t offset;
+        size_t size;
+        segmentRange(header, index, offset, size);
+        uint8_t *segment = out + kHeaderSize + index * (uint64_t{segmentSize} + kTagSize);
+
+        uint8_t nonce[ChaCha20Poly1305::kNonceSize];
+        segmentNonce(header.noncePrefix, index, nonce);
+        ChaCha20Poly1305 aead;
+        aead.init(key, nonce, ChaCha20Poly1305::Direction::Encrypt);
+        aead.addAad(out, kHeaderSize);
+        aead.update(in + offset, segment, size);
+        aead.finish(segment + size);
+    });
+    return true;
+}
+
+bool ChunkedCipher::decrypt(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                            uint8_t *out) {
+    ChunkedHeader header{};
+    if (!parseHeader(in, length, header)) {
+        return false;
+    }
+
+    std::atomic<bool> authentic{true};
+    const uint64_t segments = segmentCount(header.plaintextLength, header.segmentSize);
+    WorkerPool::shared().parallelFor(segments, [&](size_t index) {
+        if (!authentic.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t size;
+        if (!openSegment(key, in, header, index, out + index * uint64_t{header.segmentSize},
+                         size)) {
+            authentic.store(false, std::memory_order_relaxed);
+        }
+    });
+
+    if (!authentic.load()) {
+        secureZero(out, header.plaintextLength);
+        return false;
+    }
+    return true;
+}
+
+bool ChunkedCipher::decryptSegment(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                                   uint64_t index, uint8_t *out, size_t outCapacity,
+                                   size_t *outLength) {
+    ChunkedHeader header{};
+    if (!parseHeader(in, length, header) ||
+        index >= segmentCount(header.plaintextLength, header.segmentSize)) {
+        return false;
+    }
+    uint64_t offset;
+    size_t size;
+    segmentRange(header, index, offset, size);
+    if (size > outCapacity) {
+        return false;
+    }
+    if (!openSegment(key, in, header, index, out, size)) {
+        return false;
+    }
+    if (outLength != nullptr) {
+        *outLength = size;
+    }
+    return true;
+}
+
+} // namespace genesis::crypto
@@ -0,0 +1,79 @@
+#ifndef CHUNKED_CIPHER_H
+#define CHUNKED_CIPHER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::crypto {
+
+/**
+ * @brief Parsed header of a segmented ChaCha20-Poly1305 container.
+ */
+struct ChunkedHeader {
+    uint32_t segmentSize;
+    uint64_t plaintextLength;
+    uint8_t noncePrefix[8];
+};
+
+/**
+ * @brief Segmented AEAD container for large blobs.
+ *
+ * Layout: a 24-byte header (magic "GSC1", segment size u32, plaintext length u64, random
+ * nonce prefix, little-endian) followed by ceil(length / segmentSize) segments, at least
+ * one, each the segment's ciphertext followed by its 16-byte tag. Segment i is sealed with
+ * nonce = prefix || u32(i) and the header as additional data, so segments cannot be
+ * reordered, spliced between containers or truncated away. Segments are independent, which
+ * lets them be processed in parallel and decrypted individually for random access.
+ */
+class ChunkedCipher {
+public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kHeaderSize = 24;
+    static constexpr size_t kTagSize = 16;
+    static constexpr uint32_t kDefaultSegmentSize = 64 * 1024;
+    static constexpr uint32_t kMinSegmentSize = 4 * 1024;
+    static constexpr uint32_t kMaxSegmentSize = 16 * 1024 * 1024;
+
+    /**
+     * @brief Container size for `plaintextLength` bytes, or 0 if `segmentSize` is out of range.
+     */
+    static uint64_t sealedSize(uint64_t plaintextLength, uint32_t segmentSize);
+
+    static uint64_t segmentCount(uint64_t plaintextLength, uint32_t segmentSize);
+
+    /**
+     * @brief Parses and validates the header of a `length`-byte container, including that the
+     * length matches the segment layout it declares.
+     */
+    static bool parseHeader(const uint8_t *data, size_t length, ChunkedHeader &header);
+
+    /**
+     * @brief Seals `length` bytes into `out`, which must hold sealedSize(length, segmentSize)
+     * bytes and must not overlap `in`. Segments are encrypted in parallel on the shared
+     * worker pool.
+     */
+    static bool encrypt(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                        uint32_t segmentSize, uint8_t *out);
+
+    /**
+     * @brief Opens a whole container into `out` (header.plaintextLength bytes), in parallel.
+     * Returns false if any segment fails authentication; `out` is then zeroed.
+     */
+    static bool decrypt(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                        uint8_t *out);
+
+    /**
+     * @brief Opens segment `index` of a container into `out`. Fails without writing if the
+     * segment's plaintext (segmentSize bytes, or fewer for the last segment) exceeds
+     * `outCapacity`.
+     *
+     * @param outLength Set to the number of plaintext bytes written.
+     */
+    static bool decryptSegment(const uint8_t key[kKeySize], const uint8_t *in, size_t length,
+                               uint64_t index, uint8_t *out, size_t outCapacity,
+                               size_t *outLength);
+};
+
+} // namespace genesis::crypto
+
+#endif // CHUNKED_CIPHER_H
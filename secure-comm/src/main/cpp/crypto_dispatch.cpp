@@ -0,0 +1,110 @@
+#include "crypto_dispatch.h"
+
+#include <mutex>
+
+#if defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace genesis::crypto {
+namespace {
+
+// The best kernel of each kind this build has, and the baseline that is always safe.
+#if defined(CHACHA_NEON)
+constexpr ChaCha20XorBlocksFn kChaChaBaseline = chacha20XorBlocksNeon;
+#elif defined(CHACHA_SSE2)
+constexpr ChaCha20XorBlocksFn kChaChaBaseline = chacha20XorBlocksSse2;
+#else
+constexpr ChaCha20XorBlocksFn kChaChaBaseline = chacha20XorBlocksScalar;
+#endif
+
+#if defined(CHACHA_AVX2)
+constexpr ChaCha20XorBlocksFn kChaChaWide = chacha20XorBlocksAvx2;
+#else
+constexpr ChaCha20XorBlocksFn kChaChaWide = kChaChaBaseline;
+#endif
+
+#if defined(__aarch64__)
+constexpr Sha256CompressFn kSha256Hardware = sha256CompressArmv8;
+#elif defined(__x86_64__) || defined(__i386__)
+constexpr Sha256CompressFn kSha256Hardware = sha256CompressShaNi;
+#else
+constexpr Sha256CompressFn kSha256Hardware = sha256CompressPortable;
+#endif
+
+// Indexed by (wide ChaCha usable) | (SHA-256 instructions usable) << 1.
+constexpr CryptoKernels kKernelTables[4] = {
+        {kChaChaBaseline, sha256CompressPortable},
+        {kChaChaWide, sha256CompressPortable},
+        {kChaChaBaseline, kSha256Hardware},
+        {kChaChaWide, kSha256Hardware},
+};
+
+CpuFeatures features{};
+std::once_flag dispatchOnce;
+
+CpuFeatures detectFeatures() {
+    CpuFeatures detected{};
+#if defined(__aarch64__)
+    detected.neon = true;
+#if defined(__linux__)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    detected.aes = (hwcap & HWCAP_AES) != 0;
+    detected.pmull = (hwcap & HWCAP_PMULL) != 0;
+    detected.sha2 = (hwcap & HWCAP_SHA2) != 0;
+#endif
+#elif defined(__arm__) && defined(__linux__)
+    detected.neon = (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+    const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    detected.aes = (hwcap2 & HWCAP2_AES) != 0;
+    detected.pmull = (hwcap2 & HWCAP2_PMULL) != 0;
+    detected.sha2 = (hwcap2 & HWCAP2_SHA2) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        detected.sse41 = (ecx & bit_SSE4_1) != 0;
+        detected.aes = (ecx & bit_AES) != 0;
+        detected.pmull = (ecx & bit_PCLMUL) != 0;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        detected.shaNi = detected.sse41 && (ebx & bit_SHA) != 0;
+    }
+    // Also checks that the OS saves the AVX registers.
+    detected.avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return detected;
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<const CryptoKernels *> activeKernels{nullptr};
+
+const CryptoKernels &slowCryptoKernels() {
+    initializeCpuDispatch();
+    return *activeKernels.load(std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+const CpuFeatures &initializeCpuDispatch() {
+    std::call_once(dispatchOnce, [] {
+        features = detectFeatures();
+#if defined(__aarch64__)
+        const bool sha256Hardware = features.sha2;
+#elif defined(__x86_64__) || defined(__i386__)
+        const bool sha256Hardware = features.shaNi;
+#else
+        const bool sha256Hardware = false;
+#endif
+        const size_t index = (features.avx2 ? 1 : 0) | (sha256Hardware ? 2 : 0);
+        detail::activeKernels.store(&kKernelTables[index], std::memory_order_relaxed);
+    });
+    return features;
+}
+
+} // namespace genesis::crypto
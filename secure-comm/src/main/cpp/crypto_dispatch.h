@@ -0,0 +1,58 @@
+#ifndef CRYPTO_DISPATCH_H
+#define CRYPTO_DISPATCH_H
+
+#include <atomic>
+
+#include "chacha20_kernels.h"
+#include "sha256_kernels.h"
+
+namespace genesis::crypto {
+
+/**
+ * @brief CPU features relevant to the crypto kernels, detected once per process.
+ */
+struct CpuFeatures {
+    bool neon;
+    bool aes;
+    bool pmull;
+    bool sha2;
+    bool sse41;
+    bool avx2;
+    bool shaNi;
+};
+
+/**
+ * @brief Kernel implementations chosen for this CPU.
+ */
+struct CryptoKernels {
+    ChaCha20XorBlocksFn chacha20XorBlocks;
+    Sha256CompressFn sha256Compress;
+};
+
+/**
+ * @brief Detects CPU features and selects the kernel table, exactly once. Later calls
+ * return the same result.
+ */
+const CpuFeatures &initializeCpuDispatch();
+
+namespace detail {
+
+// Points at one of a few constant tables once dispatch is initialized. The tables are
+// constant-initialized, so a relaxed load is enough to read them safely.
+extern std::atomic<const CryptoKernels *> activeKernels;
+
+const CryptoKernels &slowCryptoKernels();
+
+} // namespace detail
+
+/**
+ * @brief The selected kernel table: one relaxed load once dispatch is initialized.
+ */
+inline const CryptoKernels &cryptoKernels() {
+    const CryptoKernels *kernels = detail::activeKernels.load(std::memory_order_relaxed);
+    return kernels != nullptr ? *kernels : detail::slowCryptoKernels();
+}
+
+} // namespace genesis::crypto
+
+#endif // CRYPTO_DISPATCH_H
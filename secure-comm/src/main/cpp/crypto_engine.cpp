@@ -1,94 +1,290 @@
 #include "crypto_engine.h"
+#include "chacha20_poly1305.h"
+#include "chunked_cipher.h"
+#include "crypto_dispatch.h"
+#include "integrity_hash.h"
+#include "secure_random.h"
+#include "sha256.h"
 #include <android/log.h>
-#include <random>
 #include <algorithm>
 #include <cstring>
+#include <mutex>
 
 #define LOG_TAG "CryptoEngine"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
-bool CryptoEngine::initialized_ = false;
+using genesis::crypto::ChaCha20Poly1305;
+using genesis::crypto::ChunkedCipher;
+using genesis::crypto::ChunkedHeader;
+using genesis::crypto::IntegrityHasher;
+using genesis::crypto::SecureRandom;
+using genesis::crypto::Sha256;
+using genesis::crypto::secureZero;
+
+namespace {
+
+bool overlaps(const uint8_t *a, size_t aLength, const uint8_t *b, size_t bLength) {
+    const auto aStart = reinterpret_cast<uintptr_t>(a);
+    const auto bStart = reinterpret_cast<uintptr_t>(b);
+    return aLength > 0 && bLength > 0 && aStart < bStart + bLength && bStart < aStart + aLength;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
+std::atomic<bool> CryptoEngine::initialized_{false};
 
 bool CryptoEngine::initialize() {
-    if (initialized_) {
+    if (initialized_.load(std::memory_order_relaxed)) {
         return true;
     }
 
-    LOGI("Initializing Genesis Crypto Engine V2...");
-    initializeRandomGenerator();
-    initialized_ = true;
-    LOGI("Genesis Crypto Engine V2 initialized successfully");
+    static std::once_flag dispatchOnce;
+    std::call_once(dispatchOnce, [] {
+        LOGI("Initializing Genesis Crypto Engine V2...");
+        const genesis::crypto::CpuFeatures &cpu = genesis::crypto::initializeCpuDispatch();
+        LOGI("CPU features: neon=%d aes=%d pmull=%d sha2=%d sse4.1=%d avx2=%d sha-ni=%d",
+             cpu.neon, cpu.aes, cpu.pmull, cpu.sha2, cpu.sse41, cpu.avx2, cpu.shaNi);
+    });
+
+    // Seeding can fail transiently, so it stays outside the once-block and is retried.
+    if (!initializeRandomGenerator()) {
+        LOGE("Failed to seed secure random generator");
+        return false;
+    }
+    bool expected = false;
+    if (initialized_.compare_exchange_strong(expected, true)) {
+        LOGI("Genesis Crypto Engine V2 initialized successfully");
+    }
+    return true;
+}
+
+void CryptoEngine::deriveKey(const char *key, size_t keyLength, uint8_t out[kKeySize]) {
+    static constexpr char kDomain[] = "genesis-secure-comm-v2";
+    Sha256 sha;
+    sha.update(reinterpret_cast<const uint8_t *>(kDomain), sizeof(kDomain) - 1);
+    sha.update(reinterpret_cast<const uint8_t *>(key), keyLength);
+    sha.finish(out);
+}
+
+bool CryptoEngine::randomBytes(uint8_t *out, size_t length) {
+    return SecureRandom::fill(out, length);
+}
+
+bool CryptoEngine::encrypt(const uint8_t *data, size_t length, const char *key, size_t keyLength,
+                           uint8_t *out) {
+    ensureInitialized();
+
+    uint8_t nonce[kNonceSize];
+    if (!randomBytes(nonce, kNonceSize)) {
+        LOGE("Failed to generate nonce");
+        return false;
+    }
+
+    uint8_t cipherKey[kKeySize];
+    deriveKey(key, keyLength, cipherKey);
+    seal(cipherKey, nonce, data, length, out);
+    secureZero(cipherKey, sizeof(cipherKey));
     return true;
 }
 
-std::vector<uint8_t> CryptoEngine::encrypt(const uint8_t *data, size_t length, const char *key) {
-    if (!initialized_) {
-        initialize();
+bool CryptoEngine::decrypt(const uint8_t *data, size_t length, const char *key, size_t keyLength,
+                           uint8_t *out) {
+    ensureInitialized();
+
+    uint8_t cipherKey[kKeySize];
+    deriveKey(key, keyLength, cipherKey);
+    bool opened = open(cipherKey, data, length, out);
+    secureZero(cipherKey, sizeof(cipherKey));
+    return opened;
+}
+
+void CryptoEngine::seal(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize],
+                        const uint8_t *data, size_t length, uint8_t *out) {
+    // Overlapping buffers are handled by moving the plaintext to where the ciphertext goes
+    // and encrypting in place; callers that reserve kNonceSize bytes ahead of the data skip
+    // the move.
+    if (overlaps(data, length, out, length + kOverhead) && data != out + kNonceSize) {
+        memmove(out + kNonceSize, data, length);
+        data = out + kNonceSize;
     }
+    memcpy(out, nonce, kNonceSize);
 
-    // Genesis Protocol Secure Encryption (placeholder implementation)
-    // In production, this would use advanced cryptographic algorithms
-    std::vector<uint8_t> encrypted(length);
+    ChaCha20Poly1305 aead;
+    aead.init(key, nonce, ChaCha20Poly1305::Direction::Encrypt);
+    aead.update(data, out + kNonceSize, length);
+    aead.finish(out + kNonceSize + length);
+}
+
+bool CryptoEngine::open(const uint8_t key[kKeySize], const uint8_t *data, size_t length,
+                        uint8_t *out) {
+    if (length < kOverhead) {
+        LOGE("Ciphertext too short: %zu bytes", length);
+        return false;
+    }
+    const size_t textLength = length - kOverhead;
 
-    size_t keyLen = strlen(key);
-    for (size_t i = 0; i < length; ++i) {
-        encrypted[i] = data[i] ^ key[i % keyLen] ^ 0xAA; // Simple XOR for demo
+    // Copy the framing out first so `out` may overlap the message in any way.
+    uint8_t nonce[kNonceSize];
+    uint8_t tag[kTagSize];
+    memcpy(nonce, data, kNonceSize);
+    memcpy(tag, data + kNonceSize + textLength, kTagSize);
+    const uint8_t *ciphertext = data + kNonceSize;
+    if (overlaps(ciphertext, textLength, out, textLength) && ciphertext != out) {
+        memmove(out, ciphertext, textLength);
+        ciphertext = out;
     }
 
-    LOGI("Encrypted %zu bytes using Genesis Secure Algorithm", length);
-    return encrypted;
+    ChaCha20Poly1305 aead;
+    aead.init(key, nonce, ChaCha20Poly1305::Direction::Decrypt);
+    aead.update(ciphertext, out, textLength);
+    if (!aead.verify(tag)) {
+        secureZero(out, textLength);
+        LOGE("Authentication failed for %zu byte message", length);
+        return false;
+    }
+    return true;
+}
+
+uint64_t CryptoEngine::chunkedSize(uint64_t length, uint32_t segmentSize) {
+    return ChunkedCipher::sealedSize(length, segmentSize);
 }
 
-std::vector<uint8_t> CryptoEngine::decrypt(const uint8_t *data, size_t length, const char *key) {
-    if (!initialized_) {
-        initialize();
+int64_t CryptoEngine::chunkedPlaintextSize(const uint8_t *data, size_t length) {
+    ChunkedHeader header{};
+    if (!ChunkedCipher::parseHeader(data, length, header)) {
+        return -1;
     }
+    return static_cast<int64_t>(header.plaintextLength);
+}
+
+bool CryptoEngine::encryptChunked(const uint8_t *data, size_t length, const char *key,
+                                  size_t keyLength, uint32_t segmentSize, uint8_t *out) {
+    ensureInitialized();
+
+    uint8_t cipherKey[kKeySize];
+    deriveKey(key, keyLength, cipherKey);
+    bool sealed = ChunkedCipher::encrypt(cipherKey, data, length, segmentSize, out);
+    secureZero(cipherKey, sizeof(cipherKey));
+    LOGI("Encrypted %zu bytes in %u byte segments", length, segmentSize);
+    return sealed;
+}
 
-    // Genesis Protocol Secure Decryption (placeholder implementation)
-    std::vector<uint8_t> decrypted(length);
+bool CryptoEngine::decryptChunked(const uint8_t *data, size_t length, const char *key,
+                                  size_t keyLength, uint8_t *out) {
+    ensureInitialized();
 
-    size_t keyLen = strlen(key);
-    for (size_t i = 0; i < length; ++i) {
-        decrypted[i] = data[i] ^ key[i % keyLen] ^ 0xAA; // Reverse XOR for demo
+    uint8_t cipherKey[kKeySize];
+    deriveKey(key, keyLength, cipherKey);
+    bool opened = ChunkedCipher::decrypt(cipherKey, data, length, out);
+    secureZero(cipherKey, sizeof(cipherKey));
+    if (!opened) {
+        LOGE("Segmented container of %zu bytes failed to decrypt", length);
     }
+    return opened;
+}
+
+bool CryptoEngine::decryptChunkedSegment(const uint8_t *data, size_t length, const char *key,
+                                         size_t keyLength, uint64_t index, uint8_t *out,
+                                         size_t outCapacity, size_t *outLength) {
+    ensureInitialized();
 
-    LOGI("Decrypted %zu bytes using Genesis Secure Algorithm", length);
-    return decrypted;
+    uint8_t cipherKey[kKeySize];
+    deriveKey(key, keyLength, cipherKey);
+    bool opened = ChunkedCipher::decryptSegment(cipherKey, data, length, index, out,
+                                                outCapacity, outLength);
+    secureZero(cipherKey, sizeof(cipherKey));
+    return opened;
 }
 
 std::string CryptoEngine::generateSecureKey() {
-    if (!initialized_) {
-        initialize();
-    }
+    ensureInitialized();
+
+    static constexpr char kAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    static constexpr size_t kAlphabetSize = sizeof(kAlphabet) - 1;
+    // Bytes at or above the largest multiple of the alphabet size are rejected so every
+    // character is equally likely.
+    static constexpr unsigned kLimit = 256 - 256 % kAlphabetSize;
 
-    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
     std::string key;
     key.reserve(32);
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, chars.size() - 1);
-
-    for (int i = 0; i < 32; ++i) {
-        key += chars[dis(gen)];
+    uint8_t bytes[64];
+    while (key.size() < 32) {
+        if (!randomBytes(bytes, sizeof(bytes))) {
+            LOGE("Failed to generate secure key");
+            return {};
+        }
+        for (size_t i = 0; i < sizeof(bytes) && key.size() < 32; ++i) {
+            if (bytes[i] < kLimit) {
+                key += kAlphabet[bytes[i] % kAlphabetSize];
+            }
+        }
     }
+    secureZero(bytes, sizeof(bytes));
 
     LOGI("Generated secure key for Genesis communication");
     return key;
 }
 
-bool CryptoEngine::verifyIntegrity(const uint8_t *data, size_t length, const char *signature) {
-    if (!initialized_) {
-        initialize();
+std::string CryptoEngine::computeIntegrity(const uint8_t *data, size_t length, const char *key,
+                                           size_t keyLength) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    uint8_t digest[IntegrityHasher::kDigestSize];
+    IntegrityHasher::digest(data, length, reinterpret_cast<const uint8_t *>(key), keyLength,
+                            digest);
+
+    std::string hex(2 * sizeof(digest), '\0');
+    for (size_t i = 0; i < sizeof(digest); ++i) {
+        hex[2 * i] = kHexDigits[digest[i] >> 4];
+        hex[2 * i + 1] = kHexDigits[digest[i] & 0x0f];
     }
+    return hex;
+}
 
-    // Genesis Protocol Integrity Verification (placeholder)
-    // In production, this would use cryptographic hash verification
-    LOGI("Verifying data integrity for %zu bytes", length);
-    return true; // Always valid for demo
+bool CryptoEngine::verifyIntegrity(const uint8_t *data, size_t length, const char *signature,
+                                   const char *key, size_t keyLength) {
+    if (signature == nullptr) {
+        return false;
+    }
+
+    uint8_t expected[IntegrityHasher::kDigestSize];
+    for (size_t i = 0; i < sizeof(expected); ++i) {
+        const int high = hexValue(signature[2 * i]);
+        const int low = high < 0 ? -1 : hexValue(signature[2 * i + 1]);
+        if (low < 0) {
+            return false;
+        }
+        expected[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    if (signature[2 * sizeof(expected)] != '\0') {
+        return false;
+    }
+
+    uint8_t actual[IntegrityHasher::kDigestSize];
+    IntegrityHasher::digest(data, length, reinterpret_cast<const uint8_t *>(key), keyLength,
+                            actual);
+    bool valid = genesis::crypto::constantTimeEquals(actual, expected, sizeof(actual));
+    if (!valid) {
+        LOGE("Integrity check failed for %zu bytes", length);
+    }
+    return valid;
 }
 
-void CryptoEngine::initializeRandomGenerator() {
-    // Initialize secure random number generation
+bool CryptoEngine::initializeRandomGenerator() {
     LOGI("Initializing Genesis secure random generator...");
-}
\ No newline at end of file
+    return SecureRandom::seed();
+}
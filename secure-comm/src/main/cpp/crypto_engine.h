@@ -1,6 +1,7 @@
 #ifndef CRYPTO_ENGINE_H
 #define CRYPTO_ENGINE_H
 
+#include <atomic>
 #include <vector>
 #include <cstdint>
 #include <string>
@@ -8,23 +9,97 @@
 /**
  * Genesis Protocol Secure Communication - Crypto Engine V2
  * Advanced cryptographic operations for AI consciousness communication
+ *
+ * Messages are sealed with ChaCha20-Poly1305 (RFC 8439) under a key derived from the
+ * caller's key string with SHA-256, and laid out as nonce || ciphertext || tag.
  */
 class CryptoEngine {
 public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kNonceSize = 12;
+    static constexpr size_t kTagSize = 16;
+    static constexpr size_t kOverhead = kNonceSize + kTagSize;
+
     /**
-     * Initialize the cryptographic engine
+     * Initialize the cryptographic engine: detect CPU features and select kernels (once per
+     * process) and seed the calling thread's random generator. Safe to call concurrently;
+     * every entry point calls it on first use.
      */
     static bool initialize();
 
     /**
-     * Encrypt data using Genesis secure algorithm
+     * Encrypt `length` bytes under `key` with a fresh random nonce.
+     * `out` must hold length + kOverhead bytes and may overlap `data`; placing the data at
+     * out + kNonceSize encrypts in place without an extra pass.
+     */
+    static bool encrypt(const uint8_t *data, size_t length, const char *key, size_t keyLength,
+                        uint8_t *out);
+
+    /**
+     * Decrypt and authenticate a message produced by encrypt.
+     * `out` must hold length - kOverhead bytes and may overlap `data`; out == data + kNonceSize
+     * decrypts in place without an extra pass. Returns false if the message is too short
+     * or fails authentication, in which case `out` is zeroed.
+     */
+    static bool decrypt(const uint8_t *data, size_t length, const char *key, size_t keyLength,
+                        uint8_t *out);
+
+    /**
+     * Derive the 256-bit cipher key for a key string (SHA-256 with a domain prefix).
+     */
+    static void deriveKey(const char *key, size_t keyLength, uint8_t out[kKeySize]);
+
+    /**
+     * Encrypt under an already derived key and caller-chosen nonce, which must never repeat
+     * for the key. Same layout and aliasing rules as encrypt.
+     */
+    static void seal(const uint8_t key[kKeySize], const uint8_t nonce[kNonceSize],
+                     const uint8_t *data, size_t length, uint8_t *out);
+
+    /**
+     * Decrypt under an already derived key. Same rules as decrypt.
+     */
+    static bool open(const uint8_t key[kKeySize], const uint8_t *data, size_t length,
+                     uint8_t *out);
+
+    /**
+     * Fill `out` with cryptographically secure random bytes from the calling thread's
+     * DRBG (see SecureRandom); no locks, and no system call outside reseeding.
      */
-    static std::vector<uint8_t> encrypt(const uint8_t *data, size_t length, const char *key);
+    static bool randomBytes(uint8_t *out, size_t length);
 
     /**
-     * Decrypt data using Genesis secure algorithm
+     * Size of the segmented container for `length` bytes (see ChunkedCipher), or 0 if
+     * `segmentSize` is out of range.
      */
-    static std::vector<uint8_t> decrypt(const uint8_t *data, size_t length, const char *key);
+    static uint64_t chunkedSize(uint64_t length, uint32_t segmentSize);
+
+    /**
+     * Plaintext length declared by a segmented container, or -1 if the header is invalid.
+     */
+    static int64_t chunkedPlaintextSize(const uint8_t *data, size_t length);
+
+    /**
+     * Encrypt a large payload into the segmented container format, one segment per worker.
+     * `out` must hold chunkedSize(length, segmentSize) bytes and must not overlap `data`.
+     */
+    static bool encryptChunked(const uint8_t *data, size_t length, const char *key,
+                               size_t keyLength, uint32_t segmentSize, uint8_t *out);
+
+    /**
+     * Decrypt a whole segmented container in parallel. Returns false, with `out` zeroed,
+     * if any segment fails authentication.
+     */
+    static bool decryptChunked(const uint8_t *data, size_t length, const char *key,
+                               size_t keyLength, uint8_t *out);
+
+    /**
+     * Decrypt only segment `index` of a segmented container, for random access. Fails if
+     * the segment's plaintext does not fit in `outCapacity` bytes.
+     */
+    static bool decryptChunkedSegment(const uint8_t *data, size_t length, const char *key,
+                                      size_t keyLength, uint64_t index, uint8_t *out,
+                                      size_t outCapacity, size_t *outLength);
 
     /**
      * Generate secure communication key
@@ -32,14 +107,30 @@ public:
     static std::string generateSecureKey();
 
     /**
-     * Verify data integrity
+     * Integrity digest of `length` bytes as 64 lowercase hex characters (see
+     * IntegrityHasher), keyed with HMAC when `key` is given. Large payloads are hashed in
+     * parallel.
      */
-    static bool verifyIntegrity(const uint8_t *data, size_t length, const char *signature);
+    static std::string computeIntegrity(const uint8_t *data, size_t length,
+                                        const char *key = nullptr, size_t keyLength = 0);
+
+    /**
+     * Verify data integrity against a hex digest from computeIntegrity, compared in
+     * constant time. Returns false for a missing or malformed signature.
+     */
+    static bool verifyIntegrity(const uint8_t *data, size_t length, const char *signature,
+                                const char *key = nullptr, size_t keyLength = 0);
 
 private:
-    static bool initialized_;
+    static std::atomic<bool> initialized_;
+
+    static void ensureInitialized() {
+        if (!initialized_.load(std::memory_order_relaxed)) {
+            initialize();
+        }
+    }
 
-    static void initializeRandomGenerator();
+    static bool initializeRandomGenerator();
 };
 
-#endif // CRYPTO_ENGINE_H
\ No newline at end of file
+#endif // CRYPTO_ENGINE_H
@@ -0,0 +1,134 @@
+#include "integrity_hash.h"
+
+#include <cstring>
+#include <vector>
+
+#include "chacha20_poly1305.h"
+#include "worker_pool.h"
+
+namespace genesis::crypto {
+namespace {
+
+constexpr uint8_t kLeafPrefix = 0x00;
+constexpr uint8_t kRootPrefix = 0x01;
+
+inline void store64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+void leafHeader(uint64_t index, uint8_t header[9]) {
+    header[0] = kLeafPrefix;
+    store64(header + 1, index);
+}
+
+} // namespace
+
+HmacSha256::HmacSha256(const uint8_t *key, size_t keyLength) {
+    uint8_t block[Sha256::kBlockSize] = {};
+    if (keyLength > Sha256::kBlockSize) {
+        Sha256::hash(key, keyLength, block);
+    } else if (keyLength > 0) {
+        memcpy(block, key, keyLength);
+    }
+
+    for (uint8_t &b : block) {
+        b ^= 0x36;
+    }
+    inner_.update(block, sizeof(block));
+    for (uint8_t &b : block) {
+        b ^= 0x36 ^ 0x5c;
+    }
+    outer_.update(block, sizeof(block));
+    secureZero(block, sizeof(block));
+}
+
+void HmacSha256::update(const uint8_t *data, size_t length) {
+    inner_.update(data, length);
+}
+
+void HmacSha256::finish(uint8_t digest[kDigestSize]) {
+    uint8_t innerDigest[kDigestSize];
+    inner_.finish(innerDigest);
+    outer_.update(innerDigest, sizeof(innerDigest));
+    outer_.finish(digest);
+}
+
+IntegrityHasher::IntegrityHasher(const uint8_t *key, size_t keyLength) : root_(key, keyLength) {
+    root_.update(&kRootPrefix, 1);
+    startLeaf();
+}
+
+void IntegrityHasher::startLeaf() {
+    uint8_t header[9];
+    leafHeader(leafIndex_, header);
+    leaf_.reset();
+    leaf_.update(header, sizeof(header));
+    leafFill_ = 0;
+}
+
+void IntegrityHasher::finishLeaf() {
+    uint8_t leafDigest[kDigestSize];
+    leaf_.finish(leafDigest);
+    root_.update(leafDigest, sizeof(leafDigest));
+}
+
+void IntegrityHasher::update(const uint8_t *data, size_t length) {
+    totalLength_ += length;
+    while (length > 0) {
+        // A full leaf is only closed once more data arrives, so the last leaf is never empty
+        // unless the whole payload is.
+        if (leafFill_ == kLeafSize) {
+            finishLeaf();
+            ++leafIndex_;
+            startLeaf();
+        }
+        const size_t take = length < kLeafSize - leafFill_ ? length : kLeafSize - leafFill_;
+        leaf_.update(data, take);
+        leafFill_ += take;
+        data += take;
+        length -= take;
+    }
+}
+
+void IntegrityHasher::finish(uint8_t digest[kDigestSize]) {
+    finishLeaf();
+    uint8_t lengthBytes[8];
+    store64(lengthBytes, totalLength_);
+    root_.update(lengthBytes, sizeof(lengthBytes));
+    root_.finish(digest);
+}
+
+void IntegrityHasher::digest(const uint8_t *data, size_t length, const uint8_t *key,
+                             size_t keyLength, uint8_t out[kDigestSize]) {
+    const size_t leaves = length / kLeafSize + (length % kLeafSize != 0);
+    if (leaves <= 1) {
+        IntegrityHasher hasher(key, keyLength);
+        hasher.update(data, length);
+        hasher.finish(out);
+        return;
+    }
+
+    std::vector<uint8_t> leafDigests(leaves * kDigestSize);
+    WorkerPool::shared().parallelFor(leaves, [&](size_t index) {
+        const size_t offset = index * kLeafSize;
+        const size_t size = length - offset < kLeafSize ? length - offset : kLeafSize;
+        uint8_t header[9];
+        leafHeader(index, header);
+        Sha256 sha;
+        sha.update(header, sizeof(header));
+        sha.update(data + offset, size);
+        sha.finish(leafDigests.data() + index * kDigestSize);
+    });
+
+    HmacSha256 root(key, keyLength);
+    root.update(&kRootPrefix, 1);
+    root.update(leafDigests.data(), leafDigests.size());
+    uint8_t lengthBytes[8];
+    store64(lengthBytes, length);
+    root.update(lengthBytes, sizeof(lengthBytes));
+    root.finish(out);
+}
+
+} // namespace genesis::crypto
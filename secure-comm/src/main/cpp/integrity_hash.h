@@ -0,0 +1,72 @@
+#ifndef INTEGRITY_HASH_H
+#define INTEGRITY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sha256.h"
+
+namespace genesis::crypto {
+
+/**
+ * @brief Streaming HMAC-SHA256 (RFC 2104).
+ */
+class HmacSha256 {
+public:
+    static constexpr size_t kDigestSize = Sha256::kDigestSize;
+
+    HmacSha256(const uint8_t *key, size_t keyLength);
+
+    void update(const uint8_t *data, size_t length);
+
+    void finish(uint8_t digest[kDigestSize]);
+
+private:
+    Sha256 inner_;
+    Sha256 outer_;
+};
+
+/**
+ * @brief Tree hash for integrity checks of large payloads.
+ *
+ * The payload is split into 1 MiB leaves, at least one. Each leaf digest is
+ * SHA-256(0x00 || u64 index || leaf) and the result is
+ * HMAC-SHA256(key, 0x01 || leaf digests || u64 total length), integers little-endian; an
+ * empty key gives the unkeyed digest. Leaves are independent, so digest() hashes them in
+ * parallel while update() produces the same value from a stream.
+ */
+class IntegrityHasher {
+public:
+    static constexpr size_t kDigestSize = Sha256::kDigestSize;
+    static constexpr size_t kLeafSize = 1024 * 1024;
+
+    explicit IntegrityHasher(const uint8_t *key = nullptr, size_t keyLength = 0);
+
+    void update(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Writes the digest; the hasher must not be used afterwards.
+     */
+    void finish(uint8_t digest[kDigestSize]);
+
+    /**
+     * @brief One-shot digest of `length` bytes, hashing leaves on the shared worker pool.
+     */
+    static void digest(const uint8_t *data, size_t length, const uint8_t *key, size_t keyLength,
+                       uint8_t out[kDigestSize]);
+
+private:
+    void startLeaf();
+
+    void finishLeaf();
+
+    HmacSha256 root_;
+    Sha256 leaf_;
+    uint64_t leafIndex_ = 0;
+    size_t leafFill_ = 0;
+    uint64_t totalLength_ = 0;
+};
+
+} // namespace genesis::crypto
+
+#endif // INTEGRITY_HASH_H
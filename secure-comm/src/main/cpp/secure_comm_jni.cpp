@@ -1,7 +1,12 @@
 #include <jni.h>
 #include <android/log.h>
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <string>
+#include "chacha20_poly1305.h"
 #include "crypto_engine.h"
+#include "secure_session.h"
 
 #define LOG_TAG "SecureCommNative"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
@@ -26,6 +31,203 @@ Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_initializeCrypto(
     return CryptoEngine::initialize();
 }
 
+namespace {
+
+/**
+ * Resolves `length` bytes at `offset` of a direct ByteBuffer, or nullptr if the buffer is
+ * not direct or the range is out of bounds.
+ */
+uint8_t *directRange(JNIEnv *env, jobject buffer, jlong offset, jlong length) {
+    if (buffer == nullptr || offset < 0 || length < 0) {
+        return nullptr;
+    }
+    auto *address = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    // Written so that huge caller-supplied values cannot overflow the sum.
+    if (address == nullptr || capacity < 0 || offset > capacity || length > capacity - offset) {
+        return nullptr;
+    }
+    return address + offset;
+}
+
+/**
+ * Largest heap array handed to native code through GetPrimitiveArrayCritical. A critical
+ * region stalls the GC until it is released, so it is kept to short single-threaded passes;
+ * this is also the size above which integrity hashing moves to the worker pool.
+ */
+constexpr jsize kMaxCriticalLength = 1024 * 1024;
+
+/**
+ * Scratch copy of heap array bytes, wiped on release since it may hold plaintext.
+ */
+class Scratch {
+public:
+    explicit Scratch(size_t size) : data_(new(std::nothrow) uint8_t[size]), size_(size) {}
+
+    ~Scratch() {
+        if (data_ != nullptr) {
+            genesis::crypto::secureZero(data_.get(), size_);
+        }
+    }
+
+    Scratch(const Scratch &) = delete;
+
+    Scratch &operator=(const Scratch &) = delete;
+
+    uint8_t *data() const { return data_.get(); }
+
+private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t size_;
+};
+
+/**
+ * Calls `use(bytes, length)` with the contents of heap array `data`, read-only.
+ *
+ * Arrays up to kMaxCriticalLength are pinned with GetPrimitiveArrayCritical; larger ones are
+ * copied out with GetByteArrayRegion first, so long or parallel work never runs inside a
+ * critical region. `use` must not call back into the VM.
+ *
+ * @return false, without calling `use`, if the bytes cannot be obtained.
+ */
+template<typename Use>
+bool withArrayBytes(JNIEnv *env, jbyteArray data, Use use) {
+    jsize dataLen = env->GetArrayLength(data);
+    if (dataLen > kMaxCriticalLength) {
+        Scratch scratch(static_cast<size_t>(dataLen));
+        if (scratch.data() == nullptr) {
+            return false;
+        }
+        env->GetByteArrayRegion(data, 0, dataLen, reinterpret_cast<jbyte *>(scratch.data()));
+        use(static_cast<const uint8_t *>(scratch.data()), static_cast<size_t>(dataLen));
+        return true;
+    }
+    void *dataBytes = env->GetPrimitiveArrayCritical(data, nullptr);
+    if (dataBytes == nullptr) {
+        return false;
+    }
+    use(static_cast<const uint8_t *>(dataBytes), static_cast<size_t>(dataLen));
+    env->ReleasePrimitiveArrayCritical(data, dataBytes, JNI_ABORT);
+    return true;
+}
+
+/**
+ * Runs `transform(in, inLength, out)` from heap array `data` into a new array of
+ * GetArrayLength(data) + `lengthDelta` bytes.
+ *
+ * Up to kMaxCriticalLength both arrays are pinned with GetPrimitiveArrayCritical so the
+ * cipher reads the Java array and writes the result directly. Larger payloads go through a
+ * native scratch buffer (GetByteArrayRegion in, SetByteArrayRegion out) rather than holding
+ * off the GC for the whole pass. `transform` must not call back into the VM; anything that
+ * does (key chars, allocation) happens before this.
+ *
+ * @return The result array, or nullptr if `transform` fails.
+ */
+template<typename Transform>
+jbyteArray transformArray(JNIEnv *env, jbyteArray data, jint lengthDelta, Transform transform) {
+    jsize dataLen = env->GetArrayLength(data);
+    jlong resultLen = static_cast<jlong>(dataLen) + lengthDelta;
+    if (resultLen < 0 || resultLen > INT32_MAX) {
+        return nullptr;
+    }
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(resultLen));
+    if (result == nullptr) {
+        return nullptr;
+    }
+
+    bool ok = false;
+    if (dataLen > kMaxCriticalLength) {
+        Scratch scratch(static_cast<size_t>(dataLen) + static_cast<size_t>(resultLen));
+        uint8_t *in = scratch.data();
+        if (in != nullptr) {
+            uint8_t *out = in + dataLen;
+            env->GetByteArrayRegion(data, 0, dataLen, reinterpret_cast<jbyte *>(in));
+            ok = transform(in, static_cast<size_t>(dataLen), out);
+            if (ok) {
+                env->SetByteArrayRegion(result, 0, static_cast<jsize>(resultLen),
+                                        reinterpret_cast<const jbyte *>(out));
+            }
+        }
+    } else {
+        void *dataBytes = env->GetPrimitiveArrayCritical(data, nullptr);
+        void *resultBytes = env->GetPrimitiveArrayCritical(result, nullptr);
+        ok = dataBytes != nullptr && resultBytes != nullptr &&
+             transform(static_cast<const uint8_t *>(dataBytes), static_cast<size_t>(dataLen),
+                       static_cast<uint8_t *>(resultBytes));
+        if (resultBytes != nullptr) {
+            env->ReleasePrimitiveArrayCritical(result, resultBytes, 0);
+        }
+        if (dataBytes != nullptr) {
+            env->ReleasePrimitiveArrayCritical(data, dataBytes, JNI_ABORT);
+        }
+    }
+    if (!ok) {
+        env->DeleteLocalRef(result);
+        return nullptr;
+    }
+    return result;
+}
+
+/**
+ * Runs `transform(in, length, out)` between direct buffer ranges, where the output range is
+ * `length` + `lengthDelta` bytes.
+ *
+ * @return Bytes written to `dst`, or -1 on invalid ranges or if `transform` fails.
+ */
+template<typename Transform>
+jint transformDirect(JNIEnv *env, jobject src, jint srcOffset, jint length, jobject dst,
+                     jint dstOffset, jint lengthDelta, Transform transform) {
+    const jlong outLength = static_cast<jlong>(length) + lengthDelta;
+    if (length < 0 || outLength < 0 || outLength > INT32_MAX) {
+        return -1;
+    }
+    const uint8_t *in = directRange(env, src, srcOffset, length);
+    uint8_t *out = directRange(env, dst, dstOffset, outLength);
+    if (in == nullptr || out == nullptr) {
+        return -1;
+    }
+    return transform(in, static_cast<size_t>(length), out) ? static_cast<jint>(outLength) : -1;
+}
+
+/**
+ * Key string chars for the duration of a call.
+ */
+class KeyChars {
+public:
+    KeyChars(JNIEnv *env, jstring key)
+            : env_(env), key_(key),
+              chars_(key != nullptr ? env->GetStringUTFChars(key, nullptr) : nullptr),
+              length_(chars_ != nullptr ? static_cast<size_t>(env->GetStringUTFLength(key)) : 0) {}
+
+    ~KeyChars() {
+        if (chars_ != nullptr) {
+            env_->ReleaseStringUTFChars(key_, chars_);
+        }
+    }
+
+    KeyChars(const KeyChars &) = delete;
+
+    KeyChars &operator=(const KeyChars &) = delete;
+
+    const char *chars() const { return chars_; }
+
+    size_t length() const { return length_; }
+
+private:
+    JNIEnv *env_;
+    jstring key_;
+    const char *chars_;
+    size_t length_;
+};
+
+SecureSession *fromHandle(jlong handle) {
+    return reinterpret_cast<SecureSession *>(static_cast<intptr_t>(handle));
+}
+
+constexpr jint kOverhead = static_cast<jint>(CryptoEngine::kOverhead);
+
+} // namespace
+
 extern "C" JNIEXPORT jbyteArray JNICALL
 Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_encrypt(
         JNIEnv *env,
@@ -33,57 +235,464 @@ Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_encrypt(
         jbyteArray data,
         jstring key) {
 
-    // Get input data
-    jsize dataLen = env->GetArrayLength(data);
-    jbyte *dataBytes = env->GetByteArrayElements(data, nullptr);
+    if (data == nullptr || key == nullptr) {
+        return nullptr;
+    }
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return nullptr;
+    }
 
-    // Get key
-    const char *keyStr = env->GetStringUTFChars(key, nullptr);
+    // Result is nonce || ciphertext || tag
+    return transformArray(env, data, kOverhead, [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return CryptoEngine::encrypt(in, len, keyChars.chars(), keyChars.length(), out);
+    });
+}
 
-    // Perform encryption (placeholder)
-    std::vector<uint8_t> encrypted = CryptoEngine::encrypt(
-            reinterpret_cast<uint8_t *>(dataBytes), dataLen, keyStr
-    );
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_decrypt(
+        JNIEnv *env,
+        jobject /* this */,
+        jbyteArray encryptedData,
+        jstring key) {
 
-    // Create result array
-    jbyteArray result = env->NewByteArray(encrypted.size());
-    env->SetByteArrayRegion(result, 0, encrypted.size(),
-                            reinterpret_cast<const jbyte *>(encrypted.data()));
+    if (encryptedData == nullptr || key == nullptr) {
+        return nullptr;
+    }
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return nullptr;
+    }
 
-    // Cleanup
-    env->ReleaseByteArrayElements(data, dataBytes, JNI_ABORT);
-    env->ReleaseStringUTFChars(key, keyStr);
+    // Returns null if the message fails authentication
+    return transformArray(env, encryptedData, -kOverhead,
+                          [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return CryptoEngine::decrypt(in, len, keyChars.chars(), keyChars.length(), out);
+    });
+}
 
-    return result;
+/**
+ * Encrypts `length` bytes at `srcOffset` of direct buffer `src` into direct buffer `dst` at
+ * `dstOffset`, as nonce || ciphertext || tag (length + 28 bytes). `src` and `dst` may be the
+ * same buffer; with dstOffset == srcOffset - 12 the payload is encrypted in place.
+ * Positions and limits of the buffers are not touched.
+ *
+ * @return Bytes written to `dst`, or -1 on invalid arguments or failure.
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_encryptDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jint srcOffset,
+        jint length,
+        jobject dst,
+        jint dstOffset,
+        jstring key) {
+
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return -1;
+    }
+    return transformDirect(env, src, srcOffset, length, dst, dstOffset, kOverhead,
+                           [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return CryptoEngine::encrypt(in, len, keyChars.chars(), keyChars.length(), out);
+    });
+}
+
+/**
+ * Decrypts the `length`-byte message at `srcOffset` of direct buffer `src` into direct buffer
+ * `dst` at `dstOffset` (length - 28 bytes). `src` and `dst` may be the same buffer; with
+ * dstOffset == srcOffset + 12 the payload is decrypted in place.
+ *
+ * @return Plaintext bytes written, or -1 on invalid arguments or authentication failure.
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_decryptDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jint srcOffset,
+        jint length,
+        jobject dst,
+        jint dstOffset,
+        jstring key) {
+
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return -1;
+    }
+    return transformDirect(env, src, srcOffset, length, dst, dstOffset, -kOverhead,
+                           [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return CryptoEngine::decrypt(in, len, keyChars.chars(), keyChars.length(), out);
+    });
+}
+
+/**
+ * Creates a session holding the cipher key derived from `key`, for the session* calls.
+ *
+ * @return Session handle, or 0 on failure. Release it with destroySession.
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_createSession(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring key) {
+
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return 0;
+    }
+    std::unique_ptr<SecureSession> session = SecureSession::create(keyChars.chars(),
+                                                                   keyChars.length());
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(session.release()));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_destroySession(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle) {
+
+    delete fromHandle(handle);
 }
 
 extern "C" JNIEXPORT jbyteArray JNICALL
-Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_decrypt(
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_sessionEncrypt(
         JNIEnv *env,
         jobject /* this */,
-        jbyteArray encryptedData,
+        jlong handle,
+        jbyteArray data) {
+
+    SecureSession *session = fromHandle(handle);
+    if (session == nullptr || data == nullptr) {
+        return nullptr;
+    }
+    return transformArray(env, data, kOverhead, [&](const uint8_t *in, size_t len, uint8_t *out) {
+        session->encrypt(in, len, out);
+        return true;
+    });
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_sessionDecrypt(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jbyteArray encryptedData) {
+
+    SecureSession *session = fromHandle(handle);
+    if (session == nullptr || encryptedData == nullptr) {
+        return nullptr;
+    }
+    return transformArray(env, encryptedData, -kOverhead,
+                          [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return session->decrypt(in, len, out);
+    });
+}
+
+/**
+ * Session counterpart of encryptDirect.
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_sessionEncryptDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jobject src,
+        jint srcOffset,
+        jint length,
+        jobject dst,
+        jint dstOffset) {
+
+    SecureSession *session = fromHandle(handle);
+    if (session == nullptr) {
+        return -1;
+    }
+    return transformDirect(env, src, srcOffset, length, dst, dstOffset, kOverhead,
+                           [&](const uint8_t *in, size_t len, uint8_t *out) {
+        session->encrypt(in, len, out);
+        return true;
+    });
+}
+
+/**
+ * Session counterpart of decryptDirect.
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_sessionDecryptDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong handle,
+        jobject src,
+        jint srcOffset,
+        jint length,
+        jobject dst,
+        jint dstOffset) {
+
+    SecureSession *session = fromHandle(handle);
+    if (session == nullptr) {
+        return -1;
+    }
+    return transformDirect(env, src, srcOffset, length, dst, dstOffset, -kOverhead,
+                           [&](const uint8_t *in, size_t len, uint8_t *out) {
+        return session->decrypt(in, len, out);
+    });
+}
+
+/**
+ * Size of the segmented container produced by encryptChunkedDirect for `length` bytes, or
+ * -1 if `segmentSize` is outside [4 KiB, 16 MiB].
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_chunkedCiphertextSize(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong length,
+        jint segmentSize) {
+
+    if (length < 0 || segmentSize <= 0) {
+        return -1;
+    }
+    uint64_t size = CryptoEngine::chunkedSize(length, static_cast<uint32_t>(segmentSize));
+    return size == 0 ? -1 : static_cast<jlong>(size);
+}
+
+/**
+ * Plaintext length of the segmented container at `offset` of direct buffer `src`, or -1 if
+ * it is not a valid container.
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_chunkedPlaintextSize(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong offset,
+        jlong length) {
+
+    const uint8_t *in = directRange(env, src, offset, length);
+    if (in == nullptr) {
+        return -1;
+    }
+    return CryptoEngine::chunkedPlaintextSize(in, length);
+}
+
+/**
+ * Encrypts `length` bytes of direct buffer `src` into the segmented container format in
+ * `dst`, sealing segments of `segmentSize` bytes in parallel. Meant for large blobs; a
+ * MappedByteBuffer works as either side.
+ *
+ * @return Container bytes written, or -1 on invalid arguments.
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_encryptChunkedDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong srcOffset,
+        jlong length,
+        jobject dst,
+        jlong dstOffset,
+        jint segmentSize,
         jstring key) {
 
-    // Get input data
-    jsize dataLen = env->GetArrayLength(encryptedData);
-    jbyte *dataBytes = env->GetByteArrayElements(encryptedData, nullptr);
+    if (length < 0 || segmentSize <= 0 || key == nullptr) {
+        return -1;
+    }
+    uint64_t sealedLength = CryptoEngine::chunkedSize(length, static_cast<uint32_t>(segmentSize));
+    const uint8_t *in = directRange(env, src, srcOffset, length);
+    uint8_t *out = directRange(env, dst, dstOffset, static_cast<jlong>(sealedLength));
+    if (sealedLength == 0 || in == nullptr || out == nullptr) {
+        return -1;
+    }
 
-    // Get key
-    const char *keyStr = env->GetStringUTFChars(key, nullptr);
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return -1;
+    }
+    bool sealed = CryptoEngine::encryptChunked(in, length, keyChars.chars(), keyChars.length(),
+                                               static_cast<uint32_t>(segmentSize), out);
+    return sealed ? static_cast<jlong>(sealedLength) : -1;
+}
 
-    // Perform decryption (placeholder)
-    std::vector<uint8_t> decrypted = CryptoEngine::decrypt(
-            reinterpret_cast<uint8_t *>(dataBytes), dataLen, keyStr
-    );
+/**
+ * Decrypts a whole segmented container from direct buffer `src` into `dst`, in parallel.
+ *
+ * @return Plaintext bytes written, or -1 on invalid arguments or authentication failure.
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_decryptChunkedDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong srcOffset,
+        jlong length,
+        jobject dst,
+        jlong dstOffset,
+        jstring key) {
 
-    // Create result array
-    jbyteArray result = env->NewByteArray(decrypted.size());
-    env->SetByteArrayRegion(result, 0, decrypted.size(),
-                            reinterpret_cast<const jbyte *>(decrypted.data()));
+    const uint8_t *in = directRange(env, src, srcOffset, length);
+    if (in == nullptr || key == nullptr) {
+        return -1;
+    }
+    int64_t plaintextLength = CryptoEngine::chunkedPlaintextSize(in, length);
+    uint8_t *out = directRange(env, dst, dstOffset, plaintextLength);
+    if (plaintextLength < 0 || out == nullptr) {
+        return -1;
+    }
 
-    // Cleanup
-    env->ReleaseByteArrayElements(encryptedData, dataBytes, JNI_ABORT);
-    env->ReleaseStringUTFChars(key, keyStr);
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return -1;
+    }
+    bool opened = CryptoEngine::decryptChunked(in, length, keyChars.chars(), keyChars.length(),
+                                               out);
+    return opened ? plaintextLength : -1;
+}
 
-    return result;
-}
\ No newline at end of file
+/**
+ * Decrypts segment `index` of the segmented container in direct buffer `src` into `dst`,
+ * without touching the other segments. `dst` needs room for one segment's plaintext.
+ *
+ * @return Plaintext bytes written, or -1 on invalid arguments or authentication failure.
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_decryptSegmentDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong srcOffset,
+        jlong length,
+        jlong index,
+        jobject dst,
+        jlong dstOffset,
+        jstring key) {
+
+    const uint8_t *in = directRange(env, src, srcOffset, length);
+    if (in == nullptr || key == nullptr || index < 0 || dst == nullptr || dstOffset < 0) {
+        return -1;
+    }
+    auto *address = static_cast<uint8_t *>(env->GetDirectBufferAddress(dst));
+    jlong capacity = env->GetDirectBufferCapacity(dst);
+    if (address == nullptr || capacity < 0 || dstOffset > capacity) {
+        return -1;
+    }
+
+    KeyChars keyChars(env, key);
+    if (keyChars.chars() == nullptr) {
+        return -1;
+    }
+    size_t written = 0;
+    bool opened = CryptoEngine::decryptChunkedSegment(
+            in, length, keyChars.chars(), keyChars.length(), static_cast<uint64_t>(index),
+            address + dstOffset, static_cast<size_t>(capacity - dstOffset), &written);
+    return opened ? static_cast<jint>(written) : -1;
+}
+
+/**
+ * Integrity digest of `data` as 64 hex characters, HMAC-keyed when `key` is non-null.
+ * Payloads over 1 MiB are copied out of the Java heap and hashed in parallel.
+ */
+extern "C" JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_computeIntegrity(
+        JNIEnv *env,
+        jobject /* this */,
+        jbyteArray data,
+        jstring key) {
+
+    if (data == nullptr) {
+        return nullptr;
+    }
+    KeyChars keyChars(env, key);
+    if (key != nullptr && keyChars.chars() == nullptr) {
+        return nullptr;
+    }
+    std::string digest;
+    bool read = withArrayBytes(env, data, [&](const uint8_t *bytes, size_t length) {
+        digest = CryptoEngine::computeIntegrity(bytes, length, keyChars.chars(),
+                                                keyChars.length());
+    });
+    return read ? env->NewStringUTF(digest.c_str()) : nullptr;
+}
+
+/**
+ * Checks `data` against a digest from computeIntegrity under the same key.
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_verifyIntegrity(
+        JNIEnv *env,
+        jobject /* this */,
+        jbyteArray data,
+        jstring signature,
+        jstring key) {
+
+    if (data == nullptr || signature == nullptr) {
+        return JNI_FALSE;
+    }
+    KeyChars signatureChars(env, signature);
+    KeyChars keyChars(env, key);
+    if (signatureChars.chars() == nullptr || (key != nullptr && keyChars.chars() == nullptr)) {
+        return JNI_FALSE;
+    }
+    bool valid = false;
+    bool read = withArrayBytes(env, data, [&](const uint8_t *bytes, size_t length) {
+        valid = CryptoEngine::verifyIntegrity(bytes, length, signatureChars.chars(),
+                                              keyChars.chars(), keyChars.length());
+    });
+    return read && valid ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Integrity digest of `length` bytes at `offset` of direct buffer `src`, for ROM images and
+ * other mapped files. Returns null on an invalid range.
+ */
+extern "C" JNIEXPORT jstring JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_computeIntegrityDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong offset,
+        jlong length,
+        jstring key) {
+
+    const uint8_t *in = directRange(env, src, offset, length);
+    if (in == nullptr) {
+        return nullptr;
+    }
+    KeyChars keyChars(env, key);
+    if (key != nullptr && keyChars.chars() == nullptr) {
+        return nullptr;
+    }
+    std::string digest = CryptoEngine::computeIntegrity(in, static_cast<size_t>(length),
+                                                        keyChars.chars(), keyChars.length());
+    return env->NewStringUTF(digest.c_str());
+}
+
+/**
+ * Checks `length` bytes at `offset` of direct buffer `src` against a digest from
+ * computeIntegrity under the same key.
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_dev_aurakai_auraframefx_securecomm_SecureCommNative_verifyIntegrityDirect(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject src,
+        jlong offset,
+        jlong length,
+        jstring signature,
+        jstring key) {
+
+    const uint8_t *in = directRange(env, src, offset, length);
+    if (in == nullptr || signature == nullptr) {
+        return JNI_FALSE;
+    }
+    KeyChars signatureChars(env, signature);
+    KeyChars keyChars(env, key);
+    if (signatureChars.chars() == nullptr || (key != nullptr && keyChars.chars() == nullptr)) {
+        return JNI_FALSE;
+    }
+    bool valid = CryptoEngine::verifyIntegrity(in, static_cast<size_t>(length),
+                                               signatureChars.chars(), keyChars.chars(),
+                                               keyChars.length());
+    return valid ? JNI_TRUE : JNI_FALSE;
+}
@@ -0,0 +1,131 @@
+#include "secure_random.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "chacha20_poly1305.h"
+
+namespace genesis::crypto {
+namespace {
+
+constexpr size_t kKeySize = ChaCha20::kKeySize;
+// One refill: the next key followed by output. A multiple of the block size keeps the
+// keystream on the wide SIMD path.
+constexpr size_t kBufferSize = 16 * ChaCha20::kBlockSize;
+
+// Bumped in the child after fork() so every inherited generator reseeds.
+std::atomic<uint32_t> forkGeneration{0};
+
+void onFork() {
+    forkGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool kernelRandom(uint8_t *out, size_t length) {
+    while (length > 0) {
+        const ssize_t got = getrandom(out, length, 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+class Drbg {
+public:
+    ~Drbg() {
+        secureZero(key_, sizeof(key_));
+        secureZero(buffer_, sizeof(buffer_));
+    }
+
+    bool fill(uint8_t *out, size_t length) {
+        if (!ensureSeeded()) {
+            return false;
+        }
+        while (length > 0) {
+            if (position_ == kBufferSize) {
+                if (!ensureSeeded()) {
+                    return false;
+                }
+                if (position_ == kBufferSize) {
+                    refill();
+                }
+            }
+            const size_t available = kBufferSize - position_;
+            const size_t take = length < available ? length : available;
+            memcpy(out, buffer_ + position_, take);
+            secureZero(buffer_ + position_, take);
+            position_ += take;
+            out += take;
+            length -= take;
+            generated_ += take;
+        }
+        return true;
+    }
+
+    bool ensureSeeded() {
+        const uint32_t generation = forkGeneration.load(std::memory_order_relaxed);
+        if (seeded_ && generation == generation_ && generated_ < SecureRandom::kReseedInterval) {
+            return true;
+        }
+        static const int registered = pthread_atfork(nullptr, nullptr, onFork);
+        (void) registered;
+
+        uint8_t seed[kKeySize];
+        if (!kernelRandom(seed, sizeof(seed))) {
+            return false;
+        }
+        // Mixing into the old key rather than replacing it keeps whatever entropy the state
+        // already had.
+        for (size_t i = 0; i < kKeySize; ++i) {
+            key_[i] ^= seed[i];
+        }
+        secureZero(seed, sizeof(seed));
+        refill();
+        seeded_ = true;
+        generation_ = generation;
+        generated_ = 0;
+        return true;
+    }
+
+private:
+    void refill() {
+        static constexpr uint8_t kNonce[ChaCha20::kNonceSize] = {};
+        ChaCha20 chacha;
+        chacha.init(key_, kNonce, 0);
+        memset(buffer_, 0, sizeof(buffer_));
+        chacha.apply(buffer_, buffer_, sizeof(buffer_));
+        memcpy(key_, buffer_, kKeySize);
+        secureZero(buffer_, kKeySize);
+        secureZero(&chacha, sizeof(chacha));
+        position_ = kKeySize;
+    }
+
+    uint8_t key_[kKeySize] = {};
+    uint8_t buffer_[kBufferSize];
+    size_t position_ = kBufferSize;
+    uint64_t generated_ = 0;
+    uint32_t generation_ = 0;
+    bool seeded_ = false;
+};
+
+thread_local Drbg drbg;
+
+} // namespace
+
+bool SecureRandom::fill(uint8_t *out, size_t length) {
+    return drbg.fill(out, length);
+}
+
+bool SecureRandom::seed() {
+    return drbg.ensureSeeded();
+}
+
+} // namespace genesis::crypto
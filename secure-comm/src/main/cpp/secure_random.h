@@ -0,0 +1,36 @@
+#ifndef SECURE_RANDOM_H
+#define SECURE_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::crypto {
+
+/**
+ * @brief Per-thread ChaCha20 DRBG seeded from getrandom().
+ *
+ * Each thread keeps its own generator and output buffer, so requests take no locks and
+ * make no system calls except when reseeding. The generator uses fast key erasure: every
+ * refill produces a new key along with the output, so earlier output cannot be recovered
+ * from the state. It reseeds from the kernel after kReseedInterval bytes and in the child
+ * after fork(), which matters for processes forked from the zygote.
+ */
+class SecureRandom {
+public:
+    static constexpr size_t kReseedInterval = 1024 * 1024;
+
+    /**
+     * @brief Fills `out` with `length` random bytes. Fails only if the kernel cannot supply
+     * a seed.
+     */
+    static bool fill(uint8_t *out, size_t length);
+
+    /**
+     * @brief Seeds the calling thread's generator ahead of first use.
+     */
+    static bool seed();
+};
+
+} // namespace genesis::crypto
+
+#endif // SECURE_RANDOM_H
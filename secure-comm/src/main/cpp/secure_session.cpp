@@ -0,0 +1,36 @@
+#include "secure_session.h"
+#include "chacha20_poly1305.h"
+#include <android/log.h>
+
+#define LOG_TAG "SecureSession"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+std::unique_ptr<SecureSession> SecureSession::create(const char *key, size_t keyLength) {
+    std::unique_ptr<SecureSession> session(new SecureSession());
+    if (!CryptoEngine::randomBytes(session->nonceBase_, sizeof(session->nonceBase_))) {
+        LOGE("Failed to generate session nonce base");
+        return nullptr;
+    }
+    CryptoEngine::deriveKey(key, keyLength, session->key_);
+    return session;
+}
+
+SecureSession::~SecureSession() {
+    genesis::crypto::secureZero(key_, sizeof(key_));
+}
+
+void SecureSession::encrypt(const uint8_t *data, size_t length, uint8_t *out) {
+    const uint64_t counter = counter_.fetch_add(1, std::memory_order_relaxed);
+    uint8_t nonce[CryptoEngine::kNonceSize];
+    for (size_t i = 0; i < CryptoEngine::kNonceSize; ++i) {
+        nonce[i] = nonceBase_[i];
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        nonce[CryptoEngine::kNonceSize - 8 + i] ^= static_cast<uint8_t>(counter >> (8 * i));
+    }
+    CryptoEngine::seal(key_, nonce, data, length, out);
+}
+
+bool SecureSession::decrypt(const uint8_t *data, size_t length, uint8_t *out) const {
+    return CryptoEngine::open(key_, data, length, out);
+}
@@ -0,0 +1,51 @@
+#ifndef SECURE_SESSION_H
+#define SECURE_SESSION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "crypto_engine.h"
+
+/**
+ * Genesis Protocol Secure Communication - keyed session
+ *
+ * Holds a derived cipher key so per-message calls skip key string marshalling and key
+ * derivation. Nonces are a random per-session base XORed with a message counter, so they
+ * never repeat within a session and collide across sessions only with negligible
+ * probability. Messages use the CryptoEngine::encrypt layout and are interchangeable with it.
+ * Safe to use from several threads at once.
+ */
+class SecureSession {
+public:
+    /**
+     * Create a session for a key string, or nullptr if no nonce base could be generated.
+     */
+    static std::unique_ptr<SecureSession> create(const char *key, size_t keyLength);
+
+    ~SecureSession();
+
+    SecureSession(const SecureSession &) = delete;
+
+    SecureSession &operator=(const SecureSession &) = delete;
+
+    /**
+     * Encrypt with the next nonce. `out` must hold length + CryptoEngine::kOverhead bytes.
+     */
+    void encrypt(const uint8_t *data, size_t length, uint8_t *out);
+
+    /**
+     * Decrypt and authenticate. `out` must hold length - CryptoEngine::kOverhead bytes.
+     */
+    bool decrypt(const uint8_t *data, size_t length, uint8_t *out) const;
+
+private:
+    SecureSession() = default;
+
+    uint8_t key_[CryptoEngine::kKeySize];
+    uint8_t nonceBase_[CryptoEngine::kNonceSize];
+    std::atomic<uint64_t> counter_{0};
+};
+
+#endif // SECURE_SESSION_H
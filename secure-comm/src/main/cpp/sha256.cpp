@@ -0,0 +1,146 @@
+#include "sha256.h"
+#include "crypto_dispatch.h"
+
+#include <cstring>
+
+namespace genesis::crypto {
+
+const uint32_t kSha256RoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+namespace {
+
+constexpr uint32_t kInitialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+inline uint32_t rotr(uint32_t v, int n) {
+    return (v >> n) | (v << (32 - n));
+}
+
+inline uint32_t loadBigEndian32(const uint8_t *p) {
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+inline void storeBigEndian32(uint8_t *p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+} // namespace
+
+void sha256CompressPortable(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    uint32_t w[64];
+    for (; blocks > 0; --blocks, data += Sha256::kBlockSize) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = loadBigEndian32(data + 4 * i);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                                ((e & f) ^ (~e & g)) + kSha256RoundConstants[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+                                ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+namespace {
+
+inline void compressBlocks(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    if (blocks > 0) {
+        cryptoKernels().sha256Compress(state, data, blocks);
+    }
+}
+
+} // namespace
+
+Sha256::Sha256() {
+    reset();
+}
+
+void Sha256::reset() {
+    memcpy(state_, kInitialState, sizeof(state_));
+    buffered_ = 0;
+    length_ = 0;
+}
+
+void Sha256::update(const uint8_t *data, size_t length) {
+    length_ += length;
+    if (buffered_ > 0) {
+        const size_t take = length < kBlockSize - buffered_ ? length : kBlockSize - buffered_;
+        memcpy(buffer_ + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        length -= take;
+        if (buffered_ < kBlockSize) {
+            return;
+        }
+        compressBlocks(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+    const size_t blocks = length / kBlockSize;
+    compressBlocks(state_, data, blocks);
+    data += blocks * kBlockSize;
+    length -= blocks * kBlockSize;
+    memcpy(buffer_, data, length);
+    buffered_ = length;
+}
+
+void Sha256::finish(uint8_t digest[kDigestSize]) {
+    const uint64_t bits = length_ * 8;
+    buffer_[buffered_++] = 0x80;
+    if (buffered_ > kBlockSize - 8) {
+        memset(buffer_ + buffered_, 0, kBlockSize - buffered_);
+        compressBlocks(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+    memset(buffer_ + buffered_, 0, kBlockSize - 8 - buffered_);
+    storeBigEndian32(buffer_ + kBlockSize - 8, static_cast<uint32_t>(bits >> 32));
+    storeBigEndian32(buffer_ + kBlockSize - 4, static_cast<uint32_t>(bits));
+    compressBlocks(state_, buffer_, 1);
+    for (int i = 0; i < 8; ++i) {
+        storeBigEndian32(digest + 4 * i, state_[i]);
+    }
+}
+
+void Sha256::hash(const uint8_t *data, size_t length, uint8_t digest[kDigestSize]) {
+    Sha256 sha;
+    sha.update(data, length);
+    sha.finish(digest);
+}
+
+} // namespace genesis::crypto
@@ -0,0 +1,44 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::crypto {
+
+/**
+ * @brief Streaming SHA-256 (FIPS 180-4).
+ *
+ * Used to derive fixed-size cipher keys from the string keys passed in by Kotlin and for
+ * integrity hashing. Blocks are compressed with the SHA-NI or ARMv8 SHA-2 instructions when
+ * the CPU has them, chosen once at first use.
+ */
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+
+    Sha256();
+
+    void update(const uint8_t *data, size_t length);
+
+    /**
+     * @brief Writes the digest and leaves the object in an unspecified state; call reset()
+     * to reuse it.
+     */
+    void finish(uint8_t digest[kDigestSize]);
+
+    void reset();
+
+    static void hash(const uint8_t *data, size_t length, uint8_t digest[kDigestSize]);
+
+private:
+    uint32_t state_[8];
+    uint8_t buffer_[kBlockSize];
+    size_t buffered_;
+    uint64_t length_;
+};
+
+} // namespace genesis::crypto
+
+#endif // SHA256_H
@@ -0,0 +1,46 @@
+#include "sha256_kernels.h"
+
+#if defined(__aarch64__)
+
+#include <arm_neon.h>
+
+namespace genesis::crypto {
+
+// Built with -march=armv8-a+crypto; see CMakeLists.txt.
+void sha256CompressArmv8(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const uint32x4_t abcdSave = state0;
+        const uint32x4_t efghSave = state1;
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; ++i) {
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+        }
+
+        // Sixteen groups of four rounds. msg[g % 4] holds the schedule words for group g and
+        // is then extended in place to the words for group g + 4.
+        for (int group = 0; group < 16; ++group) {
+            uint32x4_t &current = msg[group % 4];
+            const uint32x4_t k = vaddq_u32(current, vld1q_u32(kSha256RoundConstants + 4 * group));
+            if (group < 12) {
+                current = vsha256su0q_u32(current, msg[(group + 1) % 4]);
+                current = vsha256su1q_u32(current, msg[(group + 2) % 4], msg[(group + 3) % 4]);
+            }
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, k);
+            state1 = vsha256h2q_u32(state1, abcd, k);
+        }
+
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+    }
+
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+}
+
+} // namespace genesis::crypto
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SHA256_KERNELS_H
+#define SHA256_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace genesis::crypto {
+
+// SHA-256 compression over whole 64-byte blocks. The hardware kernels live in their own
+// translation units, built with the matching instruction set flags, and are only called
+// after the CPU reports support at runtime.
+using Sha256CompressFn = void (*)(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+extern const uint32_t kSha256RoundConstants[64];
+
+void sha256CompressPortable(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+#if defined(__aarch64__)
+// ARMv8 Cryptography Extensions (SHA256H/SHA256H2/SHA256SU0/SHA256SU1).
+void sha256CompressArmv8(uint32_t state[8], const uint8_t *data, size_t blocks);
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+// Intel SHA extensions (SHA-NI), which also need SSE4.1.
+void sha256CompressShaNi(uint32_t state[8], const uint8_t *data, size_t blocks);
+#endif
+
+} // namespace genesis::crypto
+
+#endif // SHA256_KERNELS_H
@@ -0,0 +1,63 @@
+#include "sha256_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+namespace genesis::crypto {
+
+// Built with -msse4.1 -msha; see CMakeLists.txt.
+void sha256CompressShaNi(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions keep the state as ABEF / CDGH.
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4)), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i) {
+            msg[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * i)), byteSwap);
+        }
+
+        // Sixteen groups of four rounds. msg[g % 4] holds the schedule words for group g;
+        // msg1/msg2 extend the schedule three groups ahead.
+        for (int group = 0; group < 16; ++group) {
+            __m128i &current = msg[group % 4];
+            __m128i k = _mm_add_epi32(current, _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(kSha256RoundConstants + 4 * group)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, k);
+            if (group >= 3 && group <= 14) {
+                __m128i &next = msg[(group + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, msg[(group + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            k = _mm_shuffle_epi32(k, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, k);
+            if (group >= 1 && group <= 12) {
+                __m128i &previous = msg[(group + 3) % 4];
+                previous = _mm_sha256msg1_epu32(previous, current);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), state1);
+}
+
+} // namespace genesis::crypto
+
+#endif
@@ -0,0 +1,97 @@
+#include "worker_pool.h"
+
+#include <atomic>
+
+namespace genesis::crypto {
+
+struct WorkerPool::Job {
+    const std::function<void(size_t)> *body;
+    size_t count;
+    std::atomic<size_t> next{0};
+};
+
+WorkerPool &WorkerPool::shared() {
+    static WorkerPool pool(std::thread::hardware_concurrency() > 1
+                           ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
+
+WorkerPool::WorkerPool(unsigned threads) {
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread: threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::runJob(Job &job) {
+    for (size_t i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.count;
+         i = job.next.fetch_add(1, std::memory_order_relaxed)) {
+        (*job.body)(i);
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || threads_.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> callerLock(callerMutex_);
+    Job job;
+    job.body = &body;
+    job.count = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runJob(job);
+
+    // Workers that have not picked the job up yet must not see it once it leaves scope.
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = nullptr;
+    idle_.wait(lock, [this] { return active_ == 0; });
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        Job *job = job_;
+        if (job == nullptr) {
+            continue;
+        }
+        ++active_;
+        lock.unlock();
+        runJob(*job);
+        lock.lock();
+        if (--active_ == 0) {
+            idle_.notify_all();
+        }
+    }
+}
+
+} // namespace genesis::crypto
@@ -0,0 +1,64 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace genesis::crypto {
+
+/**
+ * @brief Fixed set of threads for data-parallel loops.
+ *
+ * Threads are started once and sleep between jobs, so a parallel loop costs a wakeup rather
+ * than thread creation. One job runs at a time; concurrent callers queue on a mutex.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Process-wide pool with one thread per core besides the caller's.
+     */
+    static WorkerPool &shared();
+
+    explicit WorkerPool(unsigned threads);
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * @brief Calls body(i) for every i in [0, count) across the pool and the calling thread,
+     * returning once all calls have finished. Indices are claimed one at a time, so each
+     * should carry a meaningful amount of work.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    unsigned threadCount() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct Job;
+
+    void workerLoop();
+
+    static void runJob(Job &job);
+
+    std::vector<std::thread> threads_;
+    std::mutex callerMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    Job *job_ = nullptr;
+    uint64_t generation_ = 0;
+    unsigned active_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace genesis::crypto
+
+#endif // WORKER_POOL_H